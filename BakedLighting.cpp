@@ -0,0 +1,318 @@
+///////////////////////////////////////////////////////////////////////////////
+// bakedlighting.cpp
+// ============
+// draw static objects lit by a baked lightmap instead of the scene lights
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BakedLighting.h"
+#include "ShaderProgram.h"
+#include "GpuMemory.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* const g_BakedVertexSource = R"GLSL(
+#version 330 core
+layout(location = 0) in vec3 inVertexPosition;
+layout(location = 1) in vec3 inVertexNormal;
+layout(location = 2) in vec2 inTextureCoordinate;
+
+uniform mat4 model;
+uniform mat4 viewProjection;
+
+out vec3 fragLocalPosition;
+out vec3 fragLocalNormal;
+out vec2 fragUV;
+
+void main()
+{
+	gl_Position = viewProjection * model * vec4(inVertexPosition, 1.0);
+	fragLocalPosition = inVertexPosition;
+	fragLocalNormal = inVertexNormal;
+	fragUV = inTextureCoordinate;
+}
+)GLSL";
+
+	// ChartTexel() must unfold the shapes exactly like
+	// FindChart() and GetChartBounds() in LightmapBaker
+	const char* const g_BakedFragmentSource = R"GLSL(
+#version 330 core
+in vec3 fragLocalPosition;
+in vec3 fragLocalNormal;
+in vec2 fragUV;
+out vec4 fragmentColor;
+
+// 0 plane, 1 box, 2 four sided pyramid, 3 cone
+uniform int chartShape;
+// first texel and side of the object's square in the atlas
+uniform vec3 objectRect;
+uniform vec2 atlasSize;
+uniform float gutterTexels;
+uniform sampler2D lightmap;
+
+uniform sampler2D objectTexture;
+uniform vec2 uvScale;
+uniform vec3 ambientLight;
+uniform vec3 ambientColor;
+uniform float ambientStrength;
+uniform vec3 diffuseColor;
+
+const float PI = 3.14159265;
+
+vec2 ChartTexel(vec3 p, vec3 n)
+{
+	// grid cells of the chart, as x, y, width and height
+	vec2 grid = vec2(3.0, 2.0);
+	vec4 chart = vec4(0.0, 0.0, 1.0, 1.0);
+	vec2 point = (p.xz + 1.0) * 0.5;
+
+	if (chartShape == 1)
+	{
+		vec3 size = abs(n);
+		int axis = (size.x >= size.y) ? ((size.x >= size.z) ? 0 : 2) : ((size.y >= size.z) ? 1 : 2);
+		int index = axis * 2 + ((n[axis] < 0.0) ? 1 : 0);
+		point = vec2(p[(axis + 1) % 3], p[(axis + 2) % 3]) + 0.5;
+		chart.xy = vec2(index % 3, index / 3);
+	}
+	else if (chartShape == 2)
+	{
+		int index = 4;
+		point = p.xz + 0.5;
+		if (n.y >= -0.5)
+		{
+			if (abs(n.x) >= abs(n.z))
+			{
+				point = p.zy + 0.5;
+				index = (n.x >= 0.0) ? 0 : 1;
+			}
+			else
+			{
+				point = p.xy + 0.5;
+				index = (n.z >= 0.0) ? 2 : 3;
+			}
+		}
+		chart.xy = vec2(index % 3, index / 3);
+	}
+	else if (chartShape == 3)
+	{
+		if (n.y < -0.5)
+		{
+			chart.xy = vec2(0.0, 1.0);
+		}
+		else
+		{
+			point = vec2((atan(p.z, p.x) + PI) / (2.0 * PI), p.y);
+			chart.z = 3.0;
+		}
+	}
+	else
+	{
+		grid = vec2(1.0);
+	}
+
+	vec2 cellSize = objectRect.z / grid;
+	vec2 low = chart.xy * cellSize + gutterTexels;
+	vec2 high = (chart.xy + chart.zw) * cellSize - gutterTexels;
+	return low + clamp(point, 0.0, 1.0) * (high - low);
+}
+
+void main()
+{
+	vec2 texel = objectRect.xy + ChartTexel(fragLocalPosition, fragLocalNormal);
+	vec3 irradiance = texture(lightmap, texel / atlasSize).rgb;
+	vec4 albedo = texture(objectTexture, fragUV * uvScale);
+
+	vec3 ambient = (ambientLight + ambientStrength) * ambientColor;
+	vec3 diffuse = diffuseColor * irradiance;
+
+	fragmentColor = vec4((ambient + diffuse) * albedo.rgb, albedo.a);
+}
+)GLSL";
+
+	/***********************************************************
+	 *  GetChartShape()
+	 *
+	 *  This function returns the chart shape number the
+	 *  program uses for a basic shape.
+	 ***********************************************************/
+	int GetChartShape(MeshRegistry::MESH_PRIMITIVE primitive)
+	{
+		switch (primitive)
+		{
+		case MeshRegistry::MESH_PRIMITIVE_BOX:
+			return(1);
+		case MeshRegistry::MESH_PRIMITIVE_PYRAMID4:
+			return(2);
+		case MeshRegistry::MESH_PRIMITIVE_CONE:
+			return(3);
+		default:
+			return(0);
+		}
+	}
+}
+
+/***********************************************************
+ *  BakedLighting()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BakedLighting::BakedLighting()
+{
+	m_width = 0;
+	m_height = 0;
+	m_ambientLight = glm::vec3(0.0f);
+	m_previousProgram = 0;
+}
+
+/***********************************************************
+ *  ~BakedLighting()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BakedLighting::~BakedLighting()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to upload the baked atlas as a half
+ *  float texture and create the program that draws with it.
+ *  The atlas has no mip levels, the gutters around the
+ *  charts only cover linear filtering.
+ ***********************************************************/
+bool BakedLighting::Initialize(const LightmapBaker::BAKED_LIGHTMAP& lightmap)
+{
+	Destroy();
+
+	m_program = GpuProgram(CreateShaderProgram(g_BakedVertexSource, g_BakedFragmentSource, "baked lighting"));
+	if (!m_program.IsValid())
+	{
+		return(false);
+	}
+
+	glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+	m_lightmap = GpuTexture::Create();
+	glBindTexture(GL_TEXTURE_2D, m_lightmap.Get());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, lightmap.width, lightmap.height, 0, GL_RGB, GL_FLOAT, lightmap.irradiance.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	// three half floats per texel
+	m_lightmap.TrackMemory(GPU_MEMORY_TEXTURES, GpuMemory::EstimateImageBytes(lightmap.width, lightmap.height, 6, false));
+	glActiveTexture(GL_TEXTURE0);
+
+	m_width = lightmap.width;
+	m_height = lightmap.height;
+	m_objectRects = lightmap.objectRects;
+
+	std::cout << "INFO: Baked lighting atlas is " << m_width << "x" << m_height
+		<< " texels for " << m_objectRects.size() << " objects" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the atlas and the program.
+ ***********************************************************/
+void BakedLighting::Destroy()
+{
+	m_lightmap.Reset();
+	m_program.Reset();
+	m_objectRects.clear();
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  BeginDraw()
+ *
+ *  This method is used to switch to the lightmap program and
+ *  bind the atlas. The atlas is bound again every time,
+ *  because each window has its own texture unit bindings.
+ ***********************************************************/
+void BakedLighting::BeginDraw(const glm::mat4& viewProjection)
+{
+	glGetIntegerv(GL_CURRENT_PROGRAM, &m_previousProgram);
+
+	GLuint program = m_program.Get();
+	glUseProgram(program);
+
+	glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_lightmap.Get());
+	glActiveTexture(GL_TEXTURE0);
+
+	glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+	glUniform1i(glGetUniformLocation(program, "lightmap"), LIGHTMAP_TEXTURE_UNIT);
+	glUniform2f(glGetUniformLocation(program, "atlasSize"), (float)m_width, (float)m_height);
+	glUniform1f(glGetUniformLocation(program, "gutterTexels"), (float)LightmapBaker::GUTTER_TEXELS);
+	glUniform3fv(glGetUniformLocation(program, "ambientLight"), 1, glm::value_ptr(m_ambientLight));
+}
+
+/***********************************************************
+ *  EndDraw()
+ *
+ *  This method is used to switch back to the scene program.
+ ***********************************************************/
+void BakedLighting::EndDraw()
+{
+	glUseProgram((GLuint)m_previousProgram);
+}
+
+/***********************************************************
+ *  SetMaterial()
+ *
+ *  This method is used to set the material values of the
+ *  objects drawn next.
+ ***********************************************************/
+void BakedLighting::SetMaterial(const glm::vec3& ambientColor, float ambientStrength, const glm::vec3& diffuseColor)
+{
+	GLuint program = m_program.Get();
+	glUniform3fv(glGetUniformLocation(program, "ambientColor"), 1, glm::value_ptr(ambientColor));
+	glUniform1f(glGetUniformLocation(program, "ambientStrength"), ambientStrength);
+	glUniform3fv(glGetUniformLocation(program, "diffuseColor"), 1, glm::value_ptr(diffuseColor));
+}
+
+/***********************************************************
+ *  SetTexture()
+ *
+ *  This method is used to set the texture unit the objects
+ *  drawn next are textured from.
+ ***********************************************************/
+void BakedLighting::SetTexture(int textureSlot)
+{
+	glUniform1i(glGetUniformLocation(m_program.Get(), "objectTexture"), textureSlot);
+}
+
+/***********************************************************
+ *  SetObject()
+ *
+ *  This method is used to set the model matrix, the texture
+ *  scale and the square of the atlas of the next object.
+ ***********************************************************/
+void BakedLighting::SetObject(int objectIndex, MeshRegistry::MESH_PRIMITIVE primitive, const glm::mat4& model, const glm::vec2& uvScale)
+{
+	GLuint program = m_program.Get();
+	glm::vec3 objectRect(0.0f);
+	if ((objectIndex >= 0) && (objectIndex < (int)m_objectRects.size()))
+	{
+		const glm::ivec3& rect = m_objectRects[objectIndex];
+		objectRect = glm::vec3((float)rect.x, (float)rect.y, (float)rect.z);
+	}
+
+	glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(model));
+	glUniform2fv(glGetUniformLocation(program, "uvScale"), 1, glm::value_ptr(uvScale));
+	glUniform3fv(glGetUniformLocation(program, "objectRect"), 1, glm::value_ptr(objectRect));
+	glUniform1i(glGetUniformLocation(program, "chartShape"), GetChartShape(primitive));
+}
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// bakedlighting.h
+// ============
+// draw static objects lit by a baked lightmap instead of the scene lights
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResource.h"
+#include "LightmapBaker.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  BakedLighting
+ *
+ *  This class uploads a baked lightmap atlas and draws the
+ *  static objects with it. The basic meshes have no second
+ *  set of texture coordinates, so the program finds the
+ *  texel of a fragment from its local position and normal
+ *  with the same charts LightmapBaker unfolds the shapes
+ *  into. The diffuse light comes from the atlas, only the
+ *  ambient light of the material is still computed.
+ ***********************************************************/
+class BakedLighting
+{
+public:
+	// texture unit of the atlas, above the virtual texture units
+	static const int LIGHTMAP_TEXTURE_UNIT = 21;
+
+	// constructor
+	BakedLighting();
+	// destructor
+	~BakedLighting();
+
+	// upload the atlas and create the program
+	bool Initialize(const LightmapBaker::BAKED_LIGHTMAP& lightmap);
+	// free the atlas and the program
+	void Destroy();
+	bool IsInitialized() const { return(m_program.IsValid()); }
+
+	// set the ambient light of all the scene lights together
+	void SetAmbientLight(const glm::vec3& ambientLight) { m_ambientLight = ambientLight; }
+
+	// use the program that draws with the lightmap
+	void BeginDraw(const glm::mat4& viewProjection);
+	// restore the program that was in use before BeginDraw()
+	void EndDraw();
+
+	// set the material values of the next objects
+	void SetMaterial(const glm::vec3& ambientColor, float ambientStrength, const glm::vec3& diffuseColor);
+	// set the texture unit of the next objects
+	void SetTexture(int textureSlot);
+	// set the next object, by its index in the baked objects
+	void SetObject(int objectIndex, MeshRegistry::MESH_PRIMITIVE primitive, const glm::mat4& model, const glm::vec2& uvScale);
+
+private:
+	GpuTexture m_lightmap;
+	GpuProgram m_program;
+	int m_width;
+	int m_height;
+	std::vector<glm::ivec3> m_objectRects;
+	glm::vec3 m_ambientLight;
+	// the program to restore after drawing
+	GLint m_previousProgram;
+};
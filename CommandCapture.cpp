@@ -0,0 +1,350 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandcapture.cpp
+// ============
+// capture the render calls of whole frames to a file and replay them
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CommandCapture.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdint.h>
+
+// declaration of global variables
+namespace
+{
+	// identifies a capture file, and its layout version
+	const uint32_t CAPTURE_MAGIC = 0x50434C47;
+	const uint32_t CAPTURE_VERSION = 2;
+	// longest name of a shader value that a file may hold
+	const uint32_t MAX_NAME_LENGTH = 256;
+
+	// values stored at the start of every capture file, the
+	// names follow as a length and their characters, and then
+	// the command lists of the frames
+	struct CAPTURE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t frameCount;
+		uint32_t nameCount;
+	};
+}
+
+/***********************************************************
+ *  CommandCapture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CommandCapture::CommandCapture()
+{
+	m_pTarget = NULL;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used to start keeping the calls of
+ *  another frame in a list of its own.
+ ***********************************************************/
+void CommandCapture::BeginFrame()
+{
+	m_frames.push_back(RenderCommandList());
+}
+
+/***********************************************************
+ *  SetMat4Value()
+ *
+ *  This method is used to pass a call on to the target and
+ *  keep it in the current frame. The other calls are passed
+ *  on and kept the same way.
+ ***********************************************************/
+void CommandCapture::SetMat4Value(const char* name, const glm::mat4& value)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetMat4Value(name, value);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetMat4Value(name, value);
+	}
+}
+
+void CommandCapture::SetVec4Value(const char* name, const glm::vec4& value)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetVec4Value(name, value);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetVec4Value(name, value);
+	}
+}
+
+void CommandCapture::SetVec3Value(const char* name, const glm::vec3& value)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetVec3Value(name, value);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetVec3Value(name, value);
+	}
+}
+
+void CommandCapture::SetVec2Value(const char* name, const glm::vec2& value)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetVec2Value(name, value);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetVec2Value(name, value);
+	}
+}
+
+void CommandCapture::SetFloatValue(const char* name, float value)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetFloatValue(name, value);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetFloatValue(name, value);
+	}
+}
+
+void CommandCapture::SetIntValue(const char* name, int value)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetIntValue(name, value);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetIntValue(name, value);
+	}
+}
+
+void CommandCapture::SetBoolValue(const char* name, bool value)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetBoolValue(name, value);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetBoolValue(name, value);
+	}
+}
+
+void CommandCapture::SetSampler2DValue(const char* name, int textureUnit)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetSampler2DValue(name, textureUnit);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetSampler2DValue(name, textureUnit);
+	}
+}
+
+void CommandCapture::BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->BindSampler(textureUnit, tier, wrap);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->BindSampler(textureUnit, tier, wrap);
+	}
+}
+
+void CommandCapture::DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->DrawMesh(pMeshRegistry, handle);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->DrawMesh(pMeshRegistry, handle);
+	}
+}
+
+void CommandCapture::SetViewport(int x, int y, int width, int height)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->SetViewport(x, y, width, height);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->SetViewport(x, y, width, height);
+	}
+}
+
+void CommandCapture::ClearRegion(int x, int y, int width, int height)
+{
+	if (NULL != m_pTarget)
+	{
+		m_pTarget->ClearRegion(x, y, width, height);
+	}
+	RenderCommandList* pRecording = GetRecording();
+	if (NULL != pRecording)
+	{
+		pRecording->ClearRegion(x, y, width, height);
+	}
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method is used to write every frame into a file.
+ *  The frames are written first into memory, which collects
+ *  the names they use, so the names can go in front of them.
+ *  The file is written under a temporary name and renamed,
+ *  so a run that stops part way never leaves a broken file.
+ ***********************************************************/
+bool CommandCapture::Save(const std::string& path) const
+{
+	std::map<std::string, uint32_t> nameIndices;
+	std::ostringstream frames(std::ios::binary);
+	for (size_t i = 0; i < m_frames.size(); i++)
+	{
+		if (!m_frames[i].Write(frames, nameIndices))
+		{
+			return(false);
+		}
+	}
+
+	// the names in the order of their indices
+	std::vector<const std::string*> names(nameIndices.size(), NULL);
+	for (std::map<std::string, uint32_t>::const_iterator name = nameIndices.begin(); name != nameIndices.end(); ++name)
+	{
+		names[name->second] = &name->first;
+	}
+
+	std::string temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			std::cout << "ERROR: could not write the capture " << path << std::endl;
+			return(false);
+		}
+
+		CAPTURE_HEADER header;
+		header.magic = CAPTURE_MAGIC;
+		header.version = CAPTURE_VERSION;
+		header.frameCount = (uint32_t)m_frames.size();
+		header.nameCount = (uint32_t)names.size();
+		file.write((const char*)&header, sizeof(header));
+
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			uint32_t length = (uint32_t)names[i]->size();
+			file.write((const char*)&length, sizeof(length));
+			file.write(names[i]->data(), length);
+		}
+
+		std::string frameBytes = frames.str();
+		file.write(frameBytes.data(), (std::streamsize)frameBytes.size());
+
+		if (!file)
+		{
+			file.close();
+			std::remove(temporaryPath.c_str());
+			std::cout << "ERROR: could not write the capture " << path << std::endl;
+			return(false);
+		}
+	}
+
+	std::remove(path.c_str());
+	std::rename(temporaryPath.c_str(), path.c_str());
+
+	return(true);
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used to replace the frames with the ones
+ *  of a capture file. No frames are kept when the file is
+ *  not a valid capture. The names and frames are added as
+ *  they are read, so the counts of a broken file are never
+ *  allocated up front.
+ ***********************************************************/
+bool CommandCapture::Load(const std::string& path, const MeshRegistry* pMeshRegistry)
+{
+	m_frames.clear();
+	m_names.clear();
+
+	std::ifstream file(path.c_str(), std::ios::binary);
+	CAPTURE_HEADER header;
+	if (!file ||
+		!file.read((char*)&header, sizeof(header)) ||
+		(header.magic != CAPTURE_MAGIC) ||
+		(header.version != CAPTURE_VERSION))
+	{
+		std::cout << "ERROR: " << path << " is not a capture file" << std::endl;
+		return(false);
+	}
+
+	// the names are all read before any frame points into them
+	for (uint32_t i = 0; i < header.nameCount; i++)
+	{
+		uint32_t length = 0;
+		char name[MAX_NAME_LENGTH];
+		if (!file.read((char*)&length, sizeof(length)) ||
+			(length > MAX_NAME_LENGTH) ||
+			((length > 0) && !file.read(name, length)))
+		{
+			std::cout << "ERROR: the capture " << path << " has a broken name table" << std::endl;
+			m_names.clear();
+			return(false);
+		}
+		m_names.push_back(std::string(name, length));
+	}
+
+	std::vector<const char*> names(m_names.size(), NULL);
+	for (size_t i = 0; i < m_names.size(); i++)
+	{
+		names[i] = m_names[i].c_str();
+	}
+
+	for (uint32_t i = 0; i < header.frameCount; i++)
+	{
+		m_frames.push_back(RenderCommandList());
+		if (!file || !m_frames.back().Read(file, names, pMeshRegistry))
+		{
+			std::cout << "ERROR: the capture " << path << " ends part way through frame " << i << std::endl;
+			m_frames.clear();
+			m_names.clear();
+			return(false);
+		}
+	}
+
+	return(true);
+}
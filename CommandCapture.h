@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandcapture.h
+// ============
+// capture the render calls of whole frames to a file and replay them
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RenderCommandList.h"
+
+/***********************************************************
+ *  CommandCapture
+ *
+ *  This class sits between the scene and its backend and
+ *  passes every call on, keeping a copy of each frame in a
+ *  command list. The frames are saved in a compact binary
+ *  file, and a file can be loaded and its frames submitted
+ *  as fast as the driver takes them, so the cost of the
+ *  driver can be measured apart from the cost of building
+ *  the frames. A replay uses the meshes, textures and
+ *  samplers of a scene prepared with the same options as the
+ *  one that was captured, since only their handles, and the
+ *  tier and wrap mode of the samplers, are kept. Only calls
+ *  made through the backend are captured, so the features
+ *  that draw with OpenGL and programs of their own, such as
+ *  the lightmaps, the virtual ground, the shadow cubes, the
+ *  occlusion queries and the anti-aliasing resolve, cannot be
+ *  on while capturing.
+ ***********************************************************/
+class CommandCapture : public RenderBackend
+{
+public:
+	// constructor
+	CommandCapture();
+
+	// set the backend the calls are passed on to, which can be
+	// NULL to only keep them
+	void SetTarget(RenderBackend* pTarget) { m_pTarget = pTarget; }
+	RenderBackend* GetTarget() const { return(m_pTarget); }
+	// start keeping the calls of another frame, the calls made
+	// before the first frame are only passed on
+	void BeginFrame();
+	int GetFrameCount() const { return((int)m_frames.size()); }
+	const RenderCommandList& GetFrame(int index) const { return(m_frames[index]); }
+
+	// write every frame into a file
+	bool Save(const std::string& path) const;
+	// replace the frames with the ones of a file, drawn with the
+	// meshes of the passed in registry
+	bool Load(const std::string& path, const MeshRegistry* pMeshRegistry);
+
+	bool IsGpuBackend() const { return((NULL == m_pTarget) || m_pTarget->IsGpuBackend()); }
+
+	void SetMat4Value(const char* name, const glm::mat4& value);
+	void SetVec4Value(const char* name, const glm::vec4& value);
+	void SetVec3Value(const char* name, const glm::vec3& value);
+	void SetVec2Value(const char* name, const glm::vec2& value);
+	void SetFloatValue(const char* name, float value);
+	void SetIntValue(const char* name, int value);
+	void SetBoolValue(const char* name, bool value);
+	void SetSampler2DValue(const char* name, int textureUnit);
+
+	void BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap);
+	void DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle);
+	void SetViewport(int x, int y, int width, int height);
+	void ClearRegion(int x, int y, int width, int height);
+
+private:
+	// the list the current frame is kept in, NULL before the
+	// first frame
+	RenderCommandList* GetRecording() { return(m_frames.empty() ? NULL : &m_frames.back()); }
+
+	RenderBackend* m_pTarget;
+	std::vector<RenderCommandList> m_frames;
+	// the names of a loaded file, which the frames point into
+	std::vector<std::string> m_names;
+};
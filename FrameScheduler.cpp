@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////
+// framescheduler.cpp
+// ============
+// run queued work of the GL thread within a time budget of every frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// frame target until one is set, 60 frames per second
+	const double DEFAULT_FRAME_TARGET = 1000.0 / 60.0;
+
+	/***********************************************************
+	 *  GetMilliseconds()
+	 *
+	 *  This function returns the time since a point in time.
+	 ***********************************************************/
+	double GetMilliseconds(const std::chrono::high_resolution_clock::time_point& since)
+	{
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - since;
+
+		return(elapsed.count());
+	}
+}
+
+/***********************************************************
+ *  FrameScheduler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameScheduler::FrameScheduler()
+{
+	m_frameTarget = DEFAULT_FRAME_TARGET;
+	m_frameStart = std::chrono::high_resolution_clock::now();
+	m_frames = 0;
+	m_slices = 0;
+	m_backlogFrames = 0;
+	m_budgetTotal = 0.0;
+	m_workTotal = 0.0;
+	m_longestSlice = 0.0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used to mark the start of a frame, the
+ *  time the frame has taken is measured from here.
+ ***********************************************************/
+void FrameScheduler::BeginFrame()
+{
+	m_frameStart = std::chrono::high_resolution_clock::now();
+}
+
+/***********************************************************
+ *  Post()
+ *
+ *  This method is used to queue a task at the end of the
+ *  queue. A source of work that posts every frame only has
+ *  one task queued at a time, which picks up everything the
+ *  source has when it runs.
+ ***********************************************************/
+bool FrameScheduler::Post(const std::string& name, const FRAME_TASK& task)
+{
+	if (IsQueued(name))
+	{
+		return(false);
+	}
+
+	QUEUED_TASK queued;
+	queued.name = name;
+	queued.task = task;
+	m_tasks.push_back(queued);
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsQueued()
+ *
+ *  This method is used to find a queued task by name.
+ ***********************************************************/
+bool FrameScheduler::IsQueued(const std::string& name) const
+{
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		if (m_tasks[i].name == name)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  RunQueued()
+ *
+ *  This method is used to run slices of the queued tasks for
+ *  the time that is left of the frame target, less a margin
+ *  for the swap and never more than a fraction of the target.
+ *  A task with more to do goes to the back of the queue, so
+ *  no task holds up the others. The first slice always runs,
+ *  even when the frame is already late.
+ ***********************************************************/
+void FrameScheduler::RunQueued()
+{
+	double remaining = m_frameTarget - SWAP_MARGIN_MILLISECONDS - GetMilliseconds(m_frameStart);
+	double budget = std::min(remaining, m_frameTarget * MAX_BUDGET_FRACTION);
+	if (budget < MIN_BUDGET_MILLISECONDS)
+	{
+		budget = MIN_BUDGET_MILLISECONDS;
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	double elapsed = 0.0;
+	while (!m_tasks.empty() && (elapsed < budget))
+	{
+		QUEUED_TASK queued = m_tasks.front();
+		m_tasks.pop_front();
+
+		double sliceStart = elapsed;
+		bool bMoreWork = queued.task();
+		elapsed = GetMilliseconds(start);
+
+		if (bMoreWork)
+		{
+			m_tasks.push_back(queued);
+		}
+		m_longestSlice = std::max(m_longestSlice, elapsed - sliceStart);
+		m_slices++;
+	}
+
+	m_frames++;
+	m_budgetTotal += budget;
+	m_workTotal += elapsed;
+	if (!m_tasks.empty())
+	{
+		m_backlogFrames++;
+	}
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used to print the average budget and work
+ *  of a frame, the longest slice, and the frames that ended
+ *  with work still queued.
+ ***********************************************************/
+void FrameScheduler::Report()
+{
+	if ((m_frames > 0) && (m_slices > 0))
+	{
+		std::cout << "INFO: Frame scheduler budget " << (m_budgetTotal / m_frames) << " ms"
+			<< ", work " << (m_workTotal / m_frames) << " ms"
+			<< ", longest slice " << m_longestSlice << " ms"
+			<< ", " << m_slices << " slices"
+			<< ", " << m_backlogFrames << " of " << m_frames << " frames left work queued" << std::endl;
+	}
+
+	m_frames = 0;
+	m_slices = 0;
+	m_backlogFrames = 0;
+	m_budgetTotal = 0.0;
+	m_workTotal = 0.0;
+	m_longestSlice = 0.0;
+}
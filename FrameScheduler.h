@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// framescheduler.h
+// ============
+// run queued work of the GL thread within a time budget of every frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+
+/***********************************************************
+ *  FrameScheduler
+ *
+ *  This class keeps the work that has to run on the thread
+ *  of a context but not in any particular frame, such as
+ *  streamed uploads and deletions. Each task does one small
+ *  slice of its work per call, and the queue is run once per
+ *  frame for only the time that is left of the frame target,
+ *  taking turns between the tasks, so the work is spread
+ *  over frames instead of making one of them late. At least
+ *  one slice runs every frame, so the work always finishes.
+ ***********************************************************/
+class FrameScheduler
+{
+public:
+	// one slice of work, called again while it returns true
+	typedef std::function<bool()> FRAME_TASK;
+
+	// shortest time the queue gets in a frame that is late
+	static constexpr double MIN_BUDGET_MILLISECONDS = 0.25;
+	// most of the frame target the queue can take
+	static constexpr double MAX_BUDGET_FRACTION = 0.25;
+	// time kept free at the end of the frame for the swap
+	static constexpr double SWAP_MARGIN_MILLISECONDS = 1.0;
+
+	// constructor
+	FrameScheduler();
+
+	// set the time a frame should take, such as the refresh
+	// interval of the display
+	void SetFrameTarget(double milliseconds) { m_frameTarget = milliseconds; }
+	double GetFrameTarget() const { return(m_frameTarget); }
+
+	// mark the start of the frame the budget is measured from
+	void BeginFrame();
+	// queue a task, unless a task of the same name is queued,
+	// returns false when it was not queued
+	bool Post(const std::string& name, const FRAME_TASK& task);
+	bool IsQueued(const std::string& name) const;
+	int GetQueuedCount() const { return((int)m_tasks.size()); }
+	// run slices of the queued tasks until the time left of the
+	// frame is spent
+	void RunQueued();
+	// drop the queued tasks without running them
+	void Clear() { m_tasks.clear(); }
+
+	// print the time the queue took to the console and start over
+	void Report();
+
+private:
+	struct QUEUED_TASK
+	{
+		std::string name;
+		FRAME_TASK task;
+	};
+
+	std::deque<QUEUED_TASK> m_tasks;
+	double m_frameTarget;
+	std::chrono::high_resolution_clock::time_point m_frameStart;
+
+	// totals since the last report
+	int m_frames;
+	int m_slices;
+	int m_backlogFrames;
+	double m_budgetTotal;
+	double m_workTotal;
+	double m_longestSlice;
+};
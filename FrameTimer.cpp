@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////
+// frametimer.cpp
+// ============
+// measure the CPU and GPU time of a section of the frame without stalling
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameTimer.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  FrameTimer()
+ *
+ *  The constructor for the class, an OpenGL context must be
+ *  current because the timer queries are created here.
+ ***********************************************************/
+FrameTimer::FrameTimer(const char* timerName)
+{
+	m_name = timerName;
+	glGenQueries(QUERY_LATENCY, m_queries);
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		m_bQueryPending[i] = false;
+	}
+	m_queryIndex = 0;
+	m_bActive = false;
+	Reset();
+}
+
+/***********************************************************
+ *  ~FrameTimer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameTimer::~FrameTimer()
+{
+	glDeleteQueries(QUERY_LATENCY, m_queries);
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used to mark the start of the measured
+ *  section. If the oldest query has not returned yet, the
+ *  GPU time is not measured for this frame.
+ ***********************************************************/
+void FrameTimer::Begin()
+{
+	CollectQueryResults();
+
+	m_cpuStart = std::chrono::high_resolution_clock::now();
+
+	m_bActive = !m_bQueryPending[m_queryIndex];
+	if (m_bActive)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_queries[m_queryIndex]);
+	}
+}
+
+/***********************************************************
+ *  End()
+ *
+ *  This method is used to mark the end of the measured
+ *  section.
+ ***********************************************************/
+void FrameTimer::End()
+{
+	std::chrono::duration<double, std::milli> elapsed =
+		std::chrono::high_resolution_clock::now() - m_cpuStart;
+	m_cpuTotal += elapsed.count();
+	m_cpuSamples++;
+
+	if (m_bActive)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_bQueryPending[m_queryIndex] = true;
+		m_queryIndex = (m_queryIndex + 1) % QUERY_LATENCY;
+		m_bActive = false;
+	}
+}
+
+/***********************************************************
+ *  CollectQueryResults()
+ *
+ *  This method is used to add the results of the queries
+ *  that the GPU has finished to the GPU time total.
+ ***********************************************************/
+void FrameTimer::CollectQueryResults()
+{
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		if (!m_bQueryPending[i])
+		{
+			continue;
+		}
+
+		GLint bAvailable = GL_FALSE;
+		glGetQueryObjectiv(m_queries[i], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (bAvailable == GL_TRUE)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(m_queries[i], GL_QUERY_RESULT, &nanoseconds);
+			m_gpuTotal += (double)nanoseconds / 1000000.0;
+			m_gpuSamples++;
+			m_bQueryPending[i] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetAverageCpuMilliseconds()
+ *
+ *  This method returns the average CPU time of the section.
+ ***********************************************************/
+double FrameTimer::GetAverageCpuMilliseconds() const
+{
+	return((m_cpuSamples > 0) ? (m_cpuTotal / m_cpuSamples) : 0.0);
+}
+
+/***********************************************************
+ *  GetAverageGpuMilliseconds()
+ *
+ *  This method returns the average GPU time of the section.
+ ***********************************************************/
+double FrameTimer::GetAverageGpuMilliseconds() const
+{
+	return((m_gpuSamples > 0) ? (m_gpuTotal / m_gpuSamples) : 0.0);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used to print the averages collected so
+ *  far to the console and then start collecting again.
+ ***********************************************************/
+void FrameTimer::Report()
+{
+	CollectQueryResults();
+
+	if (m_cpuSamples > 0)
+	{
+		std::cout << "INFO: " << m_name
+			<< " cpu " << GetAverageCpuMilliseconds() << " ms"
+			<< ", gpu " << GetAverageGpuMilliseconds() << " ms"
+			<< " (" << m_cpuSamples << " frames)" << std::endl;
+	}
+
+	Reset();
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used to clear the collected samples.
+ ***********************************************************/
+void FrameTimer::Reset()
+{
+	m_cpuTotal = 0.0;
+	m_gpuTotal = 0.0;
+	m_cpuSamples = 0;
+	m_gpuSamples = 0;
+}
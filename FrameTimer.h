@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// frametimer.h
+// ============
+// measure the CPU and GPU time of a section of the frame without stalling
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <string>
+
+/***********************************************************
+ *  FrameTimer
+ *
+ *  This class measures the CPU time of a section of the
+ *  frame and its GPU time with timer queries. The query
+ *  results are read a few frames later, once available, so
+ *  measuring never waits for the GPU.
+ ***********************************************************/
+class FrameTimer
+{
+public:
+	// constructor
+	FrameTimer(const char* timerName);
+	// destructor
+	~FrameTimer();
+
+	// mark the start and the end of the measured section
+	void Begin();
+	void End();
+
+	// averages of the samples collected since the last reset
+	double GetAverageCpuMilliseconds() const;
+	double GetAverageGpuMilliseconds() const;
+	int GetSampleCount() const { return(m_cpuSamples); }
+	const std::string& GetName() const { return(m_name); }
+
+	// print the averages to the console and start over
+	void Report();
+	void Reset();
+
+private:
+	// number of frames a query result may take to arrive
+	static const int QUERY_LATENCY = 4;
+
+	std::string m_name;
+	GLuint m_queries[QUERY_LATENCY];
+	bool m_bQueryPending[QUERY_LATENCY];
+	int m_queryIndex;
+	bool m_bActive;
+
+	std::chrono::high_resolution_clock::time_point m_cpuStart;
+	double m_cpuTotal;
+	double m_gpuTotal;
+	int m_cpuSamples;
+	int m_gpuSamples;
+
+	// collect the finished query results without waiting
+	void CollectQueryResults();
+};
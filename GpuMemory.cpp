@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpumemory.cpp
+// ============
+// estimate the GPU memory allocated by each subsystem of the renderer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuMemory.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// names used when reporting the subsystems
+	const char* const g_SubsystemNames[GPU_MEMORY_SUBSYSTEM_COUNT] =
+	{
+		"textures",
+		"meshes",
+		"render targets",
+		"uniform buffers"
+	};
+
+	size_t g_AllocatedBytes[GPU_MEMORY_SUBSYSTEM_COUNT] = { 0, 0, 0, 0 };
+	size_t g_PeakBytes[GPU_MEMORY_SUBSYSTEM_COUNT] = { 0, 0, 0, 0 };
+
+	// free video memory reported by the driver before loading
+	bool g_bHasDriverBaseline = false;
+	GLint g_DriverBaselineKilobytes = 0;
+
+	// values of GL_NVX_gpu_memory_info and GL_ATI_meminfo
+	const GLenum GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX = 0x9049;
+	const GLenum TEXTURE_FREE_MEMORY_ATI = 0x87FC;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used to add the bytes of an allocation to
+ *  the estimate of a subsystem.
+ ***********************************************************/
+void GpuMemory::Allocate(GPU_MEMORY_SUBSYSTEM subsystem, size_t bytes)
+{
+	g_AllocatedBytes[subsystem] += bytes;
+	if (g_AllocatedBytes[subsystem] > g_PeakBytes[subsystem])
+	{
+		g_PeakBytes[subsystem] = g_AllocatedBytes[subsystem];
+	}
+}
+
+/***********************************************************
+ *  Free()
+ *
+ *  This method is used to remove the bytes of an allocation
+ *  from the estimate of a subsystem.
+ ***********************************************************/
+void GpuMemory::Free(GPU_MEMORY_SUBSYSTEM subsystem, size_t bytes)
+{
+	if (bytes > g_AllocatedBytes[subsystem])
+	{
+		std::cout << "ERROR: More GPU memory freed than allocated for " << g_SubsystemNames[subsystem] << std::endl;
+		g_AllocatedBytes[subsystem] = 0;
+		return;
+	}
+
+	g_AllocatedBytes[subsystem] -= bytes;
+}
+
+/***********************************************************
+ *  GetBytes()
+ *
+ *  This method returns the bytes a subsystem has allocated.
+ ***********************************************************/
+size_t GpuMemory::GetBytes(GPU_MEMORY_SUBSYSTEM subsystem)
+{
+	return(g_AllocatedBytes[subsystem]);
+}
+
+/***********************************************************
+ *  GetPeakBytes()
+ *
+ *  This method returns the most bytes a subsystem has had
+ *  allocated at one time.
+ ***********************************************************/
+size_t GpuMemory::GetPeakBytes(GPU_MEMORY_SUBSYSTEM subsystem)
+{
+	return(g_PeakBytes[subsystem]);
+}
+
+/***********************************************************
+ *  GetTotalBytes()
+ *
+ *  This method returns the bytes allocated by all of the
+ *  subsystems.
+ ***********************************************************/
+size_t GpuMemory::GetTotalBytes()
+{
+	size_t totalBytes = 0;
+	for (int i = 0; i < GPU_MEMORY_SUBSYSTEM_COUNT; i++)
+	{
+		totalBytes += g_AllocatedBytes[i];
+	}
+
+	return(totalBytes);
+}
+
+/***********************************************************
+ *  EstimateImageBytes()
+ *
+ *  This method returns the bytes of a 2D image. With mipmaps
+ *  every level down to 1x1 is added, which comes to about a
+ *  third more than the base level.
+ ***********************************************************/
+size_t GpuMemory::EstimateImageBytes(int width, int height, int bytesPerPixel, bool bMipmapped)
+{
+	size_t totalBytes = (size_t)width * (size_t)height * (size_t)bytesPerPixel;
+
+	while (bMipmapped && ((width > 1) || (height > 1)))
+	{
+		width = (width > 1) ? (width / 2) : 1;
+		height = (height > 1) ? (height / 2) : 1;
+		totalBytes += (size_t)width * (size_t)height * (size_t)bytesPerPixel;
+	}
+
+	return(totalBytes);
+}
+
+/***********************************************************
+ *  QueryDriverFreeKilobytes()
+ *
+ *  This method is used to ask the driver for its free video
+ *  memory, which only NVIDIA and AMD drivers report.
+ ***********************************************************/
+bool GpuMemory::QueryDriverFreeKilobytes(GLint& freeKilobytes)
+{
+	if (GLEW_NVX_gpu_memory_info)
+	{
+		glGetIntegerv(GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &freeKilobytes);
+		return(true);
+	}
+	if (GLEW_ATI_meminfo)
+	{
+		// the first of the four values is the total free memory
+		GLint textureFreeMemory[4] = { 0, 0, 0, 0 };
+		glGetIntegerv(TEXTURE_FREE_MEMORY_ATI, textureFreeMemory);
+		freeKilobytes = textureFreeMemory[0];
+		return(true);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  CaptureDriverBaseline()
+ *
+ *  This method is used to remember the free video memory
+ *  before anything is loaded, so the driver's view of what
+ *  the application uses can be compared with the estimate.
+ ***********************************************************/
+void GpuMemory::CaptureDriverBaseline()
+{
+	g_bHasDriverBaseline = QueryDriverFreeKilobytes(g_DriverBaselineKilobytes);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used to print the current and peak bytes
+ *  of every subsystem, and the memory used according to the
+ *  driver when it can be queried.
+ ***********************************************************/
+void GpuMemory::Report()
+{
+	for (int i = 0; i < GPU_MEMORY_SUBSYSTEM_COUNT; i++)
+	{
+		std::cout << "INFO: GPU memory " << g_SubsystemNames[i]
+			<< " " << (g_AllocatedBytes[i] / 1024) << " KB"
+			<< " (peak " << (g_PeakBytes[i] / 1024) << " KB)" << std::endl;
+	}
+	std::cout << "INFO: GPU memory estimated total " << (GetTotalBytes() / 1024) << " KB" << std::endl;
+
+	GLint freeKilobytes = 0;
+	if (g_bHasDriverBaseline && QueryDriverFreeKilobytes(freeKilobytes))
+	{
+		// other applications also change the free memory, so
+		// this is only a rough check of the estimate
+		std::cout << "INFO: GPU memory used according to the driver "
+			<< (g_DriverBaselineKilobytes - freeKilobytes) << " KB" << std::endl;
+	}
+}
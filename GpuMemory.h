@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpumemory.h
+// ============
+// estimate the GPU memory allocated by each subsystem of the renderer
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stddef.h>
+
+// parts of the renderer that GPU memory is counted for
+enum GPU_MEMORY_SUBSYSTEM
+{
+	GPU_MEMORY_TEXTURES,
+	GPU_MEMORY_MESHES,
+	GPU_MEMORY_RENDER_TARGETS,
+	GPU_MEMORY_UNIFORM_BUFFERS,
+	GPU_MEMORY_SUBSYSTEM_COUNT
+};
+
+/***********************************************************
+ *  GpuMemory
+ *
+ *  This class keeps an estimate of the bytes allocated on
+ *  the GPU by each subsystem, as computed from the sizes and
+ *  formats passed to OpenGL. Where the driver reports its
+ *  own memory use, that is shown next to the estimate.
+ ***********************************************************/
+class GpuMemory
+{
+public:
+	// add or remove the bytes of an allocation
+	static void Allocate(GPU_MEMORY_SUBSYSTEM subsystem, size_t bytes);
+	static void Free(GPU_MEMORY_SUBSYSTEM subsystem, size_t bytes);
+
+	static size_t GetBytes(GPU_MEMORY_SUBSYSTEM subsystem);
+	static size_t GetPeakBytes(GPU_MEMORY_SUBSYSTEM subsystem);
+	static size_t GetTotalBytes();
+
+	// bytes of a 2D image, with the levels of a full mip chain
+	static size_t EstimateImageBytes(int width, int height, int bytesPerPixel, bool bMipmapped);
+
+	// remember the free memory the driver reports before loading,
+	// a context must be current
+	static void CaptureDriverBaseline();
+
+	// print the estimate of each subsystem and the driver values
+	static void Report();
+
+private:
+	// get the free video memory in kilobytes from the NVX or ATI
+	// extensions, returns false when neither is available
+	static bool QueryDriverFreeKilobytes(GLint& freeKilobytes);
+};
@@ -0,0 +1,382 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuresource.cpp
+// ============
+// owning handles for OpenGL objects that are deleted once the GPU is done
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuResource.h"
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// unused names in a row after which no more buffers are
+	// looked for, names are handed out from the low end
+	const GLuint MAX_BUFFER_NAME_GAP = 1024;
+
+	// names used when reporting the objects
+	const char* const g_ResourceTypeNames[GPU_RESOURCE_TYPE_COUNT] =
+	{
+		"textures",
+		"buffers",
+		"vertex arrays",
+		"programs",
+		"samplers",
+		"queries"
+	};
+
+	// one object waiting to be deleted, vertex arrays and queries
+	// are not shared between contexts so the owning context is kept
+	struct PENDING_DELETION
+	{
+		GPU_RESOURCE_TYPE type;
+		GLuint name;
+		GLFWwindow* pContext;
+	};
+
+	// the objects released before a fence was placed
+	struct DELETION_BATCH
+	{
+		GLsync fence;
+		std::vector<PENDING_DELETION> deletions;
+	};
+
+	int g_LiveCounts[GPU_RESOURCE_TYPE_COUNT] = { 0, 0, 0, 0, 0, 0 };
+	// released since the last fence was placed
+	std::vector<PENDING_DELETION> g_UnfencedDeletions;
+	// waiting for their fence, oldest first
+	std::vector<DELETION_BATCH> g_FencedBatches;
+	// finished on the GPU but owned by a context that is not current
+	std::vector<PENDING_DELETION> g_ReadyDeletions;
+
+	/***********************************************************
+	 *  DeleteNow()
+	 *
+	 *  This function is used to delete one object if it can be
+	 *  deleted from the current context. Returns false when it
+	 *  must wait for its own context.
+	 ***********************************************************/
+	bool DeleteNow(const PENDING_DELETION& deletion)
+	{
+		switch (deletion.type)
+		{
+		case GPU_RESOURCE_TEXTURE:
+			glDeleteTextures(1, &deletion.name);
+			break;
+		case GPU_RESOURCE_BUFFER:
+			glDeleteBuffers(1, &deletion.name);
+			break;
+		case GPU_RESOURCE_VERTEX_ARRAY:
+			if (deletion.pContext != glfwGetCurrentContext())
+			{
+				return(false);
+			}
+			glDeleteVertexArrays(1, &deletion.name);
+			break;
+		case GPU_RESOURCE_PROGRAM:
+			glDeleteProgram(deletion.name);
+			break;
+		case GPU_RESOURCE_SAMPLER:
+			glDeleteSamplers(1, &deletion.name);
+			break;
+		case GPU_RESOURCE_QUERY:
+			if (deletion.pContext != glfwGetCurrentContext())
+			{
+				return(false);
+			}
+			glDeleteQueries(1, &deletion.name);
+			break;
+		default:
+			return(true);
+		}
+
+		g_LiveCounts[deletion.type]--;
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  DeleteOrKeep()
+	 *
+	 *  This function is used to delete a list of objects whose
+	 *  GPU work is finished, keeping the ones that belong to
+	 *  another context for when that context is current.
+	 ***********************************************************/
+	void DeleteOrKeep(const std::vector<PENDING_DELETION>& deletions)
+	{
+		for (size_t i = 0; i < deletions.size(); i++)
+		{
+			if (!DeleteNow(deletions[i]))
+			{
+				g_ReadyDeletions.push_back(deletions[i]);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  DeleteReadyForCurrentContext()
+	 *
+	 *  This function is used to delete the finished objects
+	 *  that were waiting for the current context.
+	 ***********************************************************/
+	void DeleteReadyForCurrentContext()
+	{
+		std::vector<PENDING_DELETION> readyDeletions;
+		readyDeletions.swap(g_ReadyDeletions);
+		DeleteOrKeep(readyDeletions);
+	}
+
+	/***********************************************************
+	 *  KeepForLater()
+	 *
+	 *  This function is used to hold the objects of a finished
+	 *  batch until the frame has time to delete them.
+	 ***********************************************************/
+	void KeepForLater(const std::vector<PENDING_DELETION>& deletions)
+	{
+		g_ReadyDeletions.insert(g_ReadyDeletions.end(), deletions.begin(), deletions.end());
+	}
+}
+
+/***********************************************************
+ *  Generate()
+ *
+ *  This method is used to create an object of a type. The
+ *  caller is expected to put it into a handle.
+ ***********************************************************/
+GLuint GpuResources::Generate(GPU_RESOURCE_TYPE type)
+{
+	GLuint name = 0;
+
+	switch (type)
+	{
+	case GPU_RESOURCE_TEXTURE:
+		glGenTextures(1, &name);
+		break;
+	case GPU_RESOURCE_BUFFER:
+		glGenBuffers(1, &name);
+		break;
+	case GPU_RESOURCE_VERTEX_ARRAY:
+		glGenVertexArrays(1, &name);
+		break;
+	case GPU_RESOURCE_PROGRAM:
+		name = glCreateProgram();
+		break;
+	case GPU_RESOURCE_SAMPLER:
+		glGenSamplers(1, &name);
+		break;
+	case GPU_RESOURCE_QUERY:
+		glGenQueries(1, &name);
+		break;
+	default:
+		break;
+	}
+
+	return(name);
+}
+
+/***********************************************************
+ *  TrackCreated()
+ *
+ *  This method is used to count an object as live.
+ ***********************************************************/
+void GpuResources::TrackCreated(GPU_RESOURCE_TYPE type)
+{
+	g_LiveCounts[type]++;
+}
+
+/***********************************************************
+ *  DeferDelete()
+ *
+ *  This method is used to queue an object for deletion. It
+ *  stays live until a fence placed after its last use has
+ *  signaled.
+ ***********************************************************/
+void GpuResources::DeferDelete(GPU_RESOURCE_TYPE type, GLuint name)
+{
+	PENDING_DELETION deletion;
+	deletion.type = type;
+	deletion.name = name;
+	deletion.pContext = glfwGetCurrentContext();
+
+	g_UnfencedDeletions.push_back(deletion);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used to place a fence after the objects
+ *  released during the frame, and to move the objects of
+ *  earlier frames whose fence has signaled to the ready list,
+ *  which DeleteReady() works through a few at a time. Polling
+ *  never waits, a batch that is not finished is checked again
+ *  at the end of the next frame.
+ ***********************************************************/
+void GpuResources::EndFrame()
+{
+	if (!g_UnfencedDeletions.empty())
+	{
+		DELETION_BATCH batch;
+		batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		batch.deletions.swap(g_UnfencedDeletions);
+		g_FencedBatches.push_back(batch);
+	}
+
+	// fences signal in order, so stop at the first unfinished one
+	size_t finishedBatches = 0;
+	while (finishedBatches < g_FencedBatches.size())
+	{
+		DELETION_BATCH& batch = g_FencedBatches[finishedBatches];
+		GLenum waitResult = glClientWaitSync(batch.fence, 0, 0);
+		if ((waitResult != GL_ALREADY_SIGNALED) && (waitResult != GL_CONDITION_SATISFIED))
+		{
+			break;
+		}
+
+		glDeleteSync(batch.fence);
+		KeepForLater(batch.deletions);
+		finishedBatches++;
+	}
+	g_FencedBatches.erase(g_FencedBatches.begin(), g_FencedBatches.begin() + finishedBatches);
+}
+
+/***********************************************************
+ *  DeleteReady()
+ *
+ *  This method is used to delete at most a number of the
+ *  finished objects that the current context can delete,
+ *  oldest first, keeping the rest for a later call. Returns
+ *  true when it stopped at the limit with objects left, so
+ *  it can run as a task of the frame scheduler.
+ ***********************************************************/
+bool GpuResources::DeleteReady(int maxCount)
+{
+	std::vector<PENDING_DELETION> readyDeletions;
+	readyDeletions.swap(g_ReadyDeletions);
+
+	int deletedCount = 0;
+	for (size_t i = 0; i < readyDeletions.size(); i++)
+	{
+		if ((deletedCount < maxCount) && DeleteNow(readyDeletions[i]))
+		{
+			deletedCount++;
+		}
+		else
+		{
+			g_ReadyDeletions.push_back(readyDeletions[i]);
+		}
+	}
+
+	return((deletedCount == maxCount) && !g_ReadyDeletions.empty());
+}
+
+/***********************************************************
+ *  GetReadyCount()
+ *
+ *  This method returns the number of finished objects that
+ *  are waiting to be deleted.
+ ***********************************************************/
+int GpuResources::GetReadyCount()
+{
+	return((int)g_ReadyDeletions.size());
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used to wait for the GPU and then delete
+ *  every queued object that the current context can delete.
+ *  It is meant for shutting down, not for use every frame.
+ ***********************************************************/
+void GpuResources::Flush()
+{
+	glFinish();
+
+	for (size_t i = 0; i < g_FencedBatches.size(); i++)
+	{
+		glDeleteSync(g_FencedBatches[i].fence);
+		DeleteOrKeep(g_FencedBatches[i].deletions);
+	}
+	g_FencedBatches.clear();
+
+	std::vector<PENDING_DELETION> unfencedDeletions;
+	unfencedDeletions.swap(g_UnfencedDeletions);
+	DeleteOrKeep(unfencedDeletions);
+
+	DeleteReadyForCurrentContext();
+}
+
+/***********************************************************
+ *  GetLiveCount()
+ *
+ *  This method returns the number of objects of a type that
+ *  have not been deleted yet, including queued ones.
+ ***********************************************************/
+int GpuResources::GetLiveCount(GPU_RESOURCE_TYPE type)
+{
+	return(g_LiveCounts[type]);
+}
+
+/***********************************************************
+ *  CountBufferNames()
+ *
+ *  This method returns the number of buffer names that are
+ *  in use in the current context. Every name is asked about
+ *  from the lowest up, until a long run of unused ones, so
+ *  it is meant for checks and not for every frame.
+ ***********************************************************/
+int GpuResources::CountBufferNames()
+{
+	int bufferCount = 0;
+	GLuint unusedNames = 0;
+	for (GLuint name = 1; unusedNames < MAX_BUFFER_NAME_GAP; name++)
+	{
+		if (glIsBuffer(name) == GL_TRUE)
+		{
+			bufferCount++;
+			unusedNames = 0;
+		}
+		else
+		{
+			unusedNames++;
+		}
+	}
+
+	return(bufferCount);
+}
+
+/***********************************************************
+ *  GetPendingCount()
+ *
+ *  This method returns the number of queued objects.
+ ***********************************************************/
+int GpuResources::GetPendingCount()
+{
+	size_t pendingCount = g_UnfencedDeletions.size() + g_ReadyDeletions.size();
+	for (size_t i = 0; i < g_FencedBatches.size(); i++)
+	{
+		pendingCount += g_FencedBatches[i].deletions.size();
+	}
+
+	return((int)pendingCount);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used to print the live objects of each
+ *  type and the number still waiting to be deleted.
+ ***********************************************************/
+void GpuResources::Report()
+{
+	for (int i = 0; i < GPU_RESOURCE_TYPE_COUNT; i++)
+	{
+		std::cout << "INFO: Live " << g_ResourceTypeNames[i] << " " << g_LiveCounts[i] << std::endl;
+	}
+	std::cout << "INFO: Objects waiting for deletion " << GetPendingCount() << std::endl;
+}
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuresource.h
+// ============
+// owning handles for OpenGL objects that are deleted once the GPU is done
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuMemory.h"
+
+// kinds of OpenGL objects that are owned by handles
+enum GPU_RESOURCE_TYPE
+{
+	GPU_RESOURCE_TEXTURE,
+	GPU_RESOURCE_BUFFER,
+	GPU_RESOURCE_VERTEX_ARRAY,
+	GPU_RESOURCE_PROGRAM,
+	GPU_RESOURCE_SAMPLER,
+	GPU_RESOURCE_QUERY,
+	GPU_RESOURCE_TYPE_COUNT
+};
+
+/***********************************************************
+ *  GpuResources
+ *
+ *  This class keeps the count of live OpenGL objects of each
+ *  type and the queue of objects waiting to be deleted. An
+ *  object that is released is only deleted after a fence
+ *  placed at the end of a later frame has signaled, so a
+ *  frame that is still being drawn never loses an object and
+ *  releasing never waits for the GPU.
+ ***********************************************************/
+class GpuResources
+{
+public:
+	// create an object of a type in the current context
+	static GLuint Generate(GPU_RESOURCE_TYPE type);
+	// count an object that now has an owning handle
+	static void TrackCreated(GPU_RESOURCE_TYPE type);
+	// queue an object for deletion once the GPU is done with it
+	static void DeferDelete(GPU_RESOURCE_TYPE type, GLuint name);
+
+	// fence the objects released this frame and make the ones
+	// whose fence has signaled ready, call once per frame per context
+	static void EndFrame();
+	// delete up to a number of the ready objects, returns true
+	// while more are left for a later call
+	static bool DeleteReady(int maxCount);
+	// wait for the GPU and delete everything that can be deleted
+	// from the current context, such as before it is destroyed
+	static void Flush();
+
+	static int GetLiveCount(GPU_RESOURCE_TYPE type);
+	static int GetPendingCount();
+	static int GetReadyCount();
+	// count the buffer names in use by asking GL, which includes
+	// the buffers made without a handle, such as the meshes
+	static int CountBufferNames();
+
+	// print the live and pending objects to the console
+	static void Report();
+};
+
+/***********************************************************
+ *  GpuHandle
+ *
+ *  This template owns one OpenGL object. It can be moved but
+ *  not copied, and the object is handed to the deletion
+ *  queue when the handle is reset or destroyed. Memory set
+ *  with TrackMemory() is counted until then.
+ ***********************************************************/
+template <GPU_RESOURCE_TYPE TYPE>
+class GpuHandle
+{
+public:
+	// constructor for an empty handle
+	GpuHandle()
+	{
+		m_name = 0;
+		m_memorySubsystem = GPU_MEMORY_TEXTURES;
+		m_memoryBytes = 0;
+	}
+
+	// constructor taking ownership of an existing object
+	explicit GpuHandle(GLuint name)
+	{
+		m_name = name;
+		m_memorySubsystem = GPU_MEMORY_TEXTURES;
+		m_memoryBytes = 0;
+		if (m_name != 0)
+		{
+			GpuResources::TrackCreated(TYPE);
+		}
+	}
+
+	// destructor
+	~GpuHandle()
+	{
+		Reset();
+	}
+
+	GpuHandle(GpuHandle&& other)
+	{
+		m_name = other.m_name;
+		m_memorySubsystem = other.m_memorySubsystem;
+		m_memoryBytes = other.m_memoryBytes;
+		other.m_name = 0;
+		other.m_memoryBytes = 0;
+	}
+
+	GpuHandle& operator=(GpuHandle&& other)
+	{
+		if (this != &other)
+		{
+			Reset();
+			m_name = other.m_name;
+			m_memorySubsystem = other.m_memorySubsystem;
+			m_memoryBytes = other.m_memoryBytes;
+			other.m_name = 0;
+			other.m_memoryBytes = 0;
+		}
+		return(*this);
+	}
+
+	GpuHandle(const GpuHandle&) = delete;
+	GpuHandle& operator=(const GpuHandle&) = delete;
+
+	// create a new object of the handle type
+	static GpuHandle Create()
+	{
+		return(GpuHandle(GpuResources::Generate(TYPE)));
+	}
+
+	GLuint Get() const { return(m_name); }
+	bool IsValid() const { return(m_name != 0); }
+
+	// count the GPU memory of the object's storage for a subsystem
+	void TrackMemory(GPU_MEMORY_SUBSYSTEM subsystem, size_t bytes)
+	{
+		UntrackMemory();
+		m_memorySubsystem = subsystem;
+		m_memoryBytes = bytes;
+		GpuMemory::Allocate(subsystem, bytes);
+	}
+
+	// queue the owned object for deletion and empty the handle
+	void Reset()
+	{
+		UntrackMemory();
+		if (m_name != 0)
+		{
+			GpuResources::DeferDelete(TYPE, m_name);
+			m_name = 0;
+		}
+	}
+
+private:
+	GLuint m_name;
+	GPU_MEMORY_SUBSYSTEM m_memorySubsystem;
+	size_t m_memoryBytes;
+
+	void UntrackMemory()
+	{
+		if (m_memoryBytes != 0)
+		{
+			GpuMemory::Free(m_memorySubsystem, m_memoryBytes);
+			m_memoryBytes = 0;
+		}
+	}
+};
+
+typedef GpuHandle<GPU_RESOURCE_TEXTURE> GpuTexture;
+typedef GpuHandle<GPU_RESOURCE_BUFFER> GpuBuffer;
+typedef GpuHandle<GPU_RESOURCE_VERTEX_ARRAY> GpuVertexArray;
+typedef GpuHandle<GPU_RESOURCE_PROGRAM> GpuProgram;
+typedef GpuHandle<GPU_RESOURCE_SAMPLER> GpuSampler;
+typedef GpuHandle<GPU_RESOURCE_QUERY> GpuQuery;
@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////
+// irradiancevolume.cpp
+// ============
+// upload baked irradiance probes as 3D textures and sample them in shaders
+///////////////////////////////////////////////////////////////////////////////
+
+#include "IrradianceVolume.h"
+#include "GpuMemory.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <vector>
+
+const char* const g_IrradianceVolumeSource = R"GLSL(
+uniform sampler3D probeRed;
+uniform sampler3D probeGreen;
+uniform sampler3D probeBlue;
+// position of the first probe, the distance between probes
+// and the number of probes along each side
+uniform vec3 probeOrigin;
+uniform vec3 probeSpacing;
+uniform vec3 probeCounts;
+
+vec3 SampleIrradiance(vec3 position, vec3 normal)
+{
+	// the centers of the edge texels are the edge probes
+	vec3 uvw = ((position - probeOrigin) / probeSpacing + 0.5) / probeCounts;
+	vec4 weights = vec4(1.0, normal);
+	vec3 irradiance = vec3(
+		dot(texture(probeRed, uvw), weights),
+		dot(texture(probeGreen, uvw), weights),
+		dot(texture(probeBlue, uvw), weights));
+	return max(irradiance, vec3(0.0));
+}
+)GLSL";
+
+// declaration of global variables
+namespace
+{
+	const char* const g_ProbeSamplerNames[3] = { "probeRed", "probeGreen", "probeBlue" };
+}
+
+/***********************************************************
+ *  IrradianceVolume()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+IrradianceVolume::IrradianceVolume()
+{
+	m_grid.counts = glm::ivec3(0);
+	m_grid.origin = glm::vec3(0.0f);
+	m_grid.spacing = glm::vec3(1.0f);
+}
+
+/***********************************************************
+ *  ~IrradianceVolume()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+IrradianceVolume::~IrradianceVolume()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to split the probe values by color
+ *  channel into three half float 3D textures. Linear
+ *  filtering blends the eight probes around a point, and
+ *  the edges are clamped like the CPU lookup.
+ ***********************************************************/
+bool IrradianceVolume::Initialize(const ProbeBaker::PROBE_GRID& grid)
+{
+	Destroy();
+
+	size_t probeCount = (size_t)grid.counts.x * grid.counts.y * grid.counts.z;
+	if ((probeCount == 0) || (grid.coefficients.size() != probeCount * 3))
+	{
+		return(false);
+	}
+	m_grid = grid;
+
+	std::vector<glm::vec4> channel(probeCount);
+	for (int i = 0; i < 3; i++)
+	{
+		for (size_t probe = 0; probe < probeCount; probe++)
+		{
+			channel[probe] = grid.coefficients[probe * 3 + i];
+		}
+
+		glActiveTexture(GL_TEXTURE0 + FIRST_TEXTURE_UNIT + i);
+		m_textures[i] = GpuTexture::Create();
+		glBindTexture(GL_TEXTURE_3D, m_textures[i].Get());
+		glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, grid.counts.x, grid.counts.y, grid.counts.z, 0, GL_RGBA, GL_FLOAT, channel.data());
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, 0);
+		// four half floats per probe, in every slice
+		m_textures[i].TrackMemory(GPU_MEMORY_TEXTURES, GpuMemory::EstimateImageBytes(grid.counts.x, grid.counts.y * grid.counts.z, 8, false));
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the textures.
+ ***********************************************************/
+void IrradianceVolume::Destroy()
+{
+	for (int i = 0; i < 3; i++)
+	{
+		m_textures[i].Reset();
+	}
+	m_grid.coefficients.clear();
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used to bind the probe textures to their
+ *  units and set the grid into the program in use.
+ ***********************************************************/
+void IrradianceVolume::Bind(GLuint program) const
+{
+	for (int i = 0; i < 3; i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + FIRST_TEXTURE_UNIT + i);
+		glBindTexture(GL_TEXTURE_3D, m_textures[i].Get());
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	SetSamplerUnits(program);
+	glUniform3fv(glGetUniformLocation(program, "probeOrigin"), 1, glm::value_ptr(m_grid.origin));
+	glUniform3fv(glGetUniformLocation(program, "probeSpacing"), 1, glm::value_ptr(m_grid.spacing));
+	glUniform3f(glGetUniformLocation(program, "probeCounts"), (float)m_grid.counts.x, (float)m_grid.counts.y, (float)m_grid.counts.z);
+}
+
+/***********************************************************
+ *  SetSamplerUnits()
+ *
+ *  This method is used to set the units of the three probe
+ *  samplers into the program in use.
+ ***********************************************************/
+void IrradianceVolume::SetSamplerUnits(GLuint program)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		glUniform1i(glGetUniformLocation(program, g_ProbeSamplerNames[i]), FIRST_TEXTURE_UNIT + i);
+	}
+}
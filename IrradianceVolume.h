@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// irradiancevolume.h
+// ============
+// upload baked irradiance probes as 3D textures and sample them in shaders
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResource.h"
+#include "ProbeBaker.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+// GLSL function "vec3 SampleIrradiance(vec3 position, vec3 normal)"
+// for fragment shaders, it declares the uniforms of the volume
+extern const char* const g_IrradianceVolumeSource;
+
+/***********************************************************
+ *  IrradianceVolume
+ *
+ *  This class keeps the baked probe grid in three 3D
+ *  textures, one per color channel, so a fragment shader
+ *  blends the probes around it with three filtered fetches.
+ *  The grid is kept on the CPU as well, for programs that
+ *  cannot sample it and take one value per object instead.
+ ***********************************************************/
+class IrradianceVolume
+{
+public:
+	// texture units of the red, green and blue probe values,
+	// above the unit of the lightmap atlas
+	static const int FIRST_TEXTURE_UNIT = 22;
+
+	// constructor
+	IrradianceVolume();
+	// destructor
+	~IrradianceVolume();
+
+	// upload the probe grid into the 3D textures
+	bool Initialize(const ProbeBaker::PROBE_GRID& grid);
+	// free the textures
+	void Destroy();
+	bool IsInitialized() const { return(m_textures[0].IsValid()); }
+
+	// bind the textures and set the uniforms of the volume into
+	// a program that uses g_IrradianceVolumeSource
+	void Bind(GLuint program) const;
+	// point the samplers of a program at the volume's units even
+	// when it is not bound, so they never share a unit with a
+	// texture of another type
+	static void SetSamplerUnits(GLuint program);
+
+	// get the irradiance at a point on the CPU
+	glm::vec3 SampleIrradiance(const glm::vec3& position, const glm::vec3& normal) const
+	{
+		return(ProbeBaker::SampleIrradiance(m_grid, position, normal));
+	}
+
+private:
+	GpuTexture m_textures[3];
+	ProbeBaker::PROBE_GRID m_grid;
+};
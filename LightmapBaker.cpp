@@ -0,0 +1,816 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.cpp
+// ============
+// bake the light of the static scene lights into a lightmap atlas on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightmapBaker.h"
+#include "TriangleBVH.h"
+#include "TextureCache.h"
+#include "ParallelFor.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdint.h>
+
+// declaration of global variables
+namespace
+{
+	// identifies a cached lightmap, and its layout version
+	const uint32_t LIGHTMAP_MAGIC = 0x50414D4C;
+	const uint32_t LIGHTMAP_VERSION = 1;
+
+	// values stored at the start of the cached lightmap,
+	// followed by the object squares and the texels
+	struct LIGHTMAP_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t inputHash;
+		int32_t width;
+		int32_t height;
+		int32_t objectCount;
+	};
+
+	// distance rays start off a surface so they miss it
+	const float SURFACE_OFFSET = 0.002f;
+	// length of the shadow rays toward the directional light
+	const float DIRECTIONAL_RAY_LENGTH = 1000.0f;
+	// passes of dilation, enough to fill the gutters on both
+	// sides of the edge between two charts
+	const int DILATE_PASSES = LightmapBaker::GUTTER_TEXELS * 2;
+	// texels a worker thread takes at a time
+	const int WORK_CHUNK = 64;
+	// segments around the cone in the traced geometry
+	const int CONE_SEGMENTS = 32;
+	const float PI = 3.14159265f;
+
+	// a chart is a block of cells in the grid over an object's
+	// square, and the faces of a shape are unfolded into it
+	struct CHART
+	{
+		int cellX;
+		int cellY;
+		int cellsWide;
+		int cellsHigh;
+	};
+
+	// the box has one chart per face, the pyramid one per side
+	// and the base, and the cone one for its side and the base
+	const CHART g_PlaneCharts[] = { { 0, 0, 1, 1 } };
+	const CHART g_GridCharts[] = { { 0, 0, 1, 1 }, { 1, 0, 1, 1 }, { 2, 0, 1, 1 }, { 0, 1, 1, 1 }, { 1, 1, 1, 1 }, { 2, 1, 1, 1 } };
+	const CHART g_ConeCharts[] = { { 0, 0, 3, 1 }, { 0, 1, 1, 1 } };
+
+	// a texel of the atlas that lies on a surface
+	struct TEXEL_SAMPLE
+	{
+		int texel;
+		glm::vec3 position;
+		glm::vec3 normal;
+	};
+
+	// an object prepared for looking up the texels rays hit
+	struct TRACED_OBJECT
+	{
+		glm::mat4 inverseModel;
+		glm::mat3 normalMatrix;
+	};
+
+	// a triangle of the traced scene
+	struct TRACED_TRIANGLE
+	{
+		int object;
+		glm::vec3 localNormal;
+		glm::vec3 worldNormal;
+	};
+
+	/***********************************************************
+	 *  GetCharts()
+	 *
+	 *  This function returns the charts of a basic shape and
+	 *  the columns and rows of the grid they are placed in.
+	 ***********************************************************/
+	const CHART* GetCharts(MeshRegistry::MESH_PRIMITIVE primitive, int& chartCount, int& columns, int& rows)
+	{
+		columns = 3;
+		rows = 2;
+		switch (primitive)
+		{
+		case MeshRegistry::MESH_PRIMITIVE_PLANE:
+			columns = 1;
+			rows = 1;
+			chartCount = 1;
+			return(g_PlaneCharts);
+		case MeshRegistry::MESH_PRIMITIVE_BOX:
+			chartCount = 6;
+			return(g_GridCharts);
+		case MeshRegistry::MESH_PRIMITIVE_PYRAMID4:
+			chartCount = 5;
+			return(g_GridCharts);
+		case MeshRegistry::MESH_PRIMITIVE_CONE:
+			chartCount = 2;
+			return(g_ConeCharts);
+		default:
+			chartCount = 0;
+			return(NULL);
+		}
+	}
+
+	/***********************************************************
+	 *  GetChartBounds()
+	 *
+	 *  This function returns the texels of an object's square
+	 *  that a chart covers, inside its gutter.
+	 ***********************************************************/
+	void GetChartBounds(const CHART& chart, int columns, int rows, int objectSize, glm::vec2& low, glm::vec2& high)
+	{
+		glm::vec2 cellSize((float)objectSize / columns, (float)objectSize / rows);
+		glm::vec2 gutter((float)LightmapBaker::GUTTER_TEXELS);
+
+		low = glm::vec2((float)chart.cellX, (float)chart.cellY) * cellSize + gutter;
+		high = glm::vec2((float)(chart.cellX + chart.cellsWide), (float)(chart.cellY + chart.cellsHigh)) * cellSize - gutter;
+	}
+
+	/***********************************************************
+	 *  FindChart()
+	 *
+	 *  This function is used to unfold a point of a basic
+	 *  shape, returning its chart and where it lies in the
+	 *  chart from 0 to 1. The local shapes are the ones
+	 *  ShapeMeshes draws, and the normal only picks the face.
+	 ***********************************************************/
+	int FindChart(MeshRegistry::MESH_PRIMITIVE primitive, const glm::vec3& p, const glm::vec3& n, glm::vec2& chartPoint)
+	{
+		switch (primitive)
+		{
+		case MeshRegistry::MESH_PRIMITIVE_BOX:
+		{
+			glm::vec3 size = glm::abs(n);
+			int axis = (size.x >= size.y) ? ((size.x >= size.z) ? 0 : 2) : ((size.y >= size.z) ? 1 : 2);
+			chartPoint = glm::vec2(p[(axis + 1) % 3], p[(axis + 2) % 3]) + 0.5f;
+			return(axis * 2 + ((n[axis] < 0.0f) ? 1 : 0));
+		}
+		case MeshRegistry::MESH_PRIMITIVE_PYRAMID4:
+			if (n.y < -0.5f)
+			{
+				chartPoint = glm::vec2(p.x, p.z) + 0.5f;
+				return(4);
+			}
+			if (std::abs(n.x) >= std::abs(n.z))
+			{
+				chartPoint = glm::vec2(p.z, p.y) + 0.5f;
+				return((n.x >= 0.0f) ? 0 : 1);
+			}
+			chartPoint = glm::vec2(p.x, p.y) + 0.5f;
+			return((n.z >= 0.0f) ? 2 : 3);
+		case MeshRegistry::MESH_PRIMITIVE_CONE:
+			if (n.y < -0.5f)
+			{
+				chartPoint = (glm::vec2(p.x, p.z) + 1.0f) * 0.5f;
+				return(1);
+			}
+			chartPoint = glm::vec2((std::atan2(p.z, p.x) + PI) / (2.0f * PI), p.y);
+			return(0);
+		default:
+			chartPoint = (glm::vec2(p.x, p.z) + 1.0f) * 0.5f;
+			return(0);
+		}
+	}
+
+	/***********************************************************
+	 *  UnfoldedToSurface()
+	 *
+	 *  This function is the reverse of FindChart(), getting
+	 *  the local point and normal of a chart point. It returns
+	 *  false for the parts of a chart that no face covers.
+	 ***********************************************************/
+	bool UnfoldedToSurface(MeshRegistry::MESH_PRIMITIVE primitive, int chart, const glm::vec2& c, glm::vec3& p, glm::vec3& n)
+	{
+		switch (primitive)
+		{
+		case MeshRegistry::MESH_PRIMITIVE_BOX:
+		{
+			int axis = chart / 2;
+			float side = ((chart % 2) == 0) ? 1.0f : -1.0f;
+			p[axis] = side * 0.5f;
+			p[(axis + 1) % 3] = c.x - 0.5f;
+			p[(axis + 2) % 3] = c.y - 0.5f;
+			n = glm::vec3(0.0f);
+			n[axis] = side;
+			return(true);
+		}
+		case MeshRegistry::MESH_PRIMITIVE_PYRAMID4:
+		{
+			if (chart == 4)
+			{
+				p = glm::vec3(c.x - 0.5f, -0.5f, c.y - 0.5f);
+				n = glm::vec3(0.0f, -1.0f, 0.0f);
+				return(true);
+			}
+
+			// the sides narrow from the base to the apex
+			float halfWidth = 0.5f * (1.0f - c.y);
+			float across = c.x - 0.5f;
+			if (std::abs(across) > halfWidth)
+			{
+				return(false);
+			}
+			float side = ((chart % 2) == 0) ? 1.0f : -1.0f;
+			if (chart < 2)
+			{
+				p = glm::vec3(side * halfWidth, c.y - 0.5f, across);
+				n = glm::normalize(glm::vec3(side * 2.0f, 1.0f, 0.0f));
+			}
+			else
+			{
+				p = glm::vec3(across, c.y - 0.5f, side * halfWidth);
+				n = glm::normalize(glm::vec3(0.0f, 1.0f, side * 2.0f));
+			}
+			return(true);
+		}
+		case MeshRegistry::MESH_PRIMITIVE_CONE:
+		{
+			if (chart == 1)
+			{
+				p = glm::vec3(c.x * 2.0f - 1.0f, 0.0f, c.y * 2.0f - 1.0f);
+				n = glm::vec3(0.0f, -1.0f, 0.0f);
+				return((p.x * p.x + p.z * p.z) <= 1.0f);
+			}
+
+			float angle = c.x * 2.0f * PI - PI;
+			float radius = 1.0f - c.y;
+			p = glm::vec3(radius * std::cos(angle), c.y, radius * std::sin(angle));
+			n = glm::normalize(glm::vec3(std::cos(angle), 1.0f, std::sin(angle)));
+			return(true);
+		}
+		default:
+			p = glm::vec3(c.x * 2.0f - 1.0f, 0.0f, c.y * 2.0f - 1.0f);
+			n = glm::vec3(0.0f, 1.0f, 0.0f);
+			return(true);
+		}
+	}
+
+	/***********************************************************
+	 *  AddLocalTriangles()
+	 *
+	 *  This function is used to add the triangles of a basic
+	 *  shape in local space, with the normal of each one.
+	 ***********************************************************/
+	void AddLocalTriangles(MeshRegistry::MESH_PRIMITIVE primitive, std::vector<glm::vec3>& corners, std::vector<glm::vec3>& normals)
+	{
+		std::vector<glm::vec3> quads;
+		switch (primitive)
+		{
+		case MeshRegistry::MESH_PRIMITIVE_BOX:
+			for (int axis = 0; axis < 3; axis++)
+			{
+				for (int sideIndex = 0; sideIndex < 2; sideIndex++)
+				{
+					float side = (sideIndex == 0) ? 0.5f : -0.5f;
+					glm::vec3 quad[4];
+					for (int corner = 0; corner < 4; corner++)
+					{
+						quad[corner][axis] = side;
+						quad[corner][(axis + 1) % 3] = ((corner == 1) || (corner == 2)) ? 0.5f : -0.5f;
+						quad[corner][(axis + 2) % 3] = (corner >= 2) ? 0.5f : -0.5f;
+					}
+					glm::vec3 normal(0.0f);
+					normal[axis] = (side > 0.0f) ? 1.0f : -1.0f;
+					corners.insert(corners.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+					normals.insert(normals.end(), { normal, normal });
+				}
+			}
+			break;
+		case MeshRegistry::MESH_PRIMITIVE_PYRAMID4:
+		{
+			glm::vec3 apex(0.0f, 0.5f, 0.0f);
+			glm::vec3 base[4] = {
+				glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(0.5f, -0.5f, 0.5f),
+				glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(-0.5f, -0.5f, -0.5f) };
+			for (int side = 0; side < 4; side++)
+			{
+				glm::vec3 a = base[side];
+				glm::vec3 b = base[(side + 1) % 4];
+				corners.insert(corners.end(), { a, b, apex });
+				normals.push_back(glm::normalize(glm::cross(apex - a, b - a)));
+			}
+			corners.insert(corners.end(), { base[0], base[1], base[2], base[0], base[2], base[3] });
+			normals.insert(normals.end(), { glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f) });
+			break;
+		}
+		case MeshRegistry::MESH_PRIMITIVE_CONE:
+			for (int segment = 0; segment < CONE_SEGMENTS; segment++)
+			{
+				float angleA = 2.0f * PI * segment / CONE_SEGMENTS;
+				float angleB = 2.0f * PI * (segment + 1) / CONE_SEGMENTS;
+				glm::vec3 a(std::cos(angleA), 0.0f, std::sin(angleA));
+				glm::vec3 b(std::cos(angleB), 0.0f, std::sin(angleB));
+				glm::vec3 apex(0.0f, 1.0f, 0.0f);
+				corners.insert(corners.end(), { a, apex, b });
+				normals.push_back(glm::normalize(glm::cross(apex - a, b - a)));
+				corners.insert(corners.end(), { glm::vec3(0.0f), a, b });
+				normals.push_back(glm::vec3(0.0f, -1.0f, 0.0f));
+			}
+			break;
+		default:
+			corners.insert(corners.end(), {
+				glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, -1.0f),
+				glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f) });
+			normals.insert(normals.end(), { glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) });
+			break;
+		}
+	}
+
+	/***********************************************************
+	 *  Dilate()
+	 *
+	 *  This function is used to grow the lit texels of every
+	 *  object into the empty texels around them, one texel per
+	 *  pass, never crossing into the square of another object.
+	 ***********************************************************/
+	void Dilate(std::vector<glm::vec3>& texels, std::vector<unsigned char> covered, const std::vector<int>& owners, int width, int height)
+	{
+		for (int pass = 0; pass < DILATE_PASSES; pass++)
+		{
+			std::vector<unsigned char> grown = covered;
+			for (int y = 0; y < height; y++)
+			{
+				for (int x = 0; x < width; x++)
+				{
+					int texel = y * width + x;
+					if (covered[texel] || (owners[texel] < 0))
+					{
+						continue;
+					}
+
+					glm::vec3 sum(0.0f);
+					int count = 0;
+					for (int dy = -1; dy <= 1; dy++)
+					{
+						for (int dx = -1; dx <= 1; dx++)
+						{
+							int nx = x + dx;
+							int ny = y + dy;
+							if ((nx < 0) || (ny < 0) || (nx >= width) || (ny >= height))
+							{
+								continue;
+							}
+							int neighbour = ny * width + nx;
+							if (covered[neighbour] && (owners[neighbour] == owners[texel]))
+							{
+								sum += texels[neighbour];
+								count++;
+							}
+						}
+					}
+					if (count > 0)
+					{
+						texels[texel] = sum / (float)count;
+						grown[texel] = 1;
+					}
+				}
+			}
+			covered.swap(grown);
+		}
+	}
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  This function adds bytes to an FNV-1a hash.
+	 ***********************************************************/
+	void HashBytes(uint64_t& hash, const void* pData, size_t size)
+	{
+		const unsigned char* pBytes = (const unsigned char*)pData;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ pBytes[i]) * 1099511628211ull;
+		}
+	}
+
+	/***********************************************************
+	 *  HashInputs()
+	 *
+	 *  This function returns a hash of everything the baked
+	 *  lightmap depends on, to tell if the cache is current.
+	 ***********************************************************/
+	uint64_t HashInputs(const std::vector<LightmapBaker::BAKE_OBJECT>& objects, const std::vector<LightmapBaker::BAKE_LIGHT>& lights)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		int settings[] = {
+			LightmapBaker::TEXELS_PER_UNIT, LightmapBaker::MIN_OBJECT_SIZE, LightmapBaker::MAX_OBJECT_SIZE,
+			LightmapBaker::ATLAS_WIDTH, LightmapBaker::GUTTER_TEXELS, LightmapBaker::INDIRECT_RAYS };
+		HashBytes(hash, settings, sizeof(settings));
+
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			int primitive = (int)objects[i].primitive;
+			HashBytes(hash, &primitive, sizeof(primitive));
+			HashBytes(hash, glm::value_ptr(objects[i].model), sizeof(float) * 16);
+			HashBytes(hash, glm::value_ptr(objects[i].albedo), sizeof(float) * 3);
+		}
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			int bDirectional = lights[i].bDirectional ? 1 : 0;
+			HashBytes(hash, &bDirectional, sizeof(bDirectional));
+			HashBytes(hash, glm::value_ptr(lights[i].vector), sizeof(float) * 3);
+			HashBytes(hash, glm::value_ptr(lights[i].diffuse), sizeof(float) * 3);
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  LoadCachedLightmap()
+	 *
+	 *  This function is used to load the cached lightmap when
+	 *  it was baked from the same inputs.
+	 ***********************************************************/
+	bool LoadCachedLightmap(const std::string& path, uint64_t inputHash, size_t objectCount, LightmapBaker::BAKED_LIGHTMAP& lightmap)
+	{
+		FILE* pFile = fopen(path.c_str(), "rb");
+		if (pFile == NULL)
+		{
+			return(false);
+		}
+
+		LIGHTMAP_HEADER header;
+		bool bLoaded = (fread(&header, sizeof(header), 1, pFile) == 1) &&
+			(header.magic == LIGHTMAP_MAGIC) &&
+			(header.version == LIGHTMAP_VERSION) &&
+			(header.inputHash == inputHash) &&
+			(header.objectCount == (int32_t)objectCount) &&
+			(header.width > 0) && (header.height > 0);
+		if (bLoaded)
+		{
+			lightmap.width = header.width;
+			lightmap.height = header.height;
+			lightmap.objectRects.resize(objectCount);
+			lightmap.irradiance.resize((size_t)header.width * header.height * 3);
+			bLoaded = ((objectCount == 0) || (fread(lightmap.objectRects.data(), sizeof(glm::ivec3), objectCount, pFile) == objectCount)) &&
+				(fread(lightmap.irradiance.data(), sizeof(float), lightmap.irradiance.size(), pFile) == lightmap.irradiance.size());
+		}
+		fclose(pFile);
+
+		return(bLoaded);
+	}
+
+	/***********************************************************
+	 *  SaveCachedLightmap()
+	 *
+	 *  This function is used to save a baked lightmap, failing
+	 *  to write it is not an error.
+	 ***********************************************************/
+	void SaveCachedLightmap(const std::string& path, uint64_t inputHash, const LightmapBaker::BAKED_LIGHTMAP& lightmap)
+	{
+		TextureCache::CreateCacheFolder();
+		std::string temporaryPath = path + ".tmp";
+		FILE* pFile = fopen(temporaryPath.c_str(), "wb");
+		if (pFile == NULL)
+		{
+			return;
+		}
+
+		LIGHTMAP_HEADER header;
+		header.magic = LIGHTMAP_MAGIC;
+		header.version = LIGHTMAP_VERSION;
+		header.inputHash = inputHash;
+		header.width = lightmap.width;
+		header.height = lightmap.height;
+		header.objectCount = (int32_t)lightmap.objectRects.size();
+
+		bool bWritten = (fwrite(&header, sizeof(header), 1, pFile) == 1) &&
+			(lightmap.objectRects.empty() || (fwrite(lightmap.objectRects.data(), sizeof(glm::ivec3), lightmap.objectRects.size(), pFile) == lightmap.objectRects.size())) &&
+			(fwrite(lightmap.irradiance.data(), sizeof(float), lightmap.irradiance.size(), pFile) == lightmap.irradiance.size());
+		bWritten = (fclose(pFile) == 0) && bWritten;
+		if (!bWritten)
+		{
+			std::remove(temporaryPath.c_str());
+			return;
+		}
+
+		std::remove(path.c_str());
+		std::rename(temporaryPath.c_str(), path.c_str());
+	}
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method returns true for the basic shapes that can
+ *  be unfolded into charts.
+ ***********************************************************/
+bool LightmapBaker::IsSupported(MeshRegistry::MESH_PRIMITIVE primitive)
+{
+	int chartCount = 0;
+	int columns = 0;
+	int rows = 0;
+
+	return(GetCharts(primitive, chartCount, columns, rows) != NULL);
+}
+
+/***********************************************************
+ *  AddWorldTriangles()
+ *
+ *  This method is used to add the triangles of an object
+ *  in world space, with the normal of each one, so other
+ *  bakers can trace the same scene.
+ ***********************************************************/
+void LightmapBaker::AddWorldTriangles(
+	const BAKE_OBJECT& object,
+	std::vector<glm::vec3>& worldCorners,
+	std::vector<glm::vec3>& worldNormals)
+{
+	std::vector<glm::vec3> localCorners;
+	std::vector<glm::vec3> localNormals;
+	AddLocalTriangles(object.primitive, localCorners, localNormals);
+
+	glm::mat3 normalMatrix = glm::transpose(glm::mat3(glm::inverse(object.model)));
+	for (size_t i = 0; i < localCorners.size(); i++)
+	{
+		worldCorners.push_back(glm::vec3(object.model * glm::vec4(localCorners[i], 1.0f)));
+	}
+	for (size_t i = 0; i < localNormals.size(); i++)
+	{
+		worldNormals.push_back(glm::normalize(normalMatrix * localNormals[i]));
+	}
+}
+
+/***********************************************************
+ *  GetChartTexel()
+ *
+ *  This method returns where in an object's square a point
+ *  of its basic shape is stored, in texels.
+ ***********************************************************/
+glm::vec2 LightmapBaker::GetChartTexel(
+	MeshRegistry::MESH_PRIMITIVE primitive,
+	const glm::vec3& localPosition,
+	const glm::vec3& localNormal,
+	int objectSize)
+{
+	int chartCount = 0;
+	int columns = 1;
+	int rows = 1;
+	const CHART* pCharts = GetCharts(primitive, chartCount, columns, rows);
+	if (pCharts == NULL)
+	{
+		return(glm::vec2(0.0f));
+	}
+
+	glm::vec2 chartPoint;
+	int chart = FindChart(primitive, localPosition, localNormal, chartPoint);
+
+	glm::vec2 low;
+	glm::vec2 high;
+	GetChartBounds(pCharts[chart], columns, rows, objectSize, low, high);
+
+	return(low + glm::clamp(chartPoint, 0.0f, 1.0f) * (high - low));
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used to bake the lightmap of the static
+ *  objects. The objects are given squares of the atlas by
+ *  their surface area, every texel that lies on a face is
+ *  lit by the lights, and then gathers the light that the
+ *  surfaces it sees reflect, looked up in the direct light
+ *  of the atlas itself. The texels around the charts are
+ *  filled from their neighbours last.
+ ***********************************************************/
+bool LightmapBaker::Bake(
+	const std::vector<BAKE_OBJECT>& objects,
+	const std::vector<BAKE_LIGHT>& lights,
+	BAKED_LIGHTMAP& lightmap)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	uint64_t inputHash = HashInputs(objects, lights);
+	std::string cachePath = TextureCache::GetCacheFile("lightmaps", ".bin");
+	if (LoadCachedLightmap(cachePath, inputHash, objects.size(), lightmap))
+	{
+		std::cout << "INFO: Loaded baked lightmap " << cachePath << std::endl;
+		return(true);
+	}
+
+	// the whole scene in world space, for tracing rays
+	std::vector<glm::vec3> worldCorners;
+	std::vector<TRACED_TRIANGLE> triangles;
+	std::vector<TRACED_OBJECT> tracedObjects(objects.size());
+	std::vector<float> surfaceAreas(objects.size(), 0.0f);
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		if (!IsSupported(objects[i].primitive))
+		{
+			std::cout << "ERROR: Cannot bake a lightmap for mesh primitive " << (int)objects[i].primitive << std::endl;
+			return(false);
+		}
+
+		tracedObjects[i].inverseModel = glm::inverse(objects[i].model);
+		tracedObjects[i].normalMatrix = glm::transpose(glm::mat3(tracedObjects[i].inverseModel));
+
+		std::vector<glm::vec3> localCorners;
+		std::vector<glm::vec3> localNormals;
+		AddLocalTriangles(objects[i].primitive, localCorners, localNormals);
+		for (size_t triangle = 0; triangle < localNormals.size(); triangle++)
+		{
+			glm::vec3 corners[3];
+			for (int corner = 0; corner < 3; corner++)
+			{
+				corners[corner] = glm::vec3(objects[i].model * glm::vec4(localCorners[triangle * 3 + corner], 1.0f));
+				worldCorners.push_back(corners[corner]);
+			}
+			surfaceAreas[i] += 0.5f * glm::length(glm::cross(corners[1] - corners[0], corners[2] - corners[0]));
+
+			TRACED_TRIANGLE traced;
+			traced.object = (int)i;
+			traced.localNormal = localNormals[triangle];
+			traced.worldNormal = glm::normalize(tracedObjects[i].normalMatrix * localNormals[triangle]);
+			triangles.push_back(traced);
+		}
+	}
+
+	TriangleBVH bvh;
+	bvh.Build(worldCorners);
+
+	// size the squares by area, in whole cells of the 3x2 grid,
+	// and place them on shelves from the largest down
+	std::vector<int> objectSizes(objects.size());
+	std::vector<int> placementOrder(objects.size());
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		int size = (int)std::ceil(std::sqrt(surfaceAreas[i]) * TEXELS_PER_UNIT);
+		size = ((size + 5) / 6) * 6;
+		objectSizes[i] = std::min(std::max(size, MIN_OBJECT_SIZE), MAX_OBJECT_SIZE);
+		placementOrder[i] = (int)i;
+	}
+	std::stable_sort(placementOrder.begin(), placementOrder.end(),
+		[&objectSizes](int a, int b) { return(objectSizes[a] > objectSizes[b]); });
+
+	lightmap.objectRects.resize(objects.size());
+	int shelfX = 0;
+	int shelfY = 0;
+	int shelfHeight = 0;
+	for (size_t i = 0; i < placementOrder.size(); i++)
+	{
+		int object = placementOrder[i];
+		int size = objectSizes[object];
+		if (shelfX + size > ATLAS_WIDTH)
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+		lightmap.objectRects[object] = glm::ivec3(shelfX, shelfY, size);
+		shelfX += size;
+		shelfHeight = std::max(shelfHeight, size);
+	}
+	lightmap.width = ATLAS_WIDTH;
+	lightmap.height = std::max(((shelfY + shelfHeight + 3) / 4) * 4, 4);
+
+	// find the texels that lie on a face of their object
+	int texelCount = lightmap.width * lightmap.height;
+	std::vector<int> owners(texelCount, -1);
+	std::vector<unsigned char> covered(texelCount, 0);
+	std::vector<TEXEL_SAMPLE> samples;
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		const glm::ivec3& rect = lightmap.objectRects[i];
+		int chartCount = 0;
+		int columns = 1;
+		int rows = 1;
+		const CHART* pCharts = GetCharts(objects[i].primitive, chartCount, columns, rows);
+
+		for (int y = 0; y < rect.z; y++)
+		{
+			for (int x = 0; x < rect.z; x++)
+			{
+				int texel = (rect.y + y) * lightmap.width + rect.x + x;
+				owners[texel] = (int)i;
+
+				glm::vec2 center(x + 0.5f, y + 0.5f);
+				for (int chart = 0; chart < chartCount; chart++)
+				{
+					glm::vec2 low;
+					glm::vec2 high;
+					GetChartBounds(pCharts[chart], columns, rows, rect.z, low, high);
+					if ((center.x < low.x) || (center.y < low.y) || (center.x > high.x) || (center.y > high.y))
+					{
+						continue;
+					}
+
+					glm::vec3 localPosition;
+					glm::vec3 localNormal;
+					if (UnfoldedToSurface(objects[i].primitive, chart, (center - low) / (high - low), localPosition, localNormal))
+					{
+						TEXEL_SAMPLE sample;
+						sample.texel = texel;
+						sample.position = glm::vec3(objects[i].model * glm::vec4(localPosition, 1.0f));
+						sample.normal = glm::normalize(tracedObjects[i].normalMatrix * localNormal);
+						samples.push_back(sample);
+						covered[texel] = 1;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	// light from the lights, blocked by anything in between
+	std::vector<glm::vec3> direct(texelCount, glm::vec3(0.0f));
+	ParallelFor((int)samples.size(), WORK_CHUNK, [&](int item)
+	{
+		const TEXEL_SAMPLE& sample = samples[item];
+		glm::vec3 origin = sample.position + sample.normal * SURFACE_OFFSET;
+		glm::vec3 irradiance(0.0f);
+		for (size_t light = 0; light < lights.size(); light++)
+		{
+			glm::vec3 toLight = -glm::normalize(lights[light].vector);
+			float distance = DIRECTIONAL_RAY_LENGTH;
+			if (!lights[light].bDirectional)
+			{
+				toLight = lights[light].vector - sample.position;
+				distance = glm::length(toLight);
+				toLight /= distance;
+				distance -= SURFACE_OFFSET;
+			}
+
+			float amount = glm::dot(sample.normal, toLight);
+			if ((amount > 0.0f) && !bvh.IsOccluded(origin, toLight, distance))
+			{
+				irradiance += lights[light].diffuse * amount;
+			}
+		}
+		direct[sample.texel] = irradiance;
+	});
+	Dilate(direct, covered, owners, lightmap.width, lightmap.height);
+
+	// one bounce, the light reflected by the surfaces that
+	// cosine weighted rays over the hemisphere hit
+	std::vector<glm::vec3> total = direct;
+	ParallelFor((int)samples.size(), WORK_CHUNK, [&](int item)
+	{
+		const TEXEL_SAMPLE& sample = samples[item];
+		glm::vec3 origin = sample.position + sample.normal * SURFACE_OFFSET;
+		glm::vec3 tangent = glm::normalize(glm::cross((std::abs(sample.normal.y) < 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f), sample.normal));
+		glm::vec3 bitangent = glm::cross(sample.normal, tangent);
+
+		uint32_t random = (uint32_t)sample.texel * 2654435761u + 1u;
+		glm::vec3 gathered(0.0f);
+		for (int ray = 0; ray < INDIRECT_RAYS; ray++)
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			float u1 = (ray + (random & 0xFFFF) / 65536.0f) / INDIRECT_RAYS;
+			float u2 = (random >> 16) / 65536.0f;
+			float radius = std::sqrt(u1);
+			float angle = 2.0f * PI * u2;
+			glm::vec3 direction = glm::normalize(
+				tangent * (radius * std::cos(angle)) +
+				bitangent * (radius * std::sin(angle)) +
+				sample.normal * std::sqrt(std::max(1.0f - u1, 0.0f)));
+
+			TriangleBVH::RAY_HIT hit;
+			if (!bvh.Intersect(origin, direction, DIRECTIONAL_RAY_LENGTH, hit))
+			{
+				continue;
+			}
+			const TRACED_TRIANGLE& triangle = triangles[hit.triangle];
+			if (glm::dot(direction, triangle.worldNormal) >= 0.0f)
+			{
+				continue;
+			}
+
+			const glm::ivec3& rect = lightmap.objectRects[triangle.object];
+			glm::vec3 localHit = glm::vec3(tracedObjects[triangle.object].inverseModel * glm::vec4(origin + direction * hit.distance, 1.0f));
+			glm::vec2 chartTexel = GetChartTexel(objects[triangle.object].primitive, localHit, triangle.localNormal, rect.z);
+			int x = std::min(std::max((int)chartTexel.x, 0), rect.z - 1);
+			int y = std::min(std::max((int)chartTexel.y, 0), rect.z - 1);
+			gathered += objects[triangle.object].albedo * direct[(rect.y + y) * lightmap.width + rect.x + x];
+		}
+		total[sample.texel] += gathered / (float)INDIRECT_RAYS;
+	});
+	Dilate(total, covered, owners, lightmap.width, lightmap.height);
+
+	lightmap.irradiance.resize((size_t)texelCount * 3);
+	for (int texel = 0; texel < texelCount; texel++)
+	{
+		lightmap.irradiance[texel * 3] = total[texel].r;
+		lightmap.irradiance[texel * 3 + 1] = total[texel].g;
+		lightmap.irradiance[texel * 3 + 2] = total[texel].b;
+	}
+	SaveCachedLightmap(cachePath, inputHash, lightmap);
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "INFO: Baked lightmap of " << objects.size() << " objects, " << lightmap.width << "x" << lightmap.height
+		<< " texels with " << samples.size() << " samples on " << bvh.GetTriangleCount() << " triangles in "
+		<< elapsed.count() << " ms" << std::endl;
+
+	return(true);
+}
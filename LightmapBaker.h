@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.h
+// ============
+// bake the light of the static scene lights into a lightmap atlas on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshRegistry.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  LightmapBaker
+ *
+ *  This class computes the diffuse light that reaches every
+ *  surface of the static objects, so the scene lights do not
+ *  need to be evaluated for them at runtime. Each object gets
+ *  a square of an atlas texture, split into charts for the
+ *  faces of its basic shape. Every texel is lit directly by
+ *  the lights, with shadow rays traced through a BVH of the
+ *  whole scene, and then by one bounce of the light that the
+ *  other objects reflect. The texels are shared out between
+ *  worker threads, and the result is kept in the texture
+ *  cache folder until the objects or the lights change.
+ ***********************************************************/
+class LightmapBaker
+{
+public:
+	// texels of the atlas per unit of surface along a side
+	static const int TEXELS_PER_UNIT = 16;
+	// smallest and largest square of one object, in texels
+	static const int MIN_OBJECT_SIZE = 24;
+	static const int MAX_OBJECT_SIZE = 510;
+	// width of the atlas, the height grows with the objects
+	static const int ATLAS_WIDTH = 1024;
+	// texels kept free around every chart, filled by dilation
+	// so that linear filtering at the edges never reads black
+	static const int GUTTER_TEXELS = 2;
+	// rays per texel for the bounce of indirect light
+	static const int INDIRECT_RAYS = 32;
+
+	// a static object of the scene
+	struct BAKE_OBJECT
+	{
+		MeshRegistry::MESH_PRIMITIVE primitive;
+		glm::mat4 model;
+		// diffuse color that the bounced light is tinted with
+		glm::vec3 albedo;
+	};
+
+	// a static light of the scene
+	struct BAKE_LIGHT
+	{
+		bool bDirectional;
+		// direction the light travels in, or its position
+		glm::vec3 vector;
+		glm::vec3 diffuse;
+	};
+
+	// the baked atlas and the square of every object in it
+	struct BAKED_LIGHTMAP
+	{
+		int width;
+		int height;
+		// diffuse light as RGB floats, rows from the bottom
+		std::vector<float> irradiance;
+		// first texel and side of the square of every object
+		std::vector<glm::ivec3> objectRects;
+	};
+
+	// true when the charts of a basic shape are known
+	static bool IsSupported(MeshRegistry::MESH_PRIMITIVE primitive);
+
+	// bake the lightmap of the objects, or load it from the
+	// cache when the same objects and lights were baked before
+	static bool Bake(
+		const std::vector<BAKE_OBJECT>& objects,
+		const std::vector<BAKE_LIGHT>& lights,
+		BAKED_LIGHTMAP& lightmap);
+
+	// add the triangles of an object in world space, three
+	// corners and one normal for each
+	static void AddWorldTriangles(
+		const BAKE_OBJECT& object,
+		std::vector<glm::vec3>& worldCorners,
+		std::vector<glm::vec3>& worldNormals);
+
+	// get the texel of the object's square that a point of a
+	// basic shape maps to, from its local position and normal,
+	// the shader of BakedLighting does the same
+	static glm::vec2 GetChartTexel(
+		MeshRegistry::MESH_PRIMITIVE primitive,
+		const glm::vec3& localPosition,
+		const glm::vec3& localNormal,
+		int objectSize);
+};
@@ -1,5 +1,8 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <string>
+#include <vector>
+#include <chrono>
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,6 +16,17 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "TemporalAA.h"
+#include "FrameTimer.h"
+#include "ObjectPicker.h"
+#include "GpuResource.h"
+#include "GpuMemory.h"
+#include "RenderCommandList.h"
+#include "RecordingThread.h"
+#include "CommandCapture.h"
+#include "FrameScheduler.h"
+#include "RenderHardware.h"
+#include "VulkanRenderHardware.h"
 
 // Namespace for declaring global variables
 namespace
@@ -20,21 +34,129 @@ namespace
 	// Macro for window title
 	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
 
-	// Main GLFW window
-	GLFWwindow* g_Window = nullptr;
+	// largest number of display windows that can be requested
+	const int MAX_DISPLAY_WINDOWS = 4;
+	// number of frames between the stereo frame time reports
+	const unsigned int STEREO_REPORT_FRAMES = 300;
+	// refresh rate the frame target is taken from when the
+	// monitor does not report one
+	const int DEFAULT_REFRESH_RATE = 60;
+	// finished objects deleted in one slice of the frame scheduler
+	const int DELETIONS_PER_SLICE = 16;
+	// framebuffer size that the null renderer builds frames for
+	const int NULL_RENDERER_WIDTH = 1000;
+	const int NULL_RENDERER_HEIGHT = 800;
+	// frames it takes the null renderer camera to circle the garden
+	const int NULL_RENDERER_ORBIT_FRAMES = 360;
 
-	// scene manager object for managing the 3D scene prepare and render
-	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
+	// everything needed for drawing the 3D scene into one window,
+	// each window has its own camera, views and render targets
+	struct DISPLAY_WINDOW
+	{
+		// GLFW window and its OpenGL context
+		GLFWwindow* pWindow;
+		// view manager object for managing the 3D view setup and projection to 2D
+		ViewManager* pViewManager;
+		// scene manager object for managing the 3D scene prepare and render
+		SceneManager* pSceneManager;
+		// temporal anti-aliasing applied to the rendered 3D scene
+		TemporalAA* pTemporalAA;
+		// framebuffer size the render targets were created at
+		int framebufferWidth;
+		int framebufferHeight;
+		// object ID target for selecting objects with the mouse
+		ObjectPicker* pObjectPicker;
+		// time of each stereo scene submission
+		FrameTimer* pStereoTimers[ViewManager::STEREO_SUBMISSION_COUNT];
+		// commands of each eye, recorded in parallel for the
+		// recorded stereo submission, the right eye on the thread
+		RenderCommandList* pEyeCommands[2];
+		RecordingThread* pEyeRecorder;
+		// background work of the context, such as streamed uploads
+		// and deletions, run in the time left of each frame
+		FrameScheduler* pFrameScheduler;
+		// number of frames rendered into the window
+		unsigned int frameCount;
+		// false once the window has been closed by the user
+		bool bOpen;
+	};
+
+	// display windows, the first one is the main window and the
+	// others share its textures, buffers and shader program
+	std::vector<DISPLAY_WINDOW> g_DisplayWindows;
+
+	// shader manager object for dynamic interaction with the shader code,
+	// its program is shared by the contexts of all the windows
 	ShaderManager* g_ShaderManager = nullptr;
-	// view manager object for managing the 3D view setup and projection to 2D
-	ViewManager* g_ViewManager = nullptr;
+
+	// true when the windows start with side-by-side stereo views
+	bool g_bStartInStereo = false;
+	// true when the windows start without anti-aliasing
+	bool g_bStartWithoutTemporalAA = false;
+
+	// largest texture width or height to load, zero for no limit
+	int g_MaxTextureSize = 0;
+	// true when the texture decode times are printed after loading
+	bool g_bBenchmarkTextures = false;
+	// true when the times of the per object draw functions are
+	// printed once the first window is ready
+	bool g_bBenchmarkDraw = false;
+	// best texture filtering that any material is drawn with
+	SAMPLER_TIER g_TextureFilteringLimit = SAMPLER_TIER_ANISOTROPIC_16X;
+	// large ground image streamed as a virtual texture, if any
+	std::string g_VirtualGroundFile;
+	// true when the static lights are baked into lightmaps
+	bool g_bBakeLighting = false;
+	// true when the ambient light comes from irradiance probes
+	bool g_bBakeProbes = false;
+	// true when hidden clusters are skipped with occlusion queries
+	bool g_bOcclusionCulling = false;
+	// true when the cells seen from each cell are baked at load
+	bool g_bVisibilitySets = false;
+	// true when the point lights cast shadows, and the megabytes
+	// their shadow cubes may use
+	bool g_bPointShadows = false;
+	int g_PointShadowBudget = 32;
+
+	// number of frames of the main window to capture, and the
+	// file they are saved into
+	int g_CaptureFrames = 0;
+	std::string g_CaptureFile;
+	// capture of the main window while it is being recorded
+	CommandCapture* g_pCommandCapture = nullptr;
+	// capture file submitted instead of drawing the scene
+	std::string g_ReplayFile;
+	// number of times the frames of a capture are submitted
+	const int REPLAY_PASSES = 20;
+
+	// number of frames of the main window checked for buffer
+	// allocations, the buffer names counted after the frames
+	// that may still create objects, and the result
+	int g_AllocationCheckFrames = 0;
+	const unsigned int ALLOCATION_CHECK_WARMUP_FRAMES = 10;
+	int g_AllocationCheckBaseline = 0;
+	bool g_bAllocationCheckFailed = false;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+int GetRequestedWindowCount(int argc, char* argv[]);
+int GetNullRendererFrames(int argc, char* argv[]);
+void RunNullRenderer(int frameCount);
+std::string GetRenderHardwareTest(int argc, char* argv[]);
+void ReadCommandLineOptions(int argc, char* argv[]);
+bool CreateSharedDisplayWindow(int windowIndex);
+void InitializeWindowRendering(DISPLAY_WINDOW& displayWindow);
+void ResizeWindowRendering(DISPLAY_WINDOW& displayWindow);
+void RenderDisplayWindow(DISPLAY_WINDOW& displayWindow);
+void DestroyDisplayWindow(DISPLAY_WINDOW& displayWindow);
+void PickDisplayWindowObject(DISPLAY_WINDOW& displayWindow);
+void StartCommandCapture(DISPLAY_WINDOW& displayWindow);
+void FinishCommandCapture(DISPLAY_WINDOW& displayWindow);
+void ReplayCommandCapture(DISPLAY_WINDOW& displayWindow, const std::string& path);
+void CheckBufferAllocations(DISPLAY_WINDOW& displayWindow);
 
 
 /***********************************************************
@@ -45,20 +167,48 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// "--null-renderer N" builds frames without a window, for
+	// measuring the CPU time of a frame on any machine
+	int nullRendererFrames = GetNullRendererFrames(argc, argv);
+	if (nullRendererFrames > 0)
+	{
+		RunNullRenderer(nullRendererFrames);
+		return(EXIT_SUCCESS);
+	}
+
+	// "--rhi-test vulkan" draws through the Vulkan device of the
+	// render hardware interface and exits, it needs no window
+	std::string hardwareTest = GetRenderHardwareTest(argc, argv);
+	if (!hardwareTest.empty() && (hardwareTest != "vulkan") && (hardwareTest != "gl"))
+	{
+		std::cout << "ERROR: The render hardware test is run on vulkan or gl, not " << hardwareTest << std::endl;
+		return(EXIT_FAILURE);
+	}
+	if (hardwareTest == "vulkan")
+	{
+		RenderHardware* pHardware = CreateVulkanRenderHardware();
+		bool bPassed = (NULL != pHardware) && TestRenderHardware(pHardware);
+		delete pHardware;
+		return(bPassed ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
+	DISPLAY_WINDOW mainWindow = {};
+
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
 	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
+	mainWindow.pViewManager = new ViewManager(
 		g_ShaderManager);
 
 	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	mainWindow.pWindow = mainWindow.pViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	mainWindow.bOpen = true;
 
 	// if GLEW fails initialization, then terminate the application
 	if (InitializeGLEW() == false)
@@ -66,6 +216,20 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
+	// "--rhi-test gl" draws through the OpenGL device of the main
+	// window's context and exits
+	if (hardwareTest == "gl")
+	{
+		GLRenderHardware hardware;
+		bool bPassed = TestRenderHardware(&hardware);
+		GpuResources::Flush();
+		glfwTerminate();
+		return(bPassed ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// remember the free video memory before anything is loaded
+	GpuMemory::CaptureDriverBaseline();
+
 	// load the shader code from the external GLSL files
 	g_ShaderManager->LoadShaders(
 		"../../../Utilities/shaders/vertexShader.glsl",
@@ -73,45 +237,117 @@ int main(int argc, char* argv[])
 	g_ShaderManager->use();
 
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
+	mainWindow.pSceneManager = new SceneManager(g_ShaderManager);
+	ReadCommandLineOptions(argc, argv);
+	mainWindow.pSceneManager->SetMaxTextureSize(g_MaxTextureSize);
+	mainWindow.pSceneManager->SetTextureFilteringLimit(g_TextureFilteringLimit);
+	mainWindow.pSceneManager->SetVirtualGroundFile(g_VirtualGroundFile);
+	mainWindow.pSceneManager->SetBakeLighting(g_bBakeLighting);
+	mainWindow.pSceneManager->SetBakeProbes(g_bBakeProbes);
+	mainWindow.pSceneManager->SetOcclusionCulling(g_bOcclusionCulling);
+	mainWindow.pSceneManager->SetVisibilitySets(g_bVisibilitySets);
+	mainWindow.pSceneManager->SetPointShadows(g_bPointShadows, (size_t)g_PointShadowBudget << 20);
+	mainWindow.pSceneManager->PrepareScene();
+	if (g_bBenchmarkTextures)
+	{
+		mainWindow.pSceneManager->BenchmarkTextureDecoding();
+	}
 
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
+	InitializeWindowRendering(mainWindow);
+	g_DisplayWindows.push_back(mainWindow);
+	if (g_bBenchmarkDraw)
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		mainWindow.pSceneManager->BenchmarkDrawFunctions();
+		mainWindow.pViewManager->BenchmarkSceneViews();
+	}
 
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	// "--replay file" submits the frames of a capture as fast as
+	// the driver takes them and then exits, "--capture N file"
+	// records the first frames of the main window into one
+	if (!g_ReplayFile.empty())
+	{
+		ReplayCommandCapture(mainWindow, g_ReplayFile);
+		glfwSetWindowShouldClose(mainWindow.pWindow, GLFW_TRUE);
+	}
+	else if ((g_CaptureFrames > 0) && !g_CaptureFile.empty())
+	{
+		StartCommandCapture(mainWindow);
+	}
 
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+	// create any additional windows requested on the command line,
+	// for example "--windows 2" drives two displays from one process
+	int windowCount = GetRequestedWindowCount(argc, argv);
+	for (int i = 1; i < windowCount; i++)
+	{
+		if (CreateSharedDisplayWindow(i) == false)
+		{
+			break;
+		}
+	}
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
+	// loop will keep running until the main window is closed 
+	// or until an error has occurred
+	while (!glfwWindowShouldClose(g_DisplayWindows[0].pWindow))
+	{
+		for (size_t i = 0; i < g_DisplayWindows.size(); i++)
+		{
+			DISPLAY_WINDOW& displayWindow = g_DisplayWindows[i];
+			if (!displayWindow.bOpen)
+			{
+				continue;
+			}
 
+			// additional windows are hidden when they are closed,
+			// their context is kept until the application exits
+			if ((i > 0) && glfwWindowShouldClose(displayWindow.pWindow))
+			{
+				glfwHideWindow(displayWindow.pWindow);
+				displayWindow.bOpen = false;
+				continue;
+			}
 
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+			if ((i == 0) && (NULL != g_pCommandCapture))
+			{
+				g_pCommandCapture->BeginFrame();
+			}
+			RenderDisplayWindow(displayWindow);
+			if ((i == 0) && (NULL != g_pCommandCapture) && (g_pCommandCapture->GetFrameCount() >= g_CaptureFrames))
+			{
+				FinishCommandCapture(displayWindow);
+			}
+			// "--check-allocations N" makes sure that steady frames
+			// never create a buffer and then exits
+			if ((i == 0) && (g_AllocationCheckFrames > 0))
+			{
+				CheckBufferAllocations(displayWindow);
+			}
+		}
 
 		// query the latest GLFW events
 		glfwPollEvents();
 	}
 
-	// clear the allocated manager objects from memory
-	if (NULL != g_SceneManager)
+	// keep the frames of a capture that the window closed during
+	if (NULL != g_pCommandCapture)
 	{
-		delete g_SceneManager;
-		g_SceneManager = NULL;
+		FinishCommandCapture(g_DisplayWindows[0]);
 	}
-	if (NULL != g_ViewManager)
+
+	// print the GPU memory of each subsystem before anything is freed
+	glfwMakeContextCurrent(g_DisplayWindows[0].pWindow);
+	GpuMemory::Report();
+
+	// clear the allocated manager objects from memory, the main
+	// window goes last because its context created the shared objects
+	for (int i = (int)g_DisplayWindows.size() - 1; i >= 0; i--)
 	{
-		delete g_ViewManager;
-		g_ViewManager = NULL;
+		DestroyDisplayWindow(g_DisplayWindows[i]);
 	}
+	g_DisplayWindows.clear();
+
+	// anything still live here was never released by its owner
+	GpuResources::Report();
+
 	if (NULL != g_ShaderManager)
 	{
 		delete g_ShaderManager;
@@ -119,7 +355,782 @@ int main(int argc, char* argv[])
 	}
 
 	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	exit(g_bAllocationCheckFailed ? EXIT_FAILURE : EXIT_SUCCESS); 
+}
+
+/***********************************************************
+ *	GetRequestedWindowCount()
+ *
+ *  This function is used to read the number of display
+ *  windows from the "--windows N" command line option.
+ ***********************************************************/
+int GetRequestedWindowCount(int argc, char* argv[])
+{
+	int windowCount = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((std::string(argv[i]) == "--windows") && (i + 1 < argc))
+		{
+			windowCount = std::atoi(argv[i + 1]);
+		}
+	}
+
+	if (windowCount < 1)
+	{
+		windowCount = 1;
+	}
+	else if (windowCount > MAX_DISPLAY_WINDOWS)
+	{
+		windowCount = MAX_DISPLAY_WINDOWS;
+	}
+
+	return(windowCount);
+}
+
+/***********************************************************
+ *	GetNullRendererFrames()
+ *
+ *  This function is used to read the "--null-renderer N"
+ *  command line option, the number of frames to build with
+ *  the null render backend, or zero to open the windows.
+ ***********************************************************/
+int GetNullRendererFrames(int argc, char* argv[])
+{
+	int frameCount = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((std::string(argv[i]) == "--null-renderer") && (i + 1 < argc))
+		{
+			frameCount = std::atoi(argv[i + 1]);
+		}
+	}
+
+	return((frameCount > 0) ? frameCount : 0);
+}
+
+/***********************************************************
+ *	GetRenderHardwareTest()
+ *
+ *  This function is used to read the "--rhi-test DEVICE"
+ *  command line option, the device of the render hardware
+ *  interface to test, or an empty string to open the windows.
+ ***********************************************************/
+std::string GetRenderHardwareTest(int argc, char* argv[])
+{
+	std::string device;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((std::string(argv[i]) == "--rhi-test") && (i + 1 < argc))
+		{
+			device = argv[i + 1];
+		}
+	}
+
+	return(device);
+}
+
+/***********************************************************
+ *	RunNullRenderer()
+ *
+ *  This function is used to build frames of the scene with
+ *  the null render backend, which needs neither a window nor
+ *  OpenGL. The camera circles the garden, and the time of a
+ *  frame and the calls it made are printed, which stay the
+ *  same between runs of the same build.
+ ***********************************************************/
+void RunNullRenderer(int frameCount)
+{
+	NullRenderBackend nullBackend;
+
+	ViewManager viewManager(NULL);
+	viewManager.SetRenderBackend(&nullBackend);
+	SceneManager sceneManager(NULL);
+	sceneManager.SetRenderBackend(&nullBackend);
+	sceneManager.PrepareHeadlessScene();
+	nullBackend.ResetCounters();
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float angle = glm::radians(360.0f * (float)(frame % NULL_RENDERER_ORBIT_FRAMES) / (float)NULL_RENDERER_ORBIT_FRAMES);
+		glm::vec3 target(0.0f, 1.0f, 5.0f);
+		glm::vec3 position = target + glm::vec3(12.0f * sinf(angle), 4.0f, 12.0f * cosf(angle));
+		viewManager.PrepareHeadlessSceneView(position, glm::normalize(target - position), NULL_RENDERER_WIDTH, NULL_RENDERER_HEIGHT);
+
+		// the same steps as a window with one view
+		glm::mat4 viewProjections[ViewManager::MAX_SCENE_VIEWS];
+		int viewCount = viewManager.GetViewProjections(viewProjections, ViewManager::MAX_SCENE_VIEWS);
+		sceneManager.CullDrawList(viewProjections, viewCount);
+		sceneManager.RenderScene(0);
+		for (int view = 1; view < viewCount; view++)
+		{
+			viewManager.ApplySceneView(view);
+			sceneManager.RenderScene(view);
+		}
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	const NullRenderBackend::RENDER_COUNTERS& counters = nullBackend.GetCounters();
+	std::cout << "INFO: Null renderer built " << frameCount << " frames in " << elapsed.count() << " ms, "
+		<< (elapsed.count() * 1000.0 / frameCount) << " us per frame" << std::endl;
+	std::cout << "INFO: Per frame " << ((double)counters.drawCalls / frameCount) << " draw calls, "
+		<< ((double)counters.shaderValues / frameCount) << " shader values, "
+		<< ((double)counters.samplerBinds / frameCount) << " sampler binds, "
+		<< ((double)counters.viewports / frameCount) << " viewports" << std::endl;
+}
+
+/***********************************************************
+ *	StartCommandCapture()
+ *
+ *  This function is used to put a capture between the main
+ *  window's managers and their backend, so the calls of the
+ *  next frames are kept as well as drawn. Only the calls to
+ *  the backend are kept, so the capture is refused while a
+ *  feature that draws with OpenGL directly is on, and the
+ *  anti-aliasing cannot be turned on until it is finished.
+ ***********************************************************/
+void StartCommandCapture(DISPLAY_WINDOW& displayWindow)
+{
+	if (g_bBakeLighting || g_bOcclusionCulling || g_bPointShadows || !g_VirtualGroundFile.empty())
+	{
+		std::cout << "ERROR: --capture only records calls to the render backend and cannot be used with "
+			<< "--lightmaps, --occlusion, --point-shadows or --virtual-ground" << std::endl;
+		return;
+	}
+	if (displayWindow.pTemporalAA->IsEnabled())
+	{
+		std::cout << "ERROR: --capture cannot record the anti-aliasing resolve, use it with --no-taa or --stereo" << std::endl;
+		return;
+	}
+	displayWindow.pViewManager->SetTemporalAA(NULL);
+
+	g_pCommandCapture = new CommandCapture();
+	g_pCommandCapture->SetTarget(displayWindow.pSceneManager->GetRenderBackend());
+	displayWindow.pSceneManager->SetRenderBackend(g_pCommandCapture);
+	displayWindow.pViewManager->SetRenderBackend(g_pCommandCapture);
+
+	std::cout << "INFO: Capturing " << g_CaptureFrames << " frames into " << g_CaptureFile << std::endl;
+}
+
+/***********************************************************
+ *	FinishCommandCapture()
+ *
+ *  This function is used to save the captured frames and
+ *  give the managers their own backend back.
+ ***********************************************************/
+void FinishCommandCapture(DISPLAY_WINDOW& displayWindow)
+{
+	// both managers of a window draw through the shader manager,
+	// so the scene's backend can take the view's calls as well
+	RenderBackend* pBackend = g_pCommandCapture->GetTarget();
+	displayWindow.pSceneManager->SetRenderBackend(pBackend);
+	displayWindow.pViewManager->SetRenderBackend(pBackend);
+	displayWindow.pViewManager->SetTemporalAA(displayWindow.pTemporalAA);
+
+	if (g_pCommandCapture->Save(g_CaptureFile))
+	{
+		std::cout << "INFO: Saved " << g_pCommandCapture->GetFrameCount() << " frames into " << g_CaptureFile << std::endl;
+	}
+
+	delete g_pCommandCapture;
+	g_pCommandCapture = NULL;
+}
+
+/***********************************************************
+ *	ReplayCommandCapture()
+ *
+ *  This function is used to submit the frames of a capture
+ *  file to the driver as fast as it takes them, with nothing
+ *  of the scene code in between. The time of a frame is
+ *  printed once with the calls submitted and once with them
+ *  finished by the GPU, so drivers and state strategies can
+ *  be compared on the same calls. The scene of the window
+ *  must be prepared with the options of the captured run.
+ ***********************************************************/
+void ReplayCommandCapture(DISPLAY_WINDOW& displayWindow, const std::string& path)
+{
+	CommandCapture capture;
+	if ((capture.Load(path, displayWindow.pSceneManager->GetMeshRegistry()) == false) ||
+		(capture.GetFrameCount() == 0))
+	{
+		return;
+	}
+
+	RenderBackend* pBackend = displayWindow.pSceneManager->GetRenderBackend();
+	int frameCount = capture.GetFrameCount() * REPLAY_PASSES;
+
+	glfwMakeContextCurrent(displayWindow.pWindow);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	g_ShaderManager->use();
+	glFinish();
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		capture.GetFrame(frame % capture.GetFrameCount()).Submit(pBackend);
+		glfwSwapBuffers(displayWindow.pWindow);
+	}
+	std::chrono::duration<double, std::milli> submitted = std::chrono::high_resolution_clock::now() - start;
+	glFinish();
+	std::chrono::duration<double, std::milli> finished = std::chrono::high_resolution_clock::now() - start;
+
+	std::cout << "INFO: Replayed " << capture.GetFrameCount() << " captured frames " << REPLAY_PASSES << " times, "
+		<< (submitted.count() * 1000.0 / frameCount) << " us per frame submitted, "
+		<< (finished.count() * 1000.0 / frameCount) << " us per frame finished" << std::endl;
+}
+
+/***********************************************************
+ *	CheckBufferAllocations()
+ *
+ *  This function is used to check that the frames of a window
+ *  create no buffers once the scene is running. The buffer
+ *  names in use are counted after a few frames, which may
+ *  still create objects such as programs and threads, and
+ *  again after the frames of the check, then the window is
+ *  closed. Buffers that were released may not be deleted
+ *  yet, so only more names than before fail the check. The
+ *  window must not be resized while it runs.
+ ***********************************************************/
+void CheckBufferAllocations(DISPLAY_WINDOW& displayWindow)
+{
+	if (displayWindow.frameCount == ALLOCATION_CHECK_WARMUP_FRAMES)
+	{
+		g_AllocationCheckBaseline = GpuResources::CountBufferNames();
+		std::cout << "INFO: Checking " << g_AllocationCheckFrames << " frames for buffer allocations, "
+			<< g_AllocationCheckBaseline << " buffers in use" << std::endl;
+	}
+	else if (displayWindow.frameCount == ALLOCATION_CHECK_WARMUP_FRAMES + (unsigned int)g_AllocationCheckFrames)
+	{
+		int bufferCount = GpuResources::CountBufferNames();
+		if (bufferCount > g_AllocationCheckBaseline)
+		{
+			std::cout << "ERROR: " << (bufferCount - g_AllocationCheckBaseline) << " buffers were allocated in "
+				<< g_AllocationCheckFrames << " frames" << std::endl;
+			g_bAllocationCheckFailed = true;
+		}
+		else
+		{
+			std::cout << "INFO: No buffers were allocated in " << g_AllocationCheckFrames << " frames" << std::endl;
+		}
+		glfwSetWindowShouldClose(displayWindow.pWindow, GLFW_TRUE);
+	}
+}
+
+/***********************************************************
+ *	ReadCommandLineOptions()
+ *
+ *  This function is used to read the command line options
+ *  of the scene, before the main window is set up:
+ *    --max-texture-size N     load smaller textures
+ *    --benchmark-textures     time the texture decoding
+ *    --benchmark-draw         time the draw functions
+ *    --texture-filtering F    limit the material filtering
+ *    --virtual-ground FILE    stream the ground image
+ *    --lightmaps              bake lightmaps at load
+ *    --probes                 bake the ambient probes
+ *    --occlusion              skip the hidden topiaries
+ *    --pvs                    bake the visible cells
+ *    --point-shadows          shadows of the point lights
+ *    --shadow-budget N        megabytes of the shadow cubes
+ *    --capture N FILE         save the first N frames
+ *    --replay FILE            submit a saved capture
+ *    --stereo                 start in side-by-side stereo
+ *    --no-taa                 start without anti-aliasing
+ *    --check-allocations N    check N frames allocate nothing
+ ***********************************************************/
+void ReadCommandLineOptions(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if ((std::string(argv[i]) == "--max-texture-size") && (i + 1 < argc))
+		{
+			g_MaxTextureSize = std::atoi(argv[i + 1]);
+			if (g_MaxTextureSize < 0)
+			{
+				g_MaxTextureSize = 0;
+			}
+		}
+		else if (std::string(argv[i]) == "--benchmark-textures")
+		{
+			g_bBenchmarkTextures = true;
+		}
+		else if (std::string(argv[i]) == "--benchmark-draw")
+		{
+			g_bBenchmarkDraw = true;
+		}
+		else if ((std::string(argv[i]) == "--texture-filtering") && (i + 1 < argc))
+		{
+			TextureSamplers::ParseTier(argv[i + 1], g_TextureFilteringLimit);
+		}
+		else if ((std::string(argv[i]) == "--virtual-ground") && (i + 1 < argc))
+		{
+			g_VirtualGroundFile = argv[i + 1];
+		}
+		else if (std::string(argv[i]) == "--lightmaps")
+		{
+			g_bBakeLighting = true;
+		}
+		else if (std::string(argv[i]) == "--probes")
+		{
+			g_bBakeProbes = true;
+		}
+		else if (std::string(argv[i]) == "--occlusion")
+		{
+			g_bOcclusionCulling = true;
+		}
+		else if (std::string(argv[i]) == "--pvs")
+		{
+			g_bVisibilitySets = true;
+		}
+		else if (std::string(argv[i]) == "--point-shadows")
+		{
+			g_bPointShadows = true;
+		}
+		else if ((std::string(argv[i]) == "--shadow-budget") && (i + 1 < argc))
+		{
+			g_PointShadowBudget = std::atoi(argv[i + 1]);
+			if (g_PointShadowBudget < 0)
+			{
+				g_PointShadowBudget = 0;
+			}
+		}
+		else if ((std::string(argv[i]) == "--capture") && (i + 2 < argc))
+		{
+			g_CaptureFrames = std::atoi(argv[i + 1]);
+			g_CaptureFile = argv[i + 2];
+		}
+		else if ((std::string(argv[i]) == "--replay") && (i + 1 < argc))
+		{
+			g_ReplayFile = argv[i + 1];
+		}
+		else if (std::string(argv[i]) == "--stereo")
+		{
+			g_bStartInStereo = true;
+		}
+		else if (std::string(argv[i]) == "--no-taa")
+		{
+			g_bStartWithoutTemporalAA = true;
+		}
+		else if ((std::string(argv[i]) == "--check-allocations") && (i + 1 < argc))
+		{
+			g_AllocationCheckFrames = std::atoi(argv[i + 1]);
+		}
+	}
+}
+
+/***********************************************************
+ *	CreateSharedDisplayWindow()
+ *
+ *  This function is used to create an additional display
+ *  window with its own view manager and camera. Its context
+ *  shares objects with the main window, so the textures and
+ *  shader program are used from the main window's scene.
+ ***********************************************************/
+bool CreateSharedDisplayWindow(int windowIndex)
+{
+	DISPLAY_WINDOW displayWindow = {};
+
+	std::string title = std::string(WINDOW_TITLE) + " - View " + std::to_string(windowIndex + 1);
+
+	displayWindow.pViewManager = new ViewManager(g_ShaderManager);
+	displayWindow.pWindow = displayWindow.pViewManager->CreateDisplayWindow(
+		title.c_str(),
+		g_DisplayWindows[0].pWindow);
+	if (displayWindow.pWindow == NULL)
+	{
+		delete displayWindow.pViewManager;
+		return(false);
+	}
+	displayWindow.bOpen = true;
+
+	// only the main window waits for the vertical blank, so
+	// the windows do not throttle each other when swapping
+	glfwSwapInterval(0);
+
+	// the current program is state of each context
+	g_ShaderManager->use();
+
+	displayWindow.pSceneManager = new SceneManager(g_ShaderManager);
+	displayWindow.pSceneManager->PrepareSharedScene(g_DisplayWindows[0].pSceneManager);
+
+	InitializeWindowRendering(displayWindow);
+	g_DisplayWindows.push_back(displayWindow);
+
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeWindowRendering()
+ *
+ *  This function is used to create the temporal anti-aliasing
+ *  render targets at the size of the window's framebuffer,
+ *  the frame timers and the frame scheduler, whose target is
+ *  the refresh interval of the monitor. Framebuffer and query
+ *  objects are not shared between contexts, so every window
+ *  gets its own.
+ ***********************************************************/
+void InitializeWindowRendering(DISPLAY_WINDOW& displayWindow)
+{
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+	glfwGetFramebufferSize(displayWindow.pWindow, &framebufferWidth, &framebufferHeight);
+	displayWindow.framebufferWidth = framebufferWidth;
+	displayWindow.framebufferHeight = framebufferHeight;
+
+	displayWindow.pTemporalAA = new TemporalAA();
+	displayWindow.pTemporalAA->Initialize(framebufferWidth, framebufferHeight);
+	displayWindow.pViewManager->SetTemporalAA(displayWindow.pTemporalAA);
+
+	displayWindow.pObjectPicker = new ObjectPicker();
+	displayWindow.pObjectPicker->Initialize(framebufferWidth, framebufferHeight);
+
+	displayWindow.pStereoTimers[ViewManager::STEREO_SINGLE_PASS] = new FrameTimer("Stereo single pass");
+	displayWindow.pStereoTimers[ViewManager::STEREO_TWO_PASS] = new FrameTimer("Stereo two pass");
+	displayWindow.pStereoTimers[ViewManager::STEREO_RECORDED] = new FrameTimer("Stereo recorded");
+	displayWindow.pEyeCommands[0] = new RenderCommandList();
+	displayWindow.pEyeCommands[1] = new RenderCommandList();
+	displayWindow.frameCount = 0;
+
+	int refreshRate = DEFAULT_REFRESH_RATE;
+	const GLFWvidmode* pVideoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+	if ((NULL != pVideoMode) && (pVideoMode->refreshRate > 0))
+	{
+		refreshRate = pVideoMode->refreshRate;
+	}
+	displayWindow.pFrameScheduler = new FrameScheduler();
+	displayWindow.pFrameScheduler->SetFrameTarget(1000.0 / refreshRate);
+	displayWindow.pSceneManager->SetFrameScheduler(displayWindow.pFrameScheduler);
+
+	if (g_bStartWithoutTemporalAA)
+	{
+		displayWindow.pTemporalAA->SetEnabled(false);
+	}
+	if (g_bStartInStereo)
+	{
+		displayWindow.pViewManager->SetStereo(true);
+	}
+}
+
+/***********************************************************
+ *	ResizeWindowRendering()
+ *
+ *  This function is used to create the render targets of a
+ *  window again when its framebuffer has changed size, which
+ *  also drops the anti-aliasing history of the old size and
+ *  a pick that was still being read back. A minimized window
+ *  has no framebuffer and keeps its targets.
+ ***********************************************************/
+void ResizeWindowRendering(DISPLAY_WINDOW& displayWindow)
+{
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+	glfwGetFramebufferSize(displayWindow.pWindow, &framebufferWidth, &framebufferHeight);
+	if ((framebufferWidth <= 0) || (framebufferHeight <= 0) ||
+		((framebufferWidth == displayWindow.framebufferWidth) && (framebufferHeight == displayWindow.framebufferHeight)))
+	{
+		return;
+	}
+
+	displayWindow.framebufferWidth = framebufferWidth;
+	displayWindow.framebufferHeight = framebufferHeight;
+	displayWindow.pTemporalAA->Initialize(framebufferWidth, framebufferHeight);
+	displayWindow.pObjectPicker->Initialize(framebufferWidth, framebufferHeight);
+}
+
+/***********************************************************
+ *	RenderDisplayWindow()
+ *
+ *  This function is used to render one frame of the 3D scene
+ *  into the passed in window and present it.
+ ***********************************************************/
+void RenderDisplayWindow(DISPLAY_WINDOW& displayWindow)
+{
+	glfwMakeContextCurrent(displayWindow.pWindow);
+	displayWindow.pFrameScheduler->BeginFrame();
+	ResizeWindowRendering(displayWindow);
+
+	// convert from 3D object space to 2D view
+	displayWindow.pViewManager->PrepareSceneView();
+
+	// cull the scene once for every view of this frame
+	glm::mat4 viewProjections[ViewManager::MAX_SCENE_VIEWS];
+	int viewCount = displayWindow.pViewManager->GetViewProjections(viewProjections, ViewManager::MAX_SCENE_VIEWS);
+	displayWindow.pSceneManager->CullDrawList(viewProjections, viewCount);
+	// the camera's views only keep what its cell can see, the
+	// overlays such as the minimap are seen from above
+	int cameraViewCount = displayWindow.pViewManager->IsStereo() ? 2 : 1;
+	for (int view = 0; (view < cameraViewCount) && (view < viewCount); view++)
+	{
+		displayWindow.pSceneManager->CullHiddenCells(view, displayWindow.pViewManager->GetSceneView(view).position);
+	}
+
+	ViewManager* pViewManager = displayWindow.pViewManager;
+	SceneManager* pSceneManager = displayWindow.pSceneManager;
+
+	// stream the pages of the ground seen from the main view, and
+	// the ones ahead of the camera while it is moving
+	glm::mat4 predictedViewProjection;
+	if (pViewManager->GetPredictedViewProjection(predictedViewProjection))
+	{
+		pSceneManager->UpdateVirtualGround(0, &predictedViewProjection);
+	}
+	else
+	{
+		pSceneManager->UpdateVirtualGround(0);
+	}
+	// draw the shadow cubes of the point lights that changed
+	pSceneManager->UpdatePointShadows();
+
+	// render the scene into the anti-aliasing target
+	displayWindow.pTemporalAA->BeginSceneRender();
+
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	int firstOverlayView = 1;
+	if (pViewManager->IsStereo())
+	{
+		// the recorded submission needs every object to be drawn
+		// through the backend, otherwise both eyes are drawn in turn
+		ViewManager::STEREO_SUBMISSION submission = pViewManager->GetStereoSubmission();
+		if ((submission == ViewManager::STEREO_RECORDED) && !pSceneManager->CanRecordScene())
+		{
+			submission = ViewManager::STEREO_TWO_PASS;
+		}
+		FrameTimer* pStereoTimer = displayWindow.pStereoTimers[submission];
+
+		pStereoTimer->Begin();
+		if (submission == ViewManager::STEREO_SINGLE_PASS)
+		{
+			// both eyes are drawn from one walk of the draw list
+			SceneManager::VIEW_PASS eyePasses[2];
+			for (int eye = 0; eye < 2; eye++)
+			{
+				const ViewManager::SCENE_VIEW& eyeView = pViewManager->GetSceneView(eye);
+				eyePasses[eye].viewIndex = eye;
+				eyePasses[eye].viewport[0] = eyeView.x;
+				eyePasses[eye].viewport[1] = eyeView.y;
+				eyePasses[eye].viewport[2] = eyeView.width;
+				eyePasses[eye].viewport[3] = eyeView.height;
+				eyePasses[eye].view = eyeView.view;
+				eyePasses[eye].projection = eyeView.projection;
+				eyePasses[eye].position = eyeView.position;
+			}
+			pSceneManager->RenderSceneInterleaved(eyePasses, 2);
+		}
+		else if (submission == ViewManager::STEREO_RECORDED)
+		{
+			// the right eye is recorded on the worker thread while
+			// this thread records the left, then each one is
+			// submitted in full on the thread of the context
+			if (NULL == displayWindow.pEyeRecorder)
+			{
+				displayWindow.pEyeRecorder = new RecordingThread();
+			}
+			RenderCommandList* pRightEyeCommands = displayWindow.pEyeCommands[1];
+			displayWindow.pEyeRecorder->Start([pSceneManager, pRightEyeCommands]()
+			{
+				pSceneManager->RecordScene(1, *pRightEyeCommands);
+			});
+			pSceneManager->RecordScene(0, *displayWindow.pEyeCommands[0]);
+			displayWindow.pEyeRecorder->Wait();
+
+			for (int eye = 0; eye < 2; eye++)
+			{
+				pViewManager->ApplySceneView(eye);
+				pSceneManager->SubmitRecordedScene(*displayWindow.pEyeCommands[eye]);
+			}
+		}
+		else
+		{
+			// one full submission of the scene for each eye
+			for (int eye = 0; eye < 2; eye++)
+			{
+				pViewManager->ApplySceneView(eye);
+				pSceneManager->RenderScene(eye);
+			}
+		}
+		pStereoTimer->End();
+
+		firstOverlayView = 2;
+	}
+	else
+	{
+		// refresh the 3D scene
+		pSceneManager->RenderScene(0);
+	}
+
+	// blend with the reprojected history and present the result
+	displayWindow.pTemporalAA->ResolveAndPresent();
+
+	// draw the additional views, such as the minimap, over
+	// the presented frame without any sub-pixel jitter
+	for (int view = firstOverlayView; view < viewCount; view++)
+	{
+		pViewManager->ApplySceneView(view);
+		pSceneManager->RenderScene(view);
+	}
+
+	// find the object under a click without waiting for the GPU
+	PickDisplayWindowObject(displayWindow);
+
+	// spend what is left of the frame on the background work
+	displayWindow.pFrameScheduler->RunQueued();
+
+	// Flips the the back buffer with the front buffer every frame.
+	glfwSwapBuffers(displayWindow.pWindow);
+
+	// delete the objects released by frames the GPU has finished,
+	// a few at a time in the time left of the next frames
+	GpuResources::EndFrame();
+	if (GpuResources::GetReadyCount() > 0)
+	{
+		displayWindow.pFrameScheduler->Post("deletions", []()
+		{
+			return(GpuResources::DeleteReady(DELETIONS_PER_SLICE));
+		});
+	}
+
+	// compare the stereo submission modes every few seconds,
+	// each mode is measured while it is selected with the B key
+	displayWindow.frameCount++;
+	if ((displayWindow.frameCount % STEREO_REPORT_FRAMES) == 0)
+	{
+		for (int i = 0; i < ViewManager::STEREO_SUBMISSION_COUNT; i++)
+		{
+			displayWindow.pStereoTimers[i]->Report();
+		}
+		displayWindow.pFrameScheduler->Report();
+	}
+}
+
+/***********************************************************
+ *	PickDisplayWindowObject()
+ *
+ *  This function is used to draw the object IDs for a click
+ *  into the picking target of the window, and to report the
+ *  picked object once an earlier readback has arrived. Only
+ *  the clicked pixel is drawn and read, so picking costs the
+ *  same however large the scene is.
+ ***********************************************************/
+void PickDisplayWindowObject(DISPLAY_WINDOW& displayWindow)
+{
+	ViewManager* pViewManager = displayWindow.pViewManager;
+	SceneManager* pSceneManager = displayWindow.pSceneManager;
+	ObjectPicker* pObjectPicker = displayWindow.pObjectPicker;
+
+	int pickX = 0;
+	int pickY = 0;
+	if (pViewManager->TakePickRequest(pickX, pickY))
+	{
+		pObjectPicker->RequestPick(pickX, pickY);
+	}
+
+	if (pObjectPicker->IsPickRequested())
+	{
+		// pick in the view that is on top at the clicked pixel,
+		// so a click on the minimap selects from the minimap
+		int view = pViewManager->FindSceneViewAt(pObjectPicker->GetPickX(), pObjectPicker->GetPickY());
+		if (view >= 0)
+		{
+			pObjectPicker->BeginPickPass();
+			pViewManager->ApplySceneView(view, false);
+			pSceneManager->RenderObjectIDs(view);
+			pObjectPicker->EndPickPass();
+		}
+	}
+
+	int objectIndex = ObjectPicker::NO_OBJECT;
+	if (pObjectPicker->PollResult(objectIndex))
+	{
+		if ((objectIndex >= 0) && (objectIndex < pSceneManager->GetDrawCommandCount()))
+		{
+			const SceneManager::DRAW_COMMAND& command = pSceneManager->GetDrawCommand(objectIndex);
+			glm::vec3 position = glm::vec3(command.model[3]);
+			std::cout << "INFO: Picked object " << objectIndex
+				<< " (" << command.materialTag << ", " << command.textureTag << ")"
+				<< " at " << position.x << ", " << position.y << ", " << position.z << std::endl;
+		}
+		else
+		{
+			std::cout << "INFO: No object picked" << std::endl;
+		}
+	}
+}
+
+/***********************************************************
+ *	DestroyDisplayWindow()
+ *
+ *  This function is used to free the manager objects of a
+ *  display window while its context is current, and then
+ *  destroy the window.
+ ***********************************************************/
+void DestroyDisplayWindow(DISPLAY_WINDOW& displayWindow)
+{
+	glfwMakeContextCurrent(displayWindow.pWindow);
+
+	// the queued tasks point into the scene, so they go first
+	if (NULL != displayWindow.pFrameScheduler)
+	{
+		delete displayWindow.pFrameScheduler;
+		displayWindow.pFrameScheduler = NULL;
+	}
+	if (NULL != displayWindow.pSceneManager)
+	{
+		displayWindow.pSceneManager->SetFrameScheduler(NULL);
+	}
+
+	if (NULL != displayWindow.pEyeRecorder)
+	{
+		delete displayWindow.pEyeRecorder;
+		displayWindow.pEyeRecorder = NULL;
+	}
+	for (int i = 0; i < ViewManager::STEREO_SUBMISSION_COUNT; i++)
+	{
+		delete displayWindow.pStereoTimers[i];
+		displayWindow.pStereoTimers[i] = NULL;
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		delete displayWindow.pEyeCommands[i];
+		displayWindow.pEyeCommands[i] = NULL;
+	}
+	if (NULL != displayWindow.pObjectPicker)
+	{
+		delete displayWindow.pObjectPicker;
+		displayWindow.pObjectPicker = NULL;
+	}
+	if (NULL != displayWindow.pTemporalAA)
+	{
+		delete displayWindow.pTemporalAA;
+		displayWindow.pTemporalAA = NULL;
+	}
+	if (NULL != displayWindow.pSceneManager)
+	{
+		delete displayWindow.pSceneManager;
+		displayWindow.pSceneManager = NULL;
+	}
+	if (NULL != displayWindow.pViewManager)
+	{
+		delete displayWindow.pViewManager;
+		displayWindow.pViewManager = NULL;
+	}
+
+	// the vertex arrays of this context can only be deleted now
+	GpuResources::Flush();
+
+	glfwDestroyWindow(displayWindow.pWindow);
+	displayWindow.pWindow = NULL;
 }
 
 /***********************************************************
@@ -173,5 +1184,12 @@ bool InitializeGLEW()
 	std::cout << "INFO: OpenGL Successfully Initialized\n";
 	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
 
+	// both eyes share one side-by-side target, so single pass
+	// stereo picks the eye viewport in a geometry shader instead
+	// of drawing into layers with the multiview extension
+	std::cout << "INFO: OVR_multiview " << (GLEW_OVR_multiview ? "available" : "not available")
+		<< ", viewport arrays " << (GLEW_VERSION_4_1 ? "available" : "not available")
+		<< ", single pass stereo draws each object once into both eyes\n" << std::endl;
+
 	return(true);
 }
\ No newline at end of file
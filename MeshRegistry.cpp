@@ -0,0 +1,334 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshregistry.cpp
+// ============
+// load each basic shape mesh once and hand out handles to it
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshRegistry.h"
+#include "GpuMemory.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// names used when reporting the loaded meshes
+	const char* const g_PrimitiveNames[MeshRegistry::MESH_PRIMITIVE_COUNT] =
+	{
+		"plane",
+		"box",
+		"cone",
+		"cylinder",
+		"prism",
+		"pyramid3",
+		"pyramid4",
+		"sphere",
+		"half sphere",
+		"tapered cylinder",
+		"torus"
+	};
+
+	// vertex attributes checked for their buffers, ShapeMeshes
+	// uses positions, normals and texture coordinates
+	const GLuint MAX_MEASURED_ATTRIBUTES = 4;
+}
+
+/***********************************************************
+ *  MeshRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshRegistry::MeshRegistry(ShapeMeshes* pShapeMeshes)
+{
+	m_pShapeMeshes = pShapeMeshes;
+	for (int i = 0; i < MESH_PRIMITIVE_COUNT; i++)
+	{
+		m_meshes[i].bLoaded = false;
+		m_meshes[i].referenceCount = 0;
+		m_meshes[i].gpuBytes = 0;
+	}
+	m_loadCount = 0;
+}
+
+/***********************************************************
+ *  Acquire()
+ *
+ *  This method is used to get a handle to a basic mesh. The
+ *  mesh is generated and uploaded the first time it is asked
+ *  for, later calls only add a reference.
+ ***********************************************************/
+MeshRegistry::MESH_HANDLE MeshRegistry::Acquire(MESH_PRIMITIVE primitive)
+{
+	if ((primitive < 0) || (primitive >= MESH_PRIMITIVE_COUNT))
+	{
+		std::cout << "ERROR: Unknown mesh primitive " << primitive << std::endl;
+		return(INVALID_MESH_HANDLE);
+	}
+
+	MESH_ENTRY& entry = m_meshes[primitive];
+	if (!entry.bLoaded)
+	{
+		LoadPrimitive(primitive);
+	}
+	entry.referenceCount++;
+
+	return((MESH_HANDLE)primitive);
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used to give back a handle. ShapeMeshes
+ *  has no way to free a single mesh, so a mesh that is no
+ *  longer referenced stays loaded and is reused by the next
+ *  Acquire() rather than being generated again.
+ ***********************************************************/
+void MeshRegistry::Release(MESH_HANDLE handle)
+{
+	if ((handle < 0) || (handle >= MESH_PRIMITIVE_COUNT))
+	{
+		return;
+	}
+
+	if (m_meshes[handle].referenceCount > 0)
+	{
+		m_meshes[handle].referenceCount--;
+	}
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used to draw the mesh of a handle.
+ ***********************************************************/
+void MeshRegistry::Draw(MESH_HANDLE handle) const
+{
+	if ((handle < 0) || (handle >= MESH_PRIMITIVE_COUNT) || !m_meshes[handle].bLoaded)
+	{
+		return;
+	}
+
+	switch ((MESH_PRIMITIVE)handle)
+	{
+	case MESH_PRIMITIVE_PLANE:
+		m_pShapeMeshes->DrawPlaneMesh();
+		break;
+	case MESH_PRIMITIVE_BOX:
+		m_pShapeMeshes->DrawBoxMesh();
+		break;
+	case MESH_PRIMITIVE_CONE:
+		m_pShapeMeshes->DrawConeMesh();
+		break;
+	case MESH_PRIMITIVE_CYLINDER:
+		m_pShapeMeshes->DrawCylinderMesh();
+		break;
+	case MESH_PRIMITIVE_PRISM:
+		m_pShapeMeshes->DrawPrismMesh();
+		break;
+	case MESH_PRIMITIVE_PYRAMID3:
+		m_pShapeMeshes->DrawPyramid3Mesh();
+		break;
+	case MESH_PRIMITIVE_PYRAMID4:
+		m_pShapeMeshes->DrawPyramid4Mesh();
+		break;
+	case MESH_PRIMITIVE_SPHERE:
+		m_pShapeMeshes->DrawSphereMesh();
+		break;
+	case MESH_PRIMITIVE_HALF_SPHERE:
+		m_pShapeMeshes->DrawHalfSphereMesh();
+		break;
+	case MESH_PRIMITIVE_TAPERED_CYLINDER:
+		m_pShapeMeshes->DrawTaperedCylinderMesh();
+		break;
+	case MESH_PRIMITIVE_TORUS:
+		m_pShapeMeshes->DrawTorusMesh();
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  GetReferenceCount()
+ *
+ *  This method returns the number of users of a handle.
+ ***********************************************************/
+int MeshRegistry::GetReferenceCount(MESH_HANDLE handle) const
+{
+	if ((handle < 0) || (handle >= MESH_PRIMITIVE_COUNT))
+	{
+		return(0);
+	}
+
+	return(m_meshes[handle].referenceCount);
+}
+
+/***********************************************************
+ *  GetGpuBytes()
+ *
+ *  This method returns the estimated GPU memory of a mesh.
+ ***********************************************************/
+size_t MeshRegistry::GetGpuBytes(MESH_HANDLE handle) const
+{
+	if ((handle < 0) || (handle >= MESH_PRIMITIVE_COUNT))
+	{
+		return(0);
+	}
+
+	return(m_meshes[handle].gpuBytes);
+}
+
+/***********************************************************
+ *  GetTotalGpuBytes()
+ *
+ *  This method returns the estimated GPU memory of all the
+ *  loaded meshes.
+ ***********************************************************/
+size_t MeshRegistry::GetTotalGpuBytes() const
+{
+	size_t totalBytes = 0;
+	for (int i = 0; i < MESH_PRIMITIVE_COUNT; i++)
+	{
+		totalBytes += m_meshes[i].gpuBytes;
+	}
+
+	return(totalBytes);
+}
+
+/***********************************************************
+ *  LoadPrimitive()
+ *
+ *  This method is used to generate and upload one mesh and
+ *  measure the buffers that ShapeMeshes created for it.
+ ***********************************************************/
+void MeshRegistry::LoadPrimitive(MESH_PRIMITIVE primitive)
+{
+	switch (primitive)
+	{
+	case MESH_PRIMITIVE_PLANE:
+		m_pShapeMeshes->LoadPlaneMesh();
+		break;
+	case MESH_PRIMITIVE_BOX:
+		m_pShapeMeshes->LoadBoxMesh();
+		break;
+	case MESH_PRIMITIVE_CONE:
+		m_pShapeMeshes->LoadConeMesh();
+		break;
+	case MESH_PRIMITIVE_CYLINDER:
+		m_pShapeMeshes->LoadCylinderMesh();
+		break;
+	case MESH_PRIMITIVE_PRISM:
+		m_pShapeMeshes->LoadPrismMesh();
+		break;
+	case MESH_PRIMITIVE_PYRAMID3:
+		m_pShapeMeshes->LoadPyramid3Mesh();
+		break;
+	case MESH_PRIMITIVE_PYRAMID4:
+		m_pShapeMeshes->LoadPyramid4Mesh();
+		break;
+	case MESH_PRIMITIVE_SPHERE:
+		m_pShapeMeshes->LoadSphereMesh();
+		break;
+	case MESH_PRIMITIVE_HALF_SPHERE:
+		m_pShapeMeshes->LoadHalfSphereMesh();
+		break;
+	case MESH_PRIMITIVE_TAPERED_CYLINDER:
+		m_pShapeMeshes->LoadTaperedCylinderMesh();
+		break;
+	case MESH_PRIMITIVE_TORUS:
+		m_pShapeMeshes->LoadTorusMesh();
+		break;
+	default:
+		return;
+	}
+
+	MESH_ENTRY& entry = m_meshes[primitive];
+	entry.bLoaded = true;
+	entry.gpuBytes = MeasureBoundVertexArray();
+	m_loadCount++;
+
+	// ShapeMeshes keeps its meshes until it is destroyed
+	GpuMemory::Allocate(GPU_MEMORY_MESHES, entry.gpuBytes);
+}
+
+/***********************************************************
+ *  MeasureBoundVertexArray()
+ *
+ *  This method is used to add up the sizes of the vertex
+ *  and index buffers of the vertex array that ShapeMeshes
+ *  leaves bound after loading a mesh. If none is bound, the
+ *  size is not known and zero is returned.
+ ***********************************************************/
+size_t MeshRegistry::MeasureBoundVertexArray()
+{
+	GLint vertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+	if (vertexArray == 0)
+	{
+		return(0);
+	}
+
+	GLuint buffers[MAX_MEASURED_ATTRIBUTES + 1];
+	int bufferCount = 0;
+
+	GLint elementBuffer = 0;
+	glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer);
+	if (elementBuffer != 0)
+	{
+		buffers[bufferCount++] = (GLuint)elementBuffer;
+	}
+
+	// the attributes usually share one interleaved buffer
+	for (GLuint attribute = 0; attribute < MAX_MEASURED_ATTRIBUTES; attribute++)
+	{
+		GLint arrayBuffer = 0;
+		glGetVertexAttribiv(attribute, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &arrayBuffer);
+		bool bCounted = (arrayBuffer == 0);
+		for (int i = 0; (i < bufferCount) && !bCounted; i++)
+		{
+			bCounted = (buffers[i] == (GLuint)arrayBuffer);
+		}
+		if (!bCounted)
+		{
+			buffers[bufferCount++] = (GLuint)arrayBuffer;
+		}
+	}
+
+	// the copy binding point leaves the mesh bindings untouched
+	GLint previousCopyBuffer = 0;
+	glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &previousCopyBuffer);
+
+	size_t totalBytes = 0;
+	for (int i = 0; i < bufferCount; i++)
+	{
+		GLint bufferSize = 0;
+		glBindBuffer(GL_COPY_READ_BUFFER, buffers[i]);
+		glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &bufferSize);
+		totalBytes += (size_t)bufferSize;
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, (GLuint)previousCopyBuffer);
+
+	return(totalBytes);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used to print the loaded meshes, their
+ *  references and their memory to the console.
+ ***********************************************************/
+void MeshRegistry::Report() const
+{
+	for (int i = 0; i < MESH_PRIMITIVE_COUNT; i++)
+	{
+		const MESH_ENTRY& entry = m_meshes[i];
+		if (entry.bLoaded)
+		{
+			std::cout << "INFO: Mesh " << g_PrimitiveNames[i]
+				<< " refs " << entry.referenceCount
+				<< ", " << entry.gpuBytes << " bytes" << std::endl;
+		}
+	}
+	std::cout << "INFO: Meshes loaded " << m_loadCount
+		<< ", " << GetTotalGpuBytes() << " bytes" << std::endl;
+}
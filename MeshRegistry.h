@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshregistry.h
+// ============
+// load each basic shape mesh once and hand out handles to it
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeMeshes.h"
+
+#include <stddef.h>
+
+/***********************************************************
+ *  MeshRegistry
+ *
+ *  This class sits in front of ShapeMeshes so that every
+ *  basic shape is generated and uploaded at most once in a
+ *  context, however many times it is asked for. Users get a
+ *  handle that counts as a reference, and the registry keeps
+ *  an estimate of the GPU memory used by each loaded mesh.
+ ***********************************************************/
+class MeshRegistry
+{
+public:
+	// basic shapes that ShapeMeshes can generate
+	enum MESH_PRIMITIVE
+	{
+		MESH_PRIMITIVE_PLANE,
+		MESH_PRIMITIVE_BOX,
+		MESH_PRIMITIVE_CONE,
+		MESH_PRIMITIVE_CYLINDER,
+		MESH_PRIMITIVE_PRISM,
+		MESH_PRIMITIVE_PYRAMID3,
+		MESH_PRIMITIVE_PYRAMID4,
+		MESH_PRIMITIVE_SPHERE,
+		MESH_PRIMITIVE_HALF_SPHERE,
+		MESH_PRIMITIVE_TAPERED_CYLINDER,
+		MESH_PRIMITIVE_TORUS,
+		MESH_PRIMITIVE_COUNT
+	};
+
+	// handle to a loaded mesh, stays valid for the life of the registry
+	typedef int MESH_HANDLE;
+	static const MESH_HANDLE INVALID_MESH_HANDLE = -1;
+
+	// constructor, the meshes are loaded into the current context
+	MeshRegistry(ShapeMeshes* pShapeMeshes);
+
+	// get a handle to a mesh, loading it only the first time
+	MESH_HANDLE Acquire(MESH_PRIMITIVE primitive);
+	// give back a handle that is no longer used
+	void Release(MESH_HANDLE handle);
+	// draw the mesh of a handle
+	void Draw(MESH_HANDLE handle) const;
+
+	bool IsLoaded(MESH_PRIMITIVE primitive) const { return(m_meshes[primitive].bLoaded); }
+	int GetReferenceCount(MESH_HANDLE handle) const;
+	// estimated bytes of the vertex and index buffers of a mesh
+	size_t GetGpuBytes(MESH_HANDLE handle) const;
+	size_t GetTotalGpuBytes() const;
+	// number of meshes generated and uploaded so far, this must
+	// not change once the scene has been prepared
+	unsigned int GetLoadCount() const { return(m_loadCount); }
+
+	// print the loaded meshes and their memory to the console
+	void Report() const;
+
+private:
+	struct MESH_ENTRY
+	{
+		bool bLoaded;
+		int referenceCount;
+		size_t gpuBytes;
+	};
+
+	ShapeMeshes* m_pShapeMeshes;
+	MESH_ENTRY m_meshes[MESH_PRIMITIVE_COUNT];
+	unsigned int m_loadCount;
+
+	// generate and upload one mesh with ShapeMeshes
+	void LoadPrimitive(MESH_PRIMITIVE primitive);
+	// sum the sizes of the buffers used by the bound vertex array
+	static size_t MeasureBoundVertexArray();
+};
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// microbenchmark.h
+// ============
+// time small functions over enough iterations to measure them
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+/***********************************************************
+ *  MicroBenchmark
+ *
+ *  This class times functions that take far less than a
+ *  clock tick on their own. A task is run in batches that
+ *  double in size until one batch lasts long enough to time
+ *  well, and the time per iteration of that batch is what
+ *  gets printed, so every benchmark finishes in about the
+ *  same time however fast the task is.
+ ***********************************************************/
+class MicroBenchmark
+{
+public:
+	// shortest batch that is timed, in milliseconds
+	static const int MIN_BATCH_MILLISECONDS = 50;
+	// most iterations of one batch
+	static const long long MAX_ITERATIONS = 1LL << 30;
+
+	// print the time per iteration of a task, and return it
+	// in nanoseconds
+	template <typename TASK>
+	static double Run(const std::string& name, const TASK& task);
+
+	// keep the compiler from dropping the work that produced
+	// a value that is otherwise unused
+	template <typename VALUE>
+	static void DoNotOptimize(const VALUE& value)
+	{
+		static const void* volatile pSink = NULL;
+		pSink = &value;
+		(void)pSink;
+	}
+};
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used to run a task in batches until one
+ *  batch is long enough, and print the result.
+ ***********************************************************/
+template <typename TASK>
+double MicroBenchmark::Run(const std::string& name, const TASK& task)
+{
+	long long iterations = 1;
+	double milliseconds = 0.0;
+
+	for (;;)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (long long i = 0; i < iterations; i++)
+		{
+			task();
+		}
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		milliseconds = elapsed.count();
+
+		if ((milliseconds >= MIN_BATCH_MILLISECONDS) || (iterations >= MAX_ITERATIONS))
+		{
+			break;
+		}
+		iterations *= 2;
+	}
+
+	double nanoseconds = milliseconds * 1000000.0 / (double)iterations;
+	std::cout << "INFO: Benchmark " << name << " " << nanoseconds << " ns ("
+		<< iterations << " iterations)" << std::endl;
+
+	return(nanoseconds);
+}
@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////
+// mipgenerator.cpp
+// ============
+// build gamma correct mip chains on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MipGenerator.h"
+
+#include <cmath>
+#include <mutex>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MIP_GENERATOR_SSE2
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// entries in the table for encoding linear values as sRGB,
+	// enough that every 8-bit result is reached exactly
+	const int LINEAR_TABLE_SIZE = 4096;
+
+	float g_SrgbToLinear[256];
+	unsigned char g_LinearToSrgb[LINEAR_TABLE_SIZE];
+	std::once_flag g_TablesBuilt;
+
+	/***********************************************************
+	 *  BuildTables()
+	 *
+	 *  This function is used to fill the conversion tables,
+	 *  once, before any thread filters an image.
+	 ***********************************************************/
+	void BuildTables()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			float value = (float)i / 255.0f;
+			g_SrgbToLinear[i] = (value <= 0.04045f) ? (value / 12.92f) : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < LINEAR_TABLE_SIZE; i++)
+		{
+			float value = (float)i / (float)(LINEAR_TABLE_SIZE - 1);
+			float encoded = (value <= 0.0031308f) ? (value * 12.92f) : (1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f);
+			g_LinearToSrgb[i] = (unsigned char)(encoded * 255.0f + 0.5f);
+		}
+	}
+
+	/***********************************************************
+	 *  DecodeRow()
+	 *
+	 *  This function is used to convert one row of 8-bit
+	 *  values to floats in the space they are filtered in.
+	 ***********************************************************/
+	void DecodeRow(const unsigned char* pSource, int width, int channels, bool bSrgb, float* pTarget)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				unsigned char value = pSource[x * channels + c];
+				bool bColor = bSrgb && (c < 3);
+				pTarget[x * channels + c] = bColor ? g_SrgbToLinear[value] : ((float)value / 255.0f);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  AddRows()
+	 *
+	 *  This function is used to add two rows of floats, four
+	 *  at a time with SSE2 when it is available.
+	 ***********************************************************/
+	void AddRows(const float* pFirst, const float* pSecond, int count, float* pTarget)
+	{
+		int i = 0;
+#ifdef MIP_GENERATOR_SSE2
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 sum = _mm_add_ps(_mm_loadu_ps(pFirst + i), _mm_loadu_ps(pSecond + i));
+			_mm_storeu_ps(pTarget + i, sum);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			pTarget[i] = pFirst[i] + pSecond[i];
+		}
+	}
+
+	/***********************************************************
+	 *  EncodeValue()
+	 *
+	 *  This function is used to convert a filtered float back
+	 *  to an 8-bit value.
+	 ***********************************************************/
+	unsigned char EncodeValue(float value, bool bColor)
+	{
+		if (value < 0.0f)
+		{
+			value = 0.0f;
+		}
+		else if (value > 1.0f)
+		{
+			value = 1.0f;
+		}
+
+		if (bColor)
+		{
+			return(g_LinearToSrgb[(int)(value * (float)(LINEAR_TABLE_SIZE - 1) + 0.5f)]);
+		}
+
+		return((unsigned char)(value * 255.0f + 0.5f));
+	}
+}
+
+/***********************************************************
+ *  ReduceByHalf()
+ *
+ *  This method is used to halve an image, rounding the size
+ *  down like OpenGL mip levels. The two source rows of each
+ *  target row are added as whole rows, then neighbouring
+ *  pixels are added and the average is encoded again. At an
+ *  odd edge the last row or column is used twice.
+ ***********************************************************/
+void MipGenerator::ReduceByHalf(const TextureDecoder::DECODED_IMAGE& source, TextureDecoder::DECODED_IMAGE& target, bool bSrgb)
+{
+	std::call_once(g_TablesBuilt, BuildTables);
+
+	const int channels = source.channels;
+	target.width = (source.width > 1) ? (source.width / 2) : 1;
+	target.height = (source.height > 1) ? (source.height / 2) : 1;
+	target.channels = channels;
+	target.pixels.resize((size_t)target.width * target.height * channels);
+
+	const int rowFloats = source.width * channels;
+	std::vector<float> firstRow(rowFloats);
+	std::vector<float> secondRow(rowFloats);
+	std::vector<float> rowSum(rowFloats);
+
+	for (int y = 0; y < target.height; y++)
+	{
+		int y0 = y * 2;
+		int y1 = (y0 + 1 < source.height) ? (y0 + 1) : y0;
+
+		DecodeRow(&source.pixels[(size_t)y0 * rowFloats], source.width, channels, bSrgb, firstRow.data());
+		DecodeRow(&source.pixels[(size_t)y1 * rowFloats], source.width, channels, bSrgb, secondRow.data());
+		AddRows(firstRow.data(), secondRow.data(), rowFloats, rowSum.data());
+
+		unsigned char* pTarget = &target.pixels[(size_t)y * target.width * channels];
+		for (int x = 0; x < target.width; x++)
+		{
+			int x0 = x * 2;
+			int x1 = (x0 + 1 < source.width) ? (x0 + 1) : x0;
+			for (int c = 0; c < channels; c++)
+			{
+				float average = (rowSum[x0 * channels + c] + rowSum[x1 * channels + c]) * 0.25f;
+				pTarget[x * channels + c] = EncodeValue(average, bSrgb && (c < 3));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  CompleteMipChain()
+ *
+ *  This method is used to add the missing levels of a mip
+ *  chain, each one filtered from the level above it.
+ ***********************************************************/
+void MipGenerator::CompleteMipChain(std::vector<TextureDecoder::DECODED_IMAGE>& levels, bool bSrgb)
+{
+	if (levels.empty())
+	{
+		return;
+	}
+
+	while ((levels.back().width > 1) || (levels.back().height > 1))
+	{
+		TextureDecoder::DECODED_IMAGE reduced;
+		ReduceByHalf(levels.back(), reduced, bSrgb);
+		levels.push_back(std::move(reduced));
+	}
+}
@@ -0,0 +1,31 @@
+///////////////////////////////////////////////////////////////////////////////
+// mipgenerator.h
+// ============
+// build gamma correct mip chains on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureDecoder.h"
+
+/***********************************************************
+ *  MipGenerator
+ *
+ *  This class fills in the mip levels below the last decoded
+ *  level of a texture. Color is averaged in linear light
+ *  rather than on the stored sRGB values, which keeps the
+ *  smaller levels from getting darker, and the sums use SSE2
+ *  when the compiler targets it. The functions only touch
+ *  the images passed in, so many textures can be processed
+ *  on worker threads at the same time.
+ ***********************************************************/
+class MipGenerator
+{
+public:
+	// add levels to the chain until the last one is 1x1
+	static void CompleteMipChain(std::vector<TextureDecoder::DECODED_IMAGE>& levels, bool bSrgb);
+
+	// halve an image with a 2x2 box filter, in linear light when
+	// the color is sRGB, alpha is always averaged as it is stored
+	static void ReduceByHalf(const TextureDecoder::DECODED_IMAGE& source, TextureDecoder::DECODED_IMAGE& target, bool bSrgb);
+};
@@ -0,0 +1,248 @@
+///////////////////////////////////////////////////////////////////////////////
+// objectpicker.cpp
+// ============
+// select objects in the 3D scene by reading back an object ID render target
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ObjectPicker.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  ObjectPicker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ObjectPicker::ObjectPicker()
+{
+	m_bInitialized = false;
+	m_width = 0;
+	m_height = 0;
+	m_framebuffer = 0;
+	m_colorTarget = 0;
+	m_depthTarget = 0;
+	m_targetBytes = 0;
+	m_readbackFence = 0;
+	m_bPickRequested = false;
+	m_pickX = 0;
+	m_pickY = 0;
+}
+
+/***********************************************************
+ *  ~ObjectPicker()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ObjectPicker::~ObjectPicker()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to create the object ID render target
+ *  and the pixel buffer that the picked ID is copied into.
+ ***********************************************************/
+bool ObjectPicker::Initialize(int width, int height)
+{
+	Destroy();
+
+	m_width = width;
+	m_height = height;
+
+	glGenRenderbuffers(1, &m_colorTarget);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorTarget);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &m_depthTarget);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthTarget);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	// RGBA8 color and a depth buffer padded to four bytes
+	m_targetBytes = GpuMemory::EstimateImageBytes(width, height, 8, false);
+	GpuMemory::Allocate(GPU_MEMORY_RENDER_TARGETS, m_targetBytes);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorTarget);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthTarget);
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// one RGBA8 pixel is all that is ever read back
+	m_readbackBuffer = GpuBuffer::Create();
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer.Get());
+	glBufferData(GL_PIXEL_PACK_BUFFER, 4, NULL, GL_STREAM_READ);
+	m_readbackBuffer.TrackMemory(GPU_MEMORY_RENDER_TARGETS, 4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (bComplete == false)
+	{
+		std::cout << "ERROR: Object picking target could not be created" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_bInitialized = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the render target and the
+ *  readback buffer.
+ ***********************************************************/
+void ObjectPicker::Destroy()
+{
+	if (m_readbackFence != 0)
+	{
+		glDeleteSync(m_readbackFence);
+		m_readbackFence = 0;
+	}
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteRenderbuffers(1, &m_colorTarget);
+		glDeleteRenderbuffers(1, &m_depthTarget);
+		m_framebuffer = m_colorTarget = m_depthTarget = 0;
+	}
+	if (m_targetBytes != 0)
+	{
+		GpuMemory::Free(GPU_MEMORY_RENDER_TARGETS, m_targetBytes);
+		m_targetBytes = 0;
+	}
+	m_readbackBuffer.Reset();
+
+	m_bInitialized = false;
+	m_bPickRequested = false;
+}
+
+/***********************************************************
+ *  EncodeObjectIndex()
+ *
+ *  This method returns the color written for an object.
+ *  The index is stored plus one in the red, green and blue
+ *  bytes, so a cleared black pixel means no object.
+ ***********************************************************/
+glm::vec4 ObjectPicker::EncodeObjectIndex(int objectIndex)
+{
+	unsigned int objectID = (unsigned int)(objectIndex + 1);
+
+	return(glm::vec4(
+		(float)(objectID & 0xFF) / 255.0f,
+		(float)((objectID >> 8) & 0xFF) / 255.0f,
+		(float)((objectID >> 16) & 0xFF) / 255.0f,
+		1.0f));
+}
+
+/***********************************************************
+ *  RequestPick()
+ *
+ *  This method is used to ask for the object under a pixel.
+ *  A newer request replaces one that has not been drawn yet.
+ ***********************************************************/
+void ObjectPicker::RequestPick(int x, int y)
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	if ((x < 0) || (y < 0) || (x >= m_width) || (y >= m_height))
+	{
+		return;
+	}
+
+	m_pickX = x;
+	m_pickY = y;
+	m_bPickRequested = true;
+}
+
+/***********************************************************
+ *  BeginPickPass()
+ *
+ *  This method is used to bind the ID target and limit
+ *  drawing to the requested pixel, so that the pass only
+ *  costs the vertex work of the visible objects.
+ ***********************************************************/
+void ObjectPicker::BeginPickPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(m_pickX, m_pickY, 1, 1);
+
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// the IDs must be written exactly, so no blending
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+}
+
+/***********************************************************
+ *  EndPickPass()
+ *
+ *  This method is used to start the copy of the picked pixel
+ *  into the readback buffer. The copy runs on the GPU after
+ *  the ID pass and a fence marks when it has finished.
+ ***********************************************************/
+void ObjectPicker::EndPickPass()
+{
+	glDisable(GL_SCISSOR_TEST);
+	glEnable(GL_BLEND);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer.Get());
+	glReadPixels(m_pickX, m_pickY, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// only the newest readback is of interest
+	if (m_readbackFence != 0)
+	{
+		glDeleteSync(m_readbackFence);
+	}
+	m_readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	m_bPickRequested = false;
+}
+
+/***********************************************************
+ *  PollResult()
+ *
+ *  This method is used to check if the readback has finished
+ *  without waiting for it. When it has, the object index is
+ *  decoded from the pixel and true is returned.
+ ***********************************************************/
+bool ObjectPicker::PollResult(int& objectIndex)
+{
+	if (m_readbackFence == 0)
+	{
+		return(false);
+	}
+
+	GLenum waitResult = glClientWaitSync(m_readbackFence, 0, 0);
+	if ((waitResult != GL_ALREADY_SIGNALED) && (waitResult != GL_CONDITION_SATISFIED))
+	{
+		return(false);
+	}
+
+	glDeleteSync(m_readbackFence);
+	m_readbackFence = 0;
+
+	unsigned char pixel[4] = { 0, 0, 0, 0 };
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer.Get());
+	glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, 4, pixel);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	unsigned int objectID = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+	objectIndex = (int)objectID - 1;
+
+	return(true);
+}
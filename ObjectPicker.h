@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// objectpicker.h
+// ============
+// select objects in the 3D scene by reading back an object ID render target
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResource.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  ObjectPicker
+ *
+ *  This class owns a render target that the scene writes
+ *  object IDs into, as flat colors, for the one pixel under
+ *  a pick request. The pixel is copied into a pixel buffer
+ *  object and read once a fence shows the GPU is done, so
+ *  picking never waits for the GPU and costs the same on the
+ *  CPU no matter how many objects are in the scene.
+ ***********************************************************/
+class ObjectPicker
+{
+public:
+	// value returned when no object is under the pick position
+	static const int NO_OBJECT = -1;
+
+	// constructor
+	ObjectPicker();
+	// destructor
+	~ObjectPicker();
+
+	// create the ID target and the readback buffer
+	bool Initialize(int width, int height);
+	// free the ID target and the readback buffer
+	void Destroy();
+
+	// ask for the object at a framebuffer pixel, origin bottom left
+	void RequestPick(int x, int y);
+	// true when the ID pass should be drawn this frame
+	bool IsPickRequested() const { return(m_bPickRequested); }
+	int GetPickX() const { return(m_pickX); }
+	int GetPickY() const { return(m_pickY); }
+
+	// bind the ID target limited to the requested pixel
+	void BeginPickPass();
+	// start copying the pixel into the readback buffer
+	void EndPickPass();
+
+	// check for a finished readback without waiting, returns true
+	// with the picked object index once the result is available
+	bool PollResult(int& objectIndex);
+
+	// get the flat color that identifies an object index
+	static glm::vec4 EncodeObjectIndex(int objectIndex);
+
+private:
+	bool m_bInitialized;
+	int m_width;
+	int m_height;
+
+	GLuint m_framebuffer;
+	GLuint m_colorTarget;
+	GLuint m_depthTarget;
+	size_t m_targetBytes;
+	GpuBuffer m_readbackBuffer;
+	GLsync m_readbackFence;
+
+	bool m_bPickRequested;
+	int m_pickX;
+	int m_pickY;
+};
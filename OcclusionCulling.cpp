@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculling.cpp
+// ============
+// skip clusters of objects whose bounds were hidden in the last frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCulling.h"
+#include "ShaderProgram.h"
+
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// declaration of global variables
+namespace
+{
+	const char* const g_BoxVertexSource = R"GLSL(
+#version 330 core
+layout(location = 0) in vec3 inVertexPosition;
+
+uniform mat4 model;
+uniform mat4 viewProjection;
+
+void main()
+{
+	gl_Position = viewProjection * model * vec4(inVertexPosition, 1.0);
+}
+)GLSL";
+
+	// nothing is written, the queries only count the samples
+	const char* const g_BoxFragmentSource = R"GLSL(
+#version 330 core
+out vec4 fragmentColor;
+
+void main()
+{
+	fragmentColor = vec4(1.0);
+}
+)GLSL";
+}
+
+/***********************************************************
+ *  OcclusionCulling()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionCulling::OcclusionCulling()
+{
+	m_previousProgram = 0;
+}
+
+/***********************************************************
+ *  ~OcclusionCulling()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionCulling::~OcclusionCulling()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to create one query for every
+ *  cluster and the program that draws their boxes. Queries
+ *  belong to the context they were made in, so every window
+ *  initializes its own.
+ ***********************************************************/
+bool OcclusionCulling::Initialize(int clusterCount)
+{
+	Destroy();
+
+	m_program = GpuProgram(CreateShaderProgram(g_BoxVertexSource, g_BoxFragmentSource, "occlusion boxes"));
+	if (!m_program.IsValid())
+	{
+		return(false);
+	}
+
+	for (int i = 0; i < clusterCount; i++)
+	{
+		m_queries.push_back(GpuQuery::Create());
+	}
+	m_bHasResult.assign(clusterCount, false);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the queries and the program.
+ ***********************************************************/
+void OcclusionCulling::Destroy()
+{
+	m_queries.clear();
+	m_bHasResult.clear();
+	m_program.Reset();
+}
+
+/***********************************************************
+ *  BeginConditionalDraw()
+ *
+ *  This method is used to start drawing the objects of a
+ *  cluster on the condition that its box was visible. The
+ *  GPU does not wait for a result that is not ready yet and
+ *  draws the objects then.
+ ***********************************************************/
+bool OcclusionCulling::BeginConditionalDraw(int cluster)
+{
+	if (!m_bHasResult[cluster])
+	{
+		return(false);
+	}
+
+	glBeginConditionalRender(m_queries[cluster].Get(), GL_QUERY_NO_WAIT);
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndConditionalDraw()
+ *
+ *  This method is used to end the objects of a cluster.
+ ***********************************************************/
+void OcclusionCulling::EndConditionalDraw()
+{
+	glEndConditionalRender();
+}
+
+/***********************************************************
+ *  BeginQueries()
+ *
+ *  This method is used to switch to the box program with
+ *  color and depth writes off. The clusters that are not
+ *  tested again have no result for the next frame.
+ ***********************************************************/
+void OcclusionCulling::BeginQueries(const glm::mat4& viewProjection)
+{
+	m_bHasResult.assign(m_bHasResult.size(), false);
+
+	glGetIntegerv(GL_CURRENT_PROGRAM, &m_previousProgram);
+
+	GLuint program = m_program.Get();
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+}
+
+/***********************************************************
+ *  BeginQuery()
+ *
+ *  This method is used to place the unit box around the
+ *  bounds of a cluster and start counting its samples.
+ ***********************************************************/
+void OcclusionCulling::BeginQuery(int cluster, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	glm::vec3 padding(BOX_PADDING);
+	glm::mat4 model = glm::translate((boundsMin + boundsMax) * 0.5f) * glm::scale(boundsMax - boundsMin + padding * 2.0f);
+	glUniformMatrix4fv(glGetUniformLocation(m_program.Get(), "model"), 1, GL_FALSE, glm::value_ptr(model));
+
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, m_queries[cluster].Get());
+	m_bHasResult[cluster] = true;
+}
+
+/***********************************************************
+ *  EndQuery()
+ *
+ *  This method is used to end the query of a box.
+ ***********************************************************/
+void OcclusionCulling::EndQuery()
+{
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+}
+
+/***********************************************************
+ *  EndQueries()
+ *
+ *  This method is used to switch back to the scene program
+ *  and write color and depth again.
+ ***********************************************************/
+void OcclusionCulling::EndQueries()
+{
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	glUseProgram((GLuint)m_previousProgram);
+}
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculling.h
+// ============
+// skip clusters of objects whose bounds were hidden in the last frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResource.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  OcclusionCulling
+ *
+ *  This class keeps one occlusion query per cluster of
+ *  objects. After a frame is drawn the box around each
+ *  cluster is drawn into its query without writing color or
+ *  depth, and in the next frame the objects of the cluster
+ *  are drawn with conditional rendering on that query, so
+ *  the GPU skips them when no sample of the box passed and
+ *  the CPU never waits for a result. A cluster that has no
+ *  result from the last frame is drawn without a condition.
+ ***********************************************************/
+class OcclusionCulling
+{
+public:
+	// world units the boxes are grown by on every side, so a
+	// box is never hidden by the objects inside it
+	static constexpr float BOX_PADDING = 0.05f;
+
+	// constructor
+	OcclusionCulling();
+	// destructor
+	~OcclusionCulling();
+
+	// create the queries of the clusters and the box program
+	bool Initialize(int clusterCount);
+	// free the queries and the program
+	void Destroy();
+	bool IsInitialized() const { return(m_program.IsValid()); }
+
+	// draw the next objects only if the box of a cluster passed
+	// its last test, returns false when there was no test and
+	// the objects are drawn without a condition
+	bool BeginConditionalDraw(int cluster);
+	void EndConditionalDraw();
+
+	// use the box program with color and depth writes off
+	void BeginQueries(const glm::mat4& viewProjection);
+	// set the box of a cluster and start its query, the caller
+	// then draws the unit box mesh
+	void BeginQuery(int cluster, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	void EndQuery();
+	// restore the program and the writes of before BeginQueries()
+	void EndQueries();
+
+private:
+	GpuProgram m_program;
+	std::vector<GpuQuery> m_queries;
+	// true for the clusters tested in the last frame
+	std::vector<bool> m_bHasResult;
+	// the program to restore after the queries
+	GLint m_previousProgram;
+};
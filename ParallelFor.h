@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// parallelfor.h
+// ============
+// run a task for every item of a range on all of the hardware threads
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This function runs a task for every item on all of the
+ *  hardware threads, which take small chunks of the items
+ *  in turn so that uneven work is spread evenly. It returns
+ *  when every item is done, and the calling thread works on
+ *  the items as well.
+ ***********************************************************/
+template <typename TASK>
+void ParallelFor(int itemCount, int chunkSize, const TASK& task)
+{
+	// no more threads than there are chunks to take
+	int chunkCount = (itemCount + chunkSize - 1) / chunkSize;
+	int threadCount = std::min((int)std::thread::hardware_concurrency(), chunkCount);
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+
+	std::atomic<int> nextItem(0);
+	auto worker = [&nextItem, itemCount, chunkSize, &task]()
+	{
+		for (;;)
+		{
+			int first = nextItem.fetch_add(chunkSize);
+			if (first >= itemCount)
+			{
+				return;
+			}
+			int last = std::min(first + chunkSize, itemCount);
+			for (int item = first; item < last; item++)
+			{
+				task(item);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+	{
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+}
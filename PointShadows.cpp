@@ -0,0 +1,551 @@
+///////////////////////////////////////////////////////////////////////////////
+// pointshadows.cpp
+// ============
+// cached cube map shadows of the point lights
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PointShadows.h"
+#include "ShaderProgram.h"
+#include "GpuMemory.h"
+
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* const g_CasterVertexSource = R"GLSL(
+#version 330 core
+layout(location = 0) in vec3 inVertexPosition;
+
+uniform mat4 model;
+uniform mat4 faceViewProjection;
+
+out vec3 fragPosition;
+
+void main()
+{
+	vec4 worldPosition = model * vec4(inVertexPosition, 1.0);
+	gl_Position = faceViewProjection * worldPosition;
+	fragPosition = worldPosition.xyz;
+}
+)GLSL";
+
+	// the cubes hold the distance to the light over its range,
+	// so every face compares the same values
+	const char* const g_CasterFragmentSource = R"GLSL(
+#version 330 core
+in vec3 fragPosition;
+
+uniform vec3 lightPosition;
+uniform float lightRange;
+
+void main()
+{
+	gl_FragDepth = length(fragPosition - lightPosition) / lightRange;
+}
+)GLSL";
+
+	const char* const g_ReceiverVertexSource = R"GLSL(
+#version 400 core
+layout(location = 0) in vec3 inVertexPosition;
+layout(location = 1) in vec3 inVertexNormal;
+layout(location = 2) in vec2 inTextureCoordinate;
+
+uniform mat4 model;
+uniform mat4 viewProjection;
+
+out vec3 fragPosition;
+out vec3 fragNormal;
+out vec2 fragUV;
+
+void main()
+{
+	vec4 worldPosition = model * vec4(inVertexPosition, 1.0);
+	gl_Position = viewProjection * worldPosition;
+	fragPosition = worldPosition.xyz;
+	fragNormal = mat3(transpose(inverse(model))) * inVertexNormal;
+	fragUV = inTextureCoordinate;
+}
+)GLSL";
+
+	// the diffuse and specular terms must be the ones the scene
+	// program adds for its point lights, since what this writes
+	// is taken away from the color the scene program wrote
+	const char* const g_ReceiverFragmentSource = R"GLSL(
+#version 400 core
+in vec3 fragPosition;
+in vec3 fragNormal;
+in vec2 fragUV;
+out vec4 fragmentColor;
+
+uniform samplerCubeArrayShadow shadowCubes;
+uniform int lightCount;
+uniform vec3 lightPositions[2];
+uniform vec3 lightDiffuse[2];
+uniform vec3 lightSpecular[2];
+uniform float lightRanges[2];
+uniform float sampledCubes[2];
+uniform float depthBias;
+uniform vec3 viewPosition;
+
+uniform sampler2D objectTexture;
+uniform vec2 uvScale;
+uniform vec3 diffuseColor;
+uniform vec3 specularColor;
+uniform float shininess;
+
+void main()
+{
+	vec3 normal = normalize(fragNormal);
+	vec3 viewDirection = normalize(viewPosition - fragPosition);
+	vec3 hiddenLight = vec3(0.0);
+
+	for (int i = 0; i < lightCount; i++)
+	{
+		vec3 toLight = lightPositions[i] - fragPosition;
+		float distance = length(toLight);
+		vec3 lightDirection = toLight / distance;
+
+		float lit = texture(shadowCubes, vec4(-lightDirection, sampledCubes[i]), distance / lightRanges[i] - depthBias);
+		if (lit < 1.0)
+		{
+			float impact = max(dot(normal, lightDirection), 0.0);
+			float highlight = pow(max(dot(viewDirection, reflect(-lightDirection, normal)), 0.0), shininess);
+			vec3 light = lightDiffuse[i] * impact * diffuseColor + lightSpecular[i] * highlight * specularColor;
+			hiddenLight += (1.0 - lit) * light;
+		}
+	}
+
+	vec4 albedo = texture(objectTexture, fragUV * uvScale);
+	fragmentColor = vec4(hiddenLight * albedo.rgb, 0.0);
+}
+)GLSL";
+
+	// the faces in the order of the cube map layers, looking
+	// along each axis with the up vectors cube maps expect
+	const glm::vec3 g_FaceDirections[6] =
+	{
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+	};
+	const glm::vec3 g_FaceUps[6] =
+	{
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+	};
+
+	/***********************************************************
+	 *  GetCubeBytes()
+	 *
+	 *  This function returns the memory of the cubes of the
+	 *  lights, a static and a frame cube each, with a 32 bit
+	 *  float depth per texel.
+	 ***********************************************************/
+	size_t GetCubeBytes(int lightCount, int faceSize)
+	{
+		return((size_t)lightCount * 2 * 6 * faceSize * faceSize * 4);
+	}
+}
+
+/***********************************************************
+ *  PointShadows()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PointShadows::PointShadows()
+{
+	m_framebuffer = 0;
+	m_faceSize = 0;
+	m_bStaticCached = false;
+	m_bStaticDrawn = false;
+	m_previousProgram = 0;
+	m_previousFramebuffer = 0;
+	m_previousDepthFunc = GL_LESS;
+	m_bPreviousBlend = GL_FALSE;
+	for (int i = 0; i < 4; i++)
+	{
+		m_previousViewport[i] = 0;
+		m_previousBlend[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~PointShadows()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PointShadows::~PointShadows()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to create the cube map array of the
+ *  lights and the framebuffer the faces are drawn through.
+ *  The faces start at the largest size and are halved until
+ *  the cubes fit into the budget. The cubes are copied into
+ *  each other, which needs OpenGL 4.3.
+ ***********************************************************/
+bool PointShadows::Initialize(const std::vector<SHADOW_LIGHT>& lights, size_t budgetBytes)
+{
+	Destroy();
+
+	if (!GLEW_VERSION_4_3)
+	{
+		std::cout << "ERROR: Point light shadows need OpenGL 4.3" << std::endl;
+		return(false);
+	}
+
+	int lightCount = std::min((int)lights.size(), (int)MAX_SHADOW_LIGHTS);
+	if (lightCount == 0)
+	{
+		return(false);
+	}
+
+	int faceSize = MAX_FACE_SIZE;
+	while ((faceSize > MIN_FACE_SIZE) && (GetCubeBytes(lightCount, faceSize) > budgetBytes))
+	{
+		faceSize /= 2;
+	}
+	if (GetCubeBytes(lightCount, faceSize) > budgetBytes)
+	{
+		std::cout << "ERROR: Point light shadows need " << (GetCubeBytes(lightCount, faceSize) >> 20)
+			<< " MB, more than the budget of " << (budgetBytes >> 20) << " MB" << std::endl;
+		return(false);
+	}
+
+	m_casterProgram = GpuProgram(CreateShaderProgram(g_CasterVertexSource, g_CasterFragmentSource, "shadow casters"));
+	m_receiverProgram = GpuProgram(CreateShaderProgram(g_ReceiverVertexSource, g_ReceiverFragmentSource, "shadow receivers"));
+	if (!m_casterProgram.IsValid() || !m_receiverProgram.IsValid())
+	{
+		Destroy();
+		return(false);
+	}
+
+	glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT);
+	m_cubes = GpuTexture::Create();
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_cubes.Get());
+	glTexStorage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 1, GL_DEPTH_COMPONENT32F, faceSize, faceSize, lightCount * 2 * 6);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	m_cubes.TrackMemory(GPU_MEMORY_RENDER_TARGETS, GetCubeBytes(lightCount, faceSize));
+	glActiveTexture(GL_TEXTURE0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_cubes.Get(), 0, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (!bComplete)
+	{
+		std::cout << "ERROR: Point light shadow framebuffer is incomplete" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_faceSize = faceSize;
+	m_lights.assign(lights.begin(), lights.begin() + lightCount);
+	// a copy, since glm takes the planes by reference
+	float nearPlane = NEAR_PLANE;
+	for (int light = 0; light < lightCount; light++)
+	{
+		const SHADOW_LIGHT& shadowLight = m_lights[light];
+		glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, shadowLight.range);
+		for (int face = 0; face < 6; face++)
+		{
+			glm::mat4 view = glm::lookAt(shadowLight.position, shadowLight.position + g_FaceDirections[face], g_FaceUps[face]);
+			m_faceViewProjections.push_back(projection * view);
+		}
+	}
+	UseStaticCubes();
+
+	std::cout << "INFO: Point light shadows of " << lightCount << " lights in " << faceSize << "x" << faceSize
+		<< " cube faces, " << (GetCubeBytes(lightCount, faceSize) >> 20) << " MB of the "
+		<< (budgetBytes >> 20) << " MB budget" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the cubes, the framebuffer
+ *  and the programs.
+ ***********************************************************/
+void PointShadows::Destroy()
+{
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	m_cubes.Reset();
+	m_casterProgram.Reset();
+	m_receiverProgram.Reset();
+	m_lights.clear();
+	m_faceViewProjections.clear();
+	m_sampledCubes.clear();
+	m_faceSize = 0;
+	m_bStaticCached = false;
+}
+
+/***********************************************************
+ *  IsInRange()
+ *
+ *  This method is used to test whether the point of a box
+ *  nearest to a light is within the range of the light.
+ ***********************************************************/
+bool PointShadows::IsInRange(int light, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+	const SHADOW_LIGHT& shadowLight = m_lights[light];
+	glm::vec3 nearest = glm::min(glm::max(shadowLight.position, boundsMin), boundsMax);
+
+	return(glm::length(nearest - shadowLight.position) <= shadowLight.range);
+}
+
+/***********************************************************
+ *  UseStaticCubes()
+ *
+ *  This method is used to sample the static cube of every
+ *  light, which is all a frame without moving casters needs.
+ ***********************************************************/
+void PointShadows::UseStaticCubes()
+{
+	m_sampledCubes.resize(m_lights.size());
+	for (size_t light = 0; light < m_lights.size(); light++)
+	{
+		m_sampledCubes[light] = (int)light * 2;
+	}
+}
+
+/***********************************************************
+ *  BeginCasters()
+ *
+ *  This method is used to switch to the caster program and
+ *  draw into the cubes, over the whole of a face.
+ ***********************************************************/
+void PointShadows::BeginCasters()
+{
+	glGetIntegerv(GL_CURRENT_PROGRAM, &m_previousProgram);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+
+	glUseProgram(m_casterProgram.Get());
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_faceSize, m_faceSize);
+	glEnable(GL_DEPTH_TEST);
+	m_bStaticDrawn = false;
+}
+
+/***********************************************************
+ *  AttachFace()
+ *
+ *  This method is used to draw into a face of a cube, from
+ *  the position and over the range of its light.
+ ***********************************************************/
+void PointShadows::AttachFace(int cube, int face, int light)
+{
+	GLuint program = m_casterProgram.Get();
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_cubes.Get(), 0, cube * 6 + face);
+	glUniformMatrix4fv(glGetUniformLocation(program, "faceViewProjection"), 1, GL_FALSE, glm::value_ptr(GetFaceViewProjection(light, face)));
+	glUniform3fv(glGetUniformLocation(program, "lightPosition"), 1, glm::value_ptr(m_lights[light].position));
+	glUniform1f(glGetUniformLocation(program, "lightRange"), m_lights[light].range);
+}
+
+/***********************************************************
+ *  BeginStaticFace()
+ *
+ *  This method is used to clear a face of the static cube of
+ *  a light for the objects that never move. The static cubes
+ *  are cached once EndCasters() is reached.
+ ***********************************************************/
+void PointShadows::BeginStaticFace(int light, int face)
+{
+	AttachFace(light * 2, face, light);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	m_bStaticDrawn = true;
+}
+
+/***********************************************************
+ *  BeginDynamicFace()
+ *
+ *  This method is used to draw the moving objects into a
+ *  face of the frame cube of a light. The first face of a
+ *  light in a frame copies its whole static cube into the
+ *  frame cube, so the faces without moving objects match
+ *  the static ones, and the frame cube is sampled instead.
+ ***********************************************************/
+void PointShadows::BeginDynamicFace(int light, int face)
+{
+	int frameCube = light * 2 + 1;
+	if (m_sampledCubes[light] != frameCube)
+	{
+		glCopyImageSubData(
+			m_cubes.Get(), GL_TEXTURE_CUBE_MAP_ARRAY, 0, 0, 0, light * 2 * 6,
+			m_cubes.Get(), GL_TEXTURE_CUBE_MAP_ARRAY, 0, 0, 0, frameCube * 6,
+			m_faceSize, m_faceSize, 6);
+		m_sampledCubes[light] = frameCube;
+	}
+
+	AttachFace(frameCube, face, light);
+}
+
+/***********************************************************
+ *  SetCasterModel()
+ *
+ *  This method is used to set the model matrix of the next
+ *  caster drawn into a face.
+ ***********************************************************/
+void PointShadows::SetCasterModel(const glm::mat4& model)
+{
+	glUniformMatrix4fv(glGetUniformLocation(m_casterProgram.Get(), "model"), 1, GL_FALSE, glm::value_ptr(model));
+}
+
+/***********************************************************
+ *  EndCasters()
+ *
+ *  This method is used to restore the framebuffer, viewport
+ *  and program of before BeginCasters().
+ ***********************************************************/
+void PointShadows::EndCasters()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)m_previousFramebuffer);
+	glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+	glUseProgram((GLuint)m_previousProgram);
+	m_bStaticCached = m_bStaticCached || m_bStaticDrawn;
+}
+
+/***********************************************************
+ *  BeginReceivers()
+ *
+ *  This method is used to switch to the receiver program and
+ *  bind the cubes. The objects are drawn over themselves
+ *  without writing depth, and what they write is subtracted
+ *  from the color already there. A small depth offset keeps
+ *  the surfaces of two programs from fighting.
+ ***********************************************************/
+void PointShadows::BeginReceivers(const glm::mat4& viewProjection, const glm::vec3& viewPosition)
+{
+	glGetIntegerv(GL_CURRENT_PROGRAM, &m_previousProgram);
+	glGetIntegerv(GL_DEPTH_FUNC, &m_previousDepthFunc);
+	m_bPreviousBlend = glIsEnabled(GL_BLEND);
+	glGetIntegerv(GL_BLEND_SRC_RGB, &m_previousBlend[0]);
+	glGetIntegerv(GL_BLEND_DST_RGB, &m_previousBlend[1]);
+	glGetIntegerv(GL_BLEND_SRC_ALPHA, &m_previousBlend[2]);
+	glGetIntegerv(GL_BLEND_DST_ALPHA, &m_previousBlend[3]);
+
+	GLuint program = m_receiverProgram.Get();
+	glUseProgram(program);
+
+	glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_cubes.Get());
+	glActiveTexture(GL_TEXTURE0);
+
+	int lightCount = (int)m_lights.size();
+	glm::vec3 positions[MAX_SHADOW_LIGHTS];
+	glm::vec3 diffuse[MAX_SHADOW_LIGHTS];
+	glm::vec3 specular[MAX_SHADOW_LIGHTS];
+	float ranges[MAX_SHADOW_LIGHTS];
+	float sampledCubes[MAX_SHADOW_LIGHTS];
+	for (int light = 0; light < lightCount; light++)
+	{
+		positions[light] = m_lights[light].position;
+		diffuse[light] = m_lights[light].diffuse;
+		specular[light] = m_lights[light].specular;
+		ranges[light] = m_lights[light].range;
+		sampledCubes[light] = (float)m_sampledCubes[light];
+	}
+
+	glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+	glUniform3fv(glGetUniformLocation(program, "viewPosition"), 1, glm::value_ptr(viewPosition));
+	glUniform1i(glGetUniformLocation(program, "shadowCubes"), SHADOW_TEXTURE_UNIT);
+	glUniform1i(glGetUniformLocation(program, "lightCount"), lightCount);
+	glUniform3fv(glGetUniformLocation(program, "lightPositions"), lightCount, glm::value_ptr(positions[0]));
+	glUniform3fv(glGetUniformLocation(program, "lightDiffuse"), lightCount, glm::value_ptr(diffuse[0]));
+	glUniform3fv(glGetUniformLocation(program, "lightSpecular"), lightCount, glm::value_ptr(specular[0]));
+	glUniform1fv(glGetUniformLocation(program, "lightRanges"), lightCount, ranges);
+	glUniform1fv(glGetUniformLocation(program, "sampledCubes"), lightCount, sampledCubes);
+	glUniform1f(glGetUniformLocation(program, "depthBias"), DEPTH_BIAS);
+
+	glDepthFunc(GL_LEQUAL);
+	glDepthMask(GL_FALSE);
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(-1.0f, -1.0f);
+	glEnable(GL_BLEND);
+	glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
+	glBlendFunc(GL_ONE, GL_ONE);
+}
+
+/***********************************************************
+ *  SetMaterial()
+ *
+ *  This method is used to set the material values of the
+ *  objects drawn next.
+ ***********************************************************/
+void PointShadows::SetMaterial(const glm::vec3& diffuseColor, const glm::vec3& specularColor, float shininess)
+{
+	GLuint program = m_receiverProgram.Get();
+	glUniform3fv(glGetUniformLocation(program, "diffuseColor"), 1, glm::value_ptr(diffuseColor));
+	glUniform3fv(glGetUniformLocation(program, "specularColor"), 1, glm::value_ptr(specularColor));
+	glUniform1f(glGetUniformLocation(program, "shininess"), shininess);
+}
+
+/***********************************************************
+ *  SetTexture()
+ *
+ *  This method is used to set the texture unit the objects
+ *  drawn next are textured from.
+ ***********************************************************/
+void PointShadows::SetTexture(int textureSlot)
+{
+	glUniform1i(glGetUniformLocation(m_receiverProgram.Get(), "objectTexture"), textureSlot);
+}
+
+/***********************************************************
+ *  SetObject()
+ *
+ *  This method is used to set the model matrix and texture
+ *  scale of the next object.
+ ***********************************************************/
+void PointShadows::SetObject(const glm::mat4& model, const glm::vec2& uvScale)
+{
+	GLuint program = m_receiverProgram.Get();
+	glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(model));
+	glUniform2fv(glGetUniformLocation(program, "uvScale"), 1, glm::value_ptr(uvScale));
+}
+
+/***********************************************************
+ *  EndReceivers()
+ *
+ *  This method is used to switch back to the scene program
+ *  and to the depth and blending of before BeginReceivers().
+ ***********************************************************/
+void PointShadows::EndReceivers()
+{
+	glBlendEquation(GL_FUNC_ADD);
+	glBlendFuncSeparate(m_previousBlend[0], m_previousBlend[1], m_previousBlend[2], m_previousBlend[3]);
+	if (!m_bPreviousBlend)
+	{
+		glDisable(GL_BLEND);
+	}
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glDepthMask(GL_TRUE);
+	glDepthFunc((GLenum)m_previousDepthFunc);
+	glUseProgram((GLuint)m_previousProgram);
+}
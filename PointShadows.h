@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// pointshadows.h
+// ============
+// cached cube map shadows of the point lights
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResource.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  PointShadows
+ *
+ *  This class keeps the shadows of the point lights in one
+ *  cube map array of distances. Every light has two cubes:
+ *  the static one is drawn once with the objects that never
+ *  move and kept, and the frame one is a copy of it with the
+ *  moving objects drawn over the faces they are seen in, so
+ *  a frame with nothing moving near a light draws no cube
+ *  faces at all. The size of the faces is the largest that
+ *  fits all the cubes into the memory budget.
+ *
+ *  The scene program cannot sample the cubes, so the objects
+ *  are drawn again over the frame with a program that takes
+ *  away the light of the point lights where it is hidden.
+ ***********************************************************/
+class PointShadows
+{
+public:
+	// texture unit of the cube map array, above the probe units
+	static const int SHADOW_TEXTURE_UNIT = 25;
+	// the point lights of the scene program
+	static const int MAX_SHADOW_LIGHTS = 2;
+	// smallest and largest cube faces in texels
+	static const int MIN_FACE_SIZE = 128;
+	static const int MAX_FACE_SIZE = 1024;
+	// near plane of the cube faces in world units
+	static constexpr float NEAR_PLANE = 0.05f;
+	// distance a receiver must be behind a caster to be in its
+	// shadow, as a fraction of the range of the light
+	static constexpr float DEPTH_BIAS = 0.004f;
+
+	// a point light that casts shadows, whose range is the
+	// farthest distance its cubes hold
+	struct SHADOW_LIGHT
+	{
+		glm::vec3 position;
+		glm::vec3 diffuse;
+		glm::vec3 specular;
+		float range;
+	};
+
+	// constructor
+	PointShadows();
+	// destructor
+	~PointShadows();
+
+	// create the cubes of the lights within the budget, and the
+	// programs that draw and use them
+	bool Initialize(const std::vector<SHADOW_LIGHT>& lights, size_t budgetBytes);
+	// free the cubes, the framebuffer and the programs
+	void Destroy();
+	bool IsInitialized() const { return(m_receiverProgram.IsValid()); }
+
+	int GetLightCount() const { return((int)m_lights.size()); }
+	// true once the static cubes have been drawn
+	bool IsStaticCached() const { return(m_bStaticCached); }
+	// get the projection * view matrix of a face of a light
+	const glm::mat4& GetFaceViewProjection(int light, int face) const { return(m_faceViewProjections[light * 6 + face]); }
+	// true when a box is within the range of a light
+	bool IsInRange(int light, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+	// sample the static cubes again, until a frame cube is drawn
+	void UseStaticCubes();
+
+	// switch to the caster program and the cube framebuffer
+	void BeginCasters();
+	// clear a face of the static cube of a light to draw into
+	void BeginStaticFace(int light, int face);
+	// draw into a face of the frame cube of a light, which is a
+	// copy of the static cube the first time in a frame
+	void BeginDynamicFace(int light, int face);
+	// set the model matrix of the next caster
+	void SetCasterModel(const glm::mat4& model);
+	// restore the framebuffer, viewport and program
+	void EndCasters();
+
+	// switch to the receiver program, which takes the hidden
+	// light away from the objects already drawn in a view
+	void BeginReceivers(const glm::mat4& viewProjection, const glm::vec3& viewPosition);
+	// set the material values of the next objects
+	void SetMaterial(const glm::vec3& diffuseColor, const glm::vec3& specularColor, float shininess);
+	// set the texture unit of the next objects
+	void SetTexture(int textureSlot);
+	// set the model matrix and texture scale of the next object
+	void SetObject(const glm::mat4& model, const glm::vec2& uvScale);
+	// restore the program and the blending and depth state
+	void EndReceivers();
+
+private:
+	GpuTexture m_cubes;
+	GpuProgram m_casterProgram;
+	GpuProgram m_receiverProgram;
+	// framebuffers belong to the context they were made in
+	GLuint m_framebuffer;
+	int m_faceSize;
+	std::vector<SHADOW_LIGHT> m_lights;
+	std::vector<glm::mat4> m_faceViewProjections;
+	// the cube sampled for each light, static or frame
+	std::vector<int> m_sampledCubes;
+	bool m_bStaticCached;
+	bool m_bStaticDrawn;
+	// the state to restore after drawing
+	GLint m_previousProgram;
+	GLint m_previousFramebuffer;
+	GLint m_previousViewport[4];
+	GLint m_previousDepthFunc;
+	GLboolean m_bPreviousBlend;
+	GLint m_previousBlend[4];
+
+	// attach a face of a cube to the framebuffer
+	void AttachFace(int cube, int face, int light);
+};
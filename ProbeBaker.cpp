@@ -0,0 +1,300 @@
+///////////////////////////////////////////////////////////////////////////////
+// probebaker.cpp
+// ============
+// bake a grid of spherical harmonic irradiance probes over the scene
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProbeBaker.h"
+#include "TriangleBVH.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const float PI = 3.14159265f;
+	// the constant and linear spherical harmonic basis
+	const float SH_CONSTANT = 0.282095f;
+	const float SH_LINEAR = 0.488603f;
+	// distance rays start off a surface so they miss it
+	const float SURFACE_OFFSET = 0.002f;
+	// length of the rays, longer than the whole scene
+	const float RAY_LENGTH = 1000.0f;
+	// a probe that sees the back of this many of the faces
+	// its rays hit is buried inside an object
+	const float BURIED_FRACTION = 0.25f;
+	// passes of filling the buried probes from their neighbours
+	const int FILL_PASSES = 8;
+	// probes a worker thread takes at a time
+	const int WORK_CHUNK = 4;
+
+	/***********************************************************
+	 *  GetProbeIndex()
+	 *
+	 *  This function returns the first of the three values of
+	 *  a probe of the grid.
+	 ***********************************************************/
+	int GetProbeIndex(const glm::ivec3& counts, int x, int y, int z)
+	{
+		return(((z * counts.y + y) * counts.x + x) * 3);
+	}
+
+	/***********************************************************
+	 *  GetGridAxis()
+	 *
+	 *  This function is used to fit probes along one side of
+	 *  the bounds, no further apart than the probe spacing.
+	 ***********************************************************/
+	void GetGridAxis(float low, float high, int& count, float& spacing)
+	{
+		float extent = (high > low) ? (high - low) : 0.0f;
+		count = (int)std::ceil(extent / ProbeBaker::PROBE_SPACING) + 1;
+		count = std::min(std::max(count, 2), (int)ProbeBaker::MAX_PROBES_PER_AXIS);
+		spacing = (extent > 0.0f) ? (extent / (count - 1)) : ProbeBaker::PROBE_SPACING;
+	}
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used to bake the probes. The rays of each
+ *  probe are spread evenly over the sphere on a spiral, and
+ *  every surface they hit reflects the direct light that
+ *  reaches it, found with shadow rays to the lights. Probes
+ *  buried inside objects are filled in from the probes next
+ *  to them so they do not darken the surfaces around them.
+ ***********************************************************/
+bool ProbeBaker::Bake(
+	const std::vector<LightmapBaker::BAKE_OBJECT>& objects,
+	const std::vector<LightmapBaker::BAKE_LIGHT>& lights,
+	const glm::vec3& skyIrradiance,
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax,
+	PROBE_GRID& grid)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	std::vector<glm::vec3> worldCorners;
+	std::vector<glm::vec3> worldNormals;
+	std::vector<glm::vec3> triangleAlbedos;
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		if (!LightmapBaker::IsSupported(objects[i].primitive))
+		{
+			std::cout << "ERROR: Cannot bake probes for mesh primitive " << (int)objects[i].primitive << std::endl;
+			return(false);
+		}
+		LightmapBaker::AddWorldTriangles(objects[i], worldCorners, worldNormals);
+		triangleAlbedos.resize(worldNormals.size(), objects[i].albedo);
+	}
+
+	TriangleBVH bvh;
+	bvh.Build(worldCorners);
+
+	glm::vec3 gridMin(boundsMin.x, boundsMin.y + PROBE_LIFT, boundsMin.z);
+	glm::vec3 gridMax = glm::max(boundsMax, gridMin);
+	GetGridAxis(gridMin.x, gridMax.x, grid.counts.x, grid.spacing.x);
+	GetGridAxis(gridMin.y, gridMax.y, grid.counts.y, grid.spacing.y);
+	GetGridAxis(gridMin.z, gridMax.z, grid.counts.z, grid.spacing.z);
+	grid.origin = gridMin;
+
+	int probeCount = grid.counts.x * grid.counts.y * grid.counts.z;
+	grid.coefficients.assign((size_t)probeCount * 3, glm::vec4(0.0f));
+	std::vector<unsigned char> buried(probeCount, 0);
+
+	// the same directions for every probe, on a spiral
+	std::vector<glm::vec3> directions(PROBE_RAYS);
+	for (int ray = 0; ray < PROBE_RAYS; ray++)
+	{
+		float height = 1.0f - (2.0f * ray + 1.0f) / PROBE_RAYS;
+		float radius = std::sqrt(std::max(1.0f - height * height, 0.0f));
+		float angle = ray * PI * (3.0f - std::sqrt(5.0f));
+		directions[ray] = glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle));
+	}
+
+	glm::vec3 skyRadiance = skyIrradiance / PI;
+	ParallelFor(probeCount, WORK_CHUNK, [&](int probe)
+	{
+		int x = probe % grid.counts.x;
+		int y = (probe / grid.counts.x) % grid.counts.y;
+		int z = probe / (grid.counts.x * grid.counts.y);
+		glm::vec3 position = grid.origin + glm::vec3((float)x, (float)y, (float)z) * grid.spacing;
+
+		glm::vec3 constant(0.0f);
+		glm::vec3 linear[3] = { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) };
+		int backFaces = 0;
+		for (int ray = 0; ray < PROBE_RAYS; ray++)
+		{
+			const glm::vec3& direction = directions[ray];
+
+			// the sky is only above, what misses below is past
+			// the edge of the ground and stays dark
+			glm::vec3 radiance = (direction.y > 0.0f) ? skyRadiance : glm::vec3(0.0f);
+			TriangleBVH::RAY_HIT hit;
+			if (bvh.Intersect(position, direction, RAY_LENGTH, hit))
+			{
+				const glm::vec3& normal = worldNormals[hit.triangle];
+				if (glm::dot(direction, normal) >= 0.0f)
+				{
+					backFaces++;
+					continue;
+				}
+
+				glm::vec3 surface = position + direction * hit.distance + normal * SURFACE_OFFSET;
+				glm::vec3 irradiance(0.0f);
+				for (size_t light = 0; light < lights.size(); light++)
+				{
+					glm::vec3 toLight = -glm::normalize(lights[light].vector);
+					float distance = RAY_LENGTH;
+					if (!lights[light].bDirectional)
+					{
+						toLight = lights[light].vector - surface;
+						distance = glm::length(toLight);
+						toLight /= distance;
+					}
+
+					float amount = glm::dot(normal, toLight);
+					if ((amount > 0.0f) && !bvh.IsOccluded(surface, toLight, distance))
+					{
+						irradiance += lights[light].diffuse * amount;
+					}
+				}
+				radiance = triangleAlbedos[hit.triangle] * irradiance / PI;
+			}
+
+			constant += radiance * SH_CONSTANT;
+			for (int channel = 0; channel < 3; channel++)
+			{
+				linear[channel] += direction * (radiance[channel] * SH_LINEAR);
+			}
+		}
+
+		// turn the radiance into irradiance, which only keeps
+		// the cosine lobe of the first two bands
+		float sampleWeight = 4.0f * PI / PROBE_RAYS;
+		int index = GetProbeIndex(grid.counts, x, y, z);
+		for (int channel = 0; channel < 3; channel++)
+		{
+			glm::vec3 weights = linear[channel] * (sampleWeight * SH_LINEAR * 2.0f * PI / 3.0f);
+			grid.coefficients[index + channel] = glm::vec4(
+				constant[channel] * sampleWeight * SH_CONSTANT * PI,
+				weights.x, weights.y, weights.z);
+		}
+		buried[probe] = (backFaces > (int)(PROBE_RAYS * BURIED_FRACTION)) ? 1 : 0;
+	});
+
+	int buriedCount = 0;
+	for (int probe = 0; probe < probeCount; probe++)
+	{
+		buriedCount += buried[probe];
+	}
+
+	for (int pass = 0; pass < FILL_PASSES; pass++)
+	{
+		std::vector<unsigned char> stillBuried = buried;
+		for (int probe = 0; probe < probeCount; probe++)
+		{
+			if (!buried[probe])
+			{
+				continue;
+			}
+
+			glm::ivec3 cell(probe % grid.counts.x, (probe / grid.counts.x) % grid.counts.y, probe / (grid.counts.x * grid.counts.y));
+			glm::vec4 sums[3] = { glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f) };
+			int count = 0;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				for (int step = -1; step <= 1; step += 2)
+				{
+					glm::ivec3 neighbour = cell;
+					neighbour[axis] += step;
+					if ((neighbour[axis] < 0) || (neighbour[axis] >= grid.counts[axis]))
+					{
+						continue;
+					}
+					int neighbourProbe = (neighbour.z * grid.counts.y + neighbour.y) * grid.counts.x + neighbour.x;
+					if (buried[neighbourProbe])
+					{
+						continue;
+					}
+					int neighbourIndex = neighbourProbe * 3;
+					for (int channel = 0; channel < 3; channel++)
+					{
+						sums[channel] += grid.coefficients[neighbourIndex + channel];
+					}
+					count++;
+				}
+			}
+
+			if (count > 0)
+			{
+				for (int channel = 0; channel < 3; channel++)
+				{
+					grid.coefficients[probe * 3 + channel] = sums[channel] / (float)count;
+				}
+				stillBuried[probe] = 0;
+			}
+		}
+		buried.swap(stillBuried);
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "INFO: Baked " << grid.counts.x << "x" << grid.counts.y << "x" << grid.counts.z
+		<< " irradiance probes, " << buriedCount << " buried, in " << elapsed.count() << " ms" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  SampleIrradiance()
+ *
+ *  This method is used to blend the eight probes around a
+ *  point and get the irradiance on a surface there. Points
+ *  outside the grid use the probes at its edge.
+ ***********************************************************/
+glm::vec3 ProbeBaker::SampleIrradiance(
+	const PROBE_GRID& grid,
+	const glm::vec3& position,
+	const glm::vec3& normal)
+{
+	if (grid.coefficients.empty())
+	{
+		return(glm::vec3(0.0f));
+	}
+
+	glm::vec3 cell = (position - grid.origin) / grid.spacing;
+	glm::ivec3 first;
+	glm::vec3 blend;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float clamped = std::min(std::max(cell[axis], 0.0f), (float)(grid.counts[axis] - 1));
+		first[axis] = std::min((int)clamped, grid.counts[axis] - 2);
+		blend[axis] = clamped - (float)first[axis];
+	}
+
+	glm::vec4 coefficients[3] = { glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f) };
+	for (int corner = 0; corner < 8; corner++)
+	{
+		int dx = corner & 1;
+		int dy = (corner >> 1) & 1;
+		int dz = (corner >> 2) & 1;
+		float weight = (dx ? blend.x : 1.0f - blend.x) * (dy ? blend.y : 1.0f - blend.y) * (dz ? blend.z : 1.0f - blend.z);
+		int index = GetProbeIndex(grid.counts, first.x + dx, first.y + dy, first.z + dz);
+		for (int channel = 0; channel < 3; channel++)
+		{
+			coefficients[channel] += grid.coefficients[index + channel] * weight;
+		}
+	}
+
+	glm::vec3 irradiance;
+	for (int channel = 0; channel < 3; channel++)
+	{
+		irradiance[channel] = std::max(coefficients[channel].x + glm::dot(glm::vec3(coefficients[channel].y, coefficients[channel].z, coefficients[channel].w), normal), 0.0f);
+	}
+
+	return(irradiance);
+}
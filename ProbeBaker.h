@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// probebaker.h
+// ============
+// bake a grid of spherical harmonic irradiance probes over the scene
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "LightmapBaker.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  ProbeBaker
+ *
+ *  This class computes the indirect light at the points of
+ *  a regular grid over the scene. Rays are traced from every
+ *  probe in all directions, and what they see is the light
+ *  the scene lights reflect off the surfaces they hit, or
+ *  the open sky. That light is stored as first order
+ *  spherical harmonics already turned into irradiance, so
+ *  the light reaching a surface of any direction is one
+ *  dot product per color channel. Between the probes the
+ *  values are blended trilinearly.
+ ***********************************************************/
+class ProbeBaker
+{
+public:
+	// distance between probes the grid starts with
+	static constexpr float PROBE_SPACING = 1.0f;
+	// height of the lowest probes over the bottom of the scene,
+	// so they are not buried in the ground
+	static constexpr float PROBE_LIFT = 0.25f;
+	// most probes along each side of the grid
+	static const int MAX_PROBES_PER_AXIS = 48;
+	// rays traced from each probe
+	static const int PROBE_RAYS = 256;
+
+	// the baked probes, with three values for every probe, one
+	// per color channel, of the irradiance from any direction
+	// as constant and the weights of the normal
+	struct PROBE_GRID
+	{
+		glm::ivec3 counts;
+		glm::vec3 origin;
+		glm::vec3 spacing;
+		std::vector<glm::vec4> coefficients;
+	};
+
+	// bake the probes over the bounds of the objects, the sky
+	// irradiance is what the open sky gives an upward surface
+	static bool Bake(
+		const std::vector<LightmapBaker::BAKE_OBJECT>& objects,
+		const std::vector<LightmapBaker::BAKE_LIGHT>& lights,
+		const glm::vec3& skyIrradiance,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		PROBE_GRID& grid);
+
+	// get the irradiance on a surface facing the passed in
+	// normal, or the average of every direction for a zero normal
+	static glm::vec3 SampleIrradiance(
+		const PROBE_GRID& grid,
+		const glm::vec3& position,
+		const glm::vec3& normal);
+};
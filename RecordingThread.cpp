@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// recordingthread.cpp
+// ============
+// keep a worker thread that records command lists for the frames
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RecordingThread.h"
+
+/***********************************************************
+ *  RecordingThread()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RecordingThread::RecordingThread()
+{
+	m_bTaskPending = false;
+	m_bStop = false;
+	m_thread = std::thread(&RecordingThread::WorkerThread, this);
+}
+
+/***********************************************************
+ *  ~RecordingThread()
+ *
+ *  The destructor for the class, a task that was given is
+ *  run before the thread stops.
+ ***********************************************************/
+RecordingThread::~RecordingThread()
+{
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStop = true;
+	}
+	m_signal.notify_all();
+	m_thread.join();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used to give the thread a task to run.
+ ***********************************************************/
+void RecordingThread::Start(const RECORD_TASK& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = task;
+		m_bTaskPending = true;
+	}
+	m_signal.notify_all();
+}
+
+/***********************************************************
+ *  Wait()
+ *
+ *  This method is used to wait until the task given to the
+ *  thread has run, it returns at once when there is none.
+ ***********************************************************/
+void RecordingThread::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_signal.wait(lock, [this]() { return(!m_bTaskPending); });
+}
+
+/***********************************************************
+ *  WorkerThread()
+ *
+ *  This method runs on the worker thread, running each task
+ *  it is given outside of the lock.
+ ***********************************************************/
+void RecordingThread::WorkerThread()
+{
+	for (;;)
+	{
+		RECORD_TASK task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_signal.wait(lock, [this]() { return(m_bStop || m_bTaskPending); });
+			if (m_bStop)
+			{
+				return;
+			}
+			task = m_task;
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_task = RECORD_TASK();
+			m_bTaskPending = false;
+		}
+		m_signal.notify_all();
+	}
+}
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// recordingthread.h
+// ============
+// keep a worker thread that records command lists for the frames
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/***********************************************************
+ *  RecordingThread
+ *
+ *  This class keeps one worker thread alive for as long as
+ *  it exists, so a frame can hand it the recording of a view
+ *  without starting a thread. The thread waits until it is
+ *  given a task, runs it, and waits again. Only one task is
+ *  given at a time, and Wait() returns once it has run.
+ ***********************************************************/
+class RecordingThread
+{
+public:
+	// work for the thread, such as recording one view
+	typedef std::function<void()> RECORD_TASK;
+
+	// constructor, starts the thread
+	RecordingThread();
+	// destructor, stops the thread
+	~RecordingThread();
+
+	// give the thread a task, the last one must have finished
+	void Start(const RECORD_TASK& task);
+	// wait until the task given by Start() has run
+	void Wait();
+
+private:
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_signal;
+	RECORD_TASK m_task;
+	// true from Start() until the task has run
+	bool m_bTaskPending;
+	bool m_bStop;
+
+	// the loop of the worker thread
+	void WorkerThread();
+};
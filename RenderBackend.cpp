@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderbackend.cpp
+// ============
+// the calls a frame makes to draw, behind an interface that can be swapped
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderBackend.h"
+
+/***********************************************************
+ *  GLRenderBackend()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLRenderBackend::GLRenderBackend(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_pTextureSamplers = NULL;
+}
+
+/***********************************************************
+ *  SetMat4Value()
+ *
+ *  This method is used to set a matrix of the scene program.
+ *  The other values are set the same way, and nothing is
+ *  set without a shader manager.
+ ***********************************************************/
+void GLRenderBackend::SetMat4Value(const char* name, const glm::mat4& value)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setMat4Value(name, value);
+	}
+}
+
+void GLRenderBackend::SetVec4Value(const char* name, const glm::vec4& value)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setVec4Value(name, value);
+	}
+}
+
+void GLRenderBackend::SetVec3Value(const char* name, const glm::vec3& value)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setVec3Value(name, value);
+	}
+}
+
+void GLRenderBackend::SetVec2Value(const char* name, const glm::vec2& value)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setVec2Value(name, value);
+	}
+}
+
+void GLRenderBackend::SetFloatValue(const char* name, float value)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setFloatValue(name, value);
+	}
+}
+
+void GLRenderBackend::SetIntValue(const char* name, int value)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue(name, value);
+	}
+}
+
+void GLRenderBackend::SetBoolValue(const char* name, bool value)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setBoolValue(name, value);
+	}
+}
+
+void GLRenderBackend::SetSampler2DValue(const char* name, int textureUnit)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setSampler2DValue(name, textureUnit);
+	}
+}
+
+/***********************************************************
+ *  BindSampler()
+ *
+ *  This method is used to bind the sampler object of a tier
+ *  and wrap mode to a unit.
+ ***********************************************************/
+void GLRenderBackend::BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap)
+{
+	if (NULL != m_pTextureSamplers)
+	{
+		glBindSampler(textureUnit, m_pTextureSamplers->GetSampler(tier, wrap));
+	}
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used to draw a mesh of a registry.
+ ***********************************************************/
+void GLRenderBackend::DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle)
+{
+	pMeshRegistry->Draw(handle);
+}
+
+/***********************************************************
+ *  SetViewport()
+ *
+ *  This method is used to set the viewport.
+ ***********************************************************/
+void GLRenderBackend::SetViewport(int x, int y, int width, int height)
+{
+	glViewport(x, y, width, height);
+}
+
+/***********************************************************
+ *  ClearRegion()
+ *
+ *  This method is used to clear a region of the framebuffer
+ *  with the scissor test, which is off again afterwards.
+ ***********************************************************/
+void GLRenderBackend::ClearRegion(int x, int y, int width, int height)
+{
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(x, y, width, height);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+}
+
+/***********************************************************
+ *  NullRenderBackend()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+NullRenderBackend::NullRenderBackend()
+{
+	ResetCounters();
+}
+
+/***********************************************************
+ *  ResetCounters()
+ *
+ *  This method is used to set every counter back to zero.
+ ***********************************************************/
+void NullRenderBackend::ResetCounters()
+{
+	m_counters.shaderValues = 0;
+	m_counters.samplerBinds = 0;
+	m_counters.drawCalls = 0;
+	m_counters.viewports = 0;
+	m_counters.clears = 0;
+}
@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderbackend.h
+// ============
+// the calls a frame makes to draw, behind an interface that can be swapped
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "ShaderManager.h"
+#include "MeshRegistry.h"
+#include "TextureSamplers.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  RenderBackend
+ *
+ *  This class is the interface between building a frame and
+ *  the GPU. The scene and view managers set shader values,
+ *  bind samplers, place views and draw meshes through it
+ *  instead of calling OpenGL and the shader manager, so a
+ *  backend that does no GPU work can stand in for one that
+ *  does.
+ ***********************************************************/
+class RenderBackend
+{
+public:
+	// destructor
+	virtual ~RenderBackend() {}
+
+	// false for a backend that does no GPU work, where nothing
+	// needs to be loaded onto the GPU either
+	virtual bool IsGpuBackend() const = 0;
+
+	// set a value of the scene program in use
+	virtual void SetMat4Value(const char* name, const glm::mat4& value) = 0;
+	virtual void SetVec4Value(const char* name, const glm::vec4& value) = 0;
+	virtual void SetVec3Value(const char* name, const glm::vec3& value) = 0;
+	virtual void SetVec2Value(const char* name, const glm::vec2& value) = 0;
+	virtual void SetFloatValue(const char* name, float value) = 0;
+	virtual void SetIntValue(const char* name, int value) = 0;
+	virtual void SetBoolValue(const char* name, bool value) = 0;
+	virtual void SetSampler2DValue(const char* name, int textureUnit) = 0;
+
+	// bind the sampler of a filtering tier and wrap mode to a
+	// texture unit
+	virtual void BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap) = 0;
+	// draw a mesh of a registry
+	virtual void DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle) = 0;
+	// set the region of the framebuffer that is drawn into
+	virtual void SetViewport(int x, int y, int width, int height) = 0;
+	// clear the color and depth of a region of the framebuffer
+	virtual void ClearRegion(int x, int y, int width, int height) = 0;
+};
+
+/***********************************************************
+ *  GLRenderBackend
+ *
+ *  This class passes every call on to OpenGL and to the
+ *  shader manager, which is what a window draws with.
+ ***********************************************************/
+class GLRenderBackend : public RenderBackend
+{
+public:
+	// constructor
+	GLRenderBackend(ShaderManager* pShaderManager);
+
+	// set the sampler objects that are bound, nothing is bound
+	// without them
+	void SetTextureSamplers(const TextureSamplers* pTextureSamplers) { m_pTextureSamplers = pTextureSamplers; }
+
+	bool IsGpuBackend() const { return(true); }
+
+	void SetMat4Value(const char* name, const glm::mat4& value);
+	void SetVec4Value(const char* name, const glm::vec4& value);
+	void SetVec3Value(const char* name, const glm::vec3& value);
+	void SetVec2Value(const char* name, const glm::vec2& value);
+	void SetFloatValue(const char* name, float value);
+	void SetIntValue(const char* name, int value);
+	void SetBoolValue(const char* name, bool value);
+	void SetSampler2DValue(const char* name, int textureUnit);
+
+	void BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap);
+	void DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle);
+	void SetViewport(int x, int y, int width, int height);
+	void ClearRegion(int x, int y, int width, int height);
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// sampler objects of the scene
+	const TextureSamplers* m_pTextureSamplers;
+};
+
+/***********************************************************
+ *  NullRenderBackend
+ *
+ *  This class does no GPU work and only counts the calls,
+ *  so the CPU time of building frames can be measured on a
+ *  machine without a display, and the counts of a frame can
+ *  be compared between builds.
+ ***********************************************************/
+class NullRenderBackend : public RenderBackend
+{
+public:
+	// the calls made since the counters were last reset
+	struct RENDER_COUNTERS
+	{
+		unsigned long long shaderValues;
+		unsigned long long samplerBinds;
+		unsigned long long drawCalls;
+		unsigned long long viewports;
+		unsigned long long clears;
+	};
+
+	// constructor
+	NullRenderBackend();
+
+	bool IsGpuBackend() const { return(false); }
+
+	void SetMat4Value(const char* name, const glm::mat4& value) { m_counters.shaderValues++; }
+	void SetVec4Value(const char* name, const glm::vec4& value) { m_counters.shaderValues++; }
+	void SetVec3Value(const char* name, const glm::vec3& value) { m_counters.shaderValues++; }
+	void SetVec2Value(const char* name, const glm::vec2& value) { m_counters.shaderValues++; }
+	void SetFloatValue(const char* name, float value) { m_counters.shaderValues++; }
+	void SetIntValue(const char* name, int value) { m_counters.shaderValues++; }
+	void SetBoolValue(const char* name, bool value) { m_counters.shaderValues++; }
+	void SetSampler2DValue(const char* name, int textureUnit) { m_counters.shaderValues++; }
+
+	void BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap) { m_counters.samplerBinds++; }
+	void DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle) { m_counters.drawCalls++; }
+	void SetViewport(int x, int y, int width, int height) { m_counters.viewports++; }
+	void ClearRegion(int x, int y, int width, int height) { m_counters.clears++; }
+
+	const RENDER_COUNTERS& GetCounters() const { return(m_counters); }
+	void ResetCounters();
+
+private:
+	RENDER_COUNTERS m_counters;
+};
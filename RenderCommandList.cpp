@@ -0,0 +1,423 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendercommandlist.cpp
+// ============
+// record the calls of a frame on any thread and replay them later
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderCommandList.h"
+
+// GLM Math Header inclusions
+#include <glm/gtc/type_ptr.hpp>
+
+// declaration of global variables
+namespace
+{
+	// name index of a call that has no name
+	const uint32_t NO_NAME = 0xFFFFFFFF;
+
+	// values stored at the start of every written list
+	struct STORED_LIST
+	{
+		uint32_t commandCount;
+		uint32_t floatCount;
+	};
+
+	// one call as it is written, its float values follow all of
+	// the calls of the list
+	struct STORED_COMMAND
+	{
+		uint32_t type;
+		uint32_t name;
+		int32_t values[4];
+	};
+
+	/***********************************************************
+	 *  GetRemainingBytes()
+	 *
+	 *  This function returns the number of bytes left to read
+	 *  in a stream, or zero when the stream cannot seek.
+	 ***********************************************************/
+	unsigned long long GetRemainingBytes(std::istream& stream)
+	{
+		std::streampos position = stream.tellg();
+		if (position < 0)
+		{
+			return(0);
+		}
+		stream.seekg(0, std::ios::end);
+		std::streampos end = stream.tellg();
+		stream.seekg(position);
+
+		return((end > position) ? (unsigned long long)(end - position) : 0);
+	}
+}
+
+/***********************************************************
+ *  RenderCommandList()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderCommandList::RenderCommandList()
+{
+}
+
+/***********************************************************
+ *  AddCommand()
+ *
+ *  This method is used to append a call, whose float values
+ *  start at the current end of the float values.
+ ***********************************************************/
+RenderCommandList::RENDER_COMMAND& RenderCommandList::AddCommand(COMMAND_TYPE type, const char* name)
+{
+	RENDER_COMMAND command;
+	command.type = type;
+	command.name = name;
+	command.values[0] = 0;
+	command.values[1] = 0;
+	command.values[2] = 0;
+	command.values[3] = 0;
+	command.firstFloat = m_floats.size();
+	command.pMeshRegistry = NULL;
+	m_commands.push_back(command);
+
+	return(m_commands.back());
+}
+
+/***********************************************************
+ *  AddFloats()
+ *
+ *  This method is used to append the float values of the
+ *  last call.
+ ***********************************************************/
+void RenderCommandList::AddFloats(const float* pValues, int count)
+{
+	m_floats.insert(m_floats.end(), pValues, pValues + count);
+}
+
+/***********************************************************
+ *  SetMat4Value()
+ *
+ *  This method is used to record setting a matrix of the
+ *  scene program. The other values are recorded the same
+ *  way.
+ ***********************************************************/
+void RenderCommandList::SetMat4Value(const char* name, const glm::mat4& value)
+{
+	AddCommand(COMMAND_MAT4, name);
+	AddFloats(glm::value_ptr(value), 16);
+}
+
+void RenderCommandList::SetVec4Value(const char* name, const glm::vec4& value)
+{
+	AddCommand(COMMAND_VEC4, name);
+	AddFloats(glm::value_ptr(value), 4);
+}
+
+void RenderCommandList::SetVec3Value(const char* name, const glm::vec3& value)
+{
+	AddCommand(COMMAND_VEC3, name);
+	AddFloats(glm::value_ptr(value), 3);
+}
+
+void RenderCommandList::SetVec2Value(const char* name, const glm::vec2& value)
+{
+	AddCommand(COMMAND_VEC2, name);
+	AddFloats(glm::value_ptr(value), 2);
+}
+
+void RenderCommandList::SetFloatValue(const char* name, float value)
+{
+	AddCommand(COMMAND_FLOAT, name);
+	AddFloats(&value, 1);
+}
+
+void RenderCommandList::SetIntValue(const char* name, int value)
+{
+	AddCommand(COMMAND_INT, name).values[0] = value;
+}
+
+void RenderCommandList::SetBoolValue(const char* name, bool value)
+{
+	AddCommand(COMMAND_BOOL, name).values[0] = value ? 1 : 0;
+}
+
+void RenderCommandList::SetSampler2DValue(const char* name, int textureUnit)
+{
+	AddCommand(COMMAND_SAMPLER2D, name).values[0] = textureUnit;
+}
+
+/***********************************************************
+ *  BindSampler()
+ *
+ *  This method is used to record binding the sampler of a
+ *  tier and wrap mode to a unit. The tier and wrap mode are
+ *  kept rather than the sampler object, so a saved list is
+ *  bound with the samplers of the context it is replayed in.
+ ***********************************************************/
+void RenderCommandList::BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap)
+{
+	RENDER_COMMAND& command = AddCommand(COMMAND_BIND_SAMPLER, NULL);
+	command.values[0] = textureUnit;
+	command.values[1] = tier;
+	command.values[2] = wrap;
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used to record drawing a mesh of a
+ *  registry.
+ ***********************************************************/
+void RenderCommandList::DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle)
+{
+	RENDER_COMMAND& command = AddCommand(COMMAND_DRAW_MESH, NULL);
+	command.values[0] = handle;
+	command.pMeshRegistry = pMeshRegistry;
+}
+
+/***********************************************************
+ *  SetViewport()
+ *
+ *  This method is used to record setting the viewport.
+ ***********************************************************/
+void RenderCommandList::SetViewport(int x, int y, int width, int height)
+{
+	RENDER_COMMAND& command = AddCommand(COMMAND_VIEWPORT, NULL);
+	command.values[0] = x;
+	command.values[1] = y;
+	command.values[2] = width;
+	command.values[3] = height;
+}
+
+/***********************************************************
+ *  ClearRegion()
+ *
+ *  This method is used to record clearing a region of the
+ *  framebuffer.
+ ***********************************************************/
+void RenderCommandList::ClearRegion(int x, int y, int width, int height)
+{
+	RENDER_COMMAND& command = AddCommand(COMMAND_CLEAR, NULL);
+	command.values[0] = x;
+	command.values[1] = y;
+	command.values[2] = width;
+	command.values[3] = height;
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used to make every recorded call on the
+ *  passed in backend, in the order they were recorded. It
+ *  must run on the thread that the backend draws on.
+ ***********************************************************/
+void RenderCommandList::Submit(RenderBackend* pBackend) const
+{
+	if (NULL == pBackend)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_commands.size(); i++)
+	{
+		const RENDER_COMMAND& command = m_commands[i];
+		const float* pFloats = m_floats.data() + command.firstFloat;
+
+		switch (command.type)
+		{
+		case COMMAND_MAT4:
+			pBackend->SetMat4Value(command.name, glm::make_mat4(pFloats));
+			break;
+		case COMMAND_VEC4:
+			pBackend->SetVec4Value(command.name, glm::make_vec4(pFloats));
+			break;
+		case COMMAND_VEC3:
+			pBackend->SetVec3Value(command.name, glm::make_vec3(pFloats));
+			break;
+		case COMMAND_VEC2:
+			pBackend->SetVec2Value(command.name, glm::make_vec2(pFloats));
+			break;
+		case COMMAND_FLOAT:
+			pBackend->SetFloatValue(command.name, pFloats[0]);
+			break;
+		case COMMAND_INT:
+			pBackend->SetIntValue(command.name, command.values[0]);
+			break;
+		case COMMAND_BOOL:
+			pBackend->SetBoolValue(command.name, command.values[0] != 0);
+			break;
+		case COMMAND_SAMPLER2D:
+			pBackend->SetSampler2DValue(command.name, command.values[0]);
+			break;
+		case COMMAND_BIND_SAMPLER:
+			pBackend->BindSampler(command.values[0], (SAMPLER_TIER)command.values[1], (SAMPLER_WRAP)command.values[2]);
+			break;
+		case COMMAND_DRAW_MESH:
+			if (NULL != command.pMeshRegistry)
+			{
+				pBackend->DrawMesh(command.pMeshRegistry, command.values[0]);
+			}
+			break;
+		case COMMAND_VIEWPORT:
+			pBackend->SetViewport(command.values[0], command.values[1], command.values[2], command.values[3]);
+			break;
+		case COMMAND_CLEAR:
+			pBackend->ClearRegion(command.values[0], command.values[1], command.values[2], command.values[3]);
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetFloatCount()
+ *
+ *  This method returns how many float values a call of the
+ *  passed in type keeps.
+ ***********************************************************/
+int RenderCommandList::GetFloatCount(COMMAND_TYPE type)
+{
+	switch (type)
+	{
+	case COMMAND_MAT4:
+		return(16);
+	case COMMAND_VEC4:
+		return(4);
+	case COMMAND_VEC3:
+		return(3);
+	case COMMAND_VEC2:
+		return(2);
+	case COMMAND_FLOAT:
+		return(1);
+	default:
+		return(0);
+	}
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used to write the recorded calls to a
+ *  binary stream. The mesh registry of a draw is not kept,
+ *  only its handle, so the list can be read back in another
+ *  run that prepared the same scene.
+ ***********************************************************/
+bool RenderCommandList::Write(std::ostream& stream, std::map<std::string, uint32_t>& nameIndices) const
+{
+	STORED_LIST list;
+	list.commandCount = (uint32_t)m_commands.size();
+	list.floatCount = (uint32_t)m_floats.size();
+	stream.write((const char*)&list, sizeof(list));
+
+	for (size_t i = 0; i < m_commands.size(); i++)
+	{
+		const RENDER_COMMAND& command = m_commands[i];
+
+		STORED_COMMAND stored;
+		stored.type = (uint32_t)command.type;
+		stored.name = NO_NAME;
+		if (NULL != command.name)
+		{
+			std::map<std::string, uint32_t>::iterator name = nameIndices.find(command.name);
+			if (name == nameIndices.end())
+			{
+				name = nameIndices.insert(std::make_pair(std::string(command.name), (uint32_t)nameIndices.size())).first;
+			}
+			stored.name = name->second;
+		}
+		for (int value = 0; value < 4; value++)
+		{
+			stored.values[value] = command.values[value];
+		}
+		stream.write((const char*)&stored, sizeof(stored));
+	}
+	if (!m_floats.empty())
+	{
+		stream.write((const char*)m_floats.data(), (std::streamsize)(m_floats.size() * sizeof(float)));
+	}
+
+	return(!stream.fail());
+}
+
+/***********************************************************
+ *  Read()
+ *
+ *  This method is used to replace the recorded calls with
+ *  ones read from a binary stream. Nothing is kept when the
+ *  stream does not hold a valid list. The counts of the list
+ *  are checked against the bytes left in the stream before
+ *  anything is allocated, so a broken file cannot ask for
+ *  more memory than it holds.
+ ***********************************************************/
+bool RenderCommandList::Read(std::istream& stream, const std::vector<const char*>& names, const MeshRegistry* pMeshRegistry)
+{
+	Reset();
+
+	STORED_LIST list;
+	if (!stream.read((char*)&list, sizeof(list)))
+	{
+		return(false);
+	}
+
+	unsigned long long listBytes = (unsigned long long)list.commandCount * sizeof(STORED_COMMAND) +
+		(unsigned long long)list.floatCount * sizeof(float);
+	if (listBytes > GetRemainingBytes(stream))
+	{
+		return(false);
+	}
+
+	size_t floatCount = 0;
+	m_commands.reserve(list.commandCount);
+	for (uint32_t i = 0; i < list.commandCount; i++)
+	{
+		STORED_COMMAND stored;
+		if (!stream.read((char*)&stored, sizeof(stored)) ||
+			(stored.type > (uint32_t)COMMAND_CLEAR) ||
+			((stored.name != NO_NAME) && (stored.name >= names.size())) ||
+			((stored.type == (uint32_t)COMMAND_BIND_SAMPLER) &&
+				((stored.values[1] < 0) || (stored.values[1] >= SAMPLER_TIER_COUNT) ||
+				(stored.values[2] < 0) || (stored.values[2] >= SAMPLER_WRAP_COUNT))))
+		{
+			Reset();
+			return(false);
+		}
+
+		RENDER_COMMAND command;
+		command.type = (COMMAND_TYPE)stored.type;
+		command.name = (stored.name != NO_NAME) ? names[stored.name] : NULL;
+		for (int value = 0; value < 4; value++)
+		{
+			command.values[value] = stored.values[value];
+		}
+		command.firstFloat = floatCount;
+		command.pMeshRegistry = (command.type == COMMAND_DRAW_MESH) ? pMeshRegistry : NULL;
+		m_commands.push_back(command);
+
+		floatCount += GetFloatCount(command.type);
+	}
+
+	// every float value must belong to a call
+	if (floatCount != list.floatCount)
+	{
+		Reset();
+		return(false);
+	}
+	m_floats.resize(list.floatCount);
+	if (!m_floats.empty() && !stream.read((char*)m_floats.data(), (std::streamsize)(m_floats.size() * sizeof(float))))
+	{
+		Reset();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used to forget the recorded calls.
+ ***********************************************************/
+void RenderCommandList::Reset()
+{
+	m_commands.clear();
+	m_floats.clear();
+}
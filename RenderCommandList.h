@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendercommandlist.h
+// ============
+// record the calls of a frame on any thread and replay them later
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "RenderBackend.h"
+
+/***********************************************************
+ *  RenderCommandList
+ *
+ *  This class is a backend that keeps the calls made to it
+ *  instead of doing them, so a view can be built on a worker
+ *  thread while the thread that owns the GL context is busy,
+ *  and submitted to a real backend afterwards in the same
+ *  order. Each list is only ever written by one thread. The
+ *  names of shader values are kept as pointers, so they have
+ *  to outlive the list, as the scene's names all do.
+ ***********************************************************/
+class RenderCommandList : public RenderBackend
+{
+public:
+	// constructor
+	RenderCommandList();
+
+	// what is recorded is meant for the GPU it is submitted to
+	bool IsGpuBackend() const { return(true); }
+
+	void SetMat4Value(const char* name, const glm::mat4& value);
+	void SetVec4Value(const char* name, const glm::vec4& value);
+	void SetVec3Value(const char* name, const glm::vec3& value);
+	void SetVec2Value(const char* name, const glm::vec2& value);
+	void SetFloatValue(const char* name, float value);
+	void SetIntValue(const char* name, int value);
+	void SetBoolValue(const char* name, bool value);
+	void SetSampler2DValue(const char* name, int textureUnit);
+
+	void BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap);
+	void DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle);
+	void SetViewport(int x, int y, int width, int height);
+	void ClearRegion(int x, int y, int width, int height);
+
+	// make every recorded call on a backend, in order
+	void Submit(RenderBackend* pBackend) const;
+	// forget the recorded calls, keeping the memory for the next
+	// frame so recording does not allocate once it is warm
+	void Reset();
+
+	size_t GetCommandCount() const { return(m_commands.size()); }
+
+	// write the recorded calls, each name as its index in the
+	// passed in table, which gets the names it did not have
+	bool Write(std::ostream& stream, std::map<std::string, uint32_t>& nameIndices) const;
+	// replace the calls with ones written by Write(), the names
+	// must outlive the list and the meshes are drawn from the
+	// passed in registry
+	bool Read(std::istream& stream, const std::vector<const char*>& names, const MeshRegistry* pMeshRegistry);
+
+private:
+	enum COMMAND_TYPE
+	{
+		COMMAND_MAT4 = 0,
+		COMMAND_VEC4,
+		COMMAND_VEC3,
+		COMMAND_VEC2,
+		COMMAND_FLOAT,
+		COMMAND_INT,
+		COMMAND_BOOL,
+		COMMAND_SAMPLER2D,
+		COMMAND_BIND_SAMPLER,
+		COMMAND_DRAW_MESH,
+		COMMAND_VIEWPORT,
+		COMMAND_CLEAR
+	};
+
+	// one recorded call, the float values are kept apart so
+	// that a call without a matrix does not carry one
+	struct RENDER_COMMAND
+	{
+		COMMAND_TYPE type;
+		const char* name;
+		int values[4];
+		size_t firstFloat;
+		const MeshRegistry* pMeshRegistry;
+	};
+
+	// add a call, and the float values of the last call
+	RENDER_COMMAND& AddCommand(COMMAND_TYPE type, const char* name);
+	void AddFloats(const float* pValues, int count);
+	// number of float values a call of a type keeps
+	static int GetFloatCount(COMMAND_TYPE type);
+
+	std::vector<RENDER_COMMAND> m_commands;
+	std::vector<float> m_floats;
+};
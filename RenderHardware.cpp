@@ -0,0 +1,656 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderhardware.cpp
+// ============
+// buffers, textures, pipelines and command lists behind a swappable device
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderHardware.h"
+#include "GpuResource.h"
+#include "ShaderProgram.h"
+#include "RecordingThread.h"
+
+#include <GL/glew.h>
+
+#include <cstring>
+#include <iostream>
+#include <stdint.h>
+
+// declaration of global variables
+namespace
+{
+	// width and height of the target the hardware test draws
+	const int TEST_TARGET_SIZE = 64;
+
+	const char* const g_TestVertexSource = R"GLSL(
+#version 330 core
+layout(location = 0) in vec2 position;
+void main()
+{
+	gl_Position = vec4(position, 0.0, 1.0);
+}
+)GLSL";
+
+	const char* const g_TestFragmentSource = R"GLSL(
+#version 330 core
+out vec4 fragmentColor;
+void main()
+{
+	fragmentColor = vec4(0.0, 1.0, 0.0, 1.0);
+}
+)GLSL";
+
+	// the same two shaders as SPIR-V, each instruction starts
+	// with its word count in the high half and its opcode
+	const uint32_t g_TestVertexSpirv[] =
+	{
+		0x07230203, 0x00010000, 0, 18, 0,
+		(2 << 16) | 17, 1,                                // OpCapability Shader
+		(3 << 16) | 14, 0, 1,                             // OpMemoryModel Logical GLSL450
+		(7 << 16) | 15, 0, 1, 0x6E69616D, 0, 2, 3,        // OpEntryPoint Vertex %1 "main" %2 %3
+		(4 << 16) | 71, 2, 30, 0,                         // OpDecorate %2 Location 0
+		(4 << 16) | 71, 3, 11, 0,                         // OpDecorate %3 BuiltIn Position
+		(2 << 16) | 19, 4,                                // %4 = OpTypeVoid
+		(3 << 16) | 33, 5, 4,                             // %5 = OpTypeFunction %4
+		(3 << 16) | 22, 6, 32,                            // %6 = OpTypeFloat 32
+		(4 << 16) | 23, 7, 6, 2,                          // %7 = OpTypeVector %6 2
+		(4 << 16) | 23, 8, 6, 4,                          // %8 = OpTypeVector %6 4
+		(4 << 16) | 32, 9, 1, 7,                          // %9 = OpTypePointer Input %7
+		(4 << 16) | 32, 10, 3, 8,                         // %10 = OpTypePointer Output %8
+		(4 << 16) | 59, 9, 2, 1,                          // %2 = OpVariable %9 Input
+		(4 << 16) | 59, 10, 3, 3,                         // %3 = OpVariable %10 Output
+		(4 << 16) | 43, 6, 11, 0,                         // %11 = OpConstant %6 0.0
+		(4 << 16) | 43, 6, 12, 0x3F800000,                // %12 = OpConstant %6 1.0
+		(5 << 16) | 54, 4, 1, 0, 5,                       // %1 = OpFunction %4 None %5
+		(2 << 16) | 248, 13,                              // %13 = OpLabel
+		(4 << 16) | 61, 7, 14, 2,                         // %14 = OpLoad %7 %2
+		(5 << 16) | 81, 6, 15, 14, 0,                     // %15 = OpCompositeExtract %6 %14 0
+		(5 << 16) | 81, 6, 16, 14, 1,                     // %16 = OpCompositeExtract %6 %14 1
+		(7 << 16) | 80, 8, 17, 15, 16, 11, 12,            // %17 = OpCompositeConstruct %8 %15 %16 %11 %12
+		(3 << 16) | 62, 3, 17,                            // OpStore %3 %17
+		(1 << 16) | 253,                                  // OpReturn
+		(1 << 16) | 56                                    // OpFunctionEnd
+	};
+
+	const uint32_t g_TestFragmentSpirv[] =
+	{
+		0x07230203, 0x00010000, 0, 12, 0,
+		(2 << 16) | 17, 1,                                // OpCapability Shader
+		(3 << 16) | 14, 0, 1,                             // OpMemoryModel Logical GLSL450
+		(6 << 16) | 15, 4, 1, 0x6E69616D, 0, 2,           // OpEntryPoint Fragment %1 "main" %2
+		(3 << 16) | 16, 1, 7,                             // OpExecutionMode %1 OriginUpperLeft
+		(4 << 16) | 71, 2, 30, 0,                         // OpDecorate %2 Location 0
+		(2 << 16) | 19, 3,                                // %3 = OpTypeVoid
+		(3 << 16) | 33, 4, 3,                             // %4 = OpTypeFunction %3
+		(3 << 16) | 22, 5, 32,                            // %5 = OpTypeFloat 32
+		(4 << 16) | 23, 6, 5, 4,                          // %6 = OpTypeVector %5 4
+		(4 << 16) | 32, 7, 3, 6,                          // %7 = OpTypePointer Output %6
+		(4 << 16) | 59, 7, 2, 3,                          // %2 = OpVariable %7 Output
+		(4 << 16) | 43, 5, 8, 0,                          // %8 = OpConstant %5 0.0
+		(4 << 16) | 43, 5, 9, 0x3F800000,                 // %9 = OpConstant %5 1.0
+		(7 << 16) | 44, 6, 10, 8, 9, 8, 9,                // %10 = OpConstantComposite %6 %8 %9 %8 %9
+		(5 << 16) | 54, 3, 1, 0, 4,                       // %1 = OpFunction %3 None %4
+		(2 << 16) | 248, 11,                              // %11 = OpLabel
+		(3 << 16) | 62, 2, 10,                            // OpStore %2 %10
+		(1 << 16) | 253,                                  // OpReturn
+		(1 << 16) | 56                                    // OpFunctionEnd
+	};
+
+	/***********************************************************
+	 *  GLRhiBuffer
+	 *
+	 *  This class is a buffer of the OpenGL device. Buffers of
+	 *  every usage are filled through the array buffer target,
+	 *  so filling an index buffer leaves the bound vertex array
+	 *  alone.
+	 ***********************************************************/
+	class GLRhiBuffer : public RhiBuffer
+	{
+	public:
+		GLRhiBuffer(size_t bytes, const void* pData)
+		{
+			m_size = bytes;
+			m_buffer = GpuBuffer::Create();
+
+			GLint boundBuffer = 0;
+			glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &boundBuffer);
+			glBindBuffer(GL_ARRAY_BUFFER, m_buffer.Get());
+			glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)bytes, pData, GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, (GLuint)boundBuffer);
+			m_buffer.TrackMemory(GPU_MEMORY_MESHES, bytes);
+		}
+
+		size_t GetSize() const { return(m_size); }
+		GLuint Get() const { return(m_buffer.Get()); }
+
+	private:
+		GpuBuffer m_buffer;
+		size_t m_size;
+	};
+
+	/***********************************************************
+	 *  GLRhiTexture
+	 *
+	 *  This class is a render target of the OpenGL device, a
+	 *  texture with a framebuffer that draws into it.
+	 ***********************************************************/
+	class GLRhiTexture : public RhiTexture
+	{
+	public:
+		GLRhiTexture(int width, int height)
+		{
+			m_width = width;
+			m_height = height;
+			m_texture = GpuTexture::Create();
+
+			GLint boundTexture = 0;
+			glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+			glBindTexture(GL_TEXTURE_2D, m_texture.Get());
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glBindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+			m_texture.TrackMemory(GPU_MEMORY_RENDER_TARGETS, GpuMemory::EstimateImageBytes(width, height, 4, false));
+
+			GLint boundFramebuffer = 0;
+			glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFramebuffer);
+			glGenFramebuffers(1, &m_framebuffer);
+			glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture.Get(), 0);
+			m_bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+			glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)boundFramebuffer);
+		}
+
+		~GLRhiTexture()
+		{
+			glDeleteFramebuffers(1, &m_framebuffer);
+		}
+
+		int GetWidth() const { return(m_width); }
+		int GetHeight() const { return(m_height); }
+		GLuint GetFramebuffer() const { return(m_framebuffer); }
+		bool IsComplete() const { return(m_bComplete); }
+
+	private:
+		GpuTexture m_texture;
+		GLuint m_framebuffer;
+		int m_width;
+		int m_height;
+		bool m_bComplete;
+	};
+
+	/***********************************************************
+	 *  GLRhiPipeline
+	 *
+	 *  This class is a pipeline of the OpenGL device, a program
+	 *  and a vertex array that takes the vertex layout once a
+	 *  vertex buffer is bound with it.
+	 ***********************************************************/
+	class GLRhiPipeline : public RhiPipeline
+	{
+	public:
+		explicit GLRhiPipeline(const RHI_PIPELINE_DESC& desc)
+		{
+			m_program = GpuProgram(CreateShaderProgram((const char*)desc.pVertexCode, (const char*)desc.pFragmentCode, desc.pName));
+			m_vertexArray = GpuVertexArray::Create();
+			m_vertexStride = desc.vertexStride;
+			m_attributeCount = desc.attributeCount;
+			for (int i = 0; i < desc.attributeCount; i++)
+			{
+				m_attributeFormats[i] = desc.attributeFormats[i];
+				m_attributeOffsets[i] = desc.attributeOffsets[i];
+			}
+		}
+
+		bool IsValid() const { return(m_program.IsValid()); }
+
+		// bind the program and vertex array
+		void Bind() const
+		{
+			glUseProgram(m_program.Get());
+			glBindVertexArray(m_vertexArray.Get());
+		}
+
+		// point the attributes of the bound vertex array at a buffer
+		void SetVertexBuffer(GLuint buffer) const
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			for (int i = 0; i < m_attributeCount; i++)
+			{
+				GLint components = 2 + (int)m_attributeFormats[i] - (int)RHI_VERTEX_FLOAT2;
+				glEnableVertexAttribArray(i);
+				glVertexAttribPointer(i, components, GL_FLOAT, GL_FALSE, m_vertexStride, (const void*)(size_t)m_attributeOffsets[i]);
+			}
+		}
+
+	private:
+		GpuProgram m_program;
+		GpuVertexArray m_vertexArray;
+		int m_vertexStride;
+		int m_attributeCount;
+		RHI_VERTEX_FORMAT m_attributeFormats[RHI_MAX_VERTEX_ATTRIBUTES];
+		int m_attributeOffsets[RHI_MAX_VERTEX_ATTRIBUTES];
+	};
+
+	/***********************************************************
+	 *  GLRhiCommandList
+	 *
+	 *  This class is a command list of the OpenGL device. It
+	 *  keeps the calls, and the memory for them between frames,
+	 *  and makes them in order when it is executed.
+	 ***********************************************************/
+	class GLRhiCommandList : public RhiCommandList
+	{
+	public:
+		GLRhiCommandList()
+		{
+			m_bRecorded = false;
+		}
+
+		void Begin()
+		{
+			m_commands.clear();
+			m_bRecorded = false;
+		}
+
+		void BeginRenderPass(RhiTexture* pTarget, const glm::vec4& clearColor)
+		{
+			GL_COMMAND command = MakeCommand(COMMAND_BEGIN_PASS, pTarget);
+			command.color = clearColor;
+			m_commands.push_back(command);
+		}
+
+		void SetViewport(int x, int y, int width, int height)
+		{
+			GL_COMMAND command = MakeCommand(COMMAND_VIEWPORT, NULL);
+			command.values[0] = x;
+			command.values[1] = y;
+			command.values[2] = width;
+			command.values[3] = height;
+			m_commands.push_back(command);
+		}
+
+		void BindPipeline(RhiPipeline* pPipeline) { m_commands.push_back(MakeCommand(COMMAND_PIPELINE, pPipeline)); }
+		void BindVertexBuffer(RhiBuffer* pBuffer) { m_commands.push_back(MakeCommand(COMMAND_VERTEX_BUFFER, pBuffer)); }
+		void BindIndexBuffer(RhiBuffer* pBuffer) { m_commands.push_back(MakeCommand(COMMAND_INDEX_BUFFER, pBuffer)); }
+
+		void Draw(int vertexCount, int firstVertex)
+		{
+			GL_COMMAND command = MakeCommand(COMMAND_DRAW, NULL);
+			command.values[0] = vertexCount;
+			command.values[1] = firstVertex;
+			m_commands.push_back(command);
+		}
+
+		void DrawIndexed(int indexCount, int firstIndex)
+		{
+			GL_COMMAND command = MakeCommand(COMMAND_DRAW_INDEXED, NULL);
+			command.values[0] = indexCount;
+			command.values[1] = firstIndex;
+			m_commands.push_back(command);
+		}
+
+		void EndRenderPass() { m_commands.push_back(MakeCommand(COMMAND_END_PASS, NULL)); }
+		void End() { m_bRecorded = true; }
+
+		bool IsRecorded() const { return(m_bRecorded); }
+
+		// make the recorded calls on the current context
+		void Execute() const;
+
+	private:
+		enum COMMAND_TYPE
+		{
+			COMMAND_BEGIN_PASS = 0,
+			COMMAND_VIEWPORT,
+			COMMAND_PIPELINE,
+			COMMAND_VERTEX_BUFFER,
+			COMMAND_INDEX_BUFFER,
+			COMMAND_DRAW,
+			COMMAND_DRAW_INDEXED,
+			COMMAND_END_PASS
+		};
+
+		// one recorded call, the object is the target, pipeline
+		// or buffer it names
+		struct GL_COMMAND
+		{
+			COMMAND_TYPE type;
+			void* pObject;
+			int values[4];
+			glm::vec4 color;
+		};
+
+		std::vector<GL_COMMAND> m_commands;
+		bool m_bRecorded;
+
+		static GL_COMMAND MakeCommand(COMMAND_TYPE type, void* pObject)
+		{
+			GL_COMMAND command = {};
+			command.type = type;
+			command.pObject = pObject;
+			return(command);
+		}
+	};
+
+	/***********************************************************
+	 *  Execute()
+	 *
+	 *  This method is used to make the recorded calls. The
+	 *  vertex layout is set at the draw that first uses a new
+	 *  pipeline or buffer, so they can be bound in any order.
+	 *  The state the scene draws with is put back afterwards.
+	 ***********************************************************/
+	void GLRhiCommandList::Execute() const
+	{
+		GLint program = 0;
+		GLint vertexArray = 0;
+		GLint framebuffer = 0;
+		GLint viewport[4] = { 0, 0, 0, 0 };
+		GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+		GLboolean bScissorTest = glIsEnabled(GL_SCISSOR_TEST);
+		GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+		glDisable(GL_SCISSOR_TEST);
+		glDisable(GL_DEPTH_TEST);
+
+		const GLRhiPipeline* pPipeline = NULL;
+		const GLRhiBuffer* pVertexBuffer = NULL;
+		const GLRhiBuffer* pIndexBuffer = NULL;
+		bool bVertexLayoutDirty = false;
+		bool bIndexBufferDirty = false;
+
+		for (size_t i = 0; i < m_commands.size(); i++)
+		{
+			const GL_COMMAND& command = m_commands[i];
+			switch (command.type)
+			{
+			case COMMAND_BEGIN_PASS:
+			{
+				const GLRhiTexture* pTarget = static_cast<const GLRhiTexture*>((RhiTexture*)command.pObject);
+				glBindFramebuffer(GL_FRAMEBUFFER, pTarget->GetFramebuffer());
+				glViewport(0, 0, pTarget->GetWidth(), pTarget->GetHeight());
+				glClearColor(command.color.r, command.color.g, command.color.b, command.color.a);
+				glClear(GL_COLOR_BUFFER_BIT);
+				break;
+			}
+			case COMMAND_VIEWPORT:
+				glViewport(command.values[0], command.values[1], command.values[2], command.values[3]);
+				break;
+			case COMMAND_PIPELINE:
+				pPipeline = static_cast<const GLRhiPipeline*>((RhiPipeline*)command.pObject);
+				pPipeline->Bind();
+				bVertexLayoutDirty = true;
+				bIndexBufferDirty = true;
+				break;
+			case COMMAND_VERTEX_BUFFER:
+				pVertexBuffer = static_cast<const GLRhiBuffer*>((RhiBuffer*)command.pObject);
+				bVertexLayoutDirty = true;
+				break;
+			case COMMAND_INDEX_BUFFER:
+				pIndexBuffer = static_cast<const GLRhiBuffer*>((RhiBuffer*)command.pObject);
+				bIndexBufferDirty = true;
+				break;
+			case COMMAND_DRAW:
+			case COMMAND_DRAW_INDEXED:
+				if ((NULL == pPipeline) || (NULL == pVertexBuffer))
+				{
+					break;
+				}
+				if (bVertexLayoutDirty)
+				{
+					pPipeline->SetVertexBuffer(pVertexBuffer->Get());
+					bVertexLayoutDirty = false;
+				}
+				if (command.type == COMMAND_DRAW)
+				{
+					glDrawArrays(GL_TRIANGLES, command.values[1], command.values[0]);
+				}
+				else if (NULL != pIndexBuffer)
+				{
+					// the index buffer belongs to the bound vertex array
+					if (bIndexBufferDirty)
+					{
+						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pIndexBuffer->Get());
+						bIndexBufferDirty = false;
+					}
+					glDrawElements(GL_TRIANGLES, command.values[0], GL_UNSIGNED_INT, (const void*)((size_t)command.values[1] * sizeof(uint32_t)));
+				}
+				break;
+			case COMMAND_END_PASS:
+				break;
+			}
+		}
+
+		glUseProgram((GLuint)program);
+		glBindVertexArray((GLuint)vertexArray);
+		glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)framebuffer);
+		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+		if (bScissorTest)
+		{
+			glEnable(GL_SCISSOR_TEST);
+		}
+		if (bDepthTest)
+		{
+			glEnable(GL_DEPTH_TEST);
+		}
+	}
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used to create a buffer of the context.
+ ***********************************************************/
+RhiBuffer* GLRenderHardware::CreateBuffer(RHI_BUFFER_USAGE usage, size_t bytes, const void* pData)
+{
+	return(new GLRhiBuffer(bytes, pData));
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used to create a texture and framebuffer
+ *  of the context, NULL when the driver refuses them.
+ ***********************************************************/
+RhiTexture* GLRenderHardware::CreateRenderTarget(int width, int height)
+{
+	GLRhiTexture* pTexture = new GLRhiTexture(width, height);
+	if (!pTexture->IsComplete())
+	{
+		std::cout << "ERROR: The render target could not be created" << std::endl;
+		delete pTexture;
+		return(NULL);
+	}
+
+	return(pTexture);
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used to compile the GLSL of a pipeline,
+ *  the errors are printed when it does not compile.
+ ***********************************************************/
+RhiPipeline* GLRenderHardware::CreatePipeline(const RHI_PIPELINE_DESC& desc)
+{
+	if ((desc.attributeCount < 0) || (desc.attributeCount > RHI_MAX_VERTEX_ATTRIBUTES))
+	{
+		return(NULL);
+	}
+
+	GLRhiPipeline* pPipeline = new GLRhiPipeline(desc);
+	if (!pPipeline->IsValid())
+	{
+		delete pPipeline;
+		return(NULL);
+	}
+
+	return(pPipeline);
+}
+
+/***********************************************************
+ *  CreateCommandList()
+ *
+ *  This method is used to create an empty command list.
+ ***********************************************************/
+RhiCommandList* GLRenderHardware::CreateCommandList()
+{
+	return(new GLRhiCommandList());
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used to make the calls of a command list
+ *  on the context, which must be current on this thread.
+ ***********************************************************/
+void GLRenderHardware::Submit(RhiCommandList* pCommandList)
+{
+	GLRhiCommandList* pGLCommandList = static_cast<GLRhiCommandList*>(pCommandList);
+	if (!pGLCommandList->IsRecorded())
+	{
+		std::cout << "ERROR: A command list was submitted before it was ended" << std::endl;
+		return;
+	}
+
+	pGLCommandList->Execute();
+}
+
+/***********************************************************
+ *  WaitIdle()
+ *
+ *  This method is used to wait for the context to finish.
+ ***********************************************************/
+void GLRenderHardware::WaitIdle()
+{
+	glFinish();
+}
+
+/***********************************************************
+ *  ReadPixels()
+ *
+ *  This method is used to read back a render target, with
+ *  the rows turned over so the top row comes first.
+ ***********************************************************/
+bool GLRenderHardware::ReadPixels(RhiTexture* pTexture, std::vector<unsigned char>& pixels)
+{
+	const GLRhiTexture* pGLTexture = static_cast<const GLRhiTexture*>(pTexture);
+	int width = pGLTexture->GetWidth();
+	int height = pGLTexture->GetHeight();
+	size_t rowBytes = (size_t)width * 4;
+
+	std::vector<unsigned char> rows(rowBytes * height);
+	GLint readFramebuffer = 0;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, pGLTexture->GetFramebuffer());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rows.data());
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)readFramebuffer);
+
+	pixels.resize(rows.size());
+	for (int y = 0; y < height; y++)
+	{
+		memcpy(&pixels[y * rowBytes], &rows[(height - 1 - y) * rowBytes], rowBytes);
+	}
+
+	return(glGetError() == GL_NO_ERROR);
+}
+
+/***********************************************************
+ *  TestRenderHardware()
+ *
+ *  This function is used to draw a green triangle over a
+ *  blue target through a device. The command list is
+ *  recorded on a worker thread and submitted on this one,
+ *  as a frame would be. The middle of the target must be
+ *  green and the corners blue.
+ ***********************************************************/
+bool TestRenderHardware(RenderHardware* pHardware)
+{
+	const float vertices[] =
+	{
+		-0.5f, -0.5f,
+		0.5f, -0.5f,
+		0.0f, 0.5f
+	};
+	const uint32_t indices[] = { 0, 1, 2 };
+
+	RHI_PIPELINE_DESC desc = {};
+	if (pHardware->GetShaderLanguage() == RHI_SHADER_SPIRV)
+	{
+		desc.pVertexCode = g_TestVertexSpirv;
+		desc.vertexCodeSize = sizeof(g_TestVertexSpirv);
+		desc.pFragmentCode = g_TestFragmentSpirv;
+		desc.fragmentCodeSize = sizeof(g_TestFragmentSpirv);
+	}
+	else
+	{
+		desc.pVertexCode = g_TestVertexSource;
+		desc.vertexCodeSize = strlen(g_TestVertexSource) + 1;
+		desc.pFragmentCode = g_TestFragmentSource;
+		desc.fragmentCodeSize = strlen(g_TestFragmentSource) + 1;
+	}
+	desc.vertexStride = 2 * sizeof(float);
+	desc.attributeCount = 1;
+	desc.attributeFormats[0] = RHI_VERTEX_FLOAT2;
+	desc.attributeOffsets[0] = 0;
+	desc.pName = "RHI test";
+
+	RhiBuffer* pVertexBuffer = pHardware->CreateBuffer(RHI_BUFFER_VERTEX, sizeof(vertices), vertices);
+	RhiBuffer* pIndexBuffer = pHardware->CreateBuffer(RHI_BUFFER_INDEX, sizeof(indices), indices);
+	RhiTexture* pTarget = pHardware->CreateRenderTarget(TEST_TARGET_SIZE, TEST_TARGET_SIZE);
+	RhiPipeline* pPipeline = pHardware->CreatePipeline(desc);
+	RhiCommandList* pCommandList = pHardware->CreateCommandList();
+
+	bool bPassed = false;
+	if ((NULL != pVertexBuffer) && (NULL != pIndexBuffer) && (NULL != pTarget) && (NULL != pPipeline) && (NULL != pCommandList))
+	{
+		RecordingThread recorder;
+		recorder.Start([=]()
+		{
+			pCommandList->Begin();
+			pCommandList->BeginRenderPass(pTarget, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+			pCommandList->BindPipeline(pPipeline);
+			pCommandList->BindVertexBuffer(pVertexBuffer);
+			pCommandList->BindIndexBuffer(pIndexBuffer);
+			pCommandList->DrawIndexed(3, 0);
+			pCommandList->EndRenderPass();
+			pCommandList->End();
+		});
+		recorder.Wait();
+		pHardware->Submit(pCommandList);
+
+		std::vector<unsigned char> pixels;
+		if (pHardware->ReadPixels(pTarget, pixels))
+		{
+			const unsigned char* pCenter = &pixels[((TEST_TARGET_SIZE / 2) * TEST_TARGET_SIZE + TEST_TARGET_SIZE / 2) * 4];
+			const unsigned char* pCorner = &pixels[0];
+			bPassed = (pCenter[0] < 16) && (pCenter[1] > 240) && (pCenter[2] < 16) &&
+				(pCorner[0] < 16) && (pCorner[1] < 16) && (pCorner[2] > 240);
+			std::cout << "INFO: " << pHardware->GetName() << " drew center (" << (int)pCenter[0] << ", " << (int)pCenter[1] << ", " << (int)pCenter[2]
+				<< "), corner (" << (int)pCorner[0] << ", " << (int)pCorner[1] << ", " << (int)pCorner[2] << ")" << std::endl;
+		}
+	}
+
+	delete pCommandList;
+	delete pPipeline;
+	delete pTarget;
+	delete pIndexBuffer;
+	delete pVertexBuffer;
+
+	if (bPassed)
+	{
+		std::cout << "INFO: The render hardware test passed on " << pHardware->GetName() << std::endl;
+	}
+	else
+	{
+		std::cout << "ERROR: The render hardware test failed on " << pHardware->GetName() << std::endl;
+	}
+
+	return(bPassed);
+}
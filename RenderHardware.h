@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderhardware.h
+// ============
+// buffers, textures, pipelines and command lists behind a swappable device
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// what a buffer is bound as
+enum RHI_BUFFER_USAGE
+{
+	RHI_BUFFER_VERTEX = 0,
+	// 32 bit indices
+	RHI_BUFFER_INDEX
+};
+
+// format of one vertex attribute
+enum RHI_VERTEX_FORMAT
+{
+	RHI_VERTEX_FLOAT2 = 0,
+	RHI_VERTEX_FLOAT3,
+	RHI_VERTEX_FLOAT4
+};
+
+// shader code a device takes for its pipelines
+enum RHI_SHADER_LANGUAGE
+{
+	RHI_SHADER_GLSL = 0,
+	RHI_SHADER_SPIRV
+};
+
+// most vertex attributes of a pipeline
+const int RHI_MAX_VERTEX_ATTRIBUTES = 4;
+
+// the shaders and vertex layout of a pipeline, the code is GLSL
+// source ending with a zero or SPIR-V words, whichever the
+// device takes, with its size in bytes
+struct RHI_PIPELINE_DESC
+{
+	const void* pVertexCode;
+	size_t vertexCodeSize;
+	const void* pFragmentCode;
+	size_t fragmentCodeSize;
+	// bytes from one vertex to the next in the vertex buffer
+	int vertexStride;
+	int attributeCount;
+	RHI_VERTEX_FORMAT attributeFormats[RHI_MAX_VERTEX_ATTRIBUTES];
+	int attributeOffsets[RHI_MAX_VERTEX_ATTRIBUTES];
+	const char* pName;
+};
+
+/***********************************************************
+ *  RhiBuffer, RhiTexture, RhiPipeline
+ *
+ *  These classes are the objects a device creates. They are
+ *  deleted by whoever created them, on the thread that
+ *  submits, once no submitted command list uses them.
+ ***********************************************************/
+class RhiBuffer
+{
+public:
+	virtual ~RhiBuffer() {}
+	virtual size_t GetSize() const = 0;
+};
+
+class RhiTexture
+{
+public:
+	virtual ~RhiTexture() {}
+	virtual int GetWidth() const = 0;
+	virtual int GetHeight() const = 0;
+};
+
+class RhiPipeline
+{
+public:
+	virtual ~RhiPipeline() {}
+};
+
+/***********************************************************
+ *  RhiCommandList
+ *
+ *  This class records the work of a render pass. A list can
+ *  be recorded on any thread, each list by one thread at a
+ *  time, and is handed to RenderHardware::Submit() on the
+ *  thread that owns the device once End() has been called.
+ *  Viewports are placed from the bottom left corner of the
+ *  target, as in OpenGL, on every device.
+ ***********************************************************/
+class RhiCommandList
+{
+public:
+	virtual ~RhiCommandList() {}
+
+	// start recording, forgetting what was recorded before
+	virtual void Begin() = 0;
+	// draw into a texture, cleared to a color, the viewport
+	// covers the whole texture until it is set
+	virtual void BeginRenderPass(RhiTexture* pTarget, const glm::vec4& clearColor) = 0;
+	virtual void SetViewport(int x, int y, int width, int height) = 0;
+	virtual void BindPipeline(RhiPipeline* pPipeline) = 0;
+	virtual void BindVertexBuffer(RhiBuffer* pBuffer) = 0;
+	virtual void BindIndexBuffer(RhiBuffer* pBuffer) = 0;
+	virtual void Draw(int vertexCount, int firstVertex) = 0;
+	virtual void DrawIndexed(int indexCount, int firstIndex) = 0;
+	virtual void EndRenderPass() = 0;
+	// finish recording, the list can then be submitted
+	virtual void End() = 0;
+};
+
+/***********************************************************
+ *  RenderHardware
+ *
+ *  This class is the device of the render hardware interface.
+ *  It creates the objects and runs the command lists that
+ *  are submitted to it. The objects are created and the
+ *  lists submitted on the thread that owns the device, which
+ *  for OpenGL is the thread of its context.
+ ***********************************************************/
+class RenderHardware
+{
+public:
+	virtual ~RenderHardware() {}
+
+	// name of the device for the console
+	virtual const char* GetName() const = 0;
+	// what the code of a pipeline is written in
+	virtual RHI_SHADER_LANGUAGE GetShaderLanguage() const = 0;
+
+	// create a buffer, filled with the data if it is not NULL
+	virtual RhiBuffer* CreateBuffer(RHI_BUFFER_USAGE usage, size_t bytes, const void* pData) = 0;
+	// create an RGBA8 texture that can be drawn into and read
+	virtual RhiTexture* CreateRenderTarget(int width, int height) = 0;
+	// create a pipeline, NULL when a shader is rejected
+	virtual RhiPipeline* CreatePipeline(const RHI_PIPELINE_DESC& desc) = 0;
+	virtual RhiCommandList* CreateCommandList() = 0;
+
+	// run a recorded command list
+	virtual void Submit(RhiCommandList* pCommandList) = 0;
+	// wait until the submitted lists have finished
+	virtual void WaitIdle() = 0;
+	// copy the pixels of a drawn texture, four bytes each and
+	// the top row first
+	virtual bool ReadPixels(RhiTexture* pTexture, std::vector<unsigned char>& pixels) = 0;
+};
+
+/***********************************************************
+ *  GLRenderHardware
+ *
+ *  This class is the device of the current OpenGL context.
+ *  Its command lists only keep the calls, so they can be
+ *  recorded without the context, and make the OpenGL calls
+ *  when they are submitted. The program, vertex array and
+ *  framebuffer bound before a submit are bound again after.
+ ***********************************************************/
+class GLRenderHardware : public RenderHardware
+{
+public:
+	const char* GetName() const { return("OpenGL"); }
+	RHI_SHADER_LANGUAGE GetShaderLanguage() const { return(RHI_SHADER_GLSL); }
+
+	RhiBuffer* CreateBuffer(RHI_BUFFER_USAGE usage, size_t bytes, const void* pData);
+	RhiTexture* CreateRenderTarget(int width, int height);
+	RhiPipeline* CreatePipeline(const RHI_PIPELINE_DESC& desc);
+	RhiCommandList* CreateCommandList();
+
+	void Submit(RhiCommandList* pCommandList);
+	void WaitIdle();
+	bool ReadPixels(RhiTexture* pTexture, std::vector<unsigned char>& pixels);
+};
+
+// draw a triangle through a device, with the command list
+// recorded on a worker thread, and check the pixels it drew
+bool TestRenderHardware(RenderHardware* pHardware);
@@ -8,6 +8,13 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "ObjectPicker.h"
+#include "ViewFrustum.h"
+#include "TextureDecoder.h"
+#include "MipGenerator.h"
+#include "TextureCache.h"
+#include "StaticLayout.h"
+#include "MicroBenchmark.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,6 +22,11 @@
 #endif
 
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
 
 // declaration of global variables
 namespace
@@ -24,6 +36,193 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_ViewName = "view";
+	const char* g_ProjectionName = "projection";
+	const char* g_ViewPositionName = "viewPosition";
+	// texture tag of the objects drawn with the virtual ground
+	const char* g_VirtualGroundTag = "virtual_ground";
+	// texture tag of the objects that hide the occlusion clusters
+	const char* g_OccluderTextureTag = "hedge";
+	// width and depth of the ground cells the clusters group by
+	const float OCCLUSION_CELL_SIZE = 3.0f;
+	// steps of the material count sweep of the draw benchmark, each
+	// one with this many times the materials of the step before
+	const int BENCHMARK_MATERIAL_STEPS = 4;
+	const int BENCHMARK_MATERIAL_GROWTH = 4;
+	// the registry primitive of every mesh of the draw list
+	const MeshRegistry::MESH_PRIMITIVE g_MeshPrimitives[SceneManager::MESH_TYPE_COUNT] = {
+		MeshRegistry::MESH_PRIMITIVE_PLANE,
+		MeshRegistry::MESH_PRIMITIVE_BOX,
+		MeshRegistry::MESH_PRIMITIVE_PYRAMID4,
+		MeshRegistry::MESH_PRIMITIVE_CONE };
+
+	// local bounds of the basic shape meshes, by MESH_TYPE
+	constexpr StaticLayout::LAYOUT_BOUNDS g_MeshBounds[SceneManager::MESH_TYPE_COUNT] = {
+		{ { -1.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 1.0f } },
+		{ { -0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f } },
+		{ { -0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f } },
+		{ { -1.0f, 0.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } } };
+
+	// the objects of the topiary garden, as mesh, scale, X Y Z
+	// rotation in degrees, position, UV scale, material and texture
+	constexpr StaticLayout::LAYOUT_OBJECT g_GardenLayout[] = {
+		// THIS IS THE MAIN GRASS GROUND PLANE WITH TILED TEXTURE AND LIGHTING.
+		// I set the UV scale to tile the grass texture across the large plane.
+		// This creates a realistic tiled grass effect (COMPLEX TEXTURING TECHNIQUE - TILING).
+		{ SceneManager::MESH_PLANE, { 20.0f, 1.0f, 15.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 4.0f, 2.0f }, "grass", "grass" },
+
+		// THIS IS THE BROWN/TAN DIRT PATCH WITH TEXTURE AND LIGHTING.
+		// I positioned the dirt slightly above grass to prevent z-fighting.
+		{ SceneManager::MESH_PLANE, { 8.0f, 3.5f, 8.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.02f, 6.5f }, { 2.0f, 2.0f }, "dirt", "dirt" },
+
+		// THIS IS THE BRICK PATH WITH TEXTURE AND LIGHTING (45 DEGREE ANGLE).
+		// I rotated the bricks to match the topiary orientation.
+		// THIS IS BRICK PATH - ROW 1.
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -1.2f, 0.08f, 7.2f }, { 1.0f, 1.0f }, "brick", "brick" },
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -1.6f, 0.08f, 7.6f }, { 1.0f, 1.0f }, "brick", "brick" },
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -2.0f, 0.08f, 8.0f }, { 1.0f, 1.0f }, "brick", "brick" },
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -2.4f, 0.08f, 8.4f }, { 1.0f, 1.0f }, "brick", "brick" },
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -2.8f, 0.08f, 8.8f }, { 1.0f, 1.0f }, "brick", "brick" },
+		// THIS IS BRICK PATH - ROW 2.
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -0.8f, 0.08f, 7.6f }, { 1.0f, 1.0f }, "brick", "brick" },
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -1.2f, 0.08f, 8.0f }, { 1.0f, 1.0f }, "brick", "brick" },
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -1.6f, 0.08f, 8.4f }, { 1.0f, 1.0f }, "brick", "brick" },
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -2.0f, 0.08f, 8.8f }, { 1.0f, 1.0f }, "brick", "brick" },
+		{ SceneManager::MESH_BOX, { 0.5f, 0.15f, 0.5f }, { 0.0f, 45.0f, 0.0f }, { -2.4f, 0.08f, 9.2f }, { 1.0f, 1.0f }, "brick", "brick" },
+
+		// THE COMPLEX TOPIARY OBJECT OF THE (RECTANGULAR + PYRAMID).
+		// I demonstrated COHESIVE OBJECT with DIFFERENT TEXTURES.
+		// This is the rectangular hedge bush or the (Bottom component).
+		{ SceneManager::MESH_BOX, { 2.0f, 1.0f, 1.5f }, { 0.0f, 45.0f, 0.0f }, { 0.0f, 0.75f, 6.5f }, { 2.0f, 1.0f }, "hedge", "hedge" },
+		// This is the pyramid bush or the (Top component).
+		{ SceneManager::MESH_PYRAMID4, { 1.5f, 2.5f, 1.5f }, { 0.0f, 45.0f, 0.0f }, { 0.0f, 2.5f, 6.5f }, { 1.5f, 1.5f }, "foliage", "foliage" },
+
+		// THIS IS AN ADDITIONAL TOPIARY 1 - FIRST IN LINE NEXT TO PYRAMID.
+		{ SceneManager::MESH_BOX, { 2.0f, 1.0f, 1.5f }, { 0.0f, 45.0f, 0.0f }, { 1.5f, 0.75f, 5.0f }, { 1.5f, 1.0f }, "hedge", "hedge" },
+		{ SceneManager::MESH_CONE, { 0.7f, 1.0f, 0.7f }, { 0.0f, 45.0f, 0.0f }, { 1.5f, 1.25f, 5.0f }, { 1.2f, 1.2f }, "foliage", "foliage" },
+
+		// THIS IS THE ADDITIONAL TOPIARY 2 - SECOND IN LINE.
+		{ SceneManager::MESH_BOX, { 2.0f, 1.0f, 1.5f }, { 0.0f, 45.0f, 0.0f }, { 3.0f, 0.75f, 3.5f }, { 1.5f, 1.0f }, "hedge", "hedge" },
+		{ SceneManager::MESH_CONE, { 0.75f, 1.0f, 0.75f }, { 0.0f, 45.0f, 0.0f }, { 3.0f, 1.25f, 3.5f }, { 1.2f, 1.2f }, "foliage", "foliage" },
+
+		// THIS IS AN ADDITIONAL TOPIARY 3 - THIRD IN LINE.
+		{ SceneManager::MESH_BOX, { 2.0f, 1.0f, 1.5f }, { 0.0f, 45.0f, 0.0f }, { 4.5f, 0.75f, 2.0f }, { 1.5f, 1.0f }, "hedge", "hedge" },
+		{ SceneManager::MESH_CONE, { 0.65f, 1.0f, 0.65f }, { 0.0f, 45.0f, 0.0f }, { 4.5f, 1.25f, 2.0f }, { 1.2f, 1.2f }, "foliage", "foliage" } };
+
+	// Ben Douglas- I changed the color of the plane from white to green to match the green grass in the topiary bushes picture.
+	// I added the box mesh and combine the boxes to make a recantangle to represent the rectangle hedge bush in the topiary bushes picture.
+	// I used darker green to color the rectangle hedge bush to differentiate among the plane grass and the pyramid bush, and to replicate the picture.
+	// I adjusted the numbers to get the scale of the rectangle to be like the rectangle bush in the picture.
+	// I adjusted the numbers to postioned the rectangle hedge bush under the pyramid bush.
+	// I added the pyramid mesh to represent the pyramid bush in the topiary bushes picture.
+	// I used medium green to color the pyramid bush to differentiate among the plane grass and the rectangle hedge bush in the picture.
+	// I adjusted the numbers to get the scale of the pyramid to be like the pyramid bush in the picture.
+	// I adjusted the numbers to positioned the pyramid bush on top of the rectangle bush.
+	// I constructed the 3D objects from combines boxes to make a rectangle, I used a pyramid mesh, and I combined the pyramid with the rectangle to replicate the 2D picture.
+	// I added the LoadPyramid4Mesh, and the DrawPyramid4Mesh to go from a 3-sided pyramid to a 4-sided pyramid.
+	// 11-16-2025.
+	// Ben Douglas- I added the LoadPyramid4Mesh, and the DrawPyramid4Mesh to go from a 3-sided pyramid to a 4-sided pyramid.
+	// I added the brown/tan atop of the green plane to match the picture of the green grass, the tan bricks to the left of the pyramid bush,
+	// and the brown/tan ground under the rectangular and pyramid bush.
+	// I scaled the brown/tan plane to be big enough to fit the bushes on it.
+	// I scaled the brown/tan bricks to be the right size next to the pyramid bush.
+	// I set the color for the brown/tan plane to brown/tan.
+	// I set the color for the bricks to be brown/tan.
+	// I rotated the bricks to get them in the right postion.
+	// 11-21-2025.
+	// Ben Douglas- I applied detailed textures to grass plane, the dirt under the pyramid hedge bush, the rectangular hedge bush, the pyramid hedge bush, and the bricks
+	// by using SetShaderTexture().
+	// I deleted the colors for the scene to incoporate the images for the objects.
+	// I used the textures of plants_grass_seamless.jpg, dirt.jpg, plants_hedge_seamless.jpg, foliage.jpg, and brick.jpg to render on the objects in the scene.
+	// I used a complex technique called texture tiling by using SetTextureUVScale() on the grass and the dirt planes for realistic repetition.
+	// I created a cohesive object by using the hedge texture on the rectangular bush and by using the foliage on the pyramid bush that looks like a unified look.
+	// I created code quality to make sure the scene runs smoothly.
+	// I used the best practice through modular texture of loading in the LoadSceneTextures(), consistent naming conventions, and proper texture binding.
+	// 11-29-2025.
+	// Ben Douglas- I created the void SceneManager::DefineObjectMaterials() for the scene.
+	// I created the void SceneManager::SetupSceneLights() for the lighting of the scene.
+	// I created the THIS IS THE MAIN GRASS GROUND PLANE WITH TILED TEXTURE AND LIGHTING as well as the other materials in the scene for the shaders.
+	// 12-06-2025.
+	// Ben Douglas- I added a third light that looks like the color of orange to get rid of the shadow on the left side.
+	// I added m_basicMeshes->LoadConeMesh(); to load the cone mesh to make the cone bushes.
+	// I created three rectangle bushes to look like the image.
+	// I created three cone bushes and put them on top of the rectangle bushes.
+	// Overall I added the green grass, the soil, the pyramid bush, the bricks, and the 3 cone bushes to make it look like a topiary garden image.
+	// 12-12-2025.
+
+	// index of the main ground plane in the garden layout
+	const int GROUND_LAYOUT_OBJECT = 0;
+	// the garden in draw list order, baked by the compiler
+	constexpr auto g_GardenDrawList = StaticLayout::Bake(g_GardenLayout, g_MeshBounds);
+
+	/***********************************************************
+	 *  GetViewPosition()
+	 *
+	 *  This function returns the middle of the near plane of a
+	 *  projection * view matrix, which stands in for the camera.
+	 ***********************************************************/
+	glm::vec3 GetViewPosition(const glm::mat4& viewProjection)
+	{
+		glm::vec4 nearPoint = glm::inverse(viewProjection) * glm::vec4(0.0f, 0.0f, -1.0f, 1.0f);
+
+		return(glm::vec3(nearPoint) / nearPoint.w);
+	}
+
+	/***********************************************************
+	 *  HashImage()
+	 *
+	 *  This function returns a 64-bit FNV-1a hash of the size
+	 *  and pixels of an image.
+	 ***********************************************************/
+	uint64_t HashImage(const TextureDecoder::DECODED_IMAGE& image)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		const int size[3] = { image.width, image.height, image.channels };
+		const unsigned char* pSize = (const unsigned char*)size;
+		for (size_t i = 0; i < sizeof(size); i++)
+		{
+			hash = (hash ^ pSize[i]) * 1099511628211ULL;
+		}
+		for (size_t i = 0; i < image.pixels.size(); i++)
+		{
+			hash = (hash ^ image.pixels[i]) * 1099511628211ULL;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  PrepareTextureLevels()
+	 *
+	 *  This function runs on a worker thread to build the whole
+	 *  mip chain of a texture file, from the texture cache when
+	 *  it is up to date and otherwise by decoding the file and
+	 *  filtering the lower levels, which are then cached.
+	 ***********************************************************/
+	SceneManager::TEXTURE_LEVELS PrepareTextureLevels(std::string filename, int maxTextureSize)
+	{
+		SceneManager::TEXTURE_LEVELS result;
+		result.scaleLevel = -1;
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		result.bFromCache = TextureCache::Load(filename.c_str(), maxTextureSize, result.scaleLevel, result.levels);
+		if (!result.bFromCache)
+		{
+			result.scaleLevel = TextureDecoder::DecodeMipChain(filename.c_str(), maxTextureSize, result.levels);
+			if (result.scaleLevel >= 0)
+			{
+				MipGenerator::CompleteMipChain(result.levels, true);
+				TextureCache::Save(filename.c_str(), maxTextureSize, result.scaleLevel, result.levels);
+			}
+		}
+
+		result.contentHash = (result.scaleLevel >= 0) ? HashImage(result.levels[0]) : 0;
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		result.milliseconds = elapsed.count();
+
+		return(result);
+	}
 }
 
 /***********************************************************
@@ -31,10 +230,38 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
+SceneManager::SceneManager(ShaderManager *pShaderManager) :
+	m_glBackend(pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
+	m_pRenderBackend = &m_glBackend;
 	m_basicMeshes = new ShapeMeshes();
+	m_pMeshRegistry = new MeshRegistry(m_basicMeshes);
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		m_meshHandles[i] = MeshRegistry::INVALID_MESH_HANDLE;
+	}
+	m_loadedTextures = 0;
+	m_maxTextureSize = 0;
+	m_culledViewCount = 0;
+	m_pTextureSamplers = &m_textureSamplers;
+	m_glBackend.SetTextureSamplers(m_pTextureSamplers);
+	m_pVirtualGround = NULL;
+	m_bPrefetchedGround = false;
+	m_bStereoRendererTried = false;
+	m_pFrameScheduler = NULL;
+	m_bBakeLighting = false;
+	m_bakeAmbientLight = glm::vec3(0.0f);
+	m_pBakedLighting = NULL;
+	m_bBakeProbes = false;
+	m_pProbeVolume = NULL;
+	m_bOcclusionCulling = false;
+	m_pOcclusionCulling = NULL;
+	m_bVisibilitySets = false;
+	m_cellCommandWords = 0;
+	m_bPointShadows = false;
+	m_pointShadowBudget = 0;
+	m_pPointShadows = NULL;
 }
 
 /***********************************************************
@@ -45,6 +272,20 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
+	DestroyGLTextures();
+	m_stereoRenderer.Destroy();
+	m_textureSamplers.Destroy();
+	m_virtualGround.Destroy();
+	m_bakedLighting.Destroy();
+	m_probeVolume.Destroy();
+	m_occlusionCulling.Destroy();
+	m_pointShadows.Destroy();
+	for (int i = 0; i < MESH_TYPE_COUNT; i++)
+	{
+		m_pMeshRegistry->Release(m_meshHandles[i]);
+	}
+	delete m_pMeshRegistry;
+	m_pMeshRegistry = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
 }
@@ -52,75 +293,359 @@ SceneManager::~SceneManager()
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for creating a texture for an image
+ *  file in the next available texture slot in memory. The
+ *  image is decoded and its mipmaps are generated on a worker
+ *  thread, so several textures and the rest of the scene are
+ *  loaded at the same time. FinishTextureLoads() uploads the
+ *  levels once they are ready and reports the images that
+ *  could not be decoded, this only fails when no slot is left.
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
+	const int maxTextures = (int)(sizeof(m_textureIDs) / sizeof(m_textureIDs[0]));
+
+	// a file that is already loaded only gets another tag
+	for (size_t i = 0; i < m_textureFiles.size(); i++)
+	{
+		if (m_textureFiles[i].compare(filename) == 0)
+		{
+			m_textureAliases[tag] = m_textureIDs[i].tag;
+			return true;
+		}
+	}
+
+	if (m_loadedTextures >= maxTextures)
+	{
+		std::cout << "ERROR: No texture slot is left for image:" << filename << std::endl;
+		return false;
+	}
+
+	// without a GPU the texture only needs a slot for its tag
+	if (!m_pRenderBackend->IsGpuBackend())
+	{
+		m_textureIDs[m_loadedTextures].ID = 0;
+		m_textureIDs[m_loadedTextures].tag = tag;
+		m_textureFiles.push_back(filename);
+		m_loadedTextures++;
+		return true;
+	}
+
+	GpuTexture texture = GpuTexture::Create();
+
+	PENDING_TEXTURE pendingTexture;
+	pendingTexture.slot = m_loadedTextures;
+	pendingTexture.filename = filename;
+	pendingTexture.levels = std::async(std::launch::async, PrepareTextureLevels, std::string(filename), m_maxTextureSize);
+	m_pendingTextures.push_back(std::move(pendingTexture));
+
+	// register the texture and associate it with the special tag string
+	m_textureIDs[m_loadedTextures].ID = texture.Get();
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_textureFiles.push_back(filename);
+	m_loadedTextures++;
+	m_ownedTextures.push_back(std::move(texture));
 
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
+	return true;
+}
 
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
+/***********************************************************
+ *  FinishTextureLoads()
+ *
+ *  This method is used to wait for the textures that are
+ *  still being prepared, configuring the texture mapping
+ *  parameters in OpenGL and uploading every mip level. An
+ *  image with the same pixels as one already uploaded is not
+ *  uploaded again, its tag uses the earlier texture and its
+ *  slot is given up. The slot of an image that could not be
+ *  loaded is given up too, along with the tags sharing it,
+ *  and false is returned for it.
+ ***********************************************************/
+bool SceneManager::FinishTextureLoads()
+{
+	// first levels of the uploaded textures, kept for comparing
+	struct UPLOADED_IMAGE
+	{
+		int slot;
+		uint64_t contentHash;
+		TextureDecoder::DECODED_IMAGE image;
+	};
+	std::vector<UPLOADED_IMAGE> uploadedImages;
+	// slots given up for duplicates and for failed images
+	std::vector<bool> removedSlots(m_loadedTextures, false);
+	size_t savedBytes = 0;
+	int duplicateCount = 0;
+	int failedCount = 0;
+
+	// the other tags of a file that failed have no texture either
+	auto removeAliases = [this](const std::string& failedTag)
+	{
+		std::map<std::string, std::string>::iterator alias = m_textureAliases.begin();
+		while (alias != m_textureAliases.end())
+		{
+			if (alias->second == failedTag)
+				alias = m_textureAliases.erase(alias);
+			else
+				++alias;
+		}
+	};
 
-	// if the image was successfully read from the image file
-	if (image)
+	for (size_t i = 0; i < m_pendingTextures.size(); i++)
 	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+		PENDING_TEXTURE& pendingTexture = m_pendingTextures[i];
+		TEXTURE_LEVELS prepared = pendingTexture.levels.get();
+		const char* filename = pendingTexture.filename.c_str();
+
+		if (prepared.scaleLevel < 0)
+		{
+			std::cout << "Could not load image:" << filename << std::endl;
+			removeAliases(m_textureIDs[pendingTexture.slot].tag);
+			removedSlots[pendingTexture.slot] = true;
+			failedCount++;
+			continue;
+		}
 
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		int width = prepared.levels[0].width;
+		int height = prepared.levels[0].height;
+		int colorChannels = prepared.levels[0].channels;
+		size_t textureBytes = GpuMemory::EstimateImageBytes(width, height, 4, true);
+		const std::string& tag = m_textureIDs[pendingTexture.slot].tag;
+
+		if ((colorChannels != 3) && (colorChannels != 4))
+		{
+			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+			removeAliases(tag);
+			removedSlots[pendingTexture.slot] = true;
+			failedCount++;
+			continue;
+		}
+
+		// every other tag loaded from the same file shares this texture
+		for (std::map<std::string, std::string>::const_iterator alias = m_textureAliases.begin(); alias != m_textureAliases.end(); ++alias)
+		{
+			if (alias->second == tag)
+			{
+				savedBytes += textureBytes;
+				duplicateCount++;
+			}
+		}
+
+		// the hash finds candidates, the pixels confirm them
+		int matchingSlot = -1;
+		for (size_t j = 0; (j < uploadedImages.size()) && (matchingSlot < 0); j++)
+		{
+			const UPLOADED_IMAGE& uploaded = uploadedImages[j];
+			if ((uploaded.contentHash == prepared.contentHash) &&
+				(uploaded.image.width == width) && (uploaded.image.height == height) &&
+				(uploaded.image.channels == colorChannels) &&
+				(uploaded.image.pixels == prepared.levels[0].pixels))
+			{
+				matchingSlot = uploaded.slot;
+			}
+		}
+		if (matchingSlot >= 0)
+		{
+			std::cout << "Texture " << tag << " has the same pixels as " << m_textureIDs[matchingSlot].tag << std::endl;
+
+			// tags already sharing this texture move to the match too
+			const std::string& matchingTag = m_textureIDs[matchingSlot].tag;
+			for (std::map<std::string, std::string>::iterator alias = m_textureAliases.begin(); alias != m_textureAliases.end(); ++alias)
+			{
+				if (alias->second == tag)
+				{
+					alias->second = matchingTag;
+				}
+			}
+			m_textureAliases[tag] = matchingTag;
+			removedSlots[pendingTexture.slot] = true;
+			savedBytes += textureBytes;
+			duplicateCount++;
+			continue;
+		}
+
+		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels
+			<< ", scale:1/" << (1 << prepared.scaleLevel) << ", levels:" << prepared.levels.size()
+			<< (prepared.bFromCache ? ", cached:" : ", prepared:") << prepared.milliseconds << " ms" << std::endl;
+
+		// the texture is uploaded on its own unit, which is also
+		// where BindGLTextures() leaves it
+		GpuTexture& texture = m_ownedTextures[pendingTexture.slot];
+		glActiveTexture(GL_TEXTURE0 + pendingTexture.slot);
+		glBindTexture(GL_TEXTURE_2D, texture.Get());
 
 		// set the texture wrapping parameters
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
+		// the rows of the smaller RGB levels are not 4 byte aligned
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (size_t level = 0; level < prepared.levels.size(); level++)
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
+			const TextureDecoder::DECODED_IMAGE& image = prepared.levels[level];
+
+			// if the loaded image is in RGB format
+			if (colorChannels == 3)
+				glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGB8, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels.data());
+			// if the loaded image is in RGBA format - it supports transparency
+			else
+				glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
 		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)prepared.levels.size() - 1);
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+		// drivers store RGB8 with a padding byte, like RGBA8
+		texture.TrackMemory(GPU_MEMORY_TEXTURES, textureBytes);
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+		UPLOADED_IMAGE uploaded;
+		uploaded.slot = pendingTexture.slot;
+		uploaded.contentHash = prepared.contentHash;
+		uploaded.image = std::move(prepared.levels[0]);
+		uploadedImages.push_back(std::move(uploaded));
+	}
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	m_pendingTextures.clear();
 
-		return true;
+	// move the remaining textures down over the removed slots,
+	// deleting the textures of the removed ones
+	int targetSlot = 0;
+	for (int slot = 0; slot < m_loadedTextures; slot++)
+	{
+		if (removedSlots[slot])
+		{
+			m_ownedTextures[slot].Reset();
+			continue;
+		}
+		if (targetSlot != slot)
+		{
+			m_textureIDs[targetSlot] = m_textureIDs[slot];
+			m_textureFiles[targetSlot] = m_textureFiles[slot];
+			m_ownedTextures[targetSlot] = std::move(m_ownedTextures[slot]);
+		}
+		targetSlot++;
+	}
+	if (targetSlot != m_loadedTextures)
+	{
+		m_loadedTextures = targetSlot;
+		m_textureFiles.resize(targetSlot);
+		m_ownedTextures.resize(targetSlot);
+		BindGLTextures();
+	}
+
+	if (duplicateCount > 0)
+	{
+		std::cout << "INFO: Texture deduplication shared " << duplicateCount << " textures, saving "
+			<< (savedBytes / 1024) << " KB" << std::endl;
+	}
+
+	return(failedCount == 0);
+}
+
+/***********************************************************
+ *  BenchmarkTextureDecoding()
+ *
+ *  This method is used to print the time to decode each of
+ *  the loaded texture files at full size and at each scale.
+ ***********************************************************/
+void SceneManager::BenchmarkTextureDecoding() const
+{
+	for (size_t i = 0; i < m_textureFiles.size(); i++)
+	{
+		TextureDecoder::Benchmark(m_textureFiles[i].c_str());
+	}
+}
+
+/***********************************************************
+ *  BenchmarkDrawFunctions()
+ *
+ *  This method is used to print the time of the functions
+ *  that set up each object for drawing. The lookups search
+ *  the lists in order, so they are timed for the last entry
+ *  while the lists are grown with made up entries, and the
+ *  lists are put back afterwards. The functions run through
+ *  the null render backend, so the times of the functions
+ *  that set shader values leave out the uniform calls.
+ ***********************************************************/
+void SceneManager::BenchmarkDrawFunctions()
+{
+	if ((m_objectMaterials.size() == 0) || (m_loadedTextures == 0))
+	{
+		std::cout << "ERROR: The scene must be prepared before the draw functions are benchmarked" << std::endl;
+		return;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	// only the CPU side of the functions is timed
+	NullRenderBackend nullBackend;
+	RenderBackend* pRenderBackend = m_pRenderBackend;
+	m_pRenderBackend = &nullBackend;
+	std::cout << "INFO: The draw functions are timed with the null render backend, without the OpenGL calls" << std::endl;
+
+	MicroBenchmark::Run("BuildModelMatrix", []()
+	{
+		glm::mat4 model = BuildModelMatrix(glm::vec3(2.0f, 1.0f, 1.5f), 0.0f, 45.0f, 0.0f, glm::vec3(0.0f, 0.75f, 6.5f));
+		MicroBenchmark::DoNotOptimize(model);
+	});
+	MicroBenchmark::Run("SetTransformations", [this]()
+	{
+		SetTransformations(glm::vec3(2.0f, 1.0f, 1.5f), 0.0f, 45.0f, 0.0f, glm::vec3(0.0f, 0.75f, 6.5f));
+	});
+	MicroBenchmark::Run("SetTextureUVScale", [this]()
+	{
+		SetTextureUVScale(1.5f, 1.0f);
+	});
+
+	size_t materialCount = m_objectMaterials.size();
+	size_t sweepCount = materialCount;
+	for (int step = 0; step < BENCHMARK_MATERIAL_STEPS; step++)
+	{
+		while (m_objectMaterials.size() < sweepCount)
+		{
+			OBJECT_MATERIAL material = m_objectMaterials[0];
+			material.tag = "benchmark_material_" + std::to_string(m_objectMaterials.size());
+			m_objectMaterials.push_back(material);
+		}
+
+		const std::string tag = m_objectMaterials[sweepCount - 1].tag;
+		std::string suffix = "/" + std::to_string(sweepCount) + " materials";
+		MicroBenchmark::Run("FindMaterial" + suffix, [this, &tag]()
+		{
+			OBJECT_MATERIAL material;
+			FindMaterial(tag, material);
+			MicroBenchmark::DoNotOptimize(material);
+		});
+		MicroBenchmark::Run("SetShaderMaterial" + suffix, [this, &tag]()
+		{
+			SetShaderMaterial(tag);
+		});
+
+		sweepCount *= BENCHMARK_MATERIAL_GROWTH;
+	}
+	m_objectMaterials.resize(materialCount);
 
-	// Error loading the image
-	return false;
+	// every slot of the texture list is filled for the sweep
+	const int textureCapacity = (int)(sizeof(m_textureIDs) / sizeof(m_textureIDs[0]));
+	int loadedTextures = m_loadedTextures;
+	std::vector<TEXTURE_INFO> textureIDs(m_textureIDs, m_textureIDs + textureCapacity);
+	for (int slot = loadedTextures; slot < textureCapacity; slot++)
+	{
+		m_textureIDs[slot].tag = "benchmark_texture_" + std::to_string(slot);
+		m_textureIDs[slot].ID = 0;
+	}
+	for (int textureCount = 1; textureCount <= textureCapacity; textureCount *= 2)
+	{
+		m_loadedTextures = textureCount;
+		const std::string tag = m_textureIDs[textureCount - 1].tag;
+		MicroBenchmark::Run("FindTextureSlot/" + std::to_string(textureCount) + " textures", [this, &tag]()
+		{
+			int slot = FindTextureSlot(tag);
+			MicroBenchmark::DoNotOptimize(slot);
+		});
+	}
+	std::copy(textureIDs.begin(), textureIDs.end(), m_textureIDs);
+	m_loadedTextures = loadedTextures;
+	m_pRenderBackend = pRenderBackend;
 }
 
 /***********************************************************
@@ -131,6 +656,11 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
  ***********************************************************/
 void SceneManager::BindGLTextures()
 {
+	if (!m_pRenderBackend->IsGpuBackend())
+	{
+		return;
+	}
+
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
 		// bind textures on corresponding texture units
@@ -143,14 +673,34 @@ void SceneManager::BindGLTextures()
  *  DestroyGLTextures()
  *
  *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  used texture memory slots. The textures are deleted once
+ *  the frames that may still sample them have finished, and
+ *  only by the scene that created them.
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	m_ownedTextures.clear();
+	m_textureFiles.clear();
+	m_textureAliases.clear();
+	m_loadedTextures = 0;
+}
+
+/***********************************************************
+ *  ResolveTextureTag()
+ *
+ *  This method is used for getting the tag of the texture
+ *  that the passed in tag uses, which is the tag itself
+ *  unless it was found to be a copy of another texture.
+ ***********************************************************/
+const std::string& SceneManager::ResolveTextureTag(const std::string& tag) const
+{
+	std::map<std::string, std::string>::const_iterator alias = m_textureAliases.find(tag);
+	if (alias != m_textureAliases.end())
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		return(alias->second);
 	}
+
+	return(tag);
 }
 
 /***********************************************************
@@ -165,6 +715,8 @@ int SceneManager::FindTextureID(std::string tag)
 	int index = 0;
 	bool bFound = false;
 
+	tag = ResolveTextureTag(tag);
+
 	while ((index < m_loadedTextures) && (bFound == false))
 	{
 		if (m_textureIDs[index].tag.compare(tag) == 0)
@@ -191,6 +743,8 @@ int SceneManager::FindTextureSlot(std::string tag)
 	int index = 0;
 	bool bFound = false;
 
+	tag = ResolveTextureTag(tag);
+
 	while ((index < m_loadedTextures) && (bFound == false))
 	{
 		if (m_textureIDs[index].tag.compare(tag) == 0)
@@ -230,6 +784,8 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 			material.diffuseColor = m_objectMaterials[index].diffuseColor;
 			material.specularColor = m_objectMaterials[index].specularColor;
 			material.shininess = m_objectMaterials[index].shininess;
+			material.samplerTier = m_objectMaterials[index].samplerTier;
+			material.samplerWrap = m_objectMaterials[index].samplerWrap;
 		}
 		else
 		{
@@ -237,16 +793,16 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 		}
 	}
 
-	return(true);
+	return(bFound);
 }
 
 /***********************************************************
- *  SetTransformations()
+ *  BuildModelMatrix()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for combining the passed in
+ *  transformation values into a model matrix.
  ***********************************************************/
-void SceneManager::SetTransformations(
+glm::mat4 SceneManager::BuildModelMatrix(
 	glm::vec3 scaleXYZ,
 	float XrotationDegrees,
 	float YrotationDegrees,
@@ -254,7 +810,6 @@ void SceneManager::SetTransformations(
 	glm::vec3 positionXYZ)
 {
 	// variables for this method
-	glm::mat4 modelView;
 	glm::mat4 scale;
 	glm::mat4 rotationX;
 	glm::mat4 rotationY;
@@ -270,11 +825,35 @@ void SceneManager::SetTransformations(
 	// set the translation value in the transform buffer
 	translation = glm::translate(positionXYZ);
 
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
+	return(translation * rotationX * rotationY * rotationZ * scale);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 modelView;
+
+	modelView = BuildModelMatrix(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
 
-	if (NULL != m_pShaderManager)
+	if (NULL != m_pRenderBackend)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		m_pRenderBackend->SetMat4Value(g_ModelName, modelView);
 	}
 }
 
@@ -298,10 +877,10 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
-	if (NULL != m_pShaderManager)
+	if (NULL != m_pRenderBackend)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		m_pRenderBackend->SetIntValue(g_UseTextureName, false);
+		m_pRenderBackend->SetVec4Value(g_ColorValueName, currentColor);
 	}
 }
 
@@ -312,15 +891,16 @@ void SceneManager::SetShaderColor(
  *  associated with the passed in ID into the shader.
  ***********************************************************/
 void SceneManager::SetShaderTexture(
+	RenderBackend* pBackend,
 	std::string textureTag)
 {
-	if (NULL != m_pShaderManager)
+	if (NULL != pBackend)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		pBackend->SetIntValue(g_UseTextureName, true);
 
 		int textureID = -1;
 		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		pBackend->SetSampler2DValue(g_TextureValueName, textureID);
 	}
 }
 
@@ -330,11 +910,11 @@ void SceneManager::SetShaderTexture(
  *  This method is used for setting the texture UV scale
  *  values into the shader.
  ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
+void SceneManager::SetTextureUVScale(RenderBackend* pBackend, float u, float v)
 {
-	if (NULL != m_pShaderManager)
+	if (NULL != pBackend)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		pBackend->SetVec2Value("UVscale", glm::vec2(u, v));
 	}
 }
 
@@ -345,9 +925,10 @@ void SceneManager::SetTextureUVScale(float u, float v)
  *  into the shader.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
+	RenderBackend* pBackend,
 	std::string materialTag)
 {
-	if (m_objectMaterials.size() > 0)
+	if ((NULL != pBackend) && (m_objectMaterials.size() > 0))
 	{
 		OBJECT_MATERIAL material;
 		bool bReturn = false;
@@ -355,66 +936,531 @@ void SceneManager::SetShaderMaterial(
 		bReturn = FindMaterial(materialTag, material);
 		if (bReturn == true)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			pBackend->SetVec3Value("material.ambientColor", material.ambientColor);
+			pBackend->SetFloatValue("material.ambientStrength", material.ambientStrength);
+			pBackend->SetVec3Value("material.diffuseColor", material.diffuseColor);
+			pBackend->SetVec3Value("material.specularColor", material.specularColor);
+			pBackend->SetFloatValue("material.shininess", material.shininess);
 		}
 	}
 }
 
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-void SceneManager::LoadSceneTextures()
+/***********************************************************
+ *  SetTextureSampler()
+ *
+ *  This method is used for binding the sampler of the
+ *  material's filtering tier to the texture unit of the
+ *  passed in texture. The sampler replaces the filtering and
+ *  wrapping that are stored in the texture.
+ ***********************************************************/
+void SceneManager::SetTextureSampler(
+	RenderBackend* pBackend,
+	const std::string& materialTag,
+	const std::string& textureTag)
 {
+	OBJECT_MATERIAL material;
+	int textureSlot = FindTextureSlot(textureTag);
 
-	bool bReturn = false;
+	if ((textureSlot >= 0) && (FindMaterial(materialTag, material) == true))
+	{
+		pBackend->BindSampler(textureSlot, material.samplerTier, material.samplerWrap);
+	}
+}
 
-	// This loads the grass texture for the main ground plane.
-	bReturn = CreateGLTexture("textures/plants_grass_seamless.jpg", "grass");
+/***********************************************************
+ *  DrawVirtualGround()
+ *
+ *  This method is used for drawing an object with the
+ *  virtual texture of the ground and its material. The
+ *  scene program is used again afterwards.
+ ***********************************************************/
+void SceneManager::DrawVirtualGround(
+	const DRAW_COMMAND& command,
+	const glm::mat4& viewProjection)
+{
+	OBJECT_MATERIAL material;
+	if ((NULL == m_pVirtualGround) || (FindMaterial(command.materialTag, material) == false))
+	{
+		return;
+	}
 
-	// This loads the dirt/soil texture for the brown ground patch.
-	bReturn = CreateGLTexture("textures/dirt.jpg", "dirt");
+	m_pVirtualGround->BeginDraw(viewProjection, material.ambientColor, material.ambientStrength, material.diffuseColor);
+	m_pVirtualGround->SetModel(command.model);
+	DrawMesh(command.mesh);
+	m_pVirtualGround->EndDraw();
+}
 
-	// This loads the brick texture for the decorative path.
-	bReturn = CreateGLTexture("textures/brick.jpg", "brick");
+/***********************************************************
+ *  DrawBakedObjects()
+ *
+ *  This method is used for drawing the objects visible in
+ *  any of the passed in views with the baked lightmap. They
+ *  are drawn in one batch, so the program only changes
+ *  twice, and their place in the draw list is their object
+ *  in the lightmap. The scene program is used again
+ *  afterwards.
+ ***********************************************************/
+void SceneManager::DrawBakedObjects(
+	uint32_t viewBits,
+	const glm::mat4& viewProjection)
+{
+	const std::string* pLastMaterial = NULL;
+	const std::string* pLastTexture = NULL;
 
-	// This loads the hedge/foliage texture for the rectangular hedge bush.
-	bReturn = CreateGLTexture("textures/plants_hedge_seamless.jpg", "hedge");
+	m_pBakedLighting->BeginDraw(viewProjection);
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
 
-	// This loads a second foliage texture for the pyramid bush (variation adds realism).
-	bReturn = CreateGLTexture("textures/foliage.jpg", "foliage");
+		if (((m_visibleViews[i] & viewBits) == 0) || (command.textureTag == g_VirtualGroundTag))
+		{
+			continue;
+		}
 
-	// This binds all of the loaded textures to their respective slots.
-	BindGLTextures();
+		bool bSamplerChanged = false;
+		if ((pLastMaterial == NULL) || (pLastMaterial->compare(command.materialTag) != 0))
+		{
+			OBJECT_MATERIAL material;
+			if (FindMaterial(command.materialTag, material) == true)
+			{
+				m_pBakedLighting->SetMaterial(material.ambientColor, material.ambientStrength, material.diffuseColor);
+			}
+			pLastMaterial = &command.materialTag;
+			bSamplerChanged = true;
+		}
+		if ((pLastTexture == NULL) || (pLastTexture->compare(command.textureTag) != 0))
+		{
+			int textureSlot = FindTextureSlot(command.textureTag);
+			m_pBakedLighting->SetTexture((textureSlot >= 0) ? textureSlot : 0);
+			pLastTexture = &command.textureTag;
+			bSamplerChanged = true;
+		}
+		if (bSamplerChanged)
+		{
+			SetTextureSampler(command.materialTag, command.textureTag);
+		}
+
+		m_pBakedLighting->SetObject((int)i, g_MeshPrimitives[command.mesh], command.model, command.uvScale);
+		DrawMesh(command.mesh);
+	}
+	m_pBakedLighting->EndDraw();
 }
 
 /***********************************************************
- *  DefineObjectMaterials()
+ *  DrawPointShadows()
  *
- *  This method is used for configuring the various material
- *  settings for all of the objects within the 3D scene.
+ *  This method is used for drawing the objects visible in
+ *  any of the passed in views again over themselves, taking
+ *  away the light of the point lights that their shadow
+ *  cubes hide. The virtual ground is not lit by the point
+ *  lights and is left out. The scene program is used again
+ *  afterwards.
  ***********************************************************/
-void SceneManager::DefineObjectMaterials()
+void SceneManager::DrawPointShadows(
+	uint32_t viewBits,
+	const glm::mat4& viewProjection,
+	const glm::vec3& viewPosition)
 {
-	/*** STUDENTS - add the code BELOW for defining object materials. ***/
-	/*** There is no limit to the number of object materials that can ***/
-	/*** be defined. Refer to the code in the OpenGL Sample for help ***/
+	const std::string* pLastMaterial = NULL;
+	const std::string* pLastTexture = NULL;
 
-	// Material for grass plane.
-	OBJECT_MATERIAL grassMaterial;
+	m_pPointShadows->BeginReceivers(viewProjection, viewPosition);
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+
+		if (((m_visibleViews[i] & viewBits) == 0) || (command.textureTag == g_VirtualGroundTag))
+		{
+			continue;
+		}
+
+		bool bSamplerChanged = false;
+		if ((pLastMaterial == NULL) || (pLastMaterial->compare(command.materialTag) != 0))
+		{
+			OBJECT_MATERIAL material;
+			if (FindMaterial(command.materialTag, material) == true)
+			{
+				m_pPointShadows->SetMaterial(material.diffuseColor, material.specularColor, material.shininess);
+			}
+			pLastMaterial = &command.materialTag;
+			bSamplerChanged = true;
+		}
+		if ((pLastTexture == NULL) || (pLastTexture->compare(command.textureTag) != 0))
+		{
+			int textureSlot = FindTextureSlot(command.textureTag);
+			m_pPointShadows->SetTexture((textureSlot >= 0) ? textureSlot : 0);
+			pLastTexture = &command.textureTag;
+			bSamplerChanged = true;
+		}
+		if (bSamplerChanged)
+		{
+			SetTextureSampler(command.materialTag, command.textureTag);
+		}
+
+		m_pPointShadows->SetObject(command.model, command.uvScale);
+		DrawMesh(command.mesh);
+	}
+	m_pPointShadows->EndReceivers();
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing the basic shape mesh
+ *  that is referenced by a draw command.
+ ***********************************************************/
+void SceneManager::DrawMesh(RenderBackend* pBackend, MESH_TYPE mesh)
+{
+	pBackend->DrawMesh(m_pMeshRegistry, m_meshHandles[mesh]);
+}
+
+/***********************************************************
+ *  CollectBakeObjects()
+ *
+ *  This method is used for getting the shape, placement and
+ *  diffuse color of every object of the draw list, in the
+ *  order of the list.
+ ***********************************************************/
+void SceneManager::CollectBakeObjects(std::vector<LightmapBaker::BAKE_OBJECT>& objects)
+{
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		OBJECT_MATERIAL material;
+		LightmapBaker::BAKE_OBJECT object;
+		object.primitive = g_MeshPrimitives[m_drawCommands[i].mesh];
+		object.model = m_drawCommands[i].model;
+		object.albedo = (FindMaterial(m_drawCommands[i].materialTag, material) == true) ? material.diffuseColor : glm::vec3(0.5f);
+		objects.push_back(object);
+	}
+}
+
+/***********************************************************
+ *  BakeLightmaps()
+ *
+ *  This method is used for baking the scene lights into a
+ *  lightmap for every object of the draw list, in the order
+ *  of the list. The objects drawn with the virtual ground
+ *  are baked as well, because the light they reflect onto
+ *  the other objects is part of the bounce.
+ ***********************************************************/
+void SceneManager::BakeLightmaps()
+{
+	std::vector<LightmapBaker::BAKE_OBJECT> objects;
+	CollectBakeObjects(objects);
+
+	LightmapBaker::BAKED_LIGHTMAP lightmap;
+	if (LightmapBaker::Bake(objects, m_bakeLights, lightmap) && m_bakedLighting.Initialize(lightmap))
+	{
+		m_bakedLighting.SetAmbientLight(m_bakeAmbientLight);
+		m_pBakedLighting = &m_bakedLighting;
+	}
+}
+
+/***********************************************************
+ *  BakeProbes()
+ *
+ *  This method is used for baking irradiance probes over
+ *  the bounds of the draw list. The ambient values of the
+ *  lights stand for the open sky, which the probes now hold,
+ *  so they are turned off in the shader.
+ ***********************************************************/
+void SceneManager::BakeProbes()
+{
+	if (m_drawCommands.empty())
+	{
+		return;
+	}
+
+	std::vector<LightmapBaker::BAKE_OBJECT> objects;
+	CollectBakeObjects(objects);
+
+	glm::vec3 boundsMin(0.0f);
+	glm::vec3 boundsMax(0.0f);
+	GetDrawListBounds(boundsMin, boundsMax);
+
+	ProbeBaker::PROBE_GRID grid;
+	if (!ProbeBaker::Bake(objects, m_bakeLights, m_bakeAmbientLight, boundsMin, boundsMax, grid) ||
+		!m_probeVolume.Initialize(grid))
+	{
+		return;
+	}
+	m_pProbeVolume = &m_probeVolume;
+
+	m_pRenderBackend->SetVec3Value("directionalLight.ambient", glm::vec3(0.0f));
+	m_pRenderBackend->SetVec3Value("pointLights[0].ambient", glm::vec3(0.0f));
+	m_pRenderBackend->SetVec3Value("pointLights[1].ambient", glm::vec3(0.0f));
+	if (NULL != m_pVirtualGround)
+	{
+		m_pVirtualGround->SetIrradianceVolume(m_pProbeVolume);
+	}
+
+	SampleProbeAmbient();
+}
+
+/***********************************************************
+ *  SampleProbeAmbient()
+ *
+ *  This method is used for lighting the ambient color of
+ *  every object from the probes at its center. The scene
+ *  program cannot sample the probes itself, so each object
+ *  gets one value, the average of every direction, except
+ *  for planes, which only face one way.
+ ***********************************************************/
+void SceneManager::SampleProbeAmbient()
+{
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		DRAW_COMMAND& command = m_drawCommands[i];
+
+		glm::vec3 normal(0.0f);
+		if (command.mesh == MESH_PLANE)
+		{
+			normal = glm::normalize(glm::vec3(glm::transpose(glm::inverse(command.model)) * glm::vec4(0.0f, 1.0f, 0.0f, 0.0f)));
+		}
+
+		OBJECT_MATERIAL material;
+		glm::vec3 diffuseColor = (FindMaterial(command.materialTag, material) == true) ? material.diffuseColor : glm::vec3(1.0f);
+		glm::vec3 center = (command.boundsMin + command.boundsMax) * 0.5f;
+		command.probeAmbient = m_pProbeVolume->SampleIrradiance(center, normal) * diffuseColor;
+	}
+}
+
+/***********************************************************
+ *  SetProbeAmbient()
+ *
+ *  This method is used for passing the probe lit ambient
+ *  color of an object into the shader, in place of the
+ *  ambient values of its material.
+ ***********************************************************/
+void SceneManager::SetProbeAmbient(RenderBackend* pBackend, const DRAW_COMMAND& command)
+{
+	pBackend->SetVec3Value("material.ambientColor", command.probeAmbient);
+	pBackend->SetFloatValue("material.ambientStrength", 1.0f);
+}
+
+/***********************************************************
+ *  GetDrawListBounds()
+ *
+ *  This method is used for getting the box around every
+ *  object of the draw list, which must not be empty.
+ ***********************************************************/
+void SceneManager::GetDrawListBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const
+{
+	boundsMin = m_drawCommands[0].boundsMin;
+	boundsMax = m_drawCommands[0].boundsMax;
+	for (size_t i = 1; i < m_drawCommands.size(); i++)
+	{
+		boundsMin = glm::min(boundsMin, m_drawCommands[i].boundsMin);
+		boundsMax = glm::max(boundsMax, m_drawCommands[i].boundsMax);
+	}
+}
+
+/***********************************************************
+ *  BakeVisibilitySets()
+ *
+ *  This method is used for baking the cells of the garden
+ *  that can be seen from each cell, with every object of
+ *  the draw list hiding what is behind it.
+ ***********************************************************/
+void SceneManager::BakeVisibilitySets()
+{
+	if (m_drawCommands.empty())
+	{
+		return;
+	}
+
+	std::vector<LightmapBaker::BAKE_OBJECT> objects;
+	CollectBakeObjects(objects);
+
+	glm::vec3 boundsMin(0.0f);
+	glm::vec3 boundsMax(0.0f);
+	GetDrawListBounds(boundsMin, boundsMax);
+
+	if (VisibilityBaker::Bake(objects, boundsMin, boundsMax, m_visibilityGrid))
+	{
+		BuildCellCommands();
+	}
+}
+
+/***********************************************************
+ *  BuildCellCommands()
+ *
+ *  This method is used for finding, for every cell, the
+ *  draw commands over any cell that can be seen from it, so
+ *  culling a view only masks its bits with the ones of the
+ *  cell of its camera.
+ ***********************************************************/
+void SceneManager::BuildCellCommands()
+{
+	const VisibilityBaker::VISIBILITY_GRID& grid = m_visibilityGrid;
+	int cellCount = grid.counts.x * grid.counts.y;
+
+	m_cellCommandWords = ((int)m_drawCommands.size() + 31) / 32;
+	m_cellCommands.assign((size_t)cellCount * m_cellCommandWords, 0);
+
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		glm::ivec2 first(0);
+		glm::ivec2 last(0);
+		VisibilityBaker::GetCellRange(grid, m_drawCommands[i].boundsMin, m_drawCommands[i].boundsMax, first, last);
+
+		for (int fromCell = 0; fromCell < cellCount; fromCell++)
+		{
+			bool bVisible = false;
+			for (int z = first.y; (z <= last.y) && !bVisible; z++)
+			{
+				for (int x = first.x; (x <= last.x) && !bVisible; x++)
+				{
+					bVisible = VisibilityBaker::IsCellVisible(grid, fromCell, z * grid.counts.x + x);
+				}
+			}
+			if (bVisible)
+			{
+				m_cellCommands[(size_t)fromCell * m_cellCommandWords + i / 32] |= (1u << (i % 32));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildOcclusionClusters()
+ *
+ *  This method is used for grouping the objects of the draw
+ *  list by the ground cell their middle is over, and making
+ *  the queries of the groups. The planes and the hedges are
+ *  left out, they are what hides the clusters and are drawn
+ *  first in every frame.
+ ***********************************************************/
+void SceneManager::BuildOcclusionClusters()
+{
+	m_occlusionClusters.clear();
+	m_pOcclusionCulling = NULL;
+
+	std::map<std::pair<int, int>, int> cellClusters;
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		DRAW_COMMAND& command = m_drawCommands[i];
+		command.occlusionCluster = -1;
+		if ((command.mesh == MESH_PLANE) || (command.textureTag == g_OccluderTextureTag))
+		{
+			continue;
+		}
+
+		glm::vec3 center = (command.boundsMin + command.boundsMax) * 0.5f;
+		std::pair<int, int> cell(
+			(int)floorf(center.x / OCCLUSION_CELL_SIZE),
+			(int)floorf(center.z / OCCLUSION_CELL_SIZE));
+
+		std::map<std::pair<int, int>, int>::iterator found = cellClusters.find(cell);
+		if (found == cellClusters.end())
+		{
+			OCCLUSION_CLUSTER cluster;
+			cluster.boundsMin = command.boundsMin;
+			cluster.boundsMax = command.boundsMax;
+			cluster.bTested = false;
+			m_occlusionClusters.push_back(cluster);
+			found = cellClusters.insert(std::make_pair(cell, (int)m_occlusionClusters.size() - 1)).first;
+		}
+
+		OCCLUSION_CLUSTER& cluster = m_occlusionClusters[found->second];
+		cluster.boundsMin = glm::min(cluster.boundsMin, command.boundsMin);
+		cluster.boundsMax = glm::max(cluster.boundsMax, command.boundsMax);
+		cluster.commands.push_back(i);
+		command.occlusionCluster = found->second;
+	}
+
+	if (m_occlusionClusters.empty() ||
+		!m_occlusionCulling.Initialize((int)m_occlusionClusters.size()))
+	{
+		return;
+	}
+	m_pOcclusionCulling = &m_occlusionCulling;
+
+	std::cout << "INFO: Occlusion culling " << m_occlusionClusters.size() << " clusters of objects" << std::endl;
+}
+
+/***********************************************************
+ *  InitializePointShadows()
+ *
+ *  This method is used for creating the shadow cubes of the
+ *  point lights. The lights do not fade with distance, so
+ *  the range of each one reaches the farthest corner of the
+ *  bounds of the draw list.
+ ***********************************************************/
+void SceneManager::InitializePointShadows()
+{
+	m_pPointShadows = NULL;
+
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	GetDrawListBounds(boundsMin, boundsMax);
+
+	std::vector<PointShadows::SHADOW_LIGHT> lights = m_shadowLights;
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		glm::vec3 farthest = glm::max(glm::abs(boundsMin - lights[i].position), glm::abs(boundsMax - lights[i].position));
+		lights[i].range = glm::length(farthest);
+	}
+
+	if (m_pointShadows.Initialize(lights, m_pointShadowBudget))
+	{
+		m_pPointShadows = &m_pointShadows;
+	}
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+void SceneManager::LoadSceneTextures()
+{
+
+	bool bReturn = false;
+
+	// This loads the grass texture for the main ground plane.
+	bReturn = CreateGLTexture("textures/plants_grass_seamless.jpg", "grass");
+
+	// This loads the dirt/soil texture for the brown ground patch.
+	bReturn = CreateGLTexture("textures/dirt.jpg", "dirt");
+
+	// This loads the brick texture for the decorative path.
+	bReturn = CreateGLTexture("textures/brick.jpg", "brick");
+
+	// This loads the hedge/foliage texture for the rectangular hedge bush.
+	bReturn = CreateGLTexture("textures/plants_hedge_seamless.jpg", "hedge");
+
+	// This loads a second foliage texture for the pyramid bush (variation adds realism).
+	bReturn = CreateGLTexture("textures/foliage.jpg", "foliage");
+
+	// This binds all of the loaded textures to their respective slots.
+	BindGLTextures();
+}
+
+/***********************************************************
+ *  DefineObjectMaterials()
+ *
+ *  This method is used for configuring the various material
+ *  settings for all of the objects within the 3D scene.
+ ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	/*** STUDENTS - add the code BELOW for defining object materials. ***/
+	/*** There is no limit to the number of object materials that can ***/
+	/*** be defined. Refer to the code in the OpenGL Sample for help ***/
+
+	// Material for grass plane.
+	OBJECT_MATERIAL grassMaterial;
 	grassMaterial.ambientColor = glm::vec3(0.4f, 0.6f, 0.3f);
 	grassMaterial.ambientStrength = 0.03f; // Extremely low
 	grassMaterial.diffuseColor = glm::vec3(0.4f, 0.6f, 0.3f);
 	grassMaterial.specularColor = glm::vec3(0.35f, 0.45f, 0.35f);
 	grassMaterial.shininess = 5.0;
 	grassMaterial.tag = "grass";
+	grassMaterial.samplerTier = SAMPLER_TIER_ANISOTROPIC_16X; // The grass is tiled and seen at low angles, so it gets the best filtering.
+	grassMaterial.samplerWrap = SAMPLER_WRAP_REPEAT;
 	m_objectMaterials.push_back(grassMaterial);
 
 	// Material for dirt/soil - the darkest shadows possible.
@@ -425,6 +1471,8 @@ void SceneManager::DefineObjectMaterials()
 	dirtMaterial.specularColor = glm::vec3(0.18f, 0.18f, 0.18f);
 	dirtMaterial.shininess = 1.2;
 	dirtMaterial.tag = "dirt";
+	dirtMaterial.samplerTier = SAMPLER_TIER_ANISOTROPIC_8X;
+	dirtMaterial.samplerWrap = SAMPLER_WRAP_REPEAT;
 	m_objectMaterials.push_back(dirtMaterial);
 
 	// Material for brick.
@@ -435,6 +1483,8 @@ void SceneManager::DefineObjectMaterials()
 	brickMaterial.specularColor = glm::vec3(0.45f, 0.35f, 0.35f);
 	brickMaterial.shininess = 4.0;
 	brickMaterial.tag = "brick";
+	brickMaterial.samplerTier = SAMPLER_TIER_ANISOTROPIC_4X;
+	brickMaterial.samplerWrap = SAMPLER_WRAP_REPEAT;
 	m_objectMaterials.push_back(brickMaterial);
 
 	// Material for the hedge foliage.
@@ -445,6 +1495,8 @@ void SceneManager::DefineObjectMaterials()
 	hedgeMaterial.specularColor = glm::vec3(0.22f, 0.32f, 0.22f);
 	hedgeMaterial.shininess = 3.0;
 	hedgeMaterial.tag = "hedge";
+	hedgeMaterial.samplerTier = SAMPLER_TIER_TRILINEAR;
+	hedgeMaterial.samplerWrap = SAMPLER_WRAP_REPEAT;
 	m_objectMaterials.push_back(hedgeMaterial);
 
 	// Material for the pyramid foliage.
@@ -455,6 +1507,8 @@ void SceneManager::DefineObjectMaterials()
 	foliageMaterial.specularColor = glm::vec3(0.28f, 0.35f, 0.28f);
 	foliageMaterial.shininess = 7.0; // This is high for the brilliant highlights.
 	foliageMaterial.tag = "foliage";
+	foliageMaterial.samplerTier = SAMPLER_TIER_TRILINEAR;
+	foliageMaterial.samplerWrap = SAMPLER_WRAP_REPEAT;
 	m_objectMaterials.push_back(foliageMaterial);
 }
 
@@ -469,398 +1523,1023 @@ void SceneManager::SetupSceneLights()
 	// This line of code is NEEDED for telling the shaders to render
 	// the 3D scene with custom lighting. If no light sources have
 	// been added then the display window will be black.
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	m_pRenderBackend->SetBoolValue(g_UseLightingName, true);
 
 	/*** STUDENTS - add the code BELOW for setting up light sources ***/
 
 	// This is more dramatic directional light.
-	m_pShaderManager->setVec3Value("directionalLight.direction", -0.5f, -1.0f, -0.3f);
-	m_pShaderManager->setVec3Value("directionalLight.ambient", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setVec3Value("directionalLight.diffuse", 1.5f, 1.5f, 1.4f);  // I increased this.
-	m_pShaderManager->setVec3Value("directionalLight.specular", 1.0f, 1.0f, 1.0f);
-	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
+	glm::vec3 lightDirection(-0.5f, -1.0f, -0.3f);
+	glm::vec3 lightAmbient(0.2f, 0.2f, 0.2f);
+	glm::vec3 lightDiffuse(1.5f, 1.5f, 1.4f);  // I increased this.
+	m_pRenderBackend->SetVec3Value("directionalLight.direction", lightDirection);
+	m_pRenderBackend->SetVec3Value("directionalLight.ambient", lightAmbient);
+	m_pRenderBackend->SetVec3Value("directionalLight.diffuse", lightDiffuse);
+	m_pRenderBackend->SetVec3Value("directionalLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
+	m_pRenderBackend->SetBoolValue("directionalLight.bActive", true);
 
 	// This is the fill light.
-	m_pShaderManager->setVec3Value("pointLights[0].position", 3.5f, 5.0f, 1.5f);
-	m_pShaderManager->setVec3Value("pointLights[0].ambient", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("pointLights[0].diffuse", 0.4f, 0.4f, 0.35f);
-	m_pShaderManager->setVec3Value("pointLights[0].specular", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setBoolValue("pointLights[0].bActive", true);
+	glm::vec3 fillPosition(3.5f, 5.0f, 1.5f);
+	glm::vec3 fillAmbient(0.1f, 0.1f, 0.1f);
+	glm::vec3 fillDiffuse(0.4f, 0.4f, 0.35f);
+	glm::vec3 fillSpecular(0.3f, 0.3f, 0.3f);
+	m_pRenderBackend->SetVec3Value("pointLights[0].position", fillPosition);
+	m_pRenderBackend->SetVec3Value("pointLights[0].ambient", fillAmbient);
+	m_pRenderBackend->SetVec3Value("pointLights[0].diffuse", fillDiffuse);
+	m_pRenderBackend->SetVec3Value("pointLights[0].specular", fillSpecular);
+	m_pRenderBackend->SetBoolValue("pointLights[0].bActive", true);
 
 	// This is a warm-colored fill light for the left side.
-	m_pShaderManager->setVec3Value("pointLights[1].position", -3.5f, 5.0f, 6.5f);
-	m_pShaderManager->setVec3Value("pointLights[1].ambient", 0.15f, 0.1f, 0.05f);
-	m_pShaderManager->setVec3Value("pointLights[1].diffuse", 0.8f, 0.6f, 0.3f);  // This is a Warm orange/amber color.
-	m_pShaderManager->setVec3Value("pointLights[1].specular", 0.4f, 0.3f, 0.2f);
-	m_pShaderManager->setBoolValue("pointLights[1].bActive", true);
+	glm::vec3 warmPosition(-3.5f, 5.0f, 6.5f);
+	glm::vec3 warmAmbient(0.15f, 0.1f, 0.05f);
+	glm::vec3 warmDiffuse(0.8f, 0.6f, 0.3f);  // This is a Warm orange/amber color.
+	glm::vec3 warmSpecular(0.4f, 0.3f, 0.2f);
+	m_pRenderBackend->SetVec3Value("pointLights[1].position", warmPosition);
+	m_pRenderBackend->SetVec3Value("pointLights[1].ambient", warmAmbient);
+	m_pRenderBackend->SetVec3Value("pointLights[1].diffuse", warmDiffuse);
+	m_pRenderBackend->SetVec3Value("pointLights[1].specular", warmSpecular);
+	m_pRenderBackend->SetBoolValue("pointLights[1].bActive", true);
+
+	// the virtual ground is drawn by its own program, which is
+	// lit by the directional light only
+	if (NULL != m_pVirtualGround)
+	{
+		m_pVirtualGround->SetDirectionalLight(lightDirection, lightAmbient, lightDiffuse);
+	}
+
+	// the same lights are baked into the lightmaps, none of them
+	// move, so only their ambient light is left for the shader
+	LightmapBaker::BAKE_LIGHT directionalLight = { true, lightDirection, lightDiffuse };
+	LightmapBaker::BAKE_LIGHT fillLight = { false, fillPosition, fillDiffuse };
+	LightmapBaker::BAKE_LIGHT warmLight = { false, warmPosition, warmDiffuse };
+	m_bakeLights.clear();
+	m_bakeLights.push_back(directionalLight);
+	m_bakeLights.push_back(fillLight);
+	m_bakeLights.push_back(warmLight);
+	m_bakeAmbientLight = lightAmbient + fillAmbient + warmAmbient;
+
+	// the point lights cast shadows over a range that is only
+	// known once the draw list is built
+	PointShadows::SHADOW_LIGHT fillShadow = { fillPosition, fillDiffuse, fillSpecular, 0.0f };
+	PointShadows::SHADOW_LIGHT warmShadow = { warmPosition, warmDiffuse, warmSpecular, 0.0f };
+	m_shadowLights.clear();
+	m_shadowLights.push_back(fillShadow);
+	m_shadowLights.push_back(warmShadow);
 }
 
 /***********************************************************
- *  PrepareScene()
+ *  LoadSceneMeshes()
  *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
+ *  This method is used for loading the basic shape meshes
+ *  into the current OpenGL context.
  ***********************************************************/
-void SceneManager::PrepareScene()
+void SceneManager::LoadSceneMeshes()
 {
 	// only one instance of a particular mesh needs to be
 	// loaded in memory no matter how many times it is drawn
 	// in the rendered 3D scene.
+	// The mesh registry makes sure of that, a mesh that is
+	// already loaded is only referenced again.
 	//This loads all the meshes that will be used in the scene.
-	m_basicMeshes->LoadPlaneMesh();//This loads in the plane.
-	m_basicMeshes->LoadBoxMesh();//I added this to load the boxes to create a rectangle. 
-	m_basicMeshes->LoadPyramid4Mesh();//I added this to load the pyramid to make the pyramid bush. 
+	m_meshHandles[MESH_PLANE] = m_pMeshRegistry->Acquire(MeshRegistry::MESH_PRIMITIVE_PLANE);//This loads in the plane.
+	m_meshHandles[MESH_BOX] = m_pMeshRegistry->Acquire(MeshRegistry::MESH_PRIMITIVE_BOX);//I added this to load the boxes to create a rectangle. 
+	m_meshHandles[MESH_PYRAMID4] = m_pMeshRegistry->Acquire(MeshRegistry::MESH_PRIMITIVE_PYRAMID4);//I added this to load the pyramid to make the pyramid bush. 
 	//I added the LoadPyramid4Mesh to go from a 3-sided pyramid to a 4-sided pyramid.
-	m_basicMeshes->LoadConeMesh(); // I added this line to load the cone mesh in.
+	m_meshHandles[MESH_CONE] = m_pMeshRegistry->Acquire(MeshRegistry::MESH_PRIMITIVE_CONE); // I added this line to load the cone mesh in.
+
+	m_pMeshRegistry->Report();
+}
+
+/***********************************************************
+ *  PrepareSharedScene()
+ *
+ *  This method is used for preparing the 3D scene for a
+ *  window whose context shares objects with the window of
+ *  the passed in scene. The textures, materials and shader
+ *  program are reused rather than loaded again. Vertex
+ *  array objects cannot be shared between contexts, and
+ *  ShapeMeshes creates them together with their small vertex
+ *  buffers, so the basic meshes are loaded for this context.
+ ***********************************************************/
+void SceneManager::PrepareSharedScene(const SceneManager* pSourceScene)
+{
+	LoadSceneMeshes();
+
+	// reuse the texture objects of the source scene, only the
+	// binding of texture units is state of this context
+	m_loadedTextures = pSourceScene->m_loadedTextures;
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		m_textureIDs[i] = pSourceScene->m_textureIDs[i];
+	}
+	m_textureAliases = pSourceScene->m_textureAliases;
+	BindGLTextures();
+
+	// the light values are stored in the shared shader program,
+	// so only the material definitions need to be copied
+	m_objectMaterials = pSourceScene->m_objectMaterials;
+
+	// sampler objects are shared between the contexts as well
+	m_pTextureSamplers = pSourceScene->m_pTextureSamplers;
+	m_glBackend.SetTextureSamplers(m_pTextureSamplers);
+	m_pVirtualGround = pSourceScene->m_pVirtualGround;
+	// so are the lightmap atlas and its program, and the draw
+	// list is built in the same order the lightmap was baked in
+	m_pBakedLighting = pSourceScene->m_pBakedLighting;
+	m_pProbeVolume = pSourceScene->m_pProbeVolume;
+
+	BuildDrawList();
+	if (NULL != m_pProbeVolume)
+	{
+		SampleProbeAmbient();
+	}
+	// queries are not shared, so this window makes its own
+	if (pSourceScene->m_bOcclusionCulling)
+	{
+		BuildOcclusionClusters();
+	}
+	// the draw list is in the same order, so the bits of the
+	// commands are found again for the same cells
+	if (!pSourceScene->m_visibilityGrid.visibleCells.empty())
+	{
+		m_visibilityGrid = pSourceScene->m_visibilityGrid;
+		BuildCellCommands();
+	}
+	// the framebuffer of the cubes is not shared, so this window
+	// makes and draws its own
+	if (NULL != pSourceScene->m_pPointShadows)
+	{
+		m_pointShadowBudget = pSourceScene->m_pointShadowBudget;
+		m_shadowLights = pSourceScene->m_shadowLights;
+		InitializePointShadows();
+	}
+}
+
+/***********************************************************
+ *  PrepareHeadlessScene()
+ *
+ *  This method is used for preparing the scene for a render
+ *  backend without a GPU. The textures only get their slots
+ *  and no meshes, samplers or baked lighting are loaded, so
+ *  the draw list and the shader values of every frame are
+ *  the same as in a window without the optional features.
+ ***********************************************************/
+void SceneManager::PrepareHeadlessScene()
+{
+	LoadSceneTextures();
+	DefineObjectMaterials();
+	SetupSceneLights();
+	BuildDrawList();
+}
 
-	// This loads all of the textures for the scene.
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// This loads all of the textures for the scene, they are
+	// prepared on worker threads while the rest is loaded.
 	LoadSceneTextures();
+
+	// This loads all the meshes that will be used in the scene.
+	LoadSceneMeshes();
+
 	DefineObjectMaterials();// This loads all of the materials for the scene.
+	m_textureSamplers.Initialize();// This creates the texture filtering of the materials.
+	// This opens the streamed ground image, if one was given.
+	if (!m_virtualGroundFile.empty() && m_virtualGround.Initialize(m_virtualGroundFile.c_str()))
+	{
+		m_pVirtualGround = &m_virtualGround;
+	}
 	SetupSceneLights();// This loads all of the lights for the scene.
-	
+	BuildDrawList();// This builds the objects of the scene once for every view.
+	// This bakes the lights into lightmaps for the static objects, if asked for.
+	if (m_bBakeLighting)
+	{
+		BakeLightmaps();
+	}
+	// This bakes the probes of the ambient light, if asked for.
+	if (m_bBakeProbes)
+	{
+		BakeProbes();
+	}
+	// This groups the objects behind the hedges for occlusion culling, if asked for.
+	if (m_bOcclusionCulling)
+	{
+		BuildOcclusionClusters();
+	}
+	// This bakes the cells of the garden that can see each other, if asked for.
+	if (m_bVisibilitySets)
+	{
+		BakeVisibilitySets();
+	}
+	// This lets the point lights cast shadows, if asked for, the
+	// lightmaps already have them.
+	if (m_bPointShadows && (NULL == m_pBakedLighting))
+	{
+		InitializePointShadows();
+	}
+
+	// This uploads the textures once they are ready.
+	if (!FinishTextureLoads())
+	{
+		std::cout << "ERROR: Some scene textures could not be loaded" << std::endl;
+	}
 }
 
 /***********************************************************
- *  RenderScene()
+ *  BuildDrawList()
  *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
+ *  This method is used for building the list of objects in
+ *  the 3D scene by transforming the basic 3D shapes. The
+ *  list is built once and shared by every rendered view.
  ***********************************************************/
-void SceneManager::RenderScene()
-{
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-
-/******************************************************************/
-/* THIS IS THE MAIN GRASS GROUND PLANE WITH TILED TEXTURE AND     
-LIGHTING.                                                         */
-/******************************************************************/
-	
-/******************************************************************/
-/* I RENDERED THE MAIN GRASS GROUND PLANE WITH TILED TEXTURE.     */
-/******************************************************************/
-
-	// I set the scale for the main ground plane.
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 15.0f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-
-	// I applied transformations.
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	// I set the UV scale to tile the grass texture across the large plane.
-	// This creates a realistic tiled grass effect (COMPLEX TEXTURING TECHNIQUE - TILING).
-	SetTextureUVScale(4.0f, 2.0f);
-
-	// I applied the material properties for the grass with lighting.
-	SetShaderMaterial("grass");
-
-	// I applied the grass texture.
-	SetShaderTexture("grass");
-
-	// This draws the textured ground plane.
-	m_basicMeshes->DrawPlaneMesh();
-
-/******************************************************************/
-/* THIS IS THE BROWN/TAN DIRT PATCH WITH TEXTURE AND LIGHTING.    */
-/******************************************************************/
-
-/******************************************************************/
-/* I RENDERED THE BROWN/TAN DIRT PATCH WITH TEXTURE.              */
-/******************************************************************/
-
-	// I set the scale for the dirt patch under the topiary.
-	scaleXYZ = glm::vec3(8.0f, 3.5f, 8.0f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	// I positioned the dirt slightly above grass to prevent z-fighting.
-	positionXYZ = glm::vec3(0.0f, 0.02f, 6.5f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	// I set the UV scale for dirt texture tiling.
-	SetTextureUVScale(2.0f, 2.0f);
-
-	// I applied the material properties for dirt with lighting.
-	SetShaderMaterial("dirt");
-
-	// I applied the dirt texture.
-	SetShaderTexture("dirt");
-
-	// This draws the dirt patch.
-	m_basicMeshes->DrawPlaneMesh();
-
-/******************************************************************/
-/* THIS IS THE BRICK PATH WITH TEXTURE AND LIGHTING 
-(45 DEGREE ANGLE).                                                */
-/******************************************************************/
-
-/******************************************************************/
-/* I RENDERED THE BRICK PATH WITH TEXTURE AT A (45 DEGREE ANGLE). */
-/******************************************************************/
-
-	// This does the brick dimensions and rotation.
-	scaleXYZ = glm::vec3(0.5f, 0.15f, 0.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;// I rotated to match the topiary orientation.
-	ZrotationDegrees = 0.0f;
-
-	// I set the UV scale for individual brick texture mapping.
-	SetTextureUVScale(1.0f, 1.0f);
-
-	// I applied the material properties for bricks with lighting.
-	SetShaderMaterial("brick");
-
-	// I applied the brick texture that (will be used for all bricks).
-	SetShaderTexture("brick");
-
-	// THIS IS BRICK PATH - ROW 1.
-	// This is brick 1.
-	positionXYZ = glm::vec3(-1.2f, 0.08f, 7.2f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is brick 2.
-	positionXYZ = glm::vec3(-1.6f, 0.08f, 7.6f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is brick 3.
-	positionXYZ = glm::vec3(-2.0f, 0.08f, 8.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is brick 4.
-	positionXYZ = glm::vec3(-2.4f, 0.08f, 8.4f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is brick 5.
-	positionXYZ = glm::vec3(-2.8f, 0.08f, 8.8f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// THIS IS BRICK PATH - ROW 2.
-	// This is brick 1.
-	positionXYZ = glm::vec3(-0.8f, 0.08f, 7.6f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is brick 2.
-	positionXYZ = glm::vec3(-1.2f, 0.08f, 8.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is brick 3.
-	positionXYZ = glm::vec3(-1.6f, 0.08f, 8.4f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is brick 4.
-	positionXYZ = glm::vec3(-2.0f, 0.08f, 8.8f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is brick 5.
-	positionXYZ = glm::vec3(-2.4f, 0.08f, 9.2f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-	
-/******************************************************************/
-/* I RENDERED THE COMPLEX TOPIARY OBJECT OF THE 
-   (RECTANGULAR + PYRAMID).                                       */
-/* I demonstrated COHESIVE OBJECT with DIFFERENT TEXTURES.        */
-/******************************************************************/
-
-	// This is the rectangular hedge bush or the (Bottom component).
-	scaleXYZ = glm::vec3(2.0f, 1.0f, 1.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;// I rotated to match scene orientation.
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 0.75f, 6.5f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	// I set the UV scale for the hedge texture.
-	SetTextureUVScale(2.0f, 1.0f);
-
-	// I applied the material properties for hedge with lighting.
-	SetShaderMaterial("hedge");
-
-	// I applied the hedge texture to the rectangular bush.
-	SetShaderTexture("hedge");
-
-	// This draws the rectangular hedge component.
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is the pyramid bush or the (Top component).
-	// This creates a cohesive topiary by using a different but complementary texture.
-	scaleXYZ = glm::vec3(1.5f, 2.5f, 1.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 2.5f, 6.5f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	// I set the UV scale for the foliage texture.
-	SetTextureUVScale(1.5f, 1.5f);
-
-	// I applied the material properties for foliage with lighting.
-	SetShaderMaterial("foliage");
-
-	// I applied the different foliage texture to the pyramid to (create a visual interest and realism).
-	SetShaderTexture("foliage");
-
-	// This draws the pyramid bush component.
-	m_basicMeshes->DrawPyramid4Mesh();
-
-/******************************************************************/
-/* THIS IS AN ADDITIONAL TOPIARY 1 - FIRST IN LINE NEXT TO 
-PYRAMID.															  */
-/******************************************************************/
-
-	// This loads the cone mesh once.
-	m_basicMeshes->LoadConeMesh();
-
-	// This is the rectangle base for topiary 1.
-	scaleXYZ = glm::vec3(2.0f, 1.0f, 1.5f);// I matched to the main topiary rectangle dimensions.
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(1.5f, 0.75f, 5.0f);// I adjusted to move much closer to the main topiary.
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetTextureUVScale(1.5f, 1.0f);
-	SetShaderMaterial("hedge");
-	SetShaderTexture("hedge");
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is the cone top for topiary 1.
-	scaleXYZ = glm::vec3(0.7f, 1.0f, 0.7f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(1.5f, 1.25f, 5.0f);// I lowered to sit it closer to the rectangle.
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetTextureUVScale(1.2f, 1.2f);
-	SetShaderMaterial("foliage");
-	SetShaderTexture("foliage");
-	m_basicMeshes->DrawConeMesh();
-
-/******************************************************************/
-/* THIS IS THE ADDITIONAL TOPIARY 2 - SECOND IN LINE.             */
-/******************************************************************/
-
-	// This is the rectangle base for topiary 2.
-	scaleXYZ = glm::vec3(2.0f, 1.0f, 1.5f);// I matched to the main topiary rectangle dimensions.
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(3.0f, 0.75f, 3.5f);  // I made much tighter spacing to look like the image.
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetTextureUVScale(1.5f, 1.0f);
-	SetShaderMaterial("hedge");
-	SetShaderTexture("hedge");
-	m_basicMeshes->DrawBoxMesh();
-
-	// This is the cone top for topiary 2.
-	scaleXYZ = glm::vec3(0.75f, 1.0f, 0.75f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(3.0f, 1.25f, 3.5f);  // I lowered to sit closer to the rectangle.
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetTextureUVScale(1.2f, 1.2f);
-	SetShaderMaterial("foliage");
-	SetShaderTexture("foliage");
-	m_basicMeshes->DrawConeMesh();
-
-/******************************************************************/
-/* THIS IS AN ADDITIONAL TOPIARY 3 - THIRD IN LINE.               */
-/******************************************************************/
-
-	// This is the rectangle base for topiary 3.
-	scaleXYZ = glm::vec3(2.0f, 1.0f, 1.5f);  // I matched to the main topiary rectangle dimensions.
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(4.5f, 0.75f, 2.0f);  // I made much tighter spacing to look like the image.
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetTextureUVScale(1.5f, 1.0f);
-	SetShaderMaterial("hedge");
-	SetShaderTexture("hedge");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Cone top for topiary 3.
-	scaleXYZ = glm::vec3(0.65f, 1.0f, 0.65f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(4.5f, 1.25f, 2.0f);  // I lowered the cone to sit closer on the rectangle.
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetTextureUVScale(1.2f, 1.2f);
-	SetShaderMaterial("foliage");
-	SetShaderTexture("foliage");
-	m_basicMeshes->DrawConeMesh();
+void SceneManager::BuildDrawList()
+{
+	m_drawCommands.clear();
+	m_drawCommands.reserve(g_GardenDrawList.OBJECT_COUNT);
 
-	// Ben Douglas- I changed the color of the plane from white to green to match the green grass in the topiary bushes picture.
-	// I added the box mesh and combine the boxes to make a recantangle to represent the rectangle hedge bush in the topiary bushes picture.
-	// I used darker green to color the rectangle hedge bush to differentiate among the plane grass and the pyramid bush, and to replicate the picture.
-	// I adjusted the numbers to get the scale of the rectangle to be like the rectangle bush in the picture.
-	// I adjusted the numbers to postioned the rectangle hedge bush under the pyramid bush.
-	// I added the pyramid mesh to represent the pyramid bush in the topiary bushes picture.
-	// I used medium green to color the pyramid bush to differentiate among the plane grass and the rectangle hedge bush in the picture.
-	// I adjusted the numbers to get the scale of the pyramid to be like the pyramid bush in the picture.
-	// I adjusted the numbers to positioned the pyramid bush on top of the rectangle bush.
-	// I constructed the 3D objects from combines boxes to make a rectangle, I used a pyramid mesh, and I combined the pyramid with the rectangle to replicate the 2D picture.
-	// I added the LoadPyramid4Mesh, and the DrawPyramid4Mesh to go from a 3-sided pyramid to a 4-sided pyramid.
-	// 11-16-2025.
-	// Ben Douglas- I added the LoadPyramid4Mesh, and the DrawPyramid4Mesh to go from a 3-sided pyramid to a 4-sided pyramid.
-	// I added the brown/tan atop of the green plane to match the picture of the green grass, the tan bricks to the left of the pyramid bush,
-	// and the brown/tan ground under the rectangular and pyramid bush.
-	// I scaled the brown/tan plane to be big enough to fit the bushes on it.
-	// I scaled the brown/tan bricks to be the right size next to the pyramid bush.
-	// I set the color for the brown/tan plane to brown/tan.
-	// I set the color for the bricks to be brown/tan.
-	// I rotated the bricks to get them in the right postion.
-	// 11-21-2025.
-	// Ben Douglas- I applied detailed textures to grass plane, the dirt under the pyramid hedge bush, the rectangular hedge bush, the pyramid hedge bush, and the bricks
-	// by using SetShaderTexture().
-	// I deleted the colors for the scene to incoporate the images for the objects.
-	// I used the textures of plants_grass_seamless.jpg, dirt.jpg, plants_hedge_seamless.jpg, foliage.jpg, and brick.jpg to render on the objects in the scene.
-	// I used a complex technique called texture tiling by using SetTextureUVScale() on the grass and the dirt planes for realistic repetition.
-	// I created a cohesive object by using the hedge texture on the rectangular bush and by using the foliage on the pyramid bush that looks like a unified look.
-	// I created code quality to make sure the scene runs smoothly.
-	// I used the best practice through modular texture of loading in the LoadSceneTextures(), consistent naming conventions, and proper texture binding.
-	// 11-29-2025.
-	// Ben Douglas- I created the void SceneManager::DefineObjectMaterials() for the scene.
-	// I created the void SceneManager::SetupSceneLights() for the lighting of the scene.
-	// I created the THIS IS THE MAIN GRASS GROUND PLANE WITH TILED TEXTURE AND LIGHTING as well as the other materials in the scene for the shaders.
-	// 12-06-2025.
-	// Ben Douglas- I added a third light that looks like the color of orange to get rid of the shadow on the left side.
-	// I added m_basicMeshes->LoadConeMesh(); to load the cone mesh to make the cone bushes.
-	// I created three rectangle bushes to look like the image.
-	// I created three cone bushes and put them on top of the rectangle bushes.
-	// Overall I added the green grass, the soil, the pyramid bush, the bricks, and the 3 cone bushes to make it look like a topiary garden image.
-	// 12-12-2025.
-	/****************************************************************/
+	// the baked table is already in draw list order, so each
+	// object only has its values copied out of it
+	for (int i = 0; i < g_GardenDrawList.OBJECT_COUNT; i++)
+	{
+		const StaticLayout::BAKED_OBJECT& baked = g_GardenDrawList.objects[i];
+		const StaticLayout::LAYOUT_OBJECT& object = g_GardenLayout[baked.source];
+
+		DRAW_COMMAND command;
+		command.mesh = (MESH_TYPE)object.mesh;
+		command.model = glm::make_mat4(baked.model);
+		command.uvScale = glm::vec2(object.uvScale.u, object.uvScale.v);
+		command.materialTag = object.materialTag;
+		command.textureTag = object.textureTag;
+		command.boundsMin = glm::vec3(baked.boundsMin.x, baked.boundsMin.y, baked.boundsMin.z);
+		command.boundsMax = glm::vec3(baked.boundsMax.x, baked.boundsMax.y, baked.boundsMax.z);
+		command.probeAmbient = glm::vec3(0.0f);
+		command.occlusionCluster = -1;
+		command.bDynamic = false;
+
+		// a streamed ground image covers the whole plane once
+		if ((NULL != m_pVirtualGround) && (baked.source == GROUND_LAYOUT_OBJECT))
+		{
+			command.uvScale = glm::vec2(1.0f, 1.0f);
+			command.textureTag = g_VirtualGroundTag;
+		}
+
+		m_drawCommands.push_back(command);
+	}
+
+	// the streamed ground changes the texture of an object after
+	// the table was ordered, so the list is grouped again
+	if (NULL != m_pVirtualGround)
+	{
+		std::stable_sort(m_drawCommands.begin(), m_drawCommands.end(),
+			[](const DRAW_COMMAND& a, const DRAW_COMMAND& b)
+			{
+				int textureOrder = a.textureTag.compare(b.textureTag);
+				if (textureOrder != 0)
+				{
+					return(textureOrder < 0);
+				}
+				return(a.materialTag.compare(b.materialTag) < 0);
+			});
+	}
+
+	m_visibleViews.assign(m_drawCommands.size(), 0);
+	m_culledViewCount = 0;
+}
+
+/***********************************************************
+ *  CullDrawList()
+ *
+ *  This method is used for testing every object in the draw
+ *  list against all of the passed in views in a single pass.
+ *  Each object gets one visibility bit per view.
+ ***********************************************************/
+void SceneManager::CullDrawList(const glm::mat4* viewProjections, int viewCount)
+{
+	if (viewCount > MAX_SCENE_VIEWS)
+	{
+		viewCount = MAX_SCENE_VIEWS;
+	}
+
+	ViewFrustum frustums[MAX_SCENE_VIEWS];
+	for (int view = 0; view < viewCount; view++)
+	{
+		frustums[view].Extract(viewProjections[view]);
+	}
+
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		uint32_t visibleViews = 0;
+		for (int view = 0; view < viewCount; view++)
+		{
+			if (frustums[view].IntersectsBox(m_drawCommands[i].boundsMin, m_drawCommands[i].boundsMax))
+			{
+				visibleViews |= (1u << view);
+			}
+		}
+		m_visibleViews[i] = visibleViews;
+	}
+
+	for (int view = 0; view < viewCount; view++)
+	{
+		m_viewProjections[view] = viewProjections[view];
+	}
+	m_culledViewCount = viewCount;
+}
+
+/***********************************************************
+ *  CullHiddenCells()
+ *
+ *  This method is used for hiding the objects of a culled
+ *  view that no part of can be seen from the cell of its
+ *  camera. Nothing is hidden when the camera is outside the
+ *  cells or above the heights the sets were baked for.
+ ***********************************************************/
+void SceneManager::CullHiddenCells(int viewIndex, const glm::vec3& cameraPosition)
+{
+	if ((viewIndex >= m_culledViewCount) || m_cellCommands.empty())
+	{
+		return;
+	}
+
+	int cell = VisibilityBaker::FindCell(m_visibilityGrid, cameraPosition);
+	if (cell < 0)
+	{
+		return;
+	}
+
+	const uint32_t* pCellCommands = &m_cellCommands[(size_t)cell * m_cellCommandWords];
+	uint32_t hiddenMask = ~(1u << viewIndex);
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		if (((pCellCommands[i / 32] >> (i % 32)) & 1u) == 0)
+		{
+			m_visibleViews[i] &= hiddenMask;
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateVirtualGround()
+ *
+ *  This method is used for streaming the virtual ground.
+ *  The pages loaded since the last frame are uploaded, or
+ *  posted to the frame scheduler, and when the last feedback
+ *  has been processed the ground is drawn into a new feedback
+ *  pass from the passed in view. With a predicted view every
+ *  other pass is drawn from it instead, so the pages ahead of
+ *  the camera are loaded after the ones it sees now.
+ *  Only the scene that created the virtual ground does this.
+ ***********************************************************/
+void SceneManager::UpdateVirtualGround(int viewIndex, const glm::mat4* pPredictedViewProjection)
+{
+	if ((m_pVirtualGround != &m_virtualGround) || (viewIndex >= m_culledViewCount))
+	{
+		return;
+	}
+
+	m_virtualGround.Update(m_pFrameScheduler);
+	if (m_virtualGround.IsFeedbackPending())
+	{
+		return;
+	}
+
+	// the predicted view was not culled, so all of the ground
+	// is drawn and the GPU clips what it does not see
+	bool bPrefetch = (NULL != pPredictedViewProjection) && !m_bPrefetchedGround;
+	m_bPrefetchedGround = bPrefetch;
+
+	uint32_t viewBit = 1u << viewIndex;
+	m_virtualGround.BeginFeedbackPass(bPrefetch ? *pPredictedViewProjection : m_viewProjections[viewIndex], bPrefetch);
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+		if ((command.textureTag == g_VirtualGroundTag) && (bPrefetch || ((m_visibleViews[i] & viewBit) != 0)))
+		{
+			m_virtualGround.SetModel(command.model);
+			DrawMesh(command.mesh);
+		}
+	}
+	m_virtualGround.EndFeedbackPass();
+}
+
+/***********************************************************
+ *  UpdatePointShadows()
+ *
+ *  This method is used for drawing the shadow cubes of the
+ *  point lights. The static cubes are drawn with every
+ *  object that does not move the first time, and kept. In
+ *  every frame after that, a face is only drawn again when
+ *  a moving object within the range of its light is in it,
+ *  over a copy of its static cube.
+ ***********************************************************/
+void SceneManager::UpdatePointShadows()
+{
+	if (NULL == m_pPointShadows)
+	{
+		return;
+	}
+
+	m_pPointShadows->UseStaticCubes();
+
+	bool bDrawStatic = !m_pPointShadows->IsStaticCached();
+	bool bCastersBegun = false;
+	for (int light = 0; light < m_pPointShadows->GetLightCount(); light++)
+	{
+		for (int face = 0; face < 6; face++)
+		{
+			ViewFrustum frustum;
+			frustum.Extract(m_pPointShadows->GetFaceViewProjection(light, face));
+
+			// the static faces are drawn even when they are empty,
+			// so they are cleared
+			for (int pass = (bDrawStatic ? 0 : 1); pass < 2; pass++)
+			{
+				bool bDynamic = (pass == 1);
+				bool bFaceBegun = false;
+				for (size_t i = 0; i < m_drawCommands.size(); i++)
+				{
+					const DRAW_COMMAND& command = m_drawCommands[i];
+					if ((command.bDynamic != bDynamic) ||
+						!m_pPointShadows->IsInRange(light, command.boundsMin, command.boundsMax) ||
+						!frustum.IntersectsBox(command.boundsMin, command.boundsMax))
+					{
+						continue;
+					}
+
+					if (!bCastersBegun)
+					{
+						m_pPointShadows->BeginCasters();
+						bCastersBegun = true;
+					}
+					if (!bFaceBegun)
+					{
+						if (bDynamic)
+						{
+							m_pPointShadows->BeginDynamicFace(light, face);
+						}
+						else
+						{
+							m_pPointShadows->BeginStaticFace(light, face);
+						}
+						bFaceBegun = true;
+					}
+					m_pPointShadows->SetCasterModel(command.model);
+					DrawMesh(command.mesh);
+				}
+
+				if (!bDynamic && !bFaceBegun)
+				{
+					if (!bCastersBegun)
+					{
+						m_pPointShadows->BeginCasters();
+						bCastersBegun = true;
+					}
+					m_pPointShadows->BeginStaticFace(light, face);
+				}
+			}
+		}
+	}
+
+	if (bCastersBegun)
+	{
+		m_pPointShadows->EndCasters();
+	}
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  drawing the objects in the draw list that are visible in
+ *  the passed in view. The view and projection must already
+ *  be set into the shader.
+ ***********************************************************/
+void SceneManager::RenderScene(int viewIndex)
+{
+	DrawSceneObjects(viewIndex, m_pRenderBackend);
+}
+
+/***********************************************************
+ *  CanRecordScene()
+ *
+ *  This method is used for checking that no object of the
+ *  scene is drawn with a program of its own, which is set
+ *  up with OpenGL directly and so has to be drawn on the
+ *  thread of the context.
+ ***********************************************************/
+bool SceneManager::CanRecordScene() const
+{
+	return((NULL == m_pVirtualGround) && (NULL == m_pBakedLighting) && (NULL == m_pPointShadows));
+}
+
+/***********************************************************
+ *  RecordScene()
+ *
+ *  This method is used for recording the objects visible in
+ *  the passed in view into a command list, in place of the
+ *  calls RenderScene() would make. The list is emptied
+ *  first. Nothing is recorded when the scene cannot be.
+ ***********************************************************/
+bool SceneManager::RecordScene(int viewIndex, RenderCommandList& commands)
+{
+	commands.Reset();
+	if (CanRecordScene() == false)
+	{
+		return(false);
+	}
+
+	DrawSceneObjects(viewIndex, &commands);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SubmitRecordedScene()
+ *
+ *  This method is used for drawing a view recorded by
+ *  RecordScene() through the render backend.
+ ***********************************************************/
+void SceneManager::SubmitRecordedScene(const RenderCommandList& commands)
+{
+	commands.Submit(m_pRenderBackend);
+}
+
+/***********************************************************
+ *  DrawSceneObjects()
+ *
+ *  This method is used for drawing the objects in the draw
+ *  list that are visible in the passed in view through the
+ *  passed in backend. The virtual ground and the baked
+ *  objects are drawn with their own programs straight away.
+ ***********************************************************/
+void SceneManager::DrawSceneObjects(int viewIndex, RenderBackend* pBackend)
+{
+	// only draw everything if this view was never culled
+	bool bCulled = (viewIndex < m_culledViewCount);
+	uint32_t viewBit = bCulled ? (1u << viewIndex) : 0;
+	// the baked objects need the matrices of a culled view
+	bool bBaked = bCulled && (NULL != m_pBakedLighting);
+	// the clusters are tested against the depth of the main view
+	// only, with queries of the GPU the scene draws on
+	bool bOcclusion = bCulled && !bBaked && (viewIndex == 0) &&
+		(NULL != m_pOcclusionCulling) && (pBackend == m_pRenderBackend) && pBackend->IsGpuBackend();
+
+	OBJECT_STATE state;
+	state.pLastMaterial = NULL;
+	state.pLastTexture = NULL;
+	state.lastUVScale = glm::vec2(-1.0f, -1.0f);
+
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+
+		if (bCulled && ((m_visibleViews[i] & viewBit) == 0))
+		{
+			continue;
+		}
+		// drawn after the occluders, with the rest of its cluster
+		if (bOcclusion && (command.occlusionCluster >= 0))
+		{
+			continue;
+		}
+
+		// the matrices of a view are only kept when it was culled
+		if (command.textureTag == g_VirtualGroundTag)
+		{
+			if (bCulled)
+			{
+				DrawVirtualGround(command, m_viewProjections[viewIndex]);
+			}
+			continue;
+		}
+		if (bBaked)
+		{
+			continue;
+		}
+
+		DrawSceneObject(pBackend, command, state);
+	}
+
+	if (bOcclusion)
+	{
+		DrawOcclusionClusters(viewBit, m_viewProjections[viewIndex], state);
+	}
+	if (bBaked)
+	{
+		DrawBakedObjects(viewBit, m_viewProjections[viewIndex]);
+	}
+	// the shadows are taken from what was drawn on the GPU
+	if (bCulled && (NULL != m_pPointShadows) && (pBackend == m_pRenderBackend))
+	{
+		DrawPointShadows(viewBit, m_viewProjections[viewIndex], GetViewPosition(m_viewProjections[viewIndex]));
+	}
+}
+
+/***********************************************************
+ *  DrawSceneObject()
+ *
+ *  This method is used for drawing one object of the draw
+ *  list through the passed in backend. Its material, texture
+ *  and UV scale are only set when they differ from the ones
+ *  of the object drawn before it.
+ ***********************************************************/
+void SceneManager::DrawSceneObject(
+	RenderBackend* pBackend,
+	const DRAW_COMMAND& command,
+	OBJECT_STATE& state)
+{
+	pBackend->SetMat4Value(g_ModelName, command.model);
+
+	if (command.uvScale != state.lastUVScale)
+	{
+		SetTextureUVScale(pBackend, command.uvScale.x, command.uvScale.y);
+		state.lastUVScale = command.uvScale;
+	}
+	bool bSamplerChanged = false;
+	if ((state.pLastMaterial == NULL) || (state.pLastMaterial->compare(command.materialTag) != 0))
+	{
+		SetShaderMaterial(pBackend, command.materialTag);
+		state.pLastMaterial = &command.materialTag;
+		bSamplerChanged = true;
+	}
+	if ((state.pLastTexture == NULL) || (state.pLastTexture->compare(command.textureTag) != 0))
+	{
+		SetShaderTexture(pBackend, command.textureTag);
+		state.pLastTexture = &command.textureTag;
+		bSamplerChanged = true;
+	}
+	if (bSamplerChanged)
+	{
+		SetTextureSampler(pBackend, command.materialTag, command.textureTag);
+	}
+	if (NULL != m_pProbeVolume)
+	{
+		SetProbeAmbient(pBackend, command);
+	}
+
+	DrawMesh(pBackend, command.mesh);
+}
+
+/***********************************************************
+ *  DrawOcclusionClusters()
+ *
+ *  This method is used for drawing the objects of every
+ *  cluster, after the objects that hide them. A cluster is
+ *  only drawn when its box was visible in the last frame,
+ *  which the GPU decides without the CPU ever waiting for
+ *  it. The boxes are then tested against the depth of this
+ *  frame for the next one. A cluster the camera is inside
+ *  is always drawn, since the near plane clips its box.
+ ***********************************************************/
+void SceneManager::DrawOcclusionClusters(
+	uint32_t viewBit,
+	const glm::mat4& viewProjection,
+	OBJECT_STATE& state)
+{
+	glm::vec3 eyePosition = GetViewPosition(viewProjection);
+	glm::vec3 padding(OcclusionCulling::BOX_PADDING);
+
+	for (size_t i = 0; i < m_occlusionClusters.size(); i++)
+	{
+		OCCLUSION_CLUSTER& cluster = m_occlusionClusters[i];
+
+		bool bVisible = false;
+		for (size_t j = 0; j < cluster.commands.size(); j++)
+		{
+			bVisible = bVisible || ((m_visibleViews[cluster.commands[j]] & viewBit) != 0);
+		}
+		bool bInside = glm::all(glm::greaterThanEqual(eyePosition, cluster.boundsMin - padding)) &&
+			glm::all(glm::lessThanEqual(eyePosition, cluster.boundsMax + padding));
+		cluster.bTested = bVisible && !bInside;
+		if (!bVisible)
+		{
+			continue;
+		}
+
+		bool bConditional = !bInside && m_pOcclusionCulling->BeginConditionalDraw((int)i);
+		for (size_t j = 0; j < cluster.commands.size(); j++)
+		{
+			if ((m_visibleViews[cluster.commands[j]] & viewBit) != 0)
+			{
+				DrawSceneObject(m_pRenderBackend, m_drawCommands[cluster.commands[j]], state);
+			}
+		}
+		if (bConditional)
+		{
+			m_pOcclusionCulling->EndConditionalDraw();
+		}
+	}
+
+	// the clusters out of view or around the camera are not
+	// tested, and are drawn without a condition next frame
+	m_pOcclusionCulling->BeginQueries(viewProjection);
+	for (size_t i = 0; i < m_occlusionClusters.size(); i++)
+	{
+		const OCCLUSION_CLUSTER& cluster = m_occlusionClusters[i];
+		if (cluster.bTested)
+		{
+			m_pOcclusionCulling->BeginQuery((int)i, cluster.boundsMin, cluster.boundsMax);
+			DrawMesh(MESH_BOX);
+			m_pOcclusionCulling->EndQuery();
+		}
+	}
+	m_pOcclusionCulling->EndQueries();
+}
+
+/***********************************************************
+ *  RenderSceneInterleaved()
+ *
+ *  This method is used for rendering several views, such as
+ *  the two eyes of a stereo frame, in one walk of the draw
+ *  list. The model, material and texture values are set once
+ *  per object and then only the view values, the viewport
+ *  and the draw call are repeated for each view. The two eyes
+ *  of a stereo frame are drawn by RenderSceneStereo() instead
+ *  when the stereo program could be built.
+ ***********************************************************/
+void SceneManager::RenderSceneInterleaved(const VIEW_PASS* pViewPasses, int viewCount)
+{
+	// the two eyes of a stereo frame are drawn together when the
+	// frames go to the GL context
+	if ((viewCount == StereoRenderer::EYE_COUNT) && (m_pRenderBackend == &m_glBackend))
+	{
+		if (!m_bStereoRendererTried)
+		{
+			GLint sceneProgram = 0;
+			glGetIntegerv(GL_CURRENT_PROGRAM, &sceneProgram);
+			m_stereoRenderer.Initialize((GLuint)sceneProgram, m_pTextureSamplers);
+			m_bStereoRendererTried = true;
+		}
+		if (m_stereoRenderer.IsInitialized())
+		{
+			RenderSceneStereo(pViewPasses);
+			return;
+		}
+	}
+
+	const std::string* pLastMaterial = NULL;
+	const std::string* pLastTexture = NULL;
+	glm::vec2 lastUVScale(-1.0f, -1.0f);
+	int lastView = -1;
+
+	uint32_t anyViewBits = 0;
+	for (int view = 0; view < viewCount; view++)
+	{
+		anyViewBits |= (1u << pViewPasses[view].viewIndex);
+	}
+
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+
+		bool bCulled = (m_culledViewCount > 0);
+		if (bCulled && ((m_visibleViews[i] & anyViewBits) == 0))
+		{
+			continue;
+		}
+
+		// the baked objects are drawn after the walk, once per view
+		bool bVirtualGround = (command.textureTag == g_VirtualGroundTag);
+		if (bCulled && (NULL != m_pBakedLighting) && !bVirtualGround)
+		{
+			continue;
+		}
+
+		// the virtual ground is drawn by its own program, so the
+		// object values of the scene program are left as they are
+		if (!bVirtualGround)
+		{
+			m_pRenderBackend->SetMat4Value(g_ModelName, command.model);
+
+			if (command.uvScale != lastUVScale)
+			{
+				SetTextureUVScale(command.uvScale.x, command.uvScale.y);
+				lastUVScale = command.uvScale;
+			}
+			bool bSamplerChanged = false;
+			if ((pLastMaterial == NULL) || (pLastMaterial->compare(command.materialTag) != 0))
+			{
+				SetShaderMaterial(command.materialTag);
+				pLastMaterial = &command.materialTag;
+				bSamplerChanged = true;
+			}
+			if ((pLastTexture == NULL) || (pLastTexture->compare(command.textureTag) != 0))
+			{
+				SetShaderTexture(command.textureTag);
+				pLastTexture = &command.textureTag;
+				bSamplerChanged = true;
+			}
+			if (bSamplerChanged)
+			{
+				SetTextureSampler(command.materialTag, command.textureTag);
+			}
+			if (NULL != m_pProbeVolume)
+			{
+				SetProbeAmbient(m_pRenderBackend, command);
+			}
+		}
+
+		// alternate the direction through the views so that the
+		// view values already set are reused by the next object
+		for (int step = 0; step < viewCount; step++)
+		{
+			int view = ((i % 2) == 0) ? step : (viewCount - 1 - step);
+			const VIEW_PASS& viewPass = pViewPasses[view];
+
+			if (bCulled && ((m_visibleViews[i] & (1u << viewPass.viewIndex)) == 0))
+			{
+				continue;
+			}
+
+			if (view != lastView)
+			{
+				m_pRenderBackend->SetViewport(viewPass.viewport[0], viewPass.viewport[1], viewPass.viewport[2], viewPass.viewport[3]);
+				m_pRenderBackend->SetMat4Value(g_ViewName, viewPass.view);
+				m_pRenderBackend->SetMat4Value(g_ProjectionName, viewPass.projection);
+				m_pRenderBackend->SetVec3Value(g_ViewPositionName, viewPass.position);
+				lastView = view;
+			}
+
+			if (bVirtualGround)
+			{
+				DrawVirtualGround(command, viewPass.projection * viewPass.view);
+				continue;
+			}
+
+			DrawMesh(command.mesh);
+		}
+	}
+
+	if ((m_culledViewCount > 0) && (NULL != m_pBakedLighting))
+	{
+		for (int view = 0; view < viewCount; view++)
+		{
+			const VIEW_PASS& viewPass = pViewPasses[view];
+			m_pRenderBackend->SetViewport(viewPass.viewport[0], viewPass.viewport[1], viewPass.viewport[2], viewPass.viewport[3]);
+			DrawBakedObjects(1u << viewPass.viewIndex, viewPass.projection * viewPass.view);
+		}
+	}
+	if ((m_culledViewCount > 0) && (NULL != m_pPointShadows))
+	{
+		for (int view = 0; view < viewCount; view++)
+		{
+			const VIEW_PASS& viewPass = pViewPasses[view];
+			m_pRenderBackend->SetViewport(viewPass.viewport[0], viewPass.viewport[1], viewPass.viewport[2], viewPass.viewport[3]);
+			DrawPointShadows(1u << viewPass.viewIndex, viewPass.projection * viewPass.view, viewPass.position);
+		}
+	}
+}
+
+/***********************************************************
+ *  RenderSceneStereo()
+ *
+ *  This method is used for rendering the two eyes of a stereo
+ *  frame with one walk of the draw list and a single draw
+ *  call for each object, which the stereo renderer sends to
+ *  both eye viewports. The lighting uses the point between
+ *  the eyes. The virtual ground and the baked objects have
+ *  programs of their own, so they are drawn for each eye
+ *  after the walk.
+ ***********************************************************/
+void SceneManager::RenderSceneStereo(const VIEW_PASS* pEyePasses)
+{
+	const int eyeCount = StereoRenderer::EYE_COUNT;
+	glm::mat4 eyeViewProjections[eyeCount];
+	int eyeViewports[eyeCount][4];
+	uint32_t anyEyeBits = 0;
+	for (int eye = 0; eye < eyeCount; eye++)
+	{
+		eyeViewProjections[eye] = pEyePasses[eye].projection * pEyePasses[eye].view;
+		for (int i = 0; i < 4; i++)
+		{
+			eyeViewports[eye][i] = pEyePasses[eye].viewport[i];
+		}
+		anyEyeBits |= (1u << pEyePasses[eye].viewIndex);
+	}
+
+	RenderBackend* pBackend = &m_stereoRenderer;
+	const std::string* pLastMaterial = NULL;
+	const std::string* pLastTexture = NULL;
+	glm::vec2 lastUVScale(-1.0f, -1.0f);
+	bool bCulled = (m_culledViewCount > 0);
+	bool bVirtualGroundVisible = false;
+
+	m_stereoRenderer.Begin(eyeViewProjections, eyeViewports);
+	pBackend->SetVec3Value(g_ViewPositionName, (pEyePasses[0].position + pEyePasses[1].position) * 0.5f);
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+
+		if (bCulled && ((m_visibleViews[i] & anyEyeBits) == 0))
+		{
+			continue;
+		}
+		if (command.textureTag == g_VirtualGroundTag)
+		{
+			bVirtualGroundVisible = true;
+			continue;
+		}
+		if (bCulled && (NULL != m_pBakedLighting))
+		{
+			continue;
+		}
+
+		pBackend->SetMat4Value(g_ModelName, command.model);
+		if (command.uvScale != lastUVScale)
+		{
+			SetTextureUVScale(pBackend, command.uvScale.x, command.uvScale.y);
+			lastUVScale = command.uvScale;
+		}
+		bool bSamplerChanged = false;
+		if ((pLastMaterial == NULL) || (pLastMaterial->compare(command.materialTag) != 0))
+		{
+			SetShaderMaterial(pBackend, command.materialTag);
+			pLastMaterial = &command.materialTag;
+			bSamplerChanged = true;
+		}
+		if ((pLastTexture == NULL) || (pLastTexture->compare(command.textureTag) != 0))
+		{
+			SetShaderTexture(pBackend, command.textureTag);
+			pLastTexture = &command.textureTag;
+			bSamplerChanged = true;
+		}
+		if (bSamplerChanged)
+		{
+			SetTextureSampler(pBackend, command.materialTag, command.textureTag);
+		}
+		if (NULL != m_pProbeVolume)
+		{
+			SetProbeAmbient(pBackend, command);
+		}
+
+		DrawMesh(pBackend, command.mesh);
+	}
+	m_stereoRenderer.End();
+
+	for (int eye = 0; eye < eyeCount; eye++)
+	{
+		const VIEW_PASS& eyePass = pEyePasses[eye];
+		uint32_t eyeBits = (1u << eyePass.viewIndex);
+		m_pRenderBackend->SetViewport(eyePass.viewport[0], eyePass.viewport[1], eyePass.viewport[2], eyePass.viewport[3]);
+
+		if (bVirtualGroundVisible)
+		{
+			for (size_t i = 0; i < m_drawCommands.size(); i++)
+			{
+				const DRAW_COMMAND& command = m_drawCommands[i];
+				if ((command.textureTag == g_VirtualGroundTag) && (!bCulled || ((m_visibleViews[i] & eyeBits) != 0)))
+				{
+					DrawVirtualGround(command, eyeViewProjections[eye]);
+				}
+			}
+		}
+		if (bCulled && (NULL != m_pBakedLighting))
+		{
+			DrawBakedObjects(eyeBits, eyeViewProjections[eye]);
+		}
+		if (bCulled && (NULL != m_pPointShadows))
+		{
+			DrawPointShadows(eyeBits, eyeViewProjections[eye], eyePass.position);
+		}
+	}
+}
+
+/***********************************************************
+ *  RenderObjectIDs()
+ *
+ *  This method is used for rendering the objects visible in
+ *  the passed in view with lighting and textures turned off,
+ *  so that each one is drawn in the flat color that encodes
+ *  its draw list index.
+ ***********************************************************/
+void SceneManager::RenderObjectIDs(int viewIndex)
+{
+	bool bCulled = (viewIndex < m_culledViewCount);
+	uint32_t viewBit = bCulled ? (1u << viewIndex) : 0;
+
+	m_pRenderBackend->SetBoolValue(g_UseLightingName, false);
+
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+
+		if (bCulled && ((m_visibleViews[i] & viewBit) == 0))
+		{
+			continue;
+		}
+
+		glm::vec4 objectID = ObjectPicker::EncodeObjectIndex((int)i);
+
+		m_pRenderBackend->SetMat4Value(g_ModelName, command.model);
+		SetShaderColor(objectID.r, objectID.g, objectID.b, objectID.a);
+
+		DrawMesh(command.mesh);
+	}
+
+	m_pRenderBackend->SetBoolValue(g_UseLightingName, true);
 }
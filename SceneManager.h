@@ -11,9 +11,26 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "MeshRegistry.h"
+#include "GpuResource.h"
+#include "TextureDecoder.h"
+#include "TextureSamplers.h"
+#include "VirtualTexture.h"
+#include "BakedLighting.h"
+#include "IrradianceVolume.h"
+#include "VisibilityBaker.h"
+#include "RenderBackend.h"
+#include "RenderCommandList.h"
+#include "OcclusionCulling.h"
+#include "PointShadows.h"
+#include "FrameScheduler.h"
+#include "StereoRenderer.h"
 
+#include <future>
+#include <map>
 #include <string>
 #include <vector>
+#include <stdint.h>
 
 /***********************************************************
  *  SceneManager
@@ -43,32 +60,208 @@ public:
 		glm::vec3 specularColor;
 		float shininess;
 		std::string tag;
+		// filtering and wrapping of the textures drawn with it
+		SAMPLER_TIER samplerTier;
+		SAMPLER_WRAP samplerWrap;
+	};
+
+	// the mip chain of a texture prepared on a worker thread
+	struct TEXTURE_LEVELS
+	{
+		// scale of the first level to the file, -1 when it failed
+		int scaleLevel;
+		bool bFromCache;
+		double milliseconds;
+		// hash of the first level, for finding identical images
+		uint64_t contentHash;
+		std::vector<TextureDecoder::DECODED_IMAGE> levels;
+	};
+
+	// basic shape meshes that the draw list can reference
+	enum MESH_TYPE
+	{
+		MESH_PLANE,
+		MESH_BOX,
+		MESH_PYRAMID4,
+		MESH_CONE,
+		MESH_TYPE_COUNT
+	};
+
+	// one object in the 3D scene, built once and then
+	// submitted for every view that it is visible in
+	struct DRAW_COMMAND
+	{
+		MESH_TYPE mesh;
+		glm::mat4 model;
+		glm::vec2 uvScale;
+		std::string materialTag;
+		std::string textureTag;
+		// world space bounds used for culling
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// ambient color lit by the irradiance probes at the object
+		glm::vec3 probeAmbient;
+		// cluster the object is drawn with when occlusion culling
+		// is on, or -1 for the objects that hide the clusters
+		int occlusionCluster;
+		// true for an object that moves, whose shadows are drawn
+		// every frame instead of kept in the static cubes
+		bool bDynamic;
+	};
+
+	// maximum number of views that can share one culling pass
+	static const int MAX_SCENE_VIEWS = 32;
+
+	// the values of one view when several views are drawn
+	// from a single submission of the draw list
+	struct VIEW_PASS
+	{
+		// index of the view in the last culling pass
+		int viewIndex;
+		int viewport[4];
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 position;
 	};
 
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	// where the frames are drawn, OpenGL unless another backend
+	// was set
+	GLRenderBackend m_glBackend;
+	RenderBackend* m_pRenderBackend;
+	// draws both eyes of a stereo frame with one draw call per
+	// object, built from the scene program on the first stereo
+	// frame, which is then known to be in use
+	StereoRenderer m_stereoRenderer;
+	bool m_bStereoRendererTried;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
+	// loads each basic shape mesh only once
+	MeshRegistry* m_pMeshRegistry;
+	// registry handles of the meshes the draw list references
+	MeshRegistry::MESH_HANDLE m_meshHandles[MESH_TYPE_COUNT];
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
 	TEXTURE_INFO m_textureIDs[16];
+	// textures created by this scene, empty when the textures
+	// belong to the scene of another window
+	std::vector<GpuTexture> m_ownedTextures;
+	// a texture whose levels are still being prepared
+	struct PENDING_TEXTURE
+	{
+		int slot;
+		std::string filename;
+		std::future<TEXTURE_LEVELS> levels;
+	};
+	std::vector<PENDING_TEXTURE> m_pendingTextures;
+	// image files of the textures created by this scene
+	std::vector<std::string> m_textureFiles;
+	// tags that use the texture of another tag, because the
+	// same file or the same pixels were loaded under both
+	std::map<std::string, std::string> m_textureAliases;
+	// largest texture width or height to load, zero for no limit
+	int m_maxTextureSize;
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// samplers created by this scene, and the samplers in use,
+	// which belong to the scene of another window when shared
+	TextureSamplers m_textureSamplers;
+	const TextureSamplers* m_pTextureSamplers;
+	// image of the ground streamed as a virtual texture, and the
+	// virtual texture in use, which belongs to the scene of
+	// another window when shared, or NULL when there is none
+	std::string m_virtualGroundFile;
+	VirtualTexture m_virtualGround;
+	VirtualTexture* m_pVirtualGround;
+	// true when the last feedback pass of the virtual ground was
+	// drawn from the predicted view
+	bool m_bPrefetchedGround;
+	// scheduler that the streaming work of the frame is posted
+	// to, or NULL to do it all in the update
+	FrameScheduler* m_pFrameScheduler;
+	// true when the static lights are baked into lightmaps, the
+	// lights to bake, and the baked lighting in use, which
+	// belongs to the scene of another window when shared, or
+	// NULL when the scene lights are evaluated for every object
+	bool m_bBakeLighting;
+	std::vector<LightmapBaker::BAKE_LIGHT> m_bakeLights;
+	glm::vec3 m_bakeAmbientLight;
+	BakedLighting m_bakedLighting;
+	BakedLighting* m_pBakedLighting;
+	// true when irradiance probes are baked for the ambient light,
+	// and the probes in use, which belong to the scene of another
+	// window when shared, or NULL for the ambient values
+	bool m_bBakeProbes;
+	IrradianceVolume m_probeVolume;
+	const IrradianceVolume* m_pProbeVolume;
+	// objects near each other that are tested for occlusion as
+	// one box, with the indices of their draw commands
+	struct OCCLUSION_CLUSTER
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		std::vector<size_t> commands;
+		// true when the box was tested in the current frame
+		bool bTested;
+	};
+	// true when the clusters are culled by occlusion queries, the
+	// clusters, and the queries of this window's context, or NULL
+	// when every object is drawn
+	bool m_bOcclusionCulling;
+	std::vector<OCCLUSION_CLUSTER> m_occlusionClusters;
+	OcclusionCulling m_occlusionCulling;
+	OcclusionCulling* m_pOcclusionCulling;
+	// true when the sets of visible cells are baked, the sets,
+	// and one bit per draw command for every cell, set for the
+	// commands over a cell that can be seen from it
+	bool m_bVisibilitySets;
+	VisibilityBaker::VISIBILITY_GRID m_visibilityGrid;
+	std::vector<uint32_t> m_cellCommands;
+	int m_cellCommandWords;
+	// true when the point lights cast shadows, the memory the
+	// cubes may use, the lights, and the cubes of this window's
+	// context, or NULL when the point lights cast no shadows
+	bool m_bPointShadows;
+	size_t m_pointShadowBudget;
+	std::vector<PointShadows::SHADOW_LIGHT> m_shadowLights;
+	PointShadows m_pointShadows;
+	PointShadows* m_pPointShadows;
+	// combined matrices of the views in the last culling pass
+	glm::mat4 m_viewProjections[MAX_SCENE_VIEWS];
+	// objects of the 3D scene sorted by texture and material
+	std::vector<DRAW_COMMAND> m_drawCommands;
+	// one bit per view for every visible draw command
+	std::vector<uint32_t> m_visibleViews;
+	// number of views in the last culling pass, zero draws everything
+	int m_culledViewCount;
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
+	// upload the textures once their levels are prepared
+	bool FinishTextureLoads();
 	// bind loaded OpenGL textures to slots in memory
 	void BindGLTextures();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
+	// get the tag whose texture a tag uses
+	const std::string& ResolveTextureTag(const std::string& tag) const;
 	// find a loaded texture by tag
 	int FindTextureID(std::string tag);
 	int FindTextureSlot(std::string tag);
 	// find a defined material by tag
 	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
 
+	// build the model matrix from the transformation values
+	static glm::mat4 BuildModelMatrix(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
 	// set the transformation values 
 	// into the transform buffer
 	void SetTransformations(
@@ -87,16 +280,49 @@ private:
 
 	// set the texture data into the shader
 	void SetShaderTexture(
+		std::string textureTag) { SetShaderTexture(m_pRenderBackend, textureTag); }
+	void SetShaderTexture(
+		RenderBackend* pBackend,
 		std::string textureTag);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
+		float u, float v) { SetTextureUVScale(m_pRenderBackend, u, v); }
+	void SetTextureUVScale(
+		RenderBackend* pBackend,
 		float u, float v);
 
 	// set the object material into the shader
 	void SetShaderMaterial(
+		std::string materialTag) { SetShaderMaterial(m_pRenderBackend, materialTag); }
+	void SetShaderMaterial(
+		RenderBackend* pBackend,
 		std::string materialTag);
 
+	// draw an object with the virtual texture of the ground
+	void DrawVirtualGround(
+		const DRAW_COMMAND& command,
+		const glm::mat4& viewProjection);
+
+	// draw the objects visible in any of the passed in views
+	// with the baked lightmap, after all the other objects
+	void DrawBakedObjects(
+		uint32_t viewBits,
+		const glm::mat4& viewProjection);
+
+	// draw the two eyes of a stereo frame with the stereo
+	// renderer, each object with a single draw call
+	void RenderSceneStereo(const VIEW_PASS* pEyePasses);
+
+	// bind the sampler of the material to the unit of the texture
+	void SetTextureSampler(
+		const std::string& materialTag,
+		const std::string& textureTag) { SetTextureSampler(m_pRenderBackend, materialTag, textureTag); }
+	void SetTextureSampler(
+		RenderBackend* pBackend,
+		const std::string& materialTag,
+		const std::string& textureTag);
+
 	// ****** ADD THESE TWO METHOD DECLARATIONS ******
 		// define the materials for objects in the scene
 	void DefineObjectMaterials();
@@ -105,12 +331,152 @@ private:
 	void SetupSceneLights();
 	// ***********************************************
 
+	// load the basic shape meshes into the current context
+	void LoadSceneMeshes();
+
+	// build the list of objects that make up the 3D scene
+	void BuildDrawList();
+	// draw the basic mesh referenced by a draw command
+	void DrawMesh(MESH_TYPE mesh) { DrawMesh(m_pRenderBackend, mesh); }
+	void DrawMesh(RenderBackend* pBackend, MESH_TYPE mesh);
+	// get the objects of the draw list for the bakers
+	void CollectBakeObjects(std::vector<LightmapBaker::BAKE_OBJECT>& objects);
+	// bake the scene lights into lightmaps for the draw list
+	void BakeLightmaps();
+	// bake irradiance probes over the draw list
+	void BakeProbes();
+	// light the ambient color of every object from the probes
+	void SampleProbeAmbient();
+	// set the probe lit ambient color of an object into the shader
+	void SetProbeAmbient(RenderBackend* pBackend, const DRAW_COMMAND& command);
+	// draw the objects of the draw list visible in a view through
+	// a backend, which is what rendering and recording share
+	void DrawSceneObjects(int viewIndex, RenderBackend* pBackend);
+	// the values last set while drawing the draw list, so they
+	// are only set again when the next object differs
+	struct OBJECT_STATE
+	{
+		const std::string* pLastMaterial;
+		const std::string* pLastTexture;
+		glm::vec2 lastUVScale;
+	};
+	// draw one object of the draw list through a backend
+	void DrawSceneObject(
+		RenderBackend* pBackend,
+		const DRAW_COMMAND& command,
+		OBJECT_STATE& state);
+	// group the small objects of the draw list into clusters
+	void BuildOcclusionClusters();
+	// get the bounds around every object of the draw list
+	void GetDrawListBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const;
+	// bake the sets of visible cells over the draw list
+	void BakeVisibilitySets();
+	// find the draw commands that can be seen from each cell
+	void BuildCellCommands();
+	// draw the clusters visible in the last frame, and test them
+	// for the next one
+	void DrawOcclusionClusters(
+		uint32_t viewBit,
+		const glm::mat4& viewProjection,
+		OBJECT_STATE& state);
+	// create the shadow cubes of the point lights over the
+	// range of the draw list
+	void InitializePointShadows();
+	// take the light hidden from the point lights away from the
+	// objects visible in any of the passed in views
+	void DrawPointShadows(
+		uint32_t viewBits,
+		const glm::mat4& viewProjection,
+		const glm::vec3& viewPosition);
+
 public:
 
 	// The following methods are for the students to 
 	// customize for their own 3D scene
 	void PrepareScene();
-	void RenderScene();
+	// prepare the scene for another window whose context shares
+	// the textures and shader program of the passed in scene
+	void PrepareSharedScene(const SceneManager* pSourceScene);
+	// prepare the objects, materials and lights of the scene
+	// without loading anything onto the GPU
+	void PrepareHeadlessScene();
+	// render the objects visible in the passed in view
+	void RenderScene(int viewIndex = 0);
+
+	// true when every object is drawn through the render backend,
+	// so a view can be recorded away from the GL context
+	bool CanRecordScene() const;
+	// record the objects visible in a view into a command list,
+	// which may run on any thread while the scene is unchanged
+	bool RecordScene(int viewIndex, RenderCommandList& commands);
+	// draw a recorded view through the render backend, the view
+	// and projection must already be set into the shader
+	void SubmitRecordedScene(const RenderCommandList& commands);
+
+	// render several views in one walk of the draw list, the
+	// object state is set once and each view only adds its draw
+	void RenderSceneInterleaved(const VIEW_PASS* pViewPasses, int viewCount);
+
+	// test the draw list against every view in one pass, so
+	// each additional view only pays for its own submission
+	void CullDrawList(const glm::mat4* viewProjections, int viewCount);
+	// hide the objects of a culled view that cannot be seen from
+	// the cell of its camera, after CullDrawList()
+	void CullHiddenCells(int viewIndex, const glm::vec3& cameraPosition);
+
+	// render each visible object as a flat color that encodes
+	// its draw list index, used for picking objects
+	void RenderObjectIDs(int viewIndex = 0);
+	// get the objects of the draw list, such as a picked object
+	int GetDrawCommandCount() const { return((int)m_drawCommands.size()); }
+	const DRAW_COMMAND& GetDrawCommand(int index) const { return(m_drawCommands[index]); }
+	// limit the size of the loaded textures, such as for systems
+	// with little video memory, zero loads them at full size
+	void SetMaxTextureSize(int maxTextureSize) { m_maxTextureSize = maxTextureSize; }
+	// set the best texture filtering that any material is drawn
+	// with, to trade filtering cost for quality
+	void SetTextureFilteringLimit(SAMPLER_TIER tier) { m_textureSamplers.SetQualityLimit(tier); }
+	// stream a very large ground image as a virtual texture
+	// instead of the tiled grass, set before PrepareScene()
+	void SetVirtualGroundFile(const std::string& filename) { m_virtualGroundFile = filename; }
+	// run the streaming work in the time left of each frame
+	void SetFrameScheduler(FrameScheduler* pFrameScheduler) { m_pFrameScheduler = pFrameScheduler; }
+	// stream the pages of the virtual ground seen in a view, once
+	// per frame before the scene is rendered, and prefetch the
+	// pages of a predicted view of the camera when one is passed
+	void UpdateVirtualGround(int viewIndex = 0, const glm::mat4* pPredictedViewProjection = NULL);
+	// draw the shadow cubes that are not cached, once per frame
+	// before the scene is rendered
+	void UpdatePointShadows();
+	// light the objects from lightmaps baked on the CPU instead of
+	// the scene lights, set before PrepareScene()
+	void SetBakeLighting(bool bBakeLighting) { m_bBakeLighting = bBakeLighting; }
+	// take the ambient light from baked irradiance probes instead
+	// of the ambient values, set before PrepareScene()
+	void SetBakeProbes(bool bBakeProbes) { m_bBakeProbes = bBakeProbes; }
+	// skip the clusters of objects hidden behind the hedges with
+	// occlusion queries, set before PrepareScene()
+	void SetOcclusionCulling(bool bOcclusionCulling) { m_bOcclusionCulling = bOcclusionCulling; }
+	// bake the cells that can be seen from each cell of the
+	// garden, set before PrepareScene()
+	void SetVisibilitySets(bool bVisibilitySets) { m_bVisibilitySets = bVisibilitySets; }
+	// let the point lights cast shadows from cubes that use at
+	// most the passed in memory, set before PrepareScene()
+	void SetPointShadows(bool bPointShadows, size_t budgetBytes) { m_bPointShadows = bPointShadows; m_pointShadowBudget = budgetBytes; }
+	// mark an object of the draw list as moving, so its shadows
+	// are drawn every frame instead of cached
+	void SetDynamicObject(int index, bool bDynamic) { m_drawCommands[index].bDynamic = bDynamic; }
+	// print the decode times of the loaded texture files
+	void BenchmarkTextureDecoding() const;
+	// draw the frames through another backend, such as one that
+	// does no GPU work, set before PrepareHeadlessScene()
+	void SetRenderBackend(RenderBackend* pRenderBackend) { m_pRenderBackend = pRenderBackend; }
+	RenderBackend* GetRenderBackend() const { return(m_pRenderBackend); }
+	// print the CPU time of the functions called for every object
+	// drawn, with sweeps over the number of materials and textures
+	void BenchmarkDrawFunctions();
+	// get the registry of the basic meshes loaded for this scene
+	const MeshRegistry* GetMeshRegistry() const { return(m_pMeshRegistry); }
 public:
 
 	// your other method declarations here...
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderprogram.cpp
+// ============
+// compile small built-in GLSL programs used by the rendering helpers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderProgram.h"
+
+#include <iostream>
+#include <vector>
+
+const char* const g_FullscreenVertexSource = R"GLSL(
+#version 330 core
+out vec2 fragUV;
+void main()
+{
+	// one oversized triangle covers the whole viewport
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	fragUV = position;
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)GLSL";
+
+namespace
+{
+	/***********************************************************
+	 *  CompileShaderStage()
+	 *
+	 *  This function is used to compile one shader stage and
+	 *  report any compile errors to the console.
+	 ***********************************************************/
+	GLuint CompileShaderStage(GLenum stage, const char* source, const char* programName)
+	{
+		GLuint shader = glCreateShader(stage);
+		glShaderSource(shader, 1, &source, NULL);
+		glCompileShader(shader);
+
+		GLint bSuccess = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &bSuccess);
+		if (bSuccess == GL_FALSE)
+		{
+			GLint logLength = 0;
+			glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+			std::vector<char> infoLog(logLength > 1 ? logLength : 1);
+			glGetShaderInfoLog(shader, (GLsizei)infoLog.size(), NULL, infoLog.data());
+			std::cout << "ERROR: " << programName << " shader compile failed\n" << infoLog.data() << std::endl;
+			glDeleteShader(shader);
+			return 0;
+		}
+
+		return shader;
+	}
+}
+
+/***********************************************************
+ *  CreateShaderProgram()
+ *
+ *  This function is used to compile and link a program from
+ *  GLSL source strings that are built into the application.
+ ***********************************************************/
+GLuint CreateShaderProgram(
+	const char* vertexSource,
+	const char* fragmentSource,
+	const char* programName)
+{
+	return(CreateShaderProgram(vertexSource, NULL, fragmentSource, programName));
+}
+
+/***********************************************************
+ *  CreateShaderProgram()
+ *
+ *  This function is used to compile and link a program with
+ *  a geometry shader stage, which is left out for NULL.
+ ***********************************************************/
+GLuint CreateShaderProgram(
+	const char* vertexSource,
+	const char* geometrySource,
+	const char* fragmentSource,
+	const char* programName)
+{
+	GLuint vertexShader = CompileShaderStage(GL_VERTEX_SHADER, vertexSource, programName);
+	GLuint geometryShader = 0;
+	if (NULL != geometrySource)
+	{
+		geometryShader = CompileShaderStage(GL_GEOMETRY_SHADER, geometrySource, programName);
+	}
+	GLuint fragmentShader = CompileShaderStage(GL_FRAGMENT_SHADER, fragmentSource, programName);
+	if ((vertexShader == 0) || (fragmentShader == 0) || ((NULL != geometrySource) && (geometryShader == 0)))
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(geometryShader);
+		glDeleteShader(fragmentShader);
+		return 0;
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	if (geometryShader != 0)
+	{
+		glAttachShader(program, geometryShader);
+	}
+	glAttachShader(program, fragmentShader);
+	glLinkProgram(program);
+
+	// the shader objects are no longer needed once linked
+	glDetachShader(program, vertexShader);
+	glDetachShader(program, fragmentShader);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	if (geometryShader != 0)
+	{
+		glDetachShader(program, geometryShader);
+		glDeleteShader(geometryShader);
+	}
+
+	GLint bSuccess = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &bSuccess);
+	if (bSuccess == GL_FALSE)
+	{
+		GLint logLength = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+		std::vector<char> infoLog(logLength > 1 ? logLength : 1);
+		glGetProgramInfoLog(program, (GLsizei)infoLog.size(), NULL, infoLog.data());
+		std::cout << "ERROR: " << programName << " program link failed\n" << infoLog.data() << std::endl;
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
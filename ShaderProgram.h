@@ -0,0 +1,26 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderprogram.h
+// ============
+// compile small built-in GLSL programs used by the rendering helpers
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+// compile and link a program from in-memory vertex and fragment
+// shader source, returns 0 and logs the error on failure
+GLuint CreateShaderProgram(
+	const char* vertexSource,
+	const char* fragmentSource,
+	const char* programName);
+// the same with a geometry shader stage between the two
+GLuint CreateShaderProgram(
+	const char* vertexSource,
+	const char* geometrySource,
+	const char* fragmentSource,
+	const char* programName);
+
+// full screen triangle vertex shader shared by the post passes,
+// outputs "fragUV" in the range 0..1
+extern const char* const g_FullscreenVertexSource;
@@ -0,0 +1,294 @@
+///////////////////////////////////////////////////////////////////////////////
+// staticlayout.h
+// ============
+// bake fixed scene layouts into model matrices and bounds at compile time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  StaticLayout
+ *
+ *  This class turns a scene layout declared as constant
+ *  data into read-only tables while the program compiles.
+ *  Each object of the layout gets the model matrix that
+ *  SetTransformations() would build, its world space bounds
+ *  and a sort key, and the table is already in the order of
+ *  the draw list, grouped by texture and then by material.
+ *  Everything here is constexpr, so the compiler does the
+ *  math and nothing is left to set up when the scene loads.
+ ***********************************************************/
+class StaticLayout
+{
+public:
+	struct LAYOUT_VEC2
+	{
+		float u;
+		float v;
+	};
+
+	struct LAYOUT_VEC3
+	{
+		float x;
+		float y;
+		float z;
+	};
+
+	// one object of a layout, placed with the same values as
+	// SetTransformations() takes
+	struct LAYOUT_OBJECT
+	{
+		int mesh;
+		LAYOUT_VEC3 scale;
+		LAYOUT_VEC3 rotationDegrees;
+		LAYOUT_VEC3 position;
+		LAYOUT_VEC2 uvScale;
+		const char* materialTag;
+		const char* textureTag;
+	};
+
+	// local bounds of one of the meshes a layout references
+	struct LAYOUT_BOUNDS
+	{
+		LAYOUT_VEC3 min;
+		LAYOUT_VEC3 max;
+	};
+
+	// one object of a layout after baking
+	struct BAKED_OBJECT
+	{
+		// index of the object in the layout
+		int source;
+		// column major model matrix, in the layout of glm::mat4
+		float model[16];
+		// world space bounds used for culling
+		LAYOUT_VEC3 boundsMin;
+		LAYOUT_VEC3 boundsMax;
+		// objects with the same key share their texture and
+		// material, and the keys count up along the table
+		int sortKey;
+	};
+
+	// the objects of a layout in draw list order
+	template <int COUNT>
+	struct BAKED_LAYOUT
+	{
+		static const int OBJECT_COUNT = COUNT;
+		BAKED_OBJECT objects[COUNT];
+	};
+
+	// bake a layout, the mesh bounds are indexed by the mesh
+	// value of the objects
+	template <int COUNT>
+	static constexpr BAKED_LAYOUT<COUNT> Bake(
+		const LAYOUT_OBJECT (&objects)[COUNT],
+		const LAYOUT_BOUNDS* pMeshBounds);
+
+	// sine of an angle in degrees that the compiler can evaluate
+	static constexpr double Sine(double degrees);
+	static constexpr double Cosine(double degrees) { return(Sine(degrees + 90.0)); }
+
+	// the draw list order of two objects, below zero when the
+	// first one comes first
+	static constexpr int CompareObjects(const LAYOUT_OBJECT& a, const LAYOUT_OBJECT& b);
+
+private:
+	static constexpr int CompareTags(const char* a, const char* b);
+	static constexpr float Abs(float value) { return((value < 0.0f) ? -value : value); }
+	static constexpr void BuildModel(const LAYOUT_OBJECT& object, float* model);
+	static constexpr void TransformBounds(
+		const float* model,
+		const LAYOUT_BOUNDS& local,
+		LAYOUT_VEC3& worldMin,
+		LAYOUT_VEC3& worldMax);
+};
+
+/***********************************************************
+ *  Sine()
+ *
+ *  This method returns the sine of an angle in degrees from
+ *  its Taylor series. The angle is first brought into the
+ *  range of a half turn either way, where a dozen terms are
+ *  well past the precision of a float.
+ ***********************************************************/
+constexpr double StaticLayout::Sine(double degrees)
+{
+	while (degrees > 180.0)
+	{
+		degrees -= 360.0;
+	}
+	while (degrees < -180.0)
+	{
+		degrees += 360.0;
+	}
+
+	double radians = degrees * (3.14159265358979323846 / 180.0);
+	double term = radians;
+	double sum = radians;
+	for (int n = 1; n <= 12; n++)
+	{
+		term *= -radians * radians / ((2.0 * n) * (2.0 * n + 1.0));
+		sum += term;
+	}
+
+	return(sum);
+}
+
+/***********************************************************
+ *  CompareTags()
+ *
+ *  This method compares two tags character by character,
+ *  in the same order as std::string::compare().
+ ***********************************************************/
+constexpr int StaticLayout::CompareTags(const char* a, const char* b)
+{
+	int i = 0;
+	while ((a[i] != '\0') && (a[i] == b[i]))
+	{
+		i++;
+	}
+
+	return((int)(unsigned char)a[i] - (int)(unsigned char)b[i]);
+}
+
+/***********************************************************
+ *  CompareObjects()
+ *
+ *  This method orders two objects by texture and then by
+ *  material, so the shader values only change when the next
+ *  object of the draw list differs.
+ ***********************************************************/
+constexpr int StaticLayout::CompareObjects(const LAYOUT_OBJECT& a, const LAYOUT_OBJECT& b)
+{
+	int textureOrder = CompareTags(a.textureTag, b.textureTag);
+	if (textureOrder != 0)
+	{
+		return(textureOrder);
+	}
+
+	return(CompareTags(a.materialTag, b.materialTag));
+}
+
+/***********************************************************
+ *  BuildModel()
+ *
+ *  This method combines the placement of an object into a
+ *  model matrix, as translation * rotationX * rotationY *
+ *  rotationZ * scale like BuildModelMatrix() in the scene.
+ ***********************************************************/
+constexpr void StaticLayout::BuildModel(const LAYOUT_OBJECT& object, float* model)
+{
+	double sx = Sine(object.rotationDegrees.x);
+	double cx = Cosine(object.rotationDegrees.x);
+	double sy = Sine(object.rotationDegrees.y);
+	double cy = Cosine(object.rotationDegrees.y);
+	double sz = Sine(object.rotationDegrees.z);
+	double cz = Cosine(object.rotationDegrees.z);
+
+	// rows of rotationX * rotationY * rotationZ
+	double rotation[3][3] = {
+		{ cy * cz, -cy * sz, sy },
+		{ sx * sy * cz + cx * sz, -sx * sy * sz + cx * cz, -sx * cy },
+		{ -cx * sy * cz + sx * sz, cx * sy * sz + sx * cz, cx * cy } };
+	double scale[3] = { object.scale.x, object.scale.y, object.scale.z };
+
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			model[column * 4 + row] = (float)(rotation[row][column] * scale[column]);
+		}
+		model[column * 4 + 3] = 0.0f;
+	}
+	model[12] = object.position.x;
+	model[13] = object.position.y;
+	model[14] = object.position.z;
+	model[15] = 1.0f;
+}
+
+/***********************************************************
+ *  TransformBounds()
+ *
+ *  This method gets the world space box around a local box
+ *  after the model matrix, the same way as the view frustum
+ *  does it for objects placed at run time.
+ ***********************************************************/
+constexpr void StaticLayout::TransformBounds(
+	const float* model,
+	const LAYOUT_BOUNDS& local,
+	LAYOUT_VEC3& worldMin,
+	LAYOUT_VEC3& worldMax)
+{
+	float localCenter[3] = {
+		(local.min.x + local.max.x) * 0.5f,
+		(local.min.y + local.max.y) * 0.5f,
+		(local.min.z + local.max.z) * 0.5f };
+	float extent[3] = {
+		(local.max.x - local.min.x) * 0.5f,
+		(local.max.y - local.min.y) * 0.5f,
+		(local.max.z - local.min.z) * 0.5f };
+
+	float center[3] = { 0.0f, 0.0f, 0.0f };
+	float worldExtent[3] = { 0.0f, 0.0f, 0.0f };
+	for (int axis = 0; axis < 3; axis++)
+	{
+		center[axis] = model[12 + axis];
+		for (int column = 0; column < 3; column++)
+		{
+			center[axis] += model[column * 4 + axis] * localCenter[column];
+			worldExtent[axis] += Abs(model[column * 4 + axis]) * extent[column];
+		}
+	}
+
+	worldMin.x = center[0] - worldExtent[0];
+	worldMin.y = center[1] - worldExtent[1];
+	worldMin.z = center[2] - worldExtent[2];
+	worldMax.x = center[0] + worldExtent[0];
+	worldMax.y = center[1] + worldExtent[1];
+	worldMax.z = center[2] + worldExtent[2];
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method bakes every object of a layout. The order of
+ *  the objects comes from a stable insertion sort, so ones
+ *  that share a texture and material keep the order they
+ *  were declared in, and the table is filled in that order.
+ ***********************************************************/
+template <int COUNT>
+constexpr StaticLayout::BAKED_LAYOUT<COUNT> StaticLayout::Bake(
+	const LAYOUT_OBJECT (&objects)[COUNT],
+	const LAYOUT_BOUNDS* pMeshBounds)
+{
+	int order[COUNT] = {};
+	for (int i = 0; i < COUNT; i++)
+	{
+		int slot = i;
+		while ((slot > 0) && (CompareObjects(objects[i], objects[order[slot - 1]]) < 0))
+		{
+			order[slot] = order[slot - 1];
+			slot--;
+		}
+		order[slot] = i;
+	}
+
+	BAKED_LAYOUT<COUNT> baked = {};
+	int sortKey = 0;
+	for (int i = 0; i < COUNT; i++)
+	{
+		const LAYOUT_OBJECT& object = objects[order[i]];
+		if ((i > 0) && (CompareObjects(object, objects[order[i - 1]]) != 0))
+		{
+			sortKey++;
+		}
+
+		BAKED_OBJECT& target = baked.objects[i];
+		target.source = order[i];
+		target.sortKey = sortKey;
+		BuildModel(object, target.model);
+		TransformBounds(target.model, pMeshBounds[object.mesh], target.boundsMin, target.boundsMax);
+	}
+
+	return(baked);
+}
@@ -0,0 +1,420 @@
+///////////////////////////////////////////////////////////////////////////////
+// stereorenderer.cpp
+// ============
+// draw both eyes of a stereo frame with one draw call per object
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StereoRenderer.h"
+#include "ShaderProgram.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	// longest uniform name that is looked for in both programs
+	const GLsizei MAX_UNIFORM_NAME = 256;
+
+	// the vertex inputs of ShapeMeshes, passed on in world space
+	const char* const g_StereoVertexSource = R"GLSL(
+#version 410 core
+layout(location = 0) in vec3 inVertexPosition;
+layout(location = 1) in vec3 inVertexNormal;
+layout(location = 2) in vec2 inTextureCoordinate;
+
+uniform mat4 model;
+
+out vec3 worldPosition;
+out vec3 worldNormal;
+out vec2 textureCoordinate;
+
+void main()
+{
+	vec4 position = model * vec4(inVertexPosition, 1.0);
+	worldPosition = position.xyz;
+	worldNormal = mat3(transpose(inverse(model))) * inVertexNormal;
+	textureCoordinate = inTextureCoordinate;
+	gl_Position = position;
+}
+)GLSL";
+
+	// each triangle is emitted once per eye into the viewport of
+	// that eye, with the outputs the scene fragment shader reads
+	const char* const g_StereoGeometrySource = R"GLSL(
+#version 410 core
+layout(triangles, invocations = 2) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+in vec3 worldPosition[];
+in vec3 worldNormal[];
+in vec2 textureCoordinate[];
+
+uniform mat4 eyeViewProjections[2];
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+
+void main()
+{
+	for (int i = 0; i < 3; i++)
+	{
+		gl_Position = eyeViewProjections[gl_InvocationID] * vec4(worldPosition[i], 1.0);
+		gl_ViewportIndex = gl_InvocationID;
+		fragmentPosition = worldPosition[i];
+		fragmentVertexNormal = worldNormal[i];
+		fragmentTextureCoordinate = textureCoordinate[i];
+		EmitVertex();
+	}
+	EndPrimitive();
+}
+)GLSL";
+
+	/***********************************************************
+	 *  GetFragmentSource()
+	 *
+	 *  This function is used to get the source of the fragment
+	 *  shader attached to a program. Returns false when the
+	 *  shader was detached after linking.
+	 ***********************************************************/
+	bool GetFragmentSource(GLuint program, std::string& source)
+	{
+		GLuint shaders[8];
+		GLsizei shaderCount = 0;
+		glGetAttachedShaders(program, 8, &shaderCount, shaders);
+
+		for (GLsizei i = 0; i < shaderCount; i++)
+		{
+			GLint shaderType = 0;
+			glGetShaderiv(shaders[i], GL_SHADER_TYPE, &shaderType);
+			if (shaderType != GL_FRAGMENT_SHADER)
+			{
+				continue;
+			}
+
+			GLint sourceLength = 0;
+			glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &sourceLength);
+			if (sourceLength <= 1)
+			{
+				return(false);
+			}
+			std::vector<GLchar> sourceText(sourceLength);
+			glGetShaderSource(shaders[i], sourceLength, NULL, sourceText.data());
+			source = sourceText.data();
+			return(true);
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  IsCopiedType()
+	 *
+	 *  This function returns true for the types of values that
+	 *  the scene program uses.
+	 ***********************************************************/
+	bool IsCopiedType(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_FLOAT:
+		case GL_FLOAT_VEC2:
+		case GL_FLOAT_VEC3:
+		case GL_FLOAT_VEC4:
+		case GL_FLOAT_MAT3:
+		case GL_FLOAT_MAT4:
+		case GL_INT:
+		case GL_BOOL:
+		case GL_SAMPLER_2D:
+			return(true);
+		default:
+			return(false);
+		}
+	}
+}
+
+/***********************************************************
+ *  StereoRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StereoRenderer::StereoRenderer()
+{
+	m_sceneProgram = 0;
+	m_pTextureSamplers = NULL;
+	m_eyeViewProjectionsLocation = -1;
+	m_previousProgram = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_previousViewport[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~StereoRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StereoRenderer::~StereoRenderer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to build the stereo program from the
+ *  fragment shader of the scene program. Without viewport
+ *  arrays, or when the fragment shader cannot be read back,
+ *  the stereo frames are drawn one eye at a time instead.
+ ***********************************************************/
+bool StereoRenderer::Initialize(GLuint sceneProgram, const TextureSamplers* pTextureSamplers)
+{
+	Destroy();
+
+	if (!GLEW_VERSION_4_1)
+	{
+		std::cout << "INFO: Single pass stereo needs OpenGL 4.1, the eyes are drawn one at a time" << std::endl;
+		return(false);
+	}
+
+	std::string fragmentSource;
+	if ((sceneProgram == 0) || !GetFragmentSource(sceneProgram, fragmentSource))
+	{
+		std::cout << "INFO: Single pass stereo could not read the scene fragment shader, the eyes are drawn one at a time" << std::endl;
+		return(false);
+	}
+
+	m_program = GpuProgram(CreateShaderProgram(g_StereoVertexSource, g_StereoGeometrySource, fragmentSource.c_str(), "single pass stereo"));
+	if (!m_program.IsValid())
+	{
+		return(false);
+	}
+
+	m_sceneProgram = sceneProgram;
+	m_pTextureSamplers = pTextureSamplers;
+	m_eyeViewProjectionsLocation = GetLocation("eyeViewProjections");
+	FindCopiedUniforms();
+
+	std::cout << "INFO: Single pass stereo draws both eyes from a geometry shader, "
+		<< m_copiedUniforms.size() << " values copied from the scene program" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the program.
+ ***********************************************************/
+void StereoRenderer::Destroy()
+{
+	m_program.Reset();
+	m_sceneProgram = 0;
+	m_copiedUniforms.clear();
+	m_eyeViewProjectionsLocation = -1;
+}
+
+/***********************************************************
+ *  FindCopiedUniforms()
+ *
+ *  This method is used to find the values of the stereo
+ *  program that the scene program has as well, which are the
+ *  ones of the shared fragment shader. Arrays are looked up
+ *  one element at a time, since an array of structures such
+ *  as the lights has a location for every member.
+ ***********************************************************/
+void StereoRenderer::FindCopiedUniforms()
+{
+	GLuint program = m_program.Get();
+	GLint uniformCount = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLchar name[MAX_UNIFORM_NAME];
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program, (GLuint)i, MAX_UNIFORM_NAME, NULL, &size, &type, name);
+		if (!IsCopiedType(type))
+		{
+			continue;
+		}
+
+		std::string baseName(name);
+		if ((size > 1) && (baseName.size() > 3) && (baseName.compare(baseName.size() - 3, 3, "[0]") == 0))
+		{
+			baseName.erase(baseName.size() - 3);
+		}
+
+		for (GLint element = 0; element < size; element++)
+		{
+			std::string elementName = (size > 1) ? (baseName + "[" + std::to_string(element) + "]") : baseName;
+
+			COPIED_UNIFORM uniform;
+			uniform.sourceLocation = glGetUniformLocation(m_sceneProgram, elementName.c_str());
+			uniform.targetLocation = glGetUniformLocation(program, elementName.c_str());
+			uniform.type = type;
+			if ((uniform.sourceLocation >= 0) && (uniform.targetLocation >= 0))
+			{
+				m_copiedUniforms.push_back(uniform);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  CopySceneValues()
+ *
+ *  This method is used to copy the current values of the
+ *  scene program into the stereo program, which is in use.
+ ***********************************************************/
+void StereoRenderer::CopySceneValues()
+{
+	GLfloat floatValues[16];
+	GLint intValue = 0;
+
+	for (size_t i = 0; i < m_copiedUniforms.size(); i++)
+	{
+		const COPIED_UNIFORM& uniform = m_copiedUniforms[i];
+		switch (uniform.type)
+		{
+		case GL_FLOAT:
+			glGetUniformfv(m_sceneProgram, uniform.sourceLocation, floatValues);
+			glUniform1fv(uniform.targetLocation, 1, floatValues);
+			break;
+		case GL_FLOAT_VEC2:
+			glGetUniformfv(m_sceneProgram, uniform.sourceLocation, floatValues);
+			glUniform2fv(uniform.targetLocation, 1, floatValues);
+			break;
+		case GL_FLOAT_VEC3:
+			glGetUniformfv(m_sceneProgram, uniform.sourceLocation, floatValues);
+			glUniform3fv(uniform.targetLocation, 1, floatValues);
+			break;
+		case GL_FLOAT_VEC4:
+			glGetUniformfv(m_sceneProgram, uniform.sourceLocation, floatValues);
+			glUniform4fv(uniform.targetLocation, 1, floatValues);
+			break;
+		case GL_FLOAT_MAT3:
+			glGetUniformfv(m_sceneProgram, uniform.sourceLocation, floatValues);
+			glUniformMatrix3fv(uniform.targetLocation, 1, GL_FALSE, floatValues);
+			break;
+		case GL_FLOAT_MAT4:
+			glGetUniformfv(m_sceneProgram, uniform.sourceLocation, floatValues);
+			glUniformMatrix4fv(uniform.targetLocation, 1, GL_FALSE, floatValues);
+			break;
+		default:
+			glGetUniformiv(m_sceneProgram, uniform.sourceLocation, &intValue);
+			glUniform1i(uniform.targetLocation, intValue);
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used to switch to the stereo program with
+ *  the current values of the scene program, and to set the
+ *  matrix and the viewport of each eye.
+ ***********************************************************/
+void StereoRenderer::Begin(const glm::mat4* pEyeViewProjections, const int (*pEyeViewports)[4])
+{
+	glGetIntegerv(GL_CURRENT_PROGRAM, &m_previousProgram);
+	glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+
+	glUseProgram(m_program.Get());
+	CopySceneValues();
+	glUniformMatrix4fv(m_eyeViewProjectionsLocation, EYE_COUNT, GL_FALSE, glm::value_ptr(pEyeViewProjections[0]));
+	for (int eye = 0; eye < EYE_COUNT; eye++)
+	{
+		glViewportIndexedf(eye,
+			(GLfloat)pEyeViewports[eye][0],
+			(GLfloat)pEyeViewports[eye][1],
+			(GLfloat)pEyeViewports[eye][2],
+			(GLfloat)pEyeViewports[eye][3]);
+	}
+}
+
+/***********************************************************
+ *  End()
+ *
+ *  This method is used to restore the program and the
+ *  viewport, which sets every viewport of the array again.
+ ***********************************************************/
+void StereoRenderer::End()
+{
+	glUseProgram((GLuint)m_previousProgram);
+	glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+}
+
+/***********************************************************
+ *  SetMat4Value()
+ *
+ *  This method is used to set a matrix of the stereo
+ *  program. The other values are set the same way.
+ ***********************************************************/
+void StereoRenderer::SetMat4Value(const char* name, const glm::mat4& value)
+{
+	glUniformMatrix4fv(GetLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void StereoRenderer::SetVec4Value(const char* name, const glm::vec4& value)
+{
+	glUniform4fv(GetLocation(name), 1, glm::value_ptr(value));
+}
+
+void StereoRenderer::SetVec3Value(const char* name, const glm::vec3& value)
+{
+	glUniform3fv(GetLocation(name), 1, glm::value_ptr(value));
+}
+
+void StereoRenderer::SetVec2Value(const char* name, const glm::vec2& value)
+{
+	glUniform2fv(GetLocation(name), 1, glm::value_ptr(value));
+}
+
+void StereoRenderer::SetFloatValue(const char* name, float value)
+{
+	glUniform1f(GetLocation(name), value);
+}
+
+void StereoRenderer::SetIntValue(const char* name, int value)
+{
+	glUniform1i(GetLocation(name), value);
+}
+
+void StereoRenderer::SetBoolValue(const char* name, bool value)
+{
+	glUniform1i(GetLocation(name), (int)value);
+}
+
+void StereoRenderer::SetSampler2DValue(const char* name, int textureUnit)
+{
+	glUniform1i(GetLocation(name), textureUnit);
+}
+
+/***********************************************************
+ *  BindSampler()
+ *
+ *  This method is used to bind the sampler object of a tier
+ *  and wrap mode to a unit.
+ ***********************************************************/
+void StereoRenderer::BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap)
+{
+	glBindSampler(textureUnit, m_pTextureSamplers->GetSampler(tier, wrap));
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used to draw a mesh of a registry into
+ *  both eyes.
+ ***********************************************************/
+void StereoRenderer::DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle)
+{
+	pMeshRegistry->Draw(handle);
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// stereorenderer.h
+// ============
+// draw both eyes of a stereo frame with one draw call per object
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResource.h"
+#include "RenderBackend.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  StereoRenderer
+ *
+ *  This class is a backend that draws every mesh into both
+ *  eye viewports of a side-by-side stereo frame at once. Its
+ *  program is the fragment shader of the scene program after
+ *  a geometry shader that runs twice per triangle, once for
+ *  each eye, and picks the viewport of the eye, so the draw
+ *  list is submitted a single time. The values of the scene
+ *  program, such as the lights, are copied into it when a
+ *  stereo frame begins.
+ *
+ *  OVR_multiview would draw the eyes into the layers of an
+ *  array texture, but the eyes share one side-by-side target,
+ *  and the meshes of ShapeMeshes cannot be drawn instanced,
+ *  so the eye is taken from the geometry shader invocation.
+ ***********************************************************/
+class StereoRenderer : public RenderBackend
+{
+public:
+	// the eyes drawn by every call
+	static const int EYE_COUNT = 2;
+
+	// constructor
+	StereoRenderer();
+	// destructor
+	~StereoRenderer();
+
+	// build the stereo program from the fragment shader of the
+	// scene program, false when it is not available
+	bool Initialize(GLuint sceneProgram, const TextureSamplers* pTextureSamplers);
+	// free the program
+	void Destroy();
+	bool IsInitialized() const { return(m_program.IsValid()); }
+
+	// switch to the stereo program with the values of the scene
+	// program, the eye matrices and the eye viewports
+	void Begin(const glm::mat4* pEyeViewProjections, const int (*pEyeViewports)[4]);
+	// restore the scene program and the viewport
+	void End();
+
+	bool IsGpuBackend() const { return(true); }
+
+	// the values are set into the stereo program, which must be
+	// in use between Begin() and End()
+	void SetMat4Value(const char* name, const glm::mat4& value);
+	void SetVec4Value(const char* name, const glm::vec4& value);
+	void SetVec3Value(const char* name, const glm::vec3& value);
+	void SetVec2Value(const char* name, const glm::vec2& value);
+	void SetFloatValue(const char* name, float value);
+	void SetIntValue(const char* name, int value);
+	void SetBoolValue(const char* name, bool value);
+	void SetSampler2DValue(const char* name, int textureUnit);
+
+	void BindSampler(int textureUnit, SAMPLER_TIER tier, SAMPLER_WRAP wrap);
+	void DrawMesh(const MeshRegistry* pMeshRegistry, MeshRegistry::MESH_HANDLE handle);
+	// the eye viewports stay set until End(), so these do nothing
+	void SetViewport(int x, int y, int width, int height) {}
+	void ClearRegion(int x, int y, int width, int height) {}
+
+private:
+	// a value of the scene program that is also in the stereo one
+	struct COPIED_UNIFORM
+	{
+		GLint sourceLocation;
+		GLint targetLocation;
+		GLenum type;
+	};
+
+	GpuProgram m_program;
+	GLuint m_sceneProgram;
+	const TextureSamplers* m_pTextureSamplers;
+	std::vector<COPIED_UNIFORM> m_copiedUniforms;
+	GLint m_eyeViewProjectionsLocation;
+	// the state to restore after drawing
+	GLint m_previousProgram;
+	GLint m_previousViewport[4];
+
+	// find the values that both programs have
+	void FindCopiedUniforms();
+	// copy the current values of the scene program
+	void CopySceneValues();
+	GLint GetLocation(const char* name) const { return(glGetUniformLocation(m_program.Get(), name)); }
+};
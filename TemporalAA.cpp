@@ -0,0 +1,444 @@
+///////////////////////////////////////////////////////////////////////////////
+// temporalaa.cpp
+// ============
+// temporal anti-aliasing using a jittered projection, reprojection of the
+// previous frame from cached matrices, and neighbourhood history clamping
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TemporalAA.h"
+#include "ShaderProgram.h"
+
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// number of samples in the jitter sequence before it repeats
+	const unsigned int JITTER_SAMPLE_COUNT = 8;
+	// weight of the newest frame when blending into the history
+	const float CURRENT_FRAME_WEIGHT = 0.1f;
+	// texture units used by the resolve pass, kept above the 16
+	// slots that the scene binds its textures to once at startup
+	const int RESOLVE_TEXTURE_UNIT = 16;
+
+	const char* const g_ResolveFragmentSource = R"GLSL(
+#version 330 core
+in vec2 fragUV;
+out vec4 fragmentColor;
+
+uniform sampler2D currentColor;
+uniform sampler2D currentDepth;
+uniform sampler2D historyColor;
+uniform mat4 inverseViewProjection;
+uniform mat4 previousViewProjection;
+uniform vec2 jitterUV;
+uniform vec2 texelSize;
+uniform float currentWeight;
+uniform bool bHistoryValid;
+
+vec3 RGBToYCoCg(vec3 c)
+{
+	return vec3(
+		 0.25 * c.r + 0.5 * c.g + 0.25 * c.b,
+		 0.5  * c.r             - 0.5  * c.b,
+		-0.25 * c.r + 0.5 * c.g - 0.25 * c.b);
+}
+
+vec3 YCoCgToRGB(vec3 c)
+{
+	return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+void main()
+{
+	vec3 current = texture(currentColor, fragUV).rgb;
+	if (!bHistoryValid)
+	{
+		fragmentColor = vec4(current, 1.0);
+		return;
+	}
+
+	// rebuild the world position of this pixel from the jittered depth
+	float depth = texture(currentDepth, fragUV).r;
+	vec4 worldPosition = inverseViewProjection * vec4(vec3(fragUV, depth) * 2.0 - 1.0, 1.0);
+	worldPosition /= worldPosition.w;
+
+	// project it with last frame's unjittered matrices to get the motion vector
+	vec4 previousClip = previousViewProjection * worldPosition;
+	vec2 previousUV = (previousClip.xy / previousClip.w) * 0.5 + 0.5;
+	vec2 motion = (fragUV - jitterUV) - previousUV;
+	vec2 historyUV = fragUV - motion;
+
+	if (any(lessThan(historyUV, vec2(0.0))) || any(greaterThan(historyUV, vec2(1.0))))
+	{
+		fragmentColor = vec4(current, 1.0);
+		return;
+	}
+
+	// clamp the history to the colour range of the current 3x3 neighbourhood
+	vec3 neighbourMin = vec3(1.0e6);
+	vec3 neighbourMax = vec3(-1.0e6);
+	for (int y = -1; y <= 1; y++)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			vec3 sampleColor = RGBToYCoCg(texture(currentColor, fragUV + vec2(x, y) * texelSize).rgb);
+			neighbourMin = min(neighbourMin, sampleColor);
+			neighbourMax = max(neighbourMax, sampleColor);
+		}
+	}
+
+	vec3 history = RGBToYCoCg(texture(historyColor, historyUV).rgb);
+	history = YCoCgToRGB(clamp(history, neighbourMin, neighbourMax));
+
+	fragmentColor = vec4(mix(history, current, currentWeight), 1.0);
+}
+)GLSL";
+
+	/***********************************************************
+	 *  Halton()
+	 *
+	 *  This function returns the element of the low discrepancy
+	 *  Halton sequence for the passed in index and base.
+	 ***********************************************************/
+	float Halton(unsigned int index, unsigned int base)
+	{
+		float fraction = 1.0f;
+		float result = 0.0f;
+
+		while (index > 0)
+		{
+			fraction /= (float)base;
+			result += fraction * (float)(index % base);
+			index /= base;
+		}
+
+		return(result);
+	}
+
+	/***********************************************************
+	 *  CreateColorTarget()
+	 *
+	 *  This function is used to create a half float texture
+	 *  that can be rendered into and sampled by the resolve.
+	 ***********************************************************/
+	GpuTexture CreateColorTarget(int width, int height)
+	{
+		GpuTexture texture = GpuTexture::Create();
+
+		glBindTexture(GL_TEXTURE_2D, texture.Get());
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+		texture.TrackMemory(GPU_MEMORY_RENDER_TARGETS, GpuMemory::EstimateImageBytes(width, height, 8, false));
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		return(texture);
+	}
+}
+
+/***********************************************************
+ *  TemporalAA()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TemporalAA::TemporalAA()
+{
+	m_bInitialized = false;
+	m_bEnabled = true;
+	m_width = 0;
+	m_height = 0;
+	m_sceneFramebuffer = 0;
+	m_historyFramebuffers[0] = m_historyFramebuffers[1] = 0;
+	m_historyIndex = 0;
+	m_bHistoryValid = false;
+	m_frameIndex = 0;
+	m_currentJitter = glm::vec2(0.0f, 0.0f);
+	m_currentViewProjection = glm::mat4(1.0f);
+	m_previousViewProjection = glm::mat4(1.0f);
+	m_bPreviousMatricesValid = false;
+}
+
+/***********************************************************
+ *  ~TemporalAA()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TemporalAA::~TemporalAA()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to create the offscreen scene target,
+ *  the history buffers and the resolve shader program.
+ ***********************************************************/
+bool TemporalAA::Initialize(int width, int height)
+{
+	Destroy();
+
+	m_width = width;
+	m_height = height;
+
+	// the scene target needs a depth texture so that the
+	// resolve pass can reconstruct world positions
+	m_sceneColor = CreateColorTarget(width, height);
+
+	m_sceneDepth = GpuTexture::Create();
+	glBindTexture(GL_TEXTURE_2D, m_sceneDepth.Get());
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+	m_sceneDepth.TrackMemory(GPU_MEMORY_RENDER_TARGETS, GpuMemory::EstimateImageBytes(width, height, 4, false));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &m_sceneFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_sceneColor.Get(), 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_sceneDepth.Get(), 0);
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+	for (int i = 0; i < 2; i++)
+	{
+		m_historyColors[i] = CreateColorTarget(width, height);
+		glGenFramebuffers(1, &m_historyFramebuffers[i]);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_historyFramebuffers[i]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_historyColors[i].Get(), 0);
+		bComplete = bComplete && (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	m_resolveProgram = GpuProgram(CreateShaderProgram(g_FullscreenVertexSource, g_ResolveFragmentSource, "TAA resolve"));
+	m_emptyVAO = GpuVertexArray::Create();
+
+	if ((bComplete == false) || !m_resolveProgram.IsValid())
+	{
+		std::cout << "ERROR: Temporal anti-aliasing could not be initialized" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_bInitialized = true;
+	ResetHistory();
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the render targets and the
+ *  resolve program.
+ ***********************************************************/
+void TemporalAA::Destroy()
+{
+	if (m_sceneFramebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_sceneFramebuffer);
+		m_sceneFramebuffer = 0;
+	}
+	m_sceneColor.Reset();
+	m_sceneDepth.Reset();
+	for (int i = 0; i < 2; i++)
+	{
+		if (m_historyFramebuffers[i] != 0)
+		{
+			glDeleteFramebuffers(1, &m_historyFramebuffers[i]);
+			m_historyFramebuffers[i] = 0;
+		}
+		m_historyColors[i].Reset();
+	}
+	// the program, textures and vertex array are deleted once
+	// the frames that may still use them have finished
+	m_resolveProgram.Reset();
+	m_emptyVAO.Reset();
+
+	m_bInitialized = false;
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method is used to turn the anti-aliasing on or off.
+ *  The history is discarded so stale frames never blend in.
+ ***********************************************************/
+void TemporalAA::SetEnabled(bool bEnabled)
+{
+	if (m_bEnabled != bEnabled)
+	{
+		m_bEnabled = bEnabled;
+		ResetHistory();
+	}
+}
+
+/***********************************************************
+ *  ResetHistory()
+ *
+ *  This method is used to discard the accumulated history.
+ ***********************************************************/
+void TemporalAA::ResetHistory()
+{
+	m_bHistoryValid = false;
+	m_bPreviousMatricesValid = false;
+}
+
+/***********************************************************
+ *  GetJitterOffset()
+ *
+ *  This method returns the sub-pixel offset for the passed
+ *  in frame in normalized device coordinates, using a
+ *  Halton (2,3) sequence centered on the pixel.
+ ***********************************************************/
+glm::vec2 TemporalAA::GetJitterOffset(unsigned int frameIndex) const
+{
+	unsigned int sampleIndex = (frameIndex % JITTER_SAMPLE_COUNT) + 1;
+
+	glm::vec2 offset(
+		Halton(sampleIndex, 2) - 0.5f,
+		Halton(sampleIndex, 3) - 0.5f);
+
+	// convert from pixels to NDC, where the viewport is 2 units wide
+	offset.x *= 2.0f / (float)m_width;
+	offset.y *= 2.0f / (float)m_height;
+
+	return(offset);
+}
+
+/***********************************************************
+ *  SetFrameMatrices()
+ *
+ *  This method is used to cache the unjittered view and
+ *  projection for this frame. The previous frame's matrices
+ *  are kept so the resolve pass can compute motion vectors.
+ ***********************************************************/
+void TemporalAA::SetFrameMatrices(const glm::mat4& view, const glm::mat4& projection)
+{
+	if (m_bPreviousMatricesValid)
+	{
+		m_previousViewProjection = m_currentViewProjection;
+	}
+
+	m_currentViewProjection = projection * view;
+	m_currentJitter = GetJitterOffset(m_frameIndex);
+
+	if (!m_bPreviousMatricesValid)
+	{
+		m_previousViewProjection = m_currentViewProjection;
+		m_bPreviousMatricesValid = true;
+	}
+}
+
+/***********************************************************
+ *  JitterProjection()
+ *
+ *  This method is used to shift the passed in projection by
+ *  this frame's sub-pixel jitter. Applying the offset after
+ *  the projection works for both perspective and orthographic
+ *  projections.
+ ***********************************************************/
+glm::mat4 TemporalAA::JitterProjection(const glm::mat4& projection) const
+{
+	if (!IsEnabled())
+	{
+		return(projection);
+	}
+
+	return(glm::translate(glm::vec3(m_currentJitter.x, m_currentJitter.y, 0.0f)) * projection);
+}
+
+/***********************************************************
+ *  BeginSceneRender()
+ *
+ *  This method is used to redirect the scene rendering into
+ *  the offscreen target when anti-aliasing is enabled.
+ ***********************************************************/
+void TemporalAA::BeginSceneRender()
+{
+	if (IsEnabled())
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer);
+		glViewport(0, 0, m_width, m_height);
+	}
+}
+
+/***********************************************************
+ *  ResolveAndPresent()
+ *
+ *  This method is used to blend the current frame with the
+ *  reprojected history into the next history buffer, and
+ *  then copy the result to the window's back buffer.
+ ***********************************************************/
+void TemporalAA::ResolveAndPresent()
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	int previousIndex = m_historyIndex;
+	int nextIndex = 1 - m_historyIndex;
+
+	// remember the scene program so the next frame renders normally
+	GLint sceneProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &sceneProgram);
+	GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+	GLboolean bBlend = glIsEnabled(GL_BLEND);
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_historyFramebuffers[nextIndex]);
+	glViewport(0, 0, m_width, m_height);
+
+	glUseProgram(m_resolveProgram.Get());
+
+	glActiveTexture(GL_TEXTURE0 + RESOLVE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_sceneColor.Get());
+	glActiveTexture(GL_TEXTURE0 + RESOLVE_TEXTURE_UNIT + 1);
+	glBindTexture(GL_TEXTURE_2D, m_sceneDepth.Get());
+	glActiveTexture(GL_TEXTURE0 + RESOLVE_TEXTURE_UNIT + 2);
+	glBindTexture(GL_TEXTURE_2D, m_historyColors[previousIndex].Get());
+
+	glm::mat4 jitteredViewProjection =
+		glm::translate(glm::vec3(m_currentJitter.x, m_currentJitter.y, 0.0f)) * m_currentViewProjection;
+	glm::mat4 inverseViewProjection = glm::inverse(jitteredViewProjection);
+
+	glUniform1i(glGetUniformLocation(m_resolveProgram.Get(), "currentColor"), RESOLVE_TEXTURE_UNIT);
+	glUniform1i(glGetUniformLocation(m_resolveProgram.Get(), "currentDepth"), RESOLVE_TEXTURE_UNIT + 1);
+	glUniform1i(glGetUniformLocation(m_resolveProgram.Get(), "historyColor"), RESOLVE_TEXTURE_UNIT + 2);
+	glUniformMatrix4fv(glGetUniformLocation(m_resolveProgram.Get(), "inverseViewProjection"), 1, GL_FALSE, glm::value_ptr(inverseViewProjection));
+	glUniformMatrix4fv(glGetUniformLocation(m_resolveProgram.Get(), "previousViewProjection"), 1, GL_FALSE, glm::value_ptr(m_previousViewProjection));
+	glUniform2f(glGetUniformLocation(m_resolveProgram.Get(), "jitterUV"), m_currentJitter.x * 0.5f, m_currentJitter.y * 0.5f);
+	glUniform2f(glGetUniformLocation(m_resolveProgram.Get(), "texelSize"), 1.0f / (float)m_width, 1.0f / (float)m_height);
+	glUniform1f(glGetUniformLocation(m_resolveProgram.Get(), "currentWeight"), CURRENT_FRAME_WEIGHT);
+	glUniform1i(glGetUniformLocation(m_resolveProgram.Get(), "bHistoryValid"), m_bHistoryValid ? 1 : 0);
+
+	glBindVertexArray(m_emptyVAO.Get());
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+
+	// copy the resolved frame to the window
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_historyFramebuffers[nextIndex]);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// restore the state the scene rendering expects
+	glActiveTexture(GL_TEXTURE0);
+	glUseProgram((GLuint)sceneProgram);
+	if (bDepthTest) glEnable(GL_DEPTH_TEST);
+	if (bBlend) glEnable(GL_BLEND);
+
+	m_historyIndex = nextIndex;
+	m_bHistoryValid = true;
+	m_frameIndex++;
+}
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// temporalaa.h
+// ============
+// temporal anti-aliasing using a jittered projection, reprojection of the
+// previous frame from cached matrices, and neighbourhood history clamping
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResource.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  TemporalAA
+ *
+ *  This class owns the offscreen scene target and the two
+ *  history buffers used for accumulating sub-pixel samples
+ *  across frames. The scene is drawn into the offscreen
+ *  target with a jittered projection, then resolved against
+ *  the reprojected history and presented to the window.
+ ***********************************************************/
+class TemporalAA
+{
+public:
+	// constructor
+	TemporalAA();
+	// destructor
+	~TemporalAA();
+
+	// create the render targets and resolve program
+	bool Initialize(int width, int height);
+	// free the render targets and resolve program
+	void Destroy();
+
+	// bind the offscreen target that the scene is rendered into
+	void BeginSceneRender();
+	// blend the new frame with the history and present it
+	void ResolveAndPresent();
+
+	// cache the unjittered matrices used for the current frame
+	void SetFrameMatrices(const glm::mat4& view, const glm::mat4& projection);
+	// offset the projection by the sub-pixel jitter for this frame
+	glm::mat4 JitterProjection(const glm::mat4& projection) const;
+
+	// discard the accumulated history, e.g. after a camera cut
+	void ResetHistory();
+
+	void SetEnabled(bool bEnabled);
+	bool IsEnabled() const { return(m_bEnabled && m_bInitialized); }
+
+private:
+	bool m_bInitialized;
+	bool m_bEnabled;
+	int m_width;
+	int m_height;
+
+	// offscreen scene target with a sampleable depth buffer
+	GLuint m_sceneFramebuffer;
+	GpuTexture m_sceneColor;
+	GpuTexture m_sceneDepth;
+
+	// ping-pong accumulation buffers
+	GLuint m_historyFramebuffers[2];
+	GpuTexture m_historyColors[2];
+	int m_historyIndex;
+	bool m_bHistoryValid;
+
+	// resolve program and the empty vertex array it draws with
+	GpuProgram m_resolveProgram;
+	GpuVertexArray m_emptyVAO;
+
+	// frame counter driving the jitter sequence
+	unsigned int m_frameIndex;
+	glm::vec2 m_currentJitter;
+
+	// matrices cached for reprojection
+	glm::mat4 m_currentViewProjection;
+	glm::mat4 m_previousViewProjection;
+	bool m_bPreviousMatricesValid;
+
+	// get the jitter offset in NDC units for a frame index
+	glm::vec2 GetJitterOffset(unsigned int frameIndex) const;
+};
@@ -0,0 +1,241 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.cpp
+// ============
+// store finished mip chains on disk so later runs skip decoding
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCache.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include <cstdio>
+#include <fstream>
+#include <stdint.h>
+
+// declaration of global variables
+namespace
+{
+	// folder the cached mip chains are written into
+	const char* const CACHE_FOLDER = "texture_cache";
+	// identifies a cache file, and its layout version
+	const uint32_t CACHE_MAGIC = 0x4350494D;
+	const uint32_t CACHE_VERSION = 1;
+
+	// values stored at the start of every cache file
+	struct CACHE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		int64_t sourceSize;
+		int64_t sourceModifiedTime;
+		int32_t maxTextureSize;
+		int32_t scaleLevel;
+		int32_t levelCount;
+	};
+
+	// size of one level, followed by its pixels
+	struct LEVEL_HEADER
+	{
+		int32_t width;
+		int32_t height;
+		int32_t channels;
+	};
+}
+
+/***********************************************************
+ *  GetCacheFile()
+ *
+ *  This method returns a file in the cache folder for a
+ *  source file. The folder separators of the source path are
+ *  replaced so that every cache file sits directly in the
+ *  cache folder.
+ ***********************************************************/
+std::string TextureCache::GetCacheFile(const char* filename, const std::string& extension)
+{
+	std::string name = filename;
+	for (size_t i = 0; i < name.size(); i++)
+	{
+		if ((name[i] == '/') || (name[i] == '\\') || (name[i] == ':'))
+		{
+			name[i] = '_';
+		}
+	}
+
+	return(std::string(CACHE_FOLDER) + "/" + name + extension);
+}
+
+/***********************************************************
+ *  GetCachePath()
+ *
+ *  This method returns the cache file for the mip chain of
+ *  a source file loaded with a size limit. The decoder of
+ *  the build is part of the name, since TurboJPEG and
+ *  stb_image build their chains differently.
+ ***********************************************************/
+std::string TextureCache::GetCachePath(const char* filename, int maxTextureSize)
+{
+	const char* decoderName = TextureDecoder::IsDctScalingAvailable() ? ".turbojpeg" : ".stb";
+
+	return(GetCacheFile(filename, "." + std::to_string(maxTextureSize) + decoderName + ".mips"));
+}
+
+/***********************************************************
+ *  CreateCacheFolder()
+ *
+ *  This method is used to create the cache folder.
+ ***********************************************************/
+void TextureCache::CreateCacheFolder()
+{
+#ifdef _WIN32
+	_mkdir(CACHE_FOLDER);
+#else
+	mkdir(CACHE_FOLDER, 0755);
+#endif
+}
+
+/***********************************************************
+ *  ReadSourceStamp()
+ *
+ *  This method is used to get the values that tell whether
+ *  a source file changed after its chain was cached.
+ ***********************************************************/
+bool TextureCache::ReadSourceStamp(const char* filename, long long& size, long long& modifiedTime)
+{
+	struct stat fileStatus;
+	if (stat(filename, &fileStatus) != 0)
+	{
+		return(false);
+	}
+
+	size = (long long)fileStatus.st_size;
+	modifiedTime = (long long)fileStatus.st_mtime;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used to read a cached mip chain.
+ ***********************************************************/
+bool TextureCache::Load(const char* filename, int maxTextureSize, int& scaleLevel,
+	std::vector<TextureDecoder::DECODED_IMAGE>& levels)
+{
+	long long sourceSize = 0;
+	long long sourceModifiedTime = 0;
+	if (!ReadSourceStamp(filename, sourceSize, sourceModifiedTime))
+	{
+		return(false);
+	}
+
+	std::ifstream file(GetCachePath(filename, maxTextureSize).c_str(), std::ios::binary);
+	if (!file)
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	if (!file.read((char*)&header, sizeof(header)) ||
+		(header.magic != CACHE_MAGIC) ||
+		(header.version != CACHE_VERSION) ||
+		(header.sourceSize != sourceSize) ||
+		(header.sourceModifiedTime != sourceModifiedTime) ||
+		(header.maxTextureSize != maxTextureSize) ||
+		(header.levelCount <= 0))
+	{
+		return(false);
+	}
+
+	levels.clear();
+	levels.resize(header.levelCount);
+	for (int i = 0; i < header.levelCount; i++)
+	{
+		LEVEL_HEADER levelHeader;
+		if (!file.read((char*)&levelHeader, sizeof(levelHeader)) ||
+			(levelHeader.width <= 0) || (levelHeader.height <= 0) ||
+			(levelHeader.channels <= 0) || (levelHeader.channels > 4))
+		{
+			levels.clear();
+			return(false);
+		}
+
+		TextureDecoder::DECODED_IMAGE& image = levels[i];
+		image.width = levelHeader.width;
+		image.height = levelHeader.height;
+		image.channels = levelHeader.channels;
+		image.pixels.resize((size_t)image.width * image.height * image.channels);
+		if (!file.read((char*)image.pixels.data(), (std::streamsize)image.pixels.size()))
+		{
+			levels.clear();
+			return(false);
+		}
+	}
+
+	scaleLevel = header.scaleLevel;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method is used to write a mip chain to the cache.
+ *  The file is written under a temporary name and renamed,
+ *  so a run that stops part way never leaves a broken file.
+ ***********************************************************/
+void TextureCache::Save(const char* filename, int maxTextureSize, int scaleLevel,
+	const std::vector<TextureDecoder::DECODED_IMAGE>& levels)
+{
+	long long sourceSize = 0;
+	long long sourceModifiedTime = 0;
+	if (levels.empty() || !ReadSourceStamp(filename, sourceSize, sourceModifiedTime))
+	{
+		return;
+	}
+
+	CreateCacheFolder();
+
+	std::string cachePath = GetCachePath(filename, maxTextureSize);
+	std::string temporaryPath = cachePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			return;
+		}
+
+		CACHE_HEADER header;
+		header.magic = CACHE_MAGIC;
+		header.version = CACHE_VERSION;
+		header.sourceSize = sourceSize;
+		header.sourceModifiedTime = sourceModifiedTime;
+		header.maxTextureSize = maxTextureSize;
+		header.scaleLevel = scaleLevel;
+		header.levelCount = (int32_t)levels.size();
+		file.write((const char*)&header, sizeof(header));
+
+		for (size_t i = 0; i < levels.size(); i++)
+		{
+			LEVEL_HEADER levelHeader;
+			levelHeader.width = levels[i].width;
+			levelHeader.height = levels[i].height;
+			levelHeader.channels = levels[i].channels;
+			file.write((const char*)&levelHeader, sizeof(levelHeader));
+			file.write((const char*)levels[i].pixels.data(), (std::streamsize)levels[i].pixels.size());
+		}
+
+		if (!file)
+		{
+			file.close();
+			std::remove(temporaryPath.c_str());
+			return;
+		}
+	}
+
+	std::remove(cachePath.c_str());
+	std::rename(temporaryPath.c_str(), cachePath.c_str());
+}
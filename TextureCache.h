@@ -0,0 +1,44 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.h
+// ============
+// store finished mip chains on disk so later runs skip decoding
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureDecoder.h"
+
+#include <string>
+
+/***********************************************************
+ *  TextureCache
+ *
+ *  This class saves the mip chain built for a texture file
+ *  into the texture cache folder, and loads it back when the
+ *  source file has the same size and modification time and
+ *  the same size limit is asked for by a build with the same
+ *  JPEG decoder.
+ ***********************************************************/
+class TextureCache
+{
+public:
+	// load a cached chain, returns false when there is none or
+	// it is out of date
+	static bool Load(const char* filename, int maxTextureSize, int& scaleLevel,
+		std::vector<TextureDecoder::DECODED_IMAGE>& levels);
+
+	// save a chain, failing to write is not an error
+	static void Save(const char* filename, int maxTextureSize, int scaleLevel,
+		const std::vector<TextureDecoder::DECODED_IMAGE>& levels);
+
+	// get a file in the cache folder named after a source file
+	static std::string GetCacheFile(const char* filename, const std::string& extension);
+	// create the cache folder if it does not exist yet
+	static void CreateCacheFolder();
+	// get the size and modification time of the source file
+	static bool ReadSourceStamp(const char* filename, long long& size, long long& modifiedTime);
+
+private:
+	// get the path of the cache file for a source file
+	static std::string GetCachePath(const char* filename, int maxTextureSize);
+};
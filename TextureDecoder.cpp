@@ -0,0 +1,293 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturedecoder.cpp
+// ============
+// decode texture images at reduced scales straight into mip levels
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureDecoder.h"
+#include "MipGenerator.h"
+
+#include "stb_image.h"
+
+#ifdef USE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+// declaration of global variables
+namespace
+{
+	// number of decodes averaged for each benchmarked scale
+	const int BENCHMARK_RUNS = 3;
+
+#ifdef USE_TURBOJPEG
+	/***********************************************************
+	 *  ReadFileBytes()
+	 *
+	 *  This function is used to read a whole file into memory.
+	 ***********************************************************/
+	bool ReadFileBytes(const char* filename, std::vector<unsigned char>& bytes)
+	{
+		std::ifstream file(filename, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return(false);
+		}
+
+		std::streamsize size = file.tellg();
+		file.seekg(0, std::ios::beg);
+		bytes.resize((size_t)size);
+
+		return((size > 0) && file.read((char*)bytes.data(), size));
+	}
+#endif
+}
+
+/***********************************************************
+ *  IsDctScalingAvailable()
+ *
+ *  This method returns true when the build decodes JPEG files
+ *  with TurboJPEG.
+ ***********************************************************/
+bool TextureDecoder::IsDctScalingAvailable()
+{
+#ifdef USE_TURBOJPEG
+	return(true);
+#else
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  ReadImageSize()
+ *
+ *  This method is used to get the size of an image from its
+ *  header without decoding the pixels.
+ ***********************************************************/
+bool TextureDecoder::ReadImageSize(const char* filename, int& width, int& height)
+{
+	int channels = 0;
+
+	return(stbi_info(filename, &width, &height, &channels) != 0);
+}
+
+/***********************************************************
+ *  DecodeScaledJpeg()
+ *
+ *  This method is used to decode a JPEG file at a reduced
+ *  scale. The DCT coefficients are only inverse transformed
+ *  up to the requested size, which is where the savings come
+ *  from. The rows are written bottom up to match OpenGL.
+ ***********************************************************/
+bool TextureDecoder::DecodeScaledJpeg(const char* filename, int scaleLevel, DECODED_IMAGE& image)
+{
+#ifdef USE_TURBOJPEG
+	if ((scaleLevel < 0) || (scaleLevel > MAX_DCT_SCALE_LEVEL))
+	{
+		return(false);
+	}
+
+	std::vector<unsigned char> jpegBytes;
+	if (!ReadFileBytes(filename, jpegBytes))
+	{
+		return(false);
+	}
+
+	tjhandle decompressor = tjInitDecompress();
+	if (decompressor == NULL)
+	{
+		return(false);
+	}
+
+	int width = 0;
+	int height = 0;
+	int subsampling = 0;
+	int colorspace = 0;
+	bool bDecoded = false;
+
+	// a failed header read means the file is not a JPEG
+	if (tjDecompressHeader3(decompressor, jpegBytes.data(), (unsigned long)jpegBytes.size(),
+		&width, &height, &subsampling, &colorspace) == 0)
+	{
+		tjscalingfactor scalingFactor = { 1, 1 << scaleLevel };
+		image.width = TJSCALED(width, scalingFactor);
+		image.height = TJSCALED(height, scalingFactor);
+		image.channels = 3;
+		image.pixels.resize((size_t)image.width * image.height * image.channels);
+
+		bDecoded = (tjDecompress2(decompressor, jpegBytes.data(), (unsigned long)jpegBytes.size(),
+			image.pixels.data(), image.width, 0, image.height, TJPF_RGB, TJFLAG_BOTTOMUP) == 0);
+	}
+
+	tjDestroy(decompressor);
+
+	return(bDecoded);
+#else
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  DecodeFull()
+ *
+ *  This method is used to decode an image at its full size
+ *  with stb_image, flipped vertically to match OpenGL. The
+ *  images are decoded on worker threads, so the flip is set
+ *  for the calling thread only.
+ ***********************************************************/
+bool TextureDecoder::DecodeFull(const char* filename, DECODED_IMAGE& image)
+{
+	stbi_set_flip_vertically_on_load_thread(true);
+
+	unsigned char* pixels = stbi_load(filename, &image.width, &image.height, &image.channels, 0);
+	if (pixels == NULL)
+	{
+		return(false);
+	}
+
+	image.pixels.assign(pixels, pixels + ((size_t)image.width * image.height * image.channels));
+	stbi_image_free(pixels);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Decode()
+ *
+ *  This method is used to decode an image at a reduced
+ *  scale, with DCT scaling when possible and otherwise by
+ *  decoding the full image and halving it in linear light.
+ ***********************************************************/
+bool TextureDecoder::Decode(const char* filename, int scaleLevel, DECODED_IMAGE& image)
+{
+	if (DecodeScaledJpeg(filename, scaleLevel, image))
+	{
+		return(true);
+	}
+
+	if (!DecodeFull(filename, image))
+	{
+		return(false);
+	}
+
+	for (int level = 0; level < scaleLevel; level++)
+	{
+		DECODED_IMAGE reduced;
+		MipGenerator::ReduceByHalf(image, reduced, true);
+		image = std::move(reduced);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DecodeMipChain()
+ *
+ *  This method is used to decode the top levels of a mip
+ *  chain, starting at the largest level within the size
+ *  limit. When DCT scaling is available the levels down to
+ *  1/8 of the file are also decoded from the file itself,
+ *  otherwise only the first level is returned. The levels
+ *  below are left to MipGenerator.
+ ***********************************************************/
+int TextureDecoder::DecodeMipChain(const char* filename, int maxTextureSize, std::vector<DECODED_IMAGE>& levels)
+{
+	levels.clear();
+
+	int width = 0;
+	int height = 0;
+	if (!ReadImageSize(filename, width, height))
+	{
+		return(-1);
+	}
+
+	int baseLevel = 0;
+	while ((maxTextureSize > 0) &&
+		(((width >> baseLevel) > maxTextureSize) || ((height >> baseLevel) > maxTextureSize)))
+	{
+		baseLevel++;
+	}
+
+	int lastLevel = (baseLevel > MAX_DCT_SCALE_LEVEL) ? baseLevel : MAX_DCT_SCALE_LEVEL;
+	for (int scaleLevel = baseLevel; scaleLevel <= lastLevel; scaleLevel++)
+	{
+		DECODED_IMAGE image;
+		if (DecodeScaledJpeg(filename, scaleLevel, image))
+		{
+			// decoded straight from the file
+		}
+		else if (levels.empty())
+		{
+			if (!Decode(filename, scaleLevel, image))
+			{
+				return(-1);
+			}
+		}
+		else
+		{
+			break;
+		}
+
+		// each level must be half of the one above, rounded down,
+		// which DCT scaling of odd sizes does not always give
+		if (!levels.empty())
+		{
+			const DECODED_IMAGE& above = levels.back();
+			int expectedWidth = (above.width > 1) ? (above.width / 2) : 1;
+			int expectedHeight = (above.height > 1) ? (above.height / 2) : 1;
+			if ((image.width != expectedWidth) || (image.height != expectedHeight) ||
+				(image.channels != above.channels))
+			{
+				break;
+			}
+		}
+
+		levels.push_back(std::move(image));
+
+		if ((levels.back().width == 1) && (levels.back().height == 1))
+		{
+			break;
+		}
+	}
+
+	return(baseLevel);
+}
+
+/***********************************************************
+ *  Benchmark()
+ *
+ *  This method is used to print the average time to decode
+ *  a file at full size and at each DCT scale.
+ ***********************************************************/
+void TextureDecoder::Benchmark(const char* filename)
+{
+	for (int scaleLevel = 0; scaleLevel <= MAX_DCT_SCALE_LEVEL; scaleLevel++)
+	{
+		DECODED_IMAGE image;
+		double totalMilliseconds = 0.0;
+		bool bDecoded = true;
+
+		for (int run = 0; (run < BENCHMARK_RUNS) && bDecoded; run++)
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			bDecoded = Decode(filename, scaleLevel, image);
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+			totalMilliseconds += elapsed.count();
+		}
+
+		if (!bDecoded)
+		{
+			std::cout << "ERROR: Could not decode " << filename << std::endl;
+			return;
+		}
+
+		std::cout << "INFO: Decode " << filename << " 1/" << (1 << scaleLevel)
+			<< " (" << image.width << "x" << image.height << ") "
+			<< (totalMilliseconds / BENCHMARK_RUNS) << " ms"
+			<< (IsDctScalingAvailable() ? "" : " without DCT scaling") << std::endl;
+	}
+}
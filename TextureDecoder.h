@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturedecoder.h
+// ============
+// decode texture images at reduced scales straight into mip levels
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+/***********************************************************
+ *  TextureDecoder
+ *
+ *  This class decodes texture images into the levels of a
+ *  mip chain. When built with USE_TURBOJPEG, JPEG files are
+ *  decoded at 1/2, 1/4 and 1/8 scale in the DCT domain, so
+ *  the lower levels and capped resolutions cost a fraction
+ *  of a full decode. Otherwise, and for other file types,
+ *  the image is decoded once with stb_image and reduced by
+ *  MipGenerator.
+ ***********************************************************/
+class TextureDecoder
+{
+public:
+	// the smallest scale the JPEG DCT can decode at is 1/8
+	static const int MAX_DCT_SCALE_LEVEL = 3;
+
+	// one decoded mip level, rows are stored bottom up
+	struct DECODED_IMAGE
+	{
+		int width;
+		int height;
+		int channels;
+		std::vector<unsigned char> pixels;
+	};
+
+	// decode an image at 1 / (2 ^ scaleLevel) of its size
+	static bool Decode(const char* filename, int scaleLevel, DECODED_IMAGE& image);
+
+	// decode the largest level that fits in maxTextureSize, zero
+	// for no limit, and the levels below it down to 1/8 scale of
+	// the file, returns the scale level of the first one or -1
+	static int DecodeMipChain(const char* filename, int maxTextureSize, std::vector<DECODED_IMAGE>& levels);
+
+	// true when JPEG files are decoded with DCT scaling
+	static bool IsDctScalingAvailable();
+
+	// print the decode time of a file at every DCT scale
+	static void Benchmark(const char* filename);
+
+private:
+	// get the size of an image without decoding it
+	static bool ReadImageSize(const char* filename, int& width, int& height);
+	// decode a JPEG file with DCT scaling, false when the file
+	// is not a JPEG or TurboJPEG is not available
+	static bool DecodeScaledJpeg(const char* filename, int scaleLevel, DECODED_IMAGE& image);
+	// decode at full size with stb_image
+	static bool DecodeFull(const char* filename, DECODED_IMAGE& image);
+};
@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturesamplers.cpp
+// ============
+// shared sampler objects for each texture filtering quality tier
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureSamplers.h"
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// names accepted for the tiers, in the order of SAMPLER_TIER
+	const char* const g_TierNames[SAMPLER_TIER_COUNT] =
+	{
+		"bilinear",
+		"trilinear",
+		"2x",
+		"4x",
+		"8x",
+		"16x"
+	};
+
+	// wrap modes in the order of SAMPLER_WRAP
+	const GLint g_WrapModes[SAMPLER_WRAP_COUNT] =
+	{
+		GL_REPEAT,
+		GL_MIRRORED_REPEAT,
+		GL_CLAMP_TO_EDGE
+	};
+
+	/***********************************************************
+	 *  GetTierAnisotropy()
+	 *
+	 *  This function returns the anisotropy of a tier, where
+	 *  one means the filtering is not anisotropic.
+	 ***********************************************************/
+	float GetTierAnisotropy(SAMPLER_TIER tier)
+	{
+		switch (tier)
+		{
+		case SAMPLER_TIER_ANISOTROPIC_2X:
+			return(2.0f);
+		case SAMPLER_TIER_ANISOTROPIC_4X:
+			return(4.0f);
+		case SAMPLER_TIER_ANISOTROPIC_8X:
+			return(8.0f);
+		case SAMPLER_TIER_ANISOTROPIC_16X:
+			return(16.0f);
+		default:
+			return(1.0f);
+		}
+	}
+}
+
+/***********************************************************
+ *  TextureSamplers()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureSamplers::TextureSamplers()
+{
+	m_qualityLimit = SAMPLER_TIER_ANISOTROPIC_16X;
+	m_supportedLimit = SAMPLER_TIER_TRILINEAR;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to create a sampler for every tier
+ *  and wrap mode. Anisotropic tiers beyond what the driver
+ *  supports are not used.
+ ***********************************************************/
+void TextureSamplers::Initialize()
+{
+	float maxAnisotropy = 1.0f;
+	if (GLEW_VERSION_4_6 || GLEW_ARB_texture_filter_anisotropic || GLEW_EXT_texture_filter_anisotropic)
+	{
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy);
+	}
+
+	m_supportedLimit = SAMPLER_TIER_TRILINEAR;
+	for (int tier = SAMPLER_TIER_ANISOTROPIC_2X; tier < SAMPLER_TIER_COUNT; tier++)
+	{
+		if (GetTierAnisotropy((SAMPLER_TIER)tier) <= maxAnisotropy)
+		{
+			m_supportedLimit = (SAMPLER_TIER)tier;
+		}
+	}
+
+	for (int tier = 0; tier < SAMPLER_TIER_COUNT; tier++)
+	{
+		for (int wrap = 0; wrap < SAMPLER_WRAP_COUNT; wrap++)
+		{
+			GpuSampler& sampler = m_samplers[tier][wrap];
+			sampler = GpuSampler::Create();
+
+			GLuint samplerID = sampler.Get();
+			glSamplerParameteri(samplerID, GL_TEXTURE_WRAP_S, g_WrapModes[wrap]);
+			glSamplerParameteri(samplerID, GL_TEXTURE_WRAP_T, g_WrapModes[wrap]);
+			glSamplerParameteri(samplerID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+			// bilinear only reads the nearest mip level, every other
+			// tier blends between the two nearest levels
+			if (tier == SAMPLER_TIER_BILINEAR)
+			{
+				glSamplerParameteri(samplerID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+			}
+			else
+			{
+				glSamplerParameteri(samplerID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			}
+
+			float anisotropy = GetTierAnisotropy((SAMPLER_TIER)tier);
+			if ((anisotropy > 1.0f) && (tier <= m_supportedLimit))
+			{
+				glSamplerParameterf(samplerID, GL_TEXTURE_MAX_ANISOTROPY, anisotropy);
+			}
+		}
+	}
+
+	std::cout << "INFO: Texture filtering up to " << g_TierNames[m_supportedLimit]
+		<< ", limited to " << g_TierNames[m_qualityLimit] << std::endl;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the sampler objects.
+ ***********************************************************/
+void TextureSamplers::Destroy()
+{
+	for (int tier = 0; tier < SAMPLER_TIER_COUNT; tier++)
+	{
+		for (int wrap = 0; wrap < SAMPLER_WRAP_COUNT; wrap++)
+		{
+			m_samplers[tier][wrap].Reset();
+		}
+	}
+}
+
+/***********************************************************
+ *  SetQualityLimit()
+ *
+ *  This method is used to set the best tier that is used.
+ *  Materials asking for more are drawn at this tier.
+ ***********************************************************/
+void TextureSamplers::SetQualityLimit(SAMPLER_TIER qualityLimit)
+{
+	m_qualityLimit = qualityLimit;
+}
+
+/***********************************************************
+ *  GetSampler()
+ *
+ *  This method returns the sampler for a tier and wrap mode,
+ *  lowered to the quality limit and to what is supported.
+ ***********************************************************/
+GLuint TextureSamplers::GetSampler(SAMPLER_TIER tier, SAMPLER_WRAP wrap) const
+{
+	if (tier > m_qualityLimit)
+	{
+		tier = m_qualityLimit;
+	}
+	if (tier > m_supportedLimit)
+	{
+		tier = m_supportedLimit;
+	}
+
+	return(m_samplers[tier][wrap].Get());
+}
+
+/***********************************************************
+ *  ParseTier()
+ *
+ *  This method is used to get a tier from its name.
+ ***********************************************************/
+bool TextureSamplers::ParseTier(const char* tierName, SAMPLER_TIER& tier)
+{
+	for (int i = 0; i < SAMPLER_TIER_COUNT; i++)
+	{
+		if (std::strcmp(tierName, g_TierNames[i]) == 0)
+		{
+			tier = (SAMPLER_TIER)i;
+			return(true);
+		}
+	}
+
+	std::cout << "ERROR: Unknown texture filtering " << tierName << std::endl;
+
+	return(false);
+}
@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturesamplers.h
+// ============
+// shared sampler objects for each texture filtering quality tier
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GpuResource.h"
+
+// texture filtering from cheapest to best looking
+enum SAMPLER_TIER
+{
+	SAMPLER_TIER_BILINEAR,
+	SAMPLER_TIER_TRILINEAR,
+	SAMPLER_TIER_ANISOTROPIC_2X,
+	SAMPLER_TIER_ANISOTROPIC_4X,
+	SAMPLER_TIER_ANISOTROPIC_8X,
+	SAMPLER_TIER_ANISOTROPIC_16X,
+	SAMPLER_TIER_COUNT
+};
+
+// how texture coordinates outside of 0 to 1 are handled
+enum SAMPLER_WRAP
+{
+	SAMPLER_WRAP_REPEAT,
+	SAMPLER_WRAP_MIRRORED_REPEAT,
+	SAMPLER_WRAP_CLAMP_TO_EDGE,
+	SAMPLER_WRAP_COUNT
+};
+
+/***********************************************************
+ *  TextureSamplers
+ *
+ *  This class owns one sampler object for every filtering
+ *  tier and wrap mode. Materials pick a tier, and the sampler
+ *  is bound to the texture unit when the material is drawn,
+ *  so filtering is set without changing the textures. The
+ *  quality limit lowers every tier above it, which trades
+ *  filtering cost for quality across the whole scene.
+ ***********************************************************/
+class TextureSamplers
+{
+public:
+	// constructor
+	TextureSamplers();
+
+	// create the sampler objects, a context must be current
+	void Initialize();
+	// free the sampler objects
+	void Destroy();
+
+	// set the best tier that any material is drawn with
+	void SetQualityLimit(SAMPLER_TIER qualityLimit);
+	SAMPLER_TIER GetQualityLimit() const { return(m_qualityLimit); }
+
+	// get the sampler for a tier and wrap mode, after the limit
+	GLuint GetSampler(SAMPLER_TIER tier, SAMPLER_WRAP wrap) const;
+
+	// get the tier named by "bilinear", "trilinear", "2x" to "16x"
+	static bool ParseTier(const char* tierName, SAMPLER_TIER& tier);
+
+private:
+	GpuSampler m_samplers[SAMPLER_TIER_COUNT][SAMPLER_WRAP_COUNT];
+	SAMPLER_TIER m_qualityLimit;
+	// best tier the driver supports
+	SAMPLER_TIER m_supportedLimit;
+};
@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// trianglebvh.cpp
+// ============
+// bounding volume hierarchy over world space triangles for ray casting
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TriangleBVH.h"
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	// triangles in a leaf before it is split again
+	const int MAX_LEAF_TRIANGLES = 4;
+	// deepest the traversal stack can get
+	const int MAX_TRAVERSAL_DEPTH = 64;
+
+	/***********************************************************
+	 *  IntersectBox()
+	 *
+	 *  This function returns true when a ray enters a box
+	 *  closer than maxDistance, using the slab test.
+	 ***********************************************************/
+	bool IntersectBox(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+		const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		glm::vec3 near = (boundsMin - origin) * inverseDirection;
+		glm::vec3 far = (boundsMax - origin) * inverseDirection;
+		glm::vec3 entry = glm::min(near, far);
+		glm::vec3 exit = glm::max(near, far);
+
+		float entryDistance = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.0f));
+		float exitDistance = std::min(std::min(exit.x, exit.y), std::min(exit.z, maxDistance));
+
+		return(entryDistance <= exitDistance);
+	}
+
+	/***********************************************************
+	 *  IntersectTriangle()
+	 *
+	 *  This function is used to find where a ray crosses a
+	 *  triangle, from either side, with the Moller-Trumbore
+	 *  test.
+	 ***********************************************************/
+	bool IntersectTriangle(const glm::vec3& origin, const glm::vec3& direction,
+		const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+		float& distance, float& u, float& v)
+	{
+		glm::vec3 edge1 = b - a;
+		glm::vec3 edge2 = c - a;
+		glm::vec3 p = glm::cross(direction, edge2);
+		float determinant = glm::dot(edge1, p);
+		if (std::abs(determinant) < 1e-9f)
+		{
+			return(false);
+		}
+
+		float inverseDeterminant = 1.0f / determinant;
+		glm::vec3 t = origin - a;
+		u = glm::dot(t, p) * inverseDeterminant;
+		if ((u < 0.0f) || (u > 1.0f))
+		{
+			return(false);
+		}
+
+		glm::vec3 q = glm::cross(t, edge1);
+		v = glm::dot(direction, q) * inverseDeterminant;
+		if ((v < 0.0f) || (u + v > 1.0f))
+		{
+			return(false);
+		}
+
+		distance = glm::dot(edge2, q) * inverseDeterminant;
+
+		return(distance > 0.0f);
+	}
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used to build the tree over a list of
+ *  triangles, splitting each box at the middle of the
+ *  triangle centers along its longest side.
+ ***********************************************************/
+void TriangleBVH::Build(const std::vector<glm::vec3>& corners)
+{
+	m_corners = corners;
+
+	int triangleCount = (int)m_corners.size() / 3;
+	m_centers.resize(triangleCount);
+	m_triangleOrder.resize(triangleCount);
+	for (int i = 0; i < triangleCount; i++)
+	{
+		m_centers[i] = (m_corners[i * 3] + m_corners[i * 3 + 1] + m_corners[i * 3 + 2]) / 3.0f;
+		m_triangleOrder[i] = i;
+	}
+
+	m_nodes.clear();
+	m_nodes.reserve((size_t)triangleCount * 2 + 1);
+	m_nodes.push_back(BVH_NODE());
+	Subdivide(0, 0, triangleCount);
+}
+
+/***********************************************************
+ *  Subdivide()
+ *
+ *  This method is used to fit the box of a node around its
+ *  triangles and split them between two new children.
+ ***********************************************************/
+void TriangleBVH::Subdivide(int nodeIndex, int first, int count)
+{
+	glm::vec3 boundsMin(1e30f);
+	glm::vec3 boundsMax(-1e30f);
+	glm::vec3 centerMin(1e30f);
+	glm::vec3 centerMax(-1e30f);
+	for (int i = first; i < first + count; i++)
+	{
+		int triangle = m_triangleOrder[i];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			boundsMin = glm::min(boundsMin, m_corners[triangle * 3 + corner]);
+			boundsMax = glm::max(boundsMax, m_corners[triangle * 3 + corner]);
+		}
+		centerMin = glm::min(centerMin, m_centers[triangle]);
+		centerMax = glm::max(centerMax, m_centers[triangle]);
+	}
+
+	m_nodes[nodeIndex].boundsMin = boundsMin;
+	m_nodes[nodeIndex].boundsMax = boundsMax;
+	m_nodes[nodeIndex].first = first;
+	m_nodes[nodeIndex].triangleCount = count;
+
+	glm::vec3 extent = centerMax - centerMin;
+	int axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+	if ((count <= MAX_LEAF_TRIANGLES) || (extent[axis] <= 0.0f))
+	{
+		return;
+	}
+
+	float split = centerMin[axis] + extent[axis] * 0.5f;
+	std::vector<int>::iterator middle = std::partition(
+		m_triangleOrder.begin() + first,
+		m_triangleOrder.begin() + first + count,
+		[this, axis, split](int triangle) { return(m_centers[triangle][axis] < split); });
+	int leftCount = (int)(middle - (m_triangleOrder.begin() + first));
+	if ((leftCount == 0) || (leftCount == count))
+	{
+		return;
+	}
+
+	int leftChild = (int)m_nodes.size();
+	m_nodes.push_back(BVH_NODE());
+	m_nodes.push_back(BVH_NODE());
+	m_nodes[nodeIndex].first = leftChild;
+	m_nodes[nodeIndex].triangleCount = 0;
+
+	Subdivide(leftChild, first, leftCount);
+	Subdivide(leftChild + 1, first + leftCount, count - leftCount);
+}
+
+/***********************************************************
+ *  Traverse()
+ *
+ *  This method is used to walk the boxes a ray passes
+ *  through and test their triangles, keeping the nearest
+ *  hit so the remaining boxes are cut short.
+ ***********************************************************/
+bool TriangleBVH::Traverse(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, bool bAnyHit, RAY_HIT& hit) const
+{
+	if (m_corners.empty())
+	{
+		return(false);
+	}
+
+	glm::vec3 inverseDirection(
+		1.0f / ((direction.x != 0.0f) ? direction.x : 1e-20f),
+		1.0f / ((direction.y != 0.0f) ? direction.y : 1e-20f),
+		1.0f / ((direction.z != 0.0f) ? direction.z : 1e-20f));
+
+	bool bHit = false;
+	hit.triangle = -1;
+	hit.distance = maxDistance;
+
+	int stack[MAX_TRAVERSAL_DEPTH];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const BVH_NODE& node = m_nodes[stack[--stackSize]];
+		if (!IntersectBox(origin, inverseDirection, hit.distance, node.boundsMin, node.boundsMax))
+		{
+			continue;
+		}
+
+		if (node.triangleCount == 0)
+		{
+			if (stackSize + 2 <= MAX_TRAVERSAL_DEPTH)
+			{
+				stack[stackSize++] = node.first + 1;
+				stack[stackSize++] = node.first;
+			}
+			continue;
+		}
+
+		for (int i = node.first; i < node.first + node.triangleCount; i++)
+		{
+			int triangle = m_triangleOrder[i];
+			float distance = 0.0f;
+			float u = 0.0f;
+			float v = 0.0f;
+			if (IntersectTriangle(origin, direction,
+				m_corners[triangle * 3], m_corners[triangle * 3 + 1], m_corners[triangle * 3 + 2],
+				distance, u, v) && (distance < hit.distance))
+			{
+				hit.triangle = triangle;
+				hit.distance = distance;
+				hit.u = u;
+				hit.v = v;
+				bHit = true;
+				if (bAnyHit)
+				{
+					return(true);
+				}
+			}
+		}
+	}
+
+	return(bHit);
+}
+
+/***********************************************************
+ *  Intersect()
+ *
+ *  This method is used to find the nearest triangle hit.
+ ***********************************************************/
+bool TriangleBVH::Intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RAY_HIT& hit) const
+{
+	return(Traverse(origin, direction, maxDistance, false, hit));
+}
+
+/***********************************************************
+ *  IsOccluded()
+ *
+ *  This method is used to test for any triangle between a
+ *  point and a light, which is cheaper than the nearest hit.
+ ***********************************************************/
+bool TriangleBVH::IsOccluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+	RAY_HIT hit;
+
+	return(Traverse(origin, direction, maxDistance, true, hit));
+}
@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// trianglebvh.h
+// ============
+// bounding volume hierarchy over world space triangles for ray casting
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TriangleBVH
+ *
+ *  This class sorts a list of triangles into a tree of
+ *  bounding boxes, so a ray only tests the few triangles in
+ *  the boxes it passes through. The tree is built once and
+ *  is only read afterwards, so any number of threads can
+ *  cast rays against it at the same time.
+ ***********************************************************/
+class TriangleBVH
+{
+public:
+	// the nearest triangle a ray hit
+	struct RAY_HIT
+	{
+		int triangle;
+		float distance;
+		// weights of the second and third corner
+		float u;
+		float v;
+	};
+
+	// build the tree, three corners per triangle in order
+	void Build(const std::vector<glm::vec3>& corners);
+
+	// find the nearest triangle along a ray closer than
+	// maxDistance, the direction must be normalized
+	bool Intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RAY_HIT& hit) const;
+	// true when any triangle is closer than maxDistance
+	bool IsOccluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+
+	int GetTriangleCount() const { return((int)m_corners.size() / 3); }
+
+private:
+	// a box of the tree, a leaf when triangleCount is not zero
+	struct BVH_NODE
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// first child, the second is right after it, or the
+		// first entry in the triangle order for a leaf
+		int first;
+		int triangleCount;
+	};
+
+	// split the triangles of a node until the leaves are small
+	void Subdivide(int nodeIndex, int first, int count);
+	// walk the tree, stopping at the first hit when bAnyHit
+	bool Traverse(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, bool bAnyHit, RAY_HIT& hit) const;
+
+	std::vector<glm::vec3> m_corners;
+	std::vector<glm::vec3> m_centers;
+	std::vector<int> m_triangleOrder;
+	std::vector<BVH_NODE> m_nodes;
+};
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// viewfrustum.cpp
+// ============
+// clip planes of a camera view used for culling world-space bounds
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ViewFrustum.h"
+
+#include <cmath>
+
+/***********************************************************
+ *  ViewFrustum()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ViewFrustum::ViewFrustum()
+{
+	for (int i = 0; i < 6; i++)
+	{
+		m_planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
+
+/***********************************************************
+ *  Extract()
+ *
+ *  This method is used to get the left, right, bottom, top,
+ *  near and far planes from the rows of the passed in
+ *  projection * view matrix.
+ ***********************************************************/
+void ViewFrustum::Extract(const glm::mat4& viewProjection)
+{
+	// GLM matrices are column major, so build the rows first
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(
+			viewProjection[0][row],
+			viewProjection[1][row],
+			viewProjection[2][row],
+			viewProjection[3][row]);
+	}
+
+	m_planes[0] = rows[3] + rows[0];
+	m_planes[1] = rows[3] - rows[0];
+	m_planes[2] = rows[3] + rows[1];
+	m_planes[3] = rows[3] - rows[1];
+	m_planes[4] = rows[3] + rows[2];
+	m_planes[5] = rows[3] - rows[2];
+
+	for (int i = 0; i < 6; i++)
+	{
+		float length = glm::length(glm::vec3(m_planes[i]));
+		if (length > 0.0f)
+		{
+			m_planes[i] = m_planes[i] / length;
+		}
+	}
+}
+
+/***********************************************************
+ *  IntersectsBox()
+ *
+ *  This method is used to test an axis-aligned box against
+ *  the planes. Only the corner furthest along each plane
+ *  normal needs to be checked.
+ ***********************************************************/
+bool ViewFrustum::IntersectsBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		glm::vec3 positive(
+			(m_planes[i].x >= 0.0f) ? boundsMax.x : boundsMin.x,
+			(m_planes[i].y >= 0.0f) ? boundsMax.y : boundsMin.y,
+			(m_planes[i].z >= 0.0f) ? boundsMax.z : boundsMin.z);
+
+		if (glm::dot(glm::vec3(m_planes[i]), positive) + m_planes[i].w < 0.0f)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  TransformBounds()
+ *
+ *  This method is used to get the world-space box that
+ *  encloses a local box after it has been transformed by
+ *  the passed in model matrix.
+ ***********************************************************/
+void ViewFrustum::TransformBounds(
+	const glm::mat4& model,
+	const glm::vec3& localMin,
+	const glm::vec3& localMax,
+	glm::vec3& worldMin,
+	glm::vec3& worldMax)
+{
+	glm::vec3 center = glm::vec3(model * glm::vec4((localMin + localMax) * 0.5f, 1.0f));
+	glm::vec3 extent = (localMax - localMin) * 0.5f;
+	glm::vec3 worldExtent(0.0f);
+
+	// the absolute values of the rotation and scale terms give
+	// the extent of the rotated box along each world axis
+	for (int axis = 0; axis < 3; axis++)
+	{
+		worldExtent[axis] =
+			std::fabs(model[0][axis]) * extent.x +
+			std::fabs(model[1][axis]) * extent.y +
+			std::fabs(model[2][axis]) * extent.z;
+	}
+
+	worldMin = center - worldExtent;
+	worldMax = center + worldExtent;
+}
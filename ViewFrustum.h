@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////////////////////////
+// viewfrustum.h
+// ============
+// clip planes of a camera view used for culling world-space bounds
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  ViewFrustum
+ *
+ *  This class holds the six planes of a view volume, taken
+ *  from a combined projection * view matrix, and tests
+ *  axis-aligned bounding boxes against them.
+ ***********************************************************/
+class ViewFrustum
+{
+public:
+	// constructor
+	ViewFrustum();
+
+	// extract the planes from a projection * view matrix
+	void Extract(const glm::mat4& viewProjection);
+
+	// returns false only when the box is fully outside a plane
+	bool IntersectsBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+	// transform a local box by a model matrix into world bounds
+	static void TransformBounds(
+		const glm::mat4& model,
+		const glm::vec3& localMin,
+		const glm::vec3& localMax,
+		glm::vec3& worldMin,
+		glm::vec3& worldMax);
+
+private:
+	// plane normals in xyz and distances in w
+	glm::vec4 m_planes[6];
+};
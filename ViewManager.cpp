@@ -8,6 +8,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "MicroBenchmark.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
@@ -23,44 +24,37 @@ namespace
 	const char* g_ViewName = "view";
 	const char* g_ProjectionName = "projection";
 
-	// camera object used for viewing and interacting with
-	// the 3D scene
-	Camera* g_pCamera = nullptr;
-
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
-
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
-
-	// I added the camera movement speed so that it can be adjusted with the mouse scroll.
-	float gCameraSpeed = 2.5;
-
 	//Minimum and maximum camera speed limits.
 	const float MIN_CAMERA_SPEED = 0.5f;// I added this for the minimum camera speed.
 	const float MAX_CAMERA_SPEED = 10.0f;// I added this for the maximum camera speed.
 
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
-
-	// I added this code to Store camera states for switching between projections.
-	glm::vec3 perspectivePosition;
-	glm::vec3 perspectiveFront;
-	glm::vec3 perspectiveUp;
-	float perspectiveYaw;
-	float perspectivePitch;
-
-	glm::vec3 orthographicPosition;
-	glm::vec3 orthographicFront;
-	glm::vec3 orthographicUp;
-	float orthographicYaw;
-	float orthographicPitch;
-
-	bool cameraStatesInitialized = false;
+	// the minimap is drawn over the top right corner of the window
+	const float MINIMAP_SIZE_FRACTION = 0.3f;
+	const int MINIMAP_MARGIN = 10;
+	const float MINIMAP_ORTHO_SCALE = 12.0f;
+	const glm::vec3 MINIMAP_POSITION = glm::vec3(0.0f, 20.0f, 4.0f);
+
+	// distance between the eyes and the distance at which the two
+	// eye views converge, in scene units
+	const float STEREO_EYE_SEPARATION = 0.065f;
+	const float STEREO_CONVERGENCE_DISTANCE = 6.0f;
+	const float NEAR_PLANE = 0.1f;
+	const float FAR_PLANE = 100.0f;
+
+	// seconds ahead that the camera is predicted for prefetching
+	const float PREFETCH_LOOKAHEAD_SECONDS = 0.5f;
+	// weight of the newest frame in the smoothed camera motion
+	const float CAMERA_MOTION_SMOOTHING = 0.2f;
+	// a frame longer than this is a stall, not camera motion
+	const float MAX_MOTION_FRAME_SECONDS = 0.25f;
+	// slowest motion and turning, in units and degrees per second,
+	// that is worth predicting
+	const float MIN_PREFETCH_SPEED = 0.1f;
+	const float MIN_PREFETCH_TURN_RATE = 5.0f;
+	// fastest turning that is predicted, in degrees per second
+	const float MAX_PREFETCH_TURN_RATE = 180.0f;
+	// the camera never looks further up or down than this
+	const float MAX_PREFETCH_PITCH = 89.0f;
 
 }
 
@@ -70,33 +64,65 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	ShaderManager *pShaderManager) :
+	m_glBackend(pShaderManager)
 {
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
+	m_pRenderBackend = &m_glBackend;
 	m_pWindow = NULL;
-	g_pCamera = new Camera();
+	m_pTemporalAA = NULL;
+	m_sceneViewCount = 0;
+	m_bShowMinimap = false;
+	m_bStereo = false;
+	m_stereoSubmission = STEREO_SINGLE_PASS;
+	m_bTemporalAABeforeStereo = false;
+	m_lastX = WINDOW_WIDTH / 2.0f;
+	m_lastY = WINDOW_HEIGHT / 2.0f;
+	m_bFirstMouse = true;
+	m_deltaTime = 0.0f;
+	m_lastFrame = 0.0f;
+	m_cameraSpeed = 2.5f;
+	m_bOrthographicProjection = false;
+	m_bCameraStatesInitialized = false;
+	m_bPKeyWasPressed = false;
+	m_bOKeyWasPressed = false;
+	m_bTKeyWasPressed = false;
+	m_bMKeyWasPressed = false;
+	m_bVKeyWasPressed = false;
+	m_bBKeyWasPressed = false;
+	m_bPickRequested = false;
+	m_pickX = 0;
+	m_pickY = 0;
+	m_bCameraMotionValid = false;
+	m_lastCameraPosition = glm::vec3(0.0f);
+	m_lastCameraYaw = 0.0f;
+	m_lastCameraPitch = 0.0f;
+	m_cameraVelocity = glm::vec3(0.0f);
+	m_cameraYawRate = 0.0f;
+	m_cameraPitchRate = 0.0f;
+	m_pCamera = new Camera();
 	// default camera view parameters
-	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
-	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	g_pCamera->Zoom = 80;
+	m_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
+	m_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
+	m_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	m_pCamera->Zoom = 80;
 
 	// I Initialized the perspective camera state.
-	perspectivePosition = g_pCamera->Position;
-	perspectiveFront = g_pCamera->Front;
-	perspectiveUp = g_pCamera->Up;
-	perspectiveYaw = g_pCamera->Yaw;
-	perspectivePitch = g_pCamera->Pitch;
+	m_perspectivePosition = m_pCamera->Position;
+	m_perspectiveFront = m_pCamera->Front;
+	m_perspectiveUp = m_pCamera->Up;
+	m_perspectiveYaw = m_pCamera->Yaw;
+	m_perspectivePitch = m_pCamera->Pitch;
 
 	// I Initialized the orthographic camera state (top-down view).
-	orthographicPosition = glm::vec3(0.0f, 15.0f, 0.0f);
-	orthographicFront = glm::vec3(0.0f, -1.0f, 0.0f);
-	orthographicUp = glm::vec3(0.0f, 0.0f, -1.0f);
-	orthographicYaw = -90.0f;
-	orthographicPitch = -89.0f;
+	m_orthographicPosition = glm::vec3(0.0f, 15.0f, 0.0f);
+	m_orthographicFront = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_orthographicUp = glm::vec3(0.0f, 0.0f, -1.0f);
+	m_orthographicYaw = -90.0f;
+	m_orthographicPitch = -89.0f;
 
-	cameraStatesInitialized = true;
+	m_bCameraStatesInitialized = true;
 
 }
 
@@ -110,19 +136,23 @@ ViewManager::~ViewManager()
 	// free up allocated memory
 	m_pShaderManager = NULL;
 	m_pWindow = NULL;
-	if (NULL != g_pCamera)
+	m_pTemporalAA = NULL;
+	if (NULL != m_pCamera)
 	{
-		delete g_pCamera;
-		g_pCamera = NULL;
+		delete m_pCamera;
+		m_pCamera = NULL;
 	}
 }
 
 /***********************************************************
  *  CreateDisplayWindow()
  *
- *  This method is used to create the main display window.
+ *  This method is used to create a display window. When
+ *  another window is passed in, the new window's context
+ *  joins its share group so that textures, buffers and
+ *  shader programs are not duplicated in GPU memory.
  ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle, GLFWwindow* pSharedWindow)
 {
 	GLFWwindow* window = nullptr;
 
@@ -131,7 +161,7 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 		WINDOW_WIDTH,
 		WINDOW_HEIGHT,
 		windowTitle,
-		NULL, NULL);
+		NULL, pSharedWindow);
 	if (window == NULL)
 	{
 		std::cout << "Failed to create GLFW window" << std::endl;
@@ -140,6 +170,10 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	}
 	glfwMakeContextCurrent(window);
 
+	// the callbacks are static, so they find the view manager
+	// of the window that received the event through this pointer
+	glfwSetWindowUserPointer(window, this);
+
 	// tell GLFW to capture all mouse events
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);//I uncommented this to enable the cursor for camera control.
 
@@ -149,6 +183,9 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	// I added this line to register the scroll callback:
 	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
 
+	// this callback is used to receive clicks for selecting objects
+	glfwSetMouseButtonCallback(window, &ViewManager::Mouse_Button_Callback);
+
 	// enable blending for supporting tranparent rendering
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -165,27 +202,42 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
  *  the mouse is moved within the active GLFW display window.
  ***********************************************************/
 void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+{
+	ViewManager* pViewManager = static_cast<ViewManager*>(glfwGetWindowUserPointer(window));
+	if (NULL != pViewManager)
+	{
+		pViewManager->ProcessMouseMovement(xMousePos, yMousePos);
+	}
+}
+
+/***********************************************************
+ *  ProcessMouseMovement()
+ *
+ *  This method is used to turn the camera of this window by
+ *  the distance the mouse moved since the last event.
+ ***********************************************************/
+void ViewManager::ProcessMouseMovement(double xMousePos, double yMousePos)
 {
 	// I added this code to handle first mouse movement to prevent camera jump.
-	if (gFirstMouse)
+	if (m_bFirstMouse)
 	{
-		gLastX = xMousePos;
-		gLastY = yMousePos;
-		gFirstMouse = false;
+		m_lastX = xMousePos;
+		m_lastY = yMousePos;
+		m_bFirstMouse = false;
 	}
 
 	// I added this code to calculate the mouse offset from last the position.
-	float xOffset = xMousePos - gLastX;
-	float yOffset = gLastY - yMousePos; // I added this code to reverse since y-coordinates go from bottom to top.
+	float xOffset = xMousePos - m_lastX;
+	float yOffset = m_lastY - yMousePos; // I added this code to reverse since y-coordinates go from bottom to top.
 
 	// I added this code to update the last mouse position.
-	gLastX = xMousePos;
-	gLastY = yMousePos;
+	m_lastX = xMousePos;
+	m_lastY = yMousePos;
 
 	// I added this code to process the mouse movement for the camera orientation.
-	if (g_pCamera)
+	if (m_pCamera)
 	{
-		g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+		m_pCamera->ProcessMouseMovement(xOffset, yOffset);
 	}
 }
 /***********************************************************
@@ -198,29 +250,126 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
  *  navigate through the scene.
  ***********************************************************/
 void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	ViewManager* pViewManager = static_cast<ViewManager*>(glfwGetWindowUserPointer(window));
+	if (NULL != pViewManager)
+	{
+		pViewManager->ProcessMouseScroll(yOffset);
+	}
+}
+
+/***********************************************************
+ *  ProcessMouseScroll()
+ *
+ *  This method is used to adjust the movement speed of the
+ *  camera of this window.
+ ***********************************************************/
+void ViewManager::ProcessMouseScroll(double yOffset)
 {
 	//I adjusted the camera speed based on the scroll direction.
 	// Positive yOffset = scroll up = increase speed.
 	// Negative yOffset = scroll down = decrease speed.
-	gCameraSpeed += static_cast<float>(yOffset) * 0.5f;
+	m_cameraSpeed += static_cast<float>(yOffset) * 0.5f;
 
 	//I clamped the camera speed to stay within reasonable bounds.
-	if (gCameraSpeed < MIN_CAMERA_SPEED)
+	if (m_cameraSpeed < MIN_CAMERA_SPEED)
 	{
-		gCameraSpeed = MIN_CAMERA_SPEED;
+		m_cameraSpeed = MIN_CAMERA_SPEED;
 	}
-	else if (gCameraSpeed > MAX_CAMERA_SPEED)
+	else if (m_cameraSpeed > MAX_CAMERA_SPEED)
 	{
-		gCameraSpeed = MAX_CAMERA_SPEED;
+		m_cameraSpeed = MAX_CAMERA_SPEED;
 	}
 
 	//This updates the camera's movement speed.
-	if (g_pCamera != nullptr)
+	if (m_pCamera != nullptr)
 	{
-		g_pCamera->MovementSpeed = gCameraSpeed;
+		m_pCamera->MovementSpeed = m_cameraSpeed;
 	}
 }
 
+/***********************************************************
+ *  Mouse_Button_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  a mouse button is pressed or released within the active
+ *  GLFW display window.
+ ***********************************************************/
+void ViewManager::Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods)
+{
+	ViewManager* pViewManager = (ViewManager*)glfwGetWindowUserPointer(window);
+	if (NULL != pViewManager)
+	{
+		pViewManager->ProcessMouseButton(button, action);
+	}
+}
+
+/***********************************************************
+ *  ProcessMouseButton()
+ *
+ *  This method is used to turn a left click into a pick
+ *  request. While the cursor is captured for the camera it
+ *  is hidden, so the center of the main view is picked.
+ ***********************************************************/
+void ViewManager::ProcessMouseButton(int button, int action)
+{
+	if ((button != GLFW_MOUSE_BUTTON_LEFT) || (action != GLFW_PRESS))
+	{
+		return;
+	}
+
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+	int windowWidth = 0;
+	int windowHeight = 0;
+	glfwGetFramebufferSize(m_pWindow, &framebufferWidth, &framebufferHeight);
+	glfwGetWindowSize(m_pWindow, &windowWidth, &windowHeight);
+
+	if (glfwGetInputMode(m_pWindow, GLFW_CURSOR) == GLFW_CURSOR_DISABLED)
+	{
+		const SCENE_VIEW& mainView = m_sceneViews[0];
+		m_pickX = mainView.x + (mainView.width / 2);
+		m_pickY = mainView.y + (mainView.height / 2);
+	}
+	else if ((windowWidth > 0) && (windowHeight > 0))
+	{
+		double xCursorPos = 0.0;
+		double yCursorPos = 0.0;
+		glfwGetCursorPos(m_pWindow, &xCursorPos, &yCursorPos);
+
+		// window coordinates start at the top left, framebuffer
+		// pixels at the bottom left and may be scaled
+		m_pickX = (int)(xCursorPos * framebufferWidth / windowWidth);
+		m_pickY = framebufferHeight - 1 - (int)(yCursorPos * framebufferHeight / windowHeight);
+	}
+	else
+	{
+		return;
+	}
+
+	m_bPickRequested = true;
+}
+
+/***********************************************************
+ *  TakePickRequest()
+ *
+ *  This method returns the framebuffer pixel of the last
+ *  click and clears the request.
+ ***********************************************************/
+bool ViewManager::TakePickRequest(int& x, int& y)
+{
+	if (!m_bPickRequested)
+	{
+		return(false);
+	}
+
+	x = m_pickX;
+	y = m_pickY;
+	m_bPickRequested = false;
+
+	return(true);
+}
+
 /***********************************************************
  *  SwitchToOrthographic()
  *
@@ -229,26 +378,33 @@ void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, doub
  ***********************************************************/
 void ViewManager::SwitchToOrthographic()
 {
-	if (!bOrthographicProjection && cameraStatesInitialized)
+	if (!m_bOrthographicProjection && m_bCameraStatesInitialized)
 	{
 		// I adde this to Save the current perspective camera state.
-		perspectivePosition = g_pCamera->Position;
-		perspectiveFront = g_pCamera->Front;
-		perspectiveUp = g_pCamera->Up;
-		perspectiveYaw = g_pCamera->Yaw;
-		perspectivePitch = g_pCamera->Pitch;
+		m_perspectivePosition = m_pCamera->Position;
+		m_perspectiveFront = m_pCamera->Front;
+		m_perspectiveUp = m_pCamera->Up;
+		m_perspectiveYaw = m_pCamera->Yaw;
+		m_perspectivePitch = m_pCamera->Pitch;
 
 		// This Loads the orthographic camera state.
-		g_pCamera->Position = orthographicPosition;
-		g_pCamera->Front = orthographicFront;
-		g_pCamera->Up = orthographicUp;
-		g_pCamera->Yaw = orthographicYaw;
-		g_pCamera->Pitch = orthographicPitch;
+		m_pCamera->Position = m_orthographicPosition;
+		m_pCamera->Front = m_orthographicFront;
+		m_pCamera->Up = m_orthographicUp;
+		m_pCamera->Yaw = m_orthographicYaw;
+		m_pCamera->Pitch = m_orthographicPitch;
 
 		// This triggers the camera vector update by using ProcessMouseMovement with zero offset.
-		g_pCamera->ProcessMouseMovement(0.0f, 0.0f);
+		m_pCamera->ProcessMouseMovement(0.0f, 0.0f);
+
+		m_bOrthographicProjection = true;
+		m_bCameraMotionValid = false;
 
-		bOrthographicProjection = true;
+		// the accumulated frames belong to the other camera
+		if (NULL != m_pTemporalAA)
+		{
+			m_pTemporalAA->ResetHistory();
+		}
 	}
 }
 
@@ -260,26 +416,33 @@ void ViewManager::SwitchToOrthographic()
  ***********************************************************/
 void ViewManager::SwitchToPerspective()
 {
-	if (bOrthographicProjection && cameraStatesInitialized)
+	if (m_bOrthographicProjection && m_bCameraStatesInitialized)
 	{
 		// I added this to Save the current orthographic camera state.
-		orthographicPosition = g_pCamera->Position;
-		orthographicFront = g_pCamera->Front;
-		orthographicUp = g_pCamera->Up;
-		orthographicYaw = g_pCamera->Yaw;
-		orthographicPitch = g_pCamera->Pitch;
+		m_orthographicPosition = m_pCamera->Position;
+		m_orthographicFront = m_pCamera->Front;
+		m_orthographicUp = m_pCamera->Up;
+		m_orthographicYaw = m_pCamera->Yaw;
+		m_orthographicPitch = m_pCamera->Pitch;
 
 		// This Loads the perspective camera state.
-		g_pCamera->Position = perspectivePosition;
-		g_pCamera->Front = perspectiveFront;
-		g_pCamera->Up = perspectiveUp;
-		g_pCamera->Yaw = perspectiveYaw;
-		g_pCamera->Pitch = perspectivePitch;
+		m_pCamera->Position = m_perspectivePosition;
+		m_pCamera->Front = m_perspectiveFront;
+		m_pCamera->Up = m_perspectiveUp;
+		m_pCamera->Yaw = m_perspectiveYaw;
+		m_pCamera->Pitch = m_perspectivePitch;
 
 		// This triggers the camera vector update by using ProcessMouseMovement with zero offset.
-		g_pCamera->ProcessMouseMovement(0.0f, 0.0f);
+		m_pCamera->ProcessMouseMovement(0.0f, 0.0f);
+
+		m_bOrthographicProjection = false;
+		m_bCameraMotionValid = false;
 
-		bOrthographicProjection = false;
+		// the accumulated frames belong to the other camera
+		if (NULL != m_pTemporalAA)
+		{
+			m_pTemporalAA->ResetHistory();
+		}
 	}
 }
 
@@ -299,48 +462,122 @@ void ViewManager::ProcessKeyboardEvents()
 	// I added this code to process the camera movement with WASD keys.
 	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
 	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+		m_pCamera->ProcessKeyboard(FORWARD, m_deltaTime);
 	}
 	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
 	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+		m_pCamera->ProcessKeyboard(BACKWARD, m_deltaTime);
 	}
 	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
 	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+		m_pCamera->ProcessKeyboard(LEFT, m_deltaTime);
 	}
 	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
 	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+		m_pCamera->ProcessKeyboard(RIGHT, m_deltaTime);
 	}
 
 	// I added this code to process the camera vertical movement with the QE keys.
 	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
 	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
+		m_pCamera->ProcessKeyboard(UP, m_deltaTime);
 	}
 	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
 	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+		m_pCamera->ProcessKeyboard(DOWN, m_deltaTime);
 	}
 
 	// I added this code to toggle the perspective projection with the P key.
-	static bool pKeyWasPressed = false;
 	bool pKeyIsPressed = glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS;
-	if (pKeyIsPressed && !pKeyWasPressed)
+	if (pKeyIsPressed && !m_bPKeyWasPressed)
 	{
 		SwitchToPerspective();
 	}
-	pKeyWasPressed = pKeyIsPressed;
+	m_bPKeyWasPressed = pKeyIsPressed;
 
 	// I added this code to toggle the orthographic projection with the O key.
-	static bool oKeyWasPressed = false;
 	bool oKeyIsPressed = glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS;
-	if (oKeyIsPressed && !oKeyWasPressed)
+	if (oKeyIsPressed && !m_bOKeyWasPressed)
 	{
 		SwitchToOrthographic();
 	}
-	oKeyWasPressed = oKeyIsPressed;
+	m_bOKeyWasPressed = oKeyIsPressed;
+
+	// toggle the temporal anti-aliasing with the T key
+	bool tKeyIsPressed = glfwGetKey(m_pWindow, GLFW_KEY_T) == GLFW_PRESS;
+	if (tKeyIsPressed && !m_bTKeyWasPressed && (NULL != m_pTemporalAA) && !m_bStereo)
+	{
+		m_pTemporalAA->SetEnabled(!m_pTemporalAA->IsEnabled());
+	}
+	m_bTKeyWasPressed = tKeyIsPressed;
+
+	// toggle the top-down minimap view with the M key
+	bool mKeyIsPressed = glfwGetKey(m_pWindow, GLFW_KEY_M) == GLFW_PRESS;
+	if (mKeyIsPressed && !m_bMKeyWasPressed)
+	{
+		m_bShowMinimap = !m_bShowMinimap;
+	}
+	m_bMKeyWasPressed = mKeyIsPressed;
+
+	// toggle the side-by-side stereo views with the V key
+	bool vKeyIsPressed = glfwGetKey(m_pWindow, GLFW_KEY_V) == GLFW_PRESS;
+	if (vKeyIsPressed && !m_bVKeyWasPressed)
+	{
+		SetStereo(!m_bStereo);
+	}
+	m_bVKeyWasPressed = vKeyIsPressed;
+
+	// cycle through the stereo submissions with the B key, for
+	// comparing their frame times
+	bool bKeyIsPressed = glfwGetKey(m_pWindow, GLFW_KEY_B) == GLFW_PRESS;
+	if (bKeyIsPressed && !m_bBKeyWasPressed && m_bStereo)
+	{
+		static const char* const submissionNames[STEREO_SUBMISSION_COUNT] = { "single pass", "two pass", "recorded" };
+		m_stereoSubmission = (STEREO_SUBMISSION)((m_stereoSubmission + 1) % STEREO_SUBMISSION_COUNT);
+		std::cout << "INFO: Stereo submission: " << submissionNames[m_stereoSubmission] << std::endl;
+	}
+	m_bBKeyWasPressed = bKeyIsPressed;
+}
+
+/***********************************************************
+ *  SetStereo()
+ *
+ *  This method is used to turn the side-by-side stereo views
+ *  on or off. The anti-aliasing history holds one camera, so
+ *  it is paused while the two eye views are rendered.
+ ***********************************************************/
+void ViewManager::SetStereo(bool bStereo)
+{
+	if (m_bStereo == bStereo)
+	{
+		return;
+	}
+
+	m_bStereo = bStereo;
+
+	if (NULL != m_pTemporalAA)
+	{
+		if (m_bStereo)
+		{
+			m_bTemporalAABeforeStereo = m_pTemporalAA->IsEnabled();
+			m_pTemporalAA->SetEnabled(false);
+		}
+		else
+		{
+			m_pTemporalAA->SetEnabled(m_bTemporalAABeforeStereo);
+		}
+	}
+}
+
+/***********************************************************
+ *  SetTemporalAA()
+ *
+ *  This method is used to set the temporal anti-aliasing
+ *  object whose sub-pixel jitter is applied to the projection.
+ ***********************************************************/
+void ViewManager::SetTemporalAA(TemporalAA* pTemporalAA)
+{
+	m_pTemporalAA = pTemporalAA;
 }
 
 /***********************************************************
@@ -352,23 +589,63 @@ void ViewManager::ProcessKeyboardEvents()
  ***********************************************************/
 void ViewManager::PrepareSceneView()
 {
-	glm::mat4 view;
-	glm::mat4 projection;
-
 	// per-frame timing
 	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
+	m_deltaTime = currentFrame - m_lastFrame;
+	m_lastFrame = currentFrame;
 
 	// process any keyboard events that may be waiting in the 
 	// event queue
 	ProcessKeyboardEvents();
+	TrackCameraMotion();
+
+	// the views are placed in the window's framebuffer, which
+	// can be larger than the window on high DPI displays
+	int framebufferWidth = WINDOW_WIDTH;
+	int framebufferHeight = WINDOW_HEIGHT;
+	if (NULL != m_pWindow)
+	{
+		glfwGetFramebufferSize(m_pWindow, &framebufferWidth, &framebufferHeight);
+	}
+
+	BuildSceneViews(framebufferWidth, framebufferHeight);
+
+	// set the main view into the shader for proper rendering
+	ApplySceneView(0);
+	//Ben Douglas- I added the W key for up, the S key for down, the A key for left, and the D key for right.
+	// I added the Q key to look up, and the E key to look down.
+	// I added the P key for a perspective look, and the O key for a orthographic look.
+	// I added the mouse scroll back to move fast or slow down around the scene.
+	// I clamped the camera speed so that it doesn't go too fast.
+	// I added code to get the last known location of the mouse position.
+	//11-21-2025.
+	//Ben Douglas- I added the perspective and orthographic switching.
+	// I fixed the orthographic projection.
+	//I changed the camera settings so that you can switch between the perspective and orthographic views.
+	//11-28-2025.
+	//Ben Douglas- I changed the camera.h file back to the original code.
+	// I added m_pCamera->ProcessMouseMovement(0.0f, 0.0f); to the perspective and orthographic
+	// to trigger the camera vector update by using the ProcessMouseMovement with zero offset.
+	//12-04-2025
+}
+
+/***********************************************************
+ *  BuildSceneViews()
+ *
+ *  This method is used to build the view and projection
+ *  matrices of every view of the frame, and where each one
+ *  is placed in a framebuffer of the passed in size.
+ ***********************************************************/
+void ViewManager::BuildSceneViews(int framebufferWidth, int framebufferHeight)
+{
+	glm::mat4 view;
+	glm::mat4 projection;
 
 	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
+	view = m_pCamera->GetViewMatrix();
 
 	// I added this code to create the projection matrix based on current mode.
-	if (bOrthographicProjection)
+	if (m_bOrthographicProjection)
 	{
 		// The orthographic projection in 2D view.
 		// I defined the orthographic view volume.
@@ -386,36 +663,320 @@ void ViewManager::PrepareSceneView()
 	{
 		// The perspective projection in 3D view.
 		projection = glm::perspective(
-			glm::radians(g_pCamera->Zoom),
+			glm::radians(m_pCamera->Zoom),
 			(GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT,
 			0.1f,
 			100.0f
 		);
 	}
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+	// cache the unjittered matrices for reprojecting the history
+	// and offset the projection by this frame's sub-pixel jitter
+	if ((NULL != m_pTemporalAA) && m_pTemporalAA->IsEnabled())
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		m_pTemporalAA->SetFrameMatrices(view, projection);
+		projection = m_pTemporalAA->JitterProjection(projection);
 	}
-	//Ben Douglas- I added the W key for up, the S key for down, the A key for left, and the D key for right.
-	// I added the Q key to look up, and the E key to look down.
-	// I added the P key for a perspective look, and the O key for a orthographic look.
-	// I added the mouse scroll back to move fast or slow down around the scene.
-	// I clamped the camera speed so that it doesn't go too fast.
-	// I added code to get the last known location of the mouse position.
-	//11-21-2025.
-	//Ben Douglas- I added the perspective and orthographic switching.
-	// I fixed the orthographic projection.
-	//I changed the camera settings so that you can switch between the perspective and orthographic views.
-	//11-28-2025.
-	//Ben Douglas- I changed the camera.h file back to the original code.
-	// I added g_pCamera->ProcessMouseMovement(0.0f, 0.0f); to the perspective and orthographic
-	// to trigger the camera vector update by using the ProcessMouseMovement with zero offset.
-	//12-04-2025
-}
\ No newline at end of file
+
+	if (m_bStereo)
+	{
+		// the left and right eye views each cover half the window
+		int halfWidth = framebufferWidth / 2;
+		float aspect = (float)halfWidth / (float)framebufferHeight;
+		float top = NEAR_PLANE * tanf(glm::radians(m_pCamera->Zoom) * 0.5f);
+
+		// the eye frustums are shifted towards each other so the
+		// views converge at the convergence distance (off-axis)
+		float frustumShift = 0.5f * STEREO_EYE_SEPARATION * NEAR_PLANE / STEREO_CONVERGENCE_DISTANCE;
+
+		for (int eye = 0; eye < 2; eye++)
+		{
+			// -1 for the left eye, +1 for the right eye
+			float eyeSign = (eye == 0) ? -1.0f : 1.0f;
+
+			SCENE_VIEW& eyeView = m_sceneViews[eye];
+			eyeView.x = eye * halfWidth;
+			eyeView.y = 0;
+			eyeView.width = (eye == 0) ? halfWidth : (framebufferWidth - halfWidth);
+			eyeView.height = framebufferHeight;
+
+			// move the world opposite to the eye along the camera's right axis
+			eyeView.view = glm::translate(glm::vec3(-eyeSign * 0.5f * STEREO_EYE_SEPARATION, 0.0f, 0.0f)) * view;
+			eyeView.position = m_pCamera->Position + m_pCamera->Right * (eyeSign * 0.5f * STEREO_EYE_SEPARATION);
+
+			if (m_bOrthographicProjection)
+			{
+				eyeView.projection = projection;
+			}
+			else
+			{
+				eyeView.projection = glm::frustum(
+					-aspect * top - eyeSign * frustumShift,
+					aspect * top - eyeSign * frustumShift,
+					-top,
+					top,
+					NEAR_PLANE,
+					FAR_PLANE);
+			}
+		}
+		m_sceneViewCount = 2;
+	}
+	else
+	{
+		// the main camera view covers the whole window
+		m_sceneViews[0].x = 0;
+		m_sceneViews[0].y = 0;
+		m_sceneViews[0].width = framebufferWidth;
+		m_sceneViews[0].height = framebufferHeight;
+		m_sceneViews[0].view = view;
+		m_sceneViews[0].projection = projection;
+		m_sceneViews[0].position = m_pCamera->Position;
+		m_sceneViewCount = 1;
+	}
+
+	// the minimap looks straight down on the garden from a fixed
+	// position, so it shares the frame's draw list and culling
+	// pass instead of needing a second frame build
+	if (m_bShowMinimap)
+	{
+		SCENE_VIEW& minimap = m_sceneViews[m_sceneViewCount];
+		minimap.width = (int)(framebufferWidth * MINIMAP_SIZE_FRACTION);
+		minimap.height = (int)(framebufferHeight * MINIMAP_SIZE_FRACTION);
+		minimap.x = framebufferWidth - minimap.width - MINIMAP_MARGIN;
+		minimap.y = framebufferHeight - minimap.height - MINIMAP_MARGIN;
+		minimap.position = MINIMAP_POSITION;
+		minimap.view = glm::lookAt(
+			MINIMAP_POSITION,
+			glm::vec3(MINIMAP_POSITION.x, 0.0f, MINIMAP_POSITION.z),
+			glm::vec3(0.0f, 0.0f, -1.0f));
+
+		float aspect = (float)minimap.width / (float)minimap.height;
+		minimap.projection = glm::ortho(
+			-MINIMAP_ORTHO_SCALE * aspect,
+			MINIMAP_ORTHO_SCALE * aspect,
+			-MINIMAP_ORTHO_SCALE,
+			MINIMAP_ORTHO_SCALE,
+			0.1f,
+			100.0f);
+		m_sceneViewCount++;
+	}
+}
+
+/***********************************************************
+ *  TrackCameraMotion()
+ *
+ *  This method is used to smooth the speed of the camera and
+ *  the rate it turns at over the last frames. The direction
+ *  is taken from the front vector, since the yaw and pitch of
+ *  the camera are not set until the mouse first moves.
+ ***********************************************************/
+void ViewManager::TrackCameraMotion()
+{
+	glm::vec3 front = glm::normalize(m_pCamera->Front);
+	float yaw = glm::degrees(atan2f(front.z, front.x));
+	float pitch = glm::degrees(asinf(glm::clamp(front.y, -1.0f, 1.0f)));
+
+	// the first frame, a stall or a jump between the projections
+	// is not motion of the camera
+	if (!m_bCameraMotionValid || (m_deltaTime <= 0.0f) || (m_deltaTime > MAX_MOTION_FRAME_SECONDS))
+	{
+		m_cameraVelocity = glm::vec3(0.0f);
+		m_cameraYawRate = 0.0f;
+		m_cameraPitchRate = 0.0f;
+	}
+	else
+	{
+		glm::vec3 velocity = (m_pCamera->Position - m_lastCameraPosition) / m_deltaTime;
+		float speed = glm::length(velocity);
+		if (speed > MAX_CAMERA_SPEED)
+		{
+			velocity *= MAX_CAMERA_SPEED / speed;
+		}
+
+		// the yaw wraps around, so take the shorter way
+		float yawChange = yaw - m_lastCameraYaw;
+		if (yawChange > 180.0f)
+		{
+			yawChange -= 360.0f;
+		}
+		else if (yawChange < -180.0f)
+		{
+			yawChange += 360.0f;
+		}
+		float yawRate = glm::clamp(yawChange / m_deltaTime, -MAX_PREFETCH_TURN_RATE, MAX_PREFETCH_TURN_RATE);
+		float pitchRate = glm::clamp((pitch - m_lastCameraPitch) / m_deltaTime, -MAX_PREFETCH_TURN_RATE, MAX_PREFETCH_TURN_RATE);
+
+		m_cameraVelocity = glm::mix(m_cameraVelocity, velocity, CAMERA_MOTION_SMOOTHING);
+		m_cameraYawRate = glm::mix(m_cameraYawRate, yawRate, CAMERA_MOTION_SMOOTHING);
+		m_cameraPitchRate = glm::mix(m_cameraPitchRate, pitchRate, CAMERA_MOTION_SMOOTHING);
+	}
+
+	m_lastCameraPosition = m_pCamera->Position;
+	m_lastCameraYaw = yaw;
+	m_lastCameraPitch = pitch;
+	m_bCameraMotionValid = true;
+}
+
+/***********************************************************
+ *  GetPredictedViewProjection()
+ *
+ *  This method is used to get the projection * view matrix
+ *  of where the camera will be looking a moment from now if
+ *  it keeps moving and turning as it has been, so streaming
+ *  can start before that part of the scene is seen. Returns
+ *  false when the camera is still or not in perspective.
+ ***********************************************************/
+bool ViewManager::GetPredictedViewProjection(glm::mat4& viewProjection) const
+{
+	if (m_bOrthographicProjection || !m_bCameraMotionValid)
+	{
+		return(false);
+	}
+	if ((glm::length(m_cameraVelocity) < MIN_PREFETCH_SPEED) &&
+		(fabsf(m_cameraYawRate) < MIN_PREFETCH_TURN_RATE) &&
+		(fabsf(m_cameraPitchRate) < MIN_PREFETCH_TURN_RATE))
+	{
+		return(false);
+	}
+
+	glm::vec3 position = m_pCamera->Position + m_cameraVelocity * PREFETCH_LOOKAHEAD_SECONDS;
+	float yaw = glm::radians(m_lastCameraYaw + m_cameraYawRate * PREFETCH_LOOKAHEAD_SECONDS);
+	float pitch = glm::radians(glm::clamp(m_lastCameraPitch + m_cameraPitchRate * PREFETCH_LOOKAHEAD_SECONDS, -MAX_PREFETCH_PITCH, MAX_PREFETCH_PITCH));
+	glm::vec3 front(cosf(yaw) * cosf(pitch), sinf(pitch), sinf(yaw) * cosf(pitch));
+
+	glm::mat4 view = glm::lookAt(position, position + front, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(
+		glm::radians(m_pCamera->Zoom),
+		(GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT,
+		NEAR_PLANE,
+		FAR_PLANE);
+	viewProjection = projection * view;
+
+	return(true);
+}
+
+/***********************************************************
+ *  PrepareHeadlessSceneView()
+ *
+ *  This method is used to prepare the views of a frame for
+ *  a camera placed by the caller, without a window to read
+ *  the input or the framebuffer size from.
+ ***********************************************************/
+void ViewManager::PrepareHeadlessSceneView(
+	const glm::vec3& position,
+	const glm::vec3& front,
+	int framebufferWidth,
+	int framebufferHeight)
+{
+	m_pCamera->Position = position;
+	m_pCamera->Front = front;
+
+	BuildSceneViews(framebufferWidth, framebufferHeight);
+	ApplySceneView(0);
+}
+
+/***********************************************************
+ *  BenchmarkSceneViews()
+ *
+ *  This method is used to print the time to build the views
+ *  of a frame, for one view, with the minimap and in stereo
+ *  with the minimap. The jitter of temporal anti-aliasing
+ *  is left out because it moves on with every frame.
+ ***********************************************************/
+void ViewManager::BenchmarkSceneViews()
+{
+	TemporalAA* pTemporalAA = m_pTemporalAA;
+	bool bStereo = m_bStereo;
+	bool bShowMinimap = m_bShowMinimap;
+	m_pTemporalAA = NULL;
+
+	const char* layoutNames[3] = { "/main view", "/main view and minimap", "/stereo and minimap" };
+	for (int layout = 0; layout < 3; layout++)
+	{
+		m_bStereo = (layout == 2);
+		m_bShowMinimap = (layout > 0);
+		MicroBenchmark::Run(std::string("BuildSceneViews") + layoutNames[layout], [this]()
+		{
+			BuildSceneViews(WINDOW_WIDTH, WINDOW_HEIGHT);
+		});
+	}
+
+	m_pTemporalAA = pTemporalAA;
+	m_bStereo = bStereo;
+	m_bShowMinimap = bShowMinimap;
+}
+
+/***********************************************************
+ *  GetViewProjections()
+ *
+ *  This method is used to get the combined projection and
+ *  view matrix of every view prepared for this frame, so the
+ *  scene can be culled for all of them in one pass.
+ ***********************************************************/
+int ViewManager::GetViewProjections(glm::mat4* pViewProjections, int maxViews) const
+{
+	int viewCount = (m_sceneViewCount < maxViews) ? m_sceneViewCount : maxViews;
+
+	for (int i = 0; i < viewCount; i++)
+	{
+		pViewProjections[i] = m_sceneViews[i].projection * m_sceneViews[i].view;
+	}
+
+	return(viewCount);
+}
+
+/***********************************************************
+ *  ApplySceneView()
+ *
+ *  This method is used to set the viewport and the view and
+ *  projection matrices of a prepared view into the shader.
+ *  Overlay views such as the minimap are drawn over the main
+ *  view, so their region of the window is cleared first.
+ ***********************************************************/
+void ViewManager::ApplySceneView(int viewIndex, bool bClearOverlay)
+{
+	if ((viewIndex < 0) || (viewIndex >= m_sceneViewCount))
+	{
+		return;
+	}
+
+	const SCENE_VIEW& sceneView = m_sceneViews[viewIndex];
+
+	m_pRenderBackend->SetViewport(sceneView.x, sceneView.y, sceneView.width, sceneView.height);
+
+	// the eye views of a stereo frame are cleared with the frame
+	int firstOverlayView = m_bStereo ? 2 : 1;
+	if (bClearOverlay && (viewIndex >= firstOverlayView))
+	{
+		m_pRenderBackend->ClearRegion(sceneView.x, sceneView.y, sceneView.width, sceneView.height);
+	}
+
+	// set the view matrix into the shader for proper rendering
+	m_pRenderBackend->SetMat4Value(g_ViewName, sceneView.view);
+	// set the view matrix into the shader for proper rendering
+	m_pRenderBackend->SetMat4Value(g_ProjectionName, sceneView.projection);
+	// set the view position of the camera into the shader for proper rendering
+	m_pRenderBackend->SetVec3Value("viewPosition", sceneView.position);
+}
+
+/***********************************************************
+ *  FindSceneViewAt()
+ *
+ *  This method returns the prepared view that is drawn on
+ *  top at a framebuffer pixel. Overlays are drawn last, so
+ *  the views are searched from the last one back.
+ ***********************************************************/
+int ViewManager::FindSceneViewAt(int x, int y) const
+{
+	for (int i = m_sceneViewCount - 1; i >= 0; i--)
+	{
+		const SCENE_VIEW& sceneView = m_sceneViews[i];
+		if ((x >= sceneView.x) && (x < sceneView.x + sceneView.width) &&
+			(y >= sceneView.y) && (y < sceneView.y + sceneView.height))
+		{
+			return(i);
+		}
+	}
+
+	return(-1);
+}
@@ -11,6 +11,8 @@
 
 #include "ShaderManager.h"
 #include "camera.h"
+#include "TemporalAA.h"
+#include "RenderBackend.h"
 
 // GLFW library
 #include "GLFW/glfw3.h" 
@@ -18,6 +20,34 @@
 class ViewManager
 {
 public:
+	// maximum number of views rendered in one frame
+	static const int MAX_SCENE_VIEWS = 4;
+
+	// how the two eyes of a stereo frame are submitted
+	enum STEREO_SUBMISSION
+	{
+		// both eyes drawn from one walk of the draw list
+		STEREO_SINGLE_PASS,
+		// one full submission of the scene for each eye
+		STEREO_TWO_PASS,
+		// each eye recorded into a command list on its own thread
+		// and then submitted
+		STEREO_RECORDED,
+		STEREO_SUBMISSION_COUNT
+	};
+
+	// one camera view rendered into a region of the window
+	struct SCENE_VIEW
+	{
+		int x;
+		int y;
+		int width;
+		int height;
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 position;
+	};
+
 	// constructor
 	ViewManager(
 		ShaderManager* pShaderManager);
@@ -27,24 +57,147 @@ public:
 	// mouse position callback for mouse interaction with the 3D scene
 	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
 	static void Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset);//I added the Mouse_Scroll_Callback.
+	static void Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods);
 
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	// where the views are set, OpenGL unless another backend
+	// was set
+	GLRenderBackend m_glBackend;
+	RenderBackend* m_pRenderBackend;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// temporal anti-aliasing that jitters the projection, optional
+	TemporalAA* m_pTemporalAA;
+	// views prepared for the current frame, the first is the main camera
+	SCENE_VIEW m_sceneViews[MAX_SCENE_VIEWS];
+	int m_sceneViewCount;
+	// true when the top-down minimap view is shown
+	bool m_bShowMinimap;
+	// true when side-by-side left and right eye views are rendered
+	bool m_bStereo;
+	// how the eyes are submitted, changed with the B key
+	STEREO_SUBMISSION m_stereoSubmission;
+	// anti-aliasing state to restore when stereo is turned off
+	bool m_bTemporalAABeforeStereo;
+
+	// camera object used for viewing and interacting with
+	// the 3D scene in this window
+	Camera* m_pCamera;
+
+	// these variables are used for mouse movement processing
+	float m_lastX;
+	float m_lastY;
+	bool m_bFirstMouse;
+
+	// time between current frame and last frame
+	float m_deltaTime;
+	float m_lastFrame;
+
+	// camera movement speed adjusted with the mouse scroll
+	float m_cameraSpeed;
+
+	// camera of the last frame and its smoothed motion, in units
+	// and degrees per second, for predicting where it goes next
+	bool m_bCameraMotionValid;
+	glm::vec3 m_lastCameraPosition;
+	float m_lastCameraYaw;
+	float m_lastCameraPitch;
+	glm::vec3 m_cameraVelocity;
+	float m_cameraYawRate;
+	float m_cameraPitchRate;
+
+	// true when the orthographic projection is on
+	bool m_bOrthographicProjection;
+
+	// camera states stored for switching between projections
+	glm::vec3 m_perspectivePosition;
+	glm::vec3 m_perspectiveFront;
+	glm::vec3 m_perspectiveUp;
+	float m_perspectiveYaw;
+	float m_perspectivePitch;
+
+	glm::vec3 m_orthographicPosition;
+	glm::vec3 m_orthographicFront;
+	glm::vec3 m_orthographicUp;
+	float m_orthographicYaw;
+	float m_orthographicPitch;
+
+	bool m_bCameraStatesInitialized;
+
+	// previous key states for detecting toggle key presses
+	bool m_bPKeyWasPressed;
+	bool m_bOKeyWasPressed;
+	bool m_bTKeyWasPressed;
+	bool m_bMKeyWasPressed;
+	bool m_bVKeyWasPressed;
+	bool m_bBKeyWasPressed;
+
+	// framebuffer pixel of a click waiting to be picked
+	bool m_bPickRequested;
+	int m_pickX;
+	int m_pickY;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
+	// update the smoothed motion of the camera from the last frame
+	void TrackCameraMotion();
+	// build the matrices and regions of the views of the frame
+	void BuildSceneViews(int framebufferWidth, int framebufferHeight);
+	// process mouse events received by this window
+	void ProcessMouseMovement(double xMousePos, double yMousePos);
+	void ProcessMouseScroll(double yOffset);
+	void ProcessMouseButton(int button, int action);
 
 public:
-	// create the initial OpenGL display window
-	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	// create an OpenGL display window, passing another window
+	// shares its textures, buffers and shader programs
+	GLFWwindow* CreateDisplayWindow(const char* windowTitle, GLFWwindow* pSharedWindow = NULL);
+	GLFWwindow* GetDisplayWindow() const { return(m_pWindow); }
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+	// prepare the views of a frame for a camera placed by the
+	// caller, for a backend that has no window
+	void PrepareHeadlessSceneView(
+		const glm::vec3& position,
+		const glm::vec3& front,
+		int framebufferWidth,
+		int framebufferHeight);
+	// draw the views through another backend, such as one that
+	// does no GPU work
+	void SetRenderBackend(RenderBackend* pRenderBackend) { m_pRenderBackend = pRenderBackend; }
+	// print the CPU time of building the views of a frame
+	void BenchmarkSceneViews();
+
+	// get the views prepared for the current frame
+	int GetSceneViewCount() const { return(m_sceneViewCount); }
+	const SCENE_VIEW& GetSceneView(int viewIndex) const { return(m_sceneViews[viewIndex]); }
+	// get projection * view for every prepared view, returns the count
+	int GetViewProjections(glm::mat4* pViewProjections, int maxViews) const;
+	// get projection * view of where the camera is heading, returns
+	// false when it is not moving or turning
+	bool GetPredictedViewProjection(glm::mat4& viewProjection) const;
+	// set the viewport and the shader matrices for one prepared view,
+	// overlay views are cleared first unless told otherwise
+	void ApplySceneView(int viewIndex, bool bClearOverlay = true);
+	// get the prepared view that is drawn on top at a framebuffer pixel
+	int FindSceneViewAt(int x, int y) const;
+
+	// take the framebuffer pixel of the last click, if there was one
+	bool TakePickRequest(int& x, int& y);
+
+	// turn the side-by-side stereo views on or off, when on the
+	// first two prepared views are the left and right eyes
+	void SetStereo(bool bStereo);
+	bool IsStereo() const { return(m_bStereo); }
+	STEREO_SUBMISSION GetStereoSubmission() const { return(m_stereoSubmission); }
 
 	void SwitchToOrthographic();//I added this for the Orthhographic.
 	void SwitchToPerspective();//I added this for the Perspective.
 
+	// set the temporal anti-aliasing used for jittering the projection
+	void SetTemporalAA(TemporalAA* pTemporalAA);
+
 };
\ No newline at end of file
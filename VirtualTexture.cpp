@@ -0,0 +1,906 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualtexture.cpp
+// ============
+// stream the pages of a very large texture into a fixed page cache, driven
+// by a feedback pass that records which pages are seen
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VirtualTexture.h"
+#include "ShaderProgram.h"
+#include "GpuMemory.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+
+// declaration of global variables
+namespace
+{
+	// texture units of the page table and the page cache, kept
+	// above the units used by the scene and the resolve pass
+	const int PAGE_TABLE_TEXTURE_UNIT = 19;
+	const int PAGE_CACHE_TEXTURE_UNIT = 20;
+
+	// texels along each side of the page cache texture
+	const int CACHE_SIZE = VirtualTexture::CACHE_PAGES_PER_SIDE * VirtualTextureFile::TILE_SIZE;
+
+	const char* const g_VirtualVertexSource = R"GLSL(
+#version 330 core
+layout(location = 0) in vec3 inVertexPosition;
+layout(location = 1) in vec3 inVertexNormal;
+layout(location = 2) in vec2 inTextureCoordinate;
+
+uniform mat4 model;
+uniform mat4 viewProjection;
+
+out vec3 fragPosition;
+out vec3 fragNormal;
+out vec2 fragUV;
+
+void main()
+{
+	fragPosition = vec3(model * vec4(inVertexPosition, 1.0));
+	gl_Position = viewProjection * vec4(fragPosition, 1.0);
+	fragNormal = mat3(transpose(inverse(model))) * inVertexNormal;
+	fragUV = inTextureCoordinate;
+}
+)GLSL";
+
+	// shared by both fragment programs, so the pages drawn are
+	// exactly the pages the feedback asked for
+	const char* const g_VirtualLayoutSource = R"GLSL(
+#version 330 core
+in vec3 fragNormal;
+in vec2 fragUV;
+out vec4 fragmentColor;
+
+// part of the padded page grid covered by the image
+uniform vec2 contentScale;
+// texels along each side of the page grid at mip level 0
+uniform float virtualSize;
+uniform float maxMip;
+uniform float mipBias;
+
+vec2 VirtualUV(vec2 uv)
+{
+	return clamp(uv, 0.0, 0.99999) * contentScale;
+}
+
+float VirtualMip(vec2 uv)
+{
+	vec2 dx = dFdx(uv) * virtualSize;
+	vec2 dy = dFdy(uv) * virtualSize;
+	float lengthSquared = max(max(dot(dx, dx), dot(dy, dy)), 1e-8);
+	return clamp(floor(0.5 * log2(lengthSquared) + mipBias), 0.0, maxMip);
+}
+)GLSL";
+
+	const char* const g_FeedbackFragmentSource = R"GLSL(
+void main()
+{
+	vec2 uv = VirtualUV(fragUV);
+	float mip = VirtualMip(uv);
+	vec2 page = floor(uv * exp2(maxMip - mip));
+	fragmentColor = vec4(page, mip, 255.0) / 255.0;
+}
+)GLSL";
+
+	const char* const g_DrawFragmentSource = R"GLSL(
+in vec3 fragPosition;
+
+uniform sampler2D pageTable;
+uniform sampler2D pageCache;
+uniform float pageSize;
+uniform float pageBorder;
+uniform float tileSize;
+uniform float cacheSize;
+
+uniform vec3 lightDirection;
+uniform vec3 lightAmbient;
+uniform vec3 lightDiffuse;
+uniform vec3 ambientColor;
+uniform float ambientStrength;
+uniform vec3 diffuseColor;
+uniform bool bUseProbes;
+
+void main()
+{
+	vec2 uv = VirtualUV(fragUV);
+	float mip = VirtualMip(uv);
+
+	// the entry names the cache slot of the page, or of the
+	// nearest coarser page when this one is not loaded yet
+	vec4 entry = floor(textureLod(pageTable, uv, mip) * 255.0 + 0.5);
+	float pagesAtMip = exp2(maxMip - entry.b);
+	vec2 texelInPage = fract(uv * pagesAtMip) * pageSize;
+	vec2 cacheTexel = entry.rg * tileSize + pageBorder + texelInPage;
+	vec3 albedo = textureLod(pageCache, cacheTexel / cacheSize, 0.0).rgb;
+
+	// lit by the directional light of the scene, and by the
+	// indirect light of the probes when there are any
+	vec3 normal = normalize(fragNormal);
+	float diffuseAmount = max(dot(normal, normalize(-lightDirection)), 0.0);
+	vec3 ambient = (lightAmbient + ambientStrength) * ambientColor;
+	if (bUseProbes)
+	{
+		ambient = SampleIrradiance(fragPosition, normal) * diffuseColor;
+	}
+	vec3 diffuse = lightDiffuse * diffuseColor * diffuseAmount;
+
+	fragmentColor = vec4((ambient + diffuse) * albedo, 1.0);
+}
+)GLSL";
+}
+
+/***********************************************************
+ *  VirtualTexture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VirtualTexture::VirtualTexture()
+{
+	m_bInitialized = false;
+	m_layout.imageWidth = 0;
+	m_layout.imageHeight = 0;
+	m_layout.pagesPerSide = 0;
+	m_layout.mipCount = 0;
+	m_activeProgram = 0;
+	m_previousProgram = 0;
+	m_feedbackFramebuffer = 0;
+	m_feedbackColor = 0;
+	m_feedbackDepth = 0;
+	m_feedbackBytes = 0;
+	m_feedbackFence = 0;
+	m_feedbackWidth = 0;
+	m_feedbackHeight = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_savedViewport[i] = 0;
+	}
+	m_bFeedbackScheduled = false;
+	m_bFeedbackPrefetch = false;
+	m_bPageTableDirty = false;
+	m_frameIndex = 0;
+	m_lastFeedbackFrame = 0;
+	m_bStopLoader = false;
+	m_lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_lightAmbient = glm::vec3(0.2f);
+	m_lightDiffuse = glm::vec3(1.0f);
+	m_pIrradianceVolume = NULL;
+}
+
+/***********************************************************
+ *  ~VirtualTexture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VirtualTexture::~VirtualTexture()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  MakePageKey()
+ *
+ *  This method returns the key of a page. The mip level is
+ *  kept in the top bits, so the coarsest pages sort last.
+ ***********************************************************/
+VirtualTexture::PAGE_KEY VirtualTexture::MakePageKey(int mip, int pageX, int pageY)
+{
+	return(((PAGE_KEY)mip << 24) | ((PAGE_KEY)pageY << 12) | (PAGE_KEY)pageX);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to open the tiled file of an image,
+ *  create the page table, the page cache, the two programs
+ *  and the feedback target, and start the loader thread. The
+ *  single page of the coarsest mip level is loaded right away
+ *  and never replaced, so every page has something to show.
+ ***********************************************************/
+bool VirtualTexture::Initialize(const char* imageFile)
+{
+	Destroy();
+
+	if (!m_file.Open(imageFile))
+	{
+		return(false);
+	}
+	m_layout = m_file.GetLayout();
+
+	std::string feedbackSource = std::string(g_VirtualLayoutSource) + g_FeedbackFragmentSource;
+	std::string drawSource = std::string(g_VirtualLayoutSource) + g_IrradianceVolumeSource + g_DrawFragmentSource;
+	m_feedbackProgram = GpuProgram(CreateShaderProgram(g_VirtualVertexSource, feedbackSource.c_str(), "virtual texture feedback"));
+	m_drawProgram = GpuProgram(CreateShaderProgram(g_VirtualVertexSource, drawSource.c_str(), "virtual texture draw"));
+	if (!m_feedbackProgram.IsValid() || !m_drawProgram.IsValid())
+	{
+		Destroy();
+		return(false);
+	}
+
+	glActiveTexture(GL_TEXTURE0 + PAGE_TABLE_TEXTURE_UNIT);
+
+	// one texel per page, with a mip level for every page level
+	m_pageTable = GpuTexture::Create();
+	glBindTexture(GL_TEXTURE_2D, m_pageTable.Get());
+	for (int mip = 0; mip < m_layout.mipCount; mip++)
+	{
+		int side = m_file.GetPagesPerSide(mip);
+		glTexImage2D(GL_TEXTURE_2D, mip, GL_RGBA8, side, side, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_layout.mipCount - 1);
+	m_pageTable.TrackMemory(GPU_MEMORY_TEXTURES, GpuMemory::EstimateImageBytes(m_layout.pagesPerSide, m_layout.pagesPerSide, 4, true));
+
+	// the cache has no mip levels, every page level is its own page
+	glActiveTexture(GL_TEXTURE0 + PAGE_CACHE_TEXTURE_UNIT);
+	m_pageCache = GpuTexture::Create();
+	glBindTexture(GL_TEXTURE_2D, m_pageCache.Get());
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, CACHE_SIZE, CACHE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	m_pageCache.TrackMemory(GPU_MEMORY_TEXTURES, GpuMemory::EstimateImageBytes(CACHE_SIZE, CACHE_SIZE, 4, false));
+
+	glActiveTexture(GL_TEXTURE0);
+
+	// the feedback target and the buffer it is read back into
+	glGenRenderbuffers(1, &m_feedbackColor);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_feedbackColor);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, FEEDBACK_TARGET_SIZE, FEEDBACK_TARGET_SIZE);
+	glGenRenderbuffers(1, &m_feedbackDepth);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_feedbackDepth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, FEEDBACK_TARGET_SIZE, FEEDBACK_TARGET_SIZE);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	m_feedbackBytes = GpuMemory::EstimateImageBytes(FEEDBACK_TARGET_SIZE, FEEDBACK_TARGET_SIZE, 8, false);
+	GpuMemory::Allocate(GPU_MEMORY_RENDER_TARGETS, m_feedbackBytes);
+
+	glGenFramebuffers(1, &m_feedbackFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_feedbackFramebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_feedbackColor);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_feedbackDepth);
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	size_t readbackBytes = (size_t)FEEDBACK_TARGET_SIZE * FEEDBACK_TARGET_SIZE * 4;
+	m_feedbackBuffer = GpuBuffer::Create();
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_feedbackBuffer.Get());
+	glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)readbackBytes, NULL, GL_STREAM_READ);
+	m_feedbackBuffer.TrackMemory(GPU_MEMORY_RENDER_TARGETS, readbackBytes);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (bComplete == false)
+	{
+		std::cout << "ERROR: Virtual texture feedback target could not be created" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	CACHE_SLOT emptySlot;
+	emptySlot.bUsed = false;
+	emptySlot.bLocked = false;
+	emptySlot.key = 0;
+	emptySlot.lastSeenFrame = 0;
+	m_slots.assign(CACHE_PAGES_PER_SIDE * CACHE_PAGES_PER_SIDE, emptySlot);
+
+	int rootMip = m_layout.mipCount - 1;
+	std::vector<unsigned char> rootTile(VirtualTextureFile::TILE_BYTES);
+	if (!m_file.ReadTile(rootMip, 0, 0, rootTile.data()))
+	{
+		std::cout << "ERROR: Could not read the virtual texture pages" << std::endl;
+		Destroy();
+		return(false);
+	}
+	UploadPage(MakePageKey(rootMip, 0, 0), rootTile.data());
+	m_slots[m_residentPages.begin()->second].bLocked = true;
+	UpdatePageTable();
+
+	m_bStopLoader = false;
+	m_loaderThread = std::thread(&VirtualTexture::LoaderThread, this);
+
+	m_bInitialized = true;
+
+	std::cout << "INFO: Virtual texture " << imageFile << " is " << m_layout.imageWidth << "x" << m_layout.imageHeight
+		<< " with a " << CACHE_PAGES_PER_SIDE * CACHE_PAGES_PER_SIDE << " page cache" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to stop the loader thread and free the
+ *  textures, the programs and the feedback target.
+ ***********************************************************/
+void VirtualTexture::Destroy()
+{
+	if (m_loaderThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_loaderMutex);
+			m_bStopLoader = true;
+		}
+		m_loaderSignal.notify_all();
+		m_loaderThread.join();
+	}
+	m_queuedPages.clear();
+	m_prefetchPages.clear();
+	m_loadedPages.clear();
+	m_requestedPages.clear();
+	m_bFeedbackScheduled = false;
+	m_residentPages.clear();
+	m_slots.clear();
+
+	if (m_feedbackFence != 0)
+	{
+		glDeleteSync(m_feedbackFence);
+		m_feedbackFence = 0;
+	}
+	if (m_feedbackFramebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_feedbackFramebuffer);
+		m_feedbackFramebuffer = 0;
+	}
+	if (m_feedbackColor != 0)
+	{
+		glDeleteRenderbuffers(1, &m_feedbackColor);
+		glDeleteRenderbuffers(1, &m_feedbackDepth);
+		m_feedbackColor = m_feedbackDepth = 0;
+	}
+	if (m_feedbackBytes != 0)
+	{
+		GpuMemory::Free(GPU_MEMORY_RENDER_TARGETS, m_feedbackBytes);
+		m_feedbackBytes = 0;
+	}
+	m_feedbackBuffer.Reset();
+	m_pageTable.Reset();
+	m_pageCache.Reset();
+	m_drawProgram.Reset();
+	m_feedbackProgram.Reset();
+	m_file.Close();
+
+	m_bInitialized = false;
+}
+
+/***********************************************************
+ *  SetDirectionalLight()
+ *
+ *  This method is used to set the light values of the scene
+ *  that the draw program uses.
+ ***********************************************************/
+void VirtualTexture::SetDirectionalLight(const glm::vec3& direction, const glm::vec3& ambient, const glm::vec3& diffuse)
+{
+	m_lightDirection = direction;
+	m_lightAmbient = ambient;
+	m_lightDiffuse = diffuse;
+}
+
+/***********************************************************
+ *  LoaderThread()
+ *
+ *  This method runs on the loader thread, reading the queued
+ *  pages from the tiled file one at a time. The prefetched
+ *  pages are only read when no page of the view is waiting.
+ ***********************************************************/
+void VirtualTexture::LoaderThread()
+{
+	for (;;)
+	{
+		PAGE_KEY key = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_loaderMutex);
+			m_loaderSignal.wait(lock, [this]() { return(m_bStopLoader || !m_queuedPages.empty() || !m_prefetchPages.empty()); });
+			if (m_bStopLoader)
+			{
+				return;
+			}
+			std::deque<PAGE_KEY>& pages = !m_queuedPages.empty() ? m_queuedPages : m_prefetchPages;
+			key = pages.front();
+			pages.pop_front();
+		}
+
+		LOADED_PAGE loadedPage;
+		loadedPage.key = key;
+		loadedPage.tile.resize(VirtualTextureFile::TILE_BYTES);
+		if (!m_file.ReadTile((int)(key >> 24), (int)(key & 0xFFF), (int)((key >> 12) & 0xFFF), loadedPage.tile.data()))
+		{
+			loadedPage.tile.clear();
+		}
+
+		std::lock_guard<std::mutex> lock(m_loaderMutex);
+		m_loadedPages.push_back(std::move(loadedPage));
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used to read the last feedback pass once
+ *  the GPU has finished it, queue the pages it is missing,
+ *  and upload a few of the pages the loader thread has read.
+ *  With a frame scheduler the feedback and the uploads are
+ *  posted to it instead, and run one page at a time in the
+ *  time left of the frame. The page table is written again
+ *  when the cache changed, which covers the pages uploaded
+ *  by the scheduler since the last frame.
+ ***********************************************************/
+void VirtualTexture::Update(FrameScheduler* pScheduler)
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	if (m_feedbackFence != 0)
+	{
+		GLenum waitResult = glClientWaitSync(m_feedbackFence, 0, 0);
+		if ((waitResult == GL_ALREADY_SIGNALED) || (waitResult == GL_CONDITION_SATISFIED))
+		{
+			glDeleteSync(m_feedbackFence);
+			m_feedbackFence = 0;
+
+			m_feedbackPixels.resize((size_t)m_feedbackWidth * m_feedbackHeight * 4);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, m_feedbackBuffer.Get());
+			glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)m_feedbackPixels.size(), m_feedbackPixels.data());
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+			// no new feedback pass is drawn until this one is
+			// processed, since it would overwrite the pixels
+			if (NULL != pScheduler)
+			{
+				m_bFeedbackScheduled = pScheduler->Post("virtual texture feedback", [this]()
+				{
+					ProcessFeedback(m_feedbackPixels.data(), m_feedbackWidth, m_feedbackHeight, m_bFeedbackPrefetch);
+					m_bFeedbackScheduled = false;
+					return(false);
+				});
+			}
+			if (!m_bFeedbackScheduled)
+			{
+				ProcessFeedback(m_feedbackPixels.data(), m_feedbackWidth, m_feedbackHeight, m_bFeedbackPrefetch);
+			}
+		}
+	}
+
+	if (NULL != pScheduler)
+	{
+		bool bPagesLoaded = false;
+		{
+			std::lock_guard<std::mutex> lock(m_loaderMutex);
+			bPagesLoaded = !m_loadedPages.empty();
+		}
+		if (bPagesLoaded)
+		{
+			pScheduler->Post("virtual texture uploads", [this]()
+			{
+				return(UploadLoadedPage());
+			});
+		}
+	}
+	else
+	{
+		bool bMorePages = true;
+		for (int i = 0; bMorePages && (i < MAX_UPLOADS_PER_FRAME); i++)
+		{
+			bMorePages = UploadLoadedPage();
+		}
+	}
+
+	if (m_bPageTableDirty)
+	{
+		UpdatePageTable();
+	}
+
+	m_frameIndex++;
+}
+
+/***********************************************************
+ *  UploadLoadedPage()
+ *
+ *  This method is used to take the oldest page the loader
+ *  thread has read and put it into the cache. A page that
+ *  finds no free slot is dropped, and requested again if a
+ *  later feedback pass still sees it.
+ ***********************************************************/
+bool VirtualTexture::UploadLoadedPage()
+{
+	LOADED_PAGE loadedPage;
+	bool bMorePages = false;
+	{
+		std::lock_guard<std::mutex> lock(m_loaderMutex);
+		if (m_loadedPages.empty())
+		{
+			return(false);
+		}
+		loadedPage = std::move(m_loadedPages.front());
+		m_loadedPages.pop_front();
+		bMorePages = !m_loadedPages.empty();
+	}
+
+	m_requestedPages.erase(loadedPage.key);
+	if (!loadedPage.tile.empty())
+	{
+		UploadPage(loadedPage.key, loadedPage.tile.data());
+	}
+
+	return(bMorePages);
+}
+
+/***********************************************************
+ *  ProcessFeedback()
+ *
+ *  This method is used to mark the loaded pages seen in the
+ *  feedback as used, and to queue the missing ones. Every
+ *  coarser page above a seen page is wanted as well, since it
+ *  is drawn until the finer page arrives. The coarsest missing
+ *  pages are queued first so the view sharpens evenly. The
+ *  pages of a predicted view go to their own shorter queue,
+ *  replacing the ones of the last prediction not read yet. A
+ *  page the view needs that is still waiting in that queue
+ *  is moved to the queue of the view, so it is not read
+ *  after the pages of the view that were asked for later.
+ *  The frame of the last feedback of the view is kept, so
+ *  the pages it saw are not replaced until the next one.
+ ***********************************************************/
+void VirtualTexture::ProcessFeedback(const unsigned char* pPixels, int width, int height, bool bPrefetch)
+{
+	if (!bPrefetch)
+	{
+		m_lastFeedbackFrame = m_frameIndex;
+	}
+
+	if (bPrefetch)
+	{
+		std::lock_guard<std::mutex> lock(m_loaderMutex);
+		for (size_t i = 0; i < m_prefetchPages.size(); i++)
+		{
+			m_requestedPages.erase(m_prefetchPages[i]);
+		}
+		m_prefetchPages.clear();
+	}
+
+	std::set<PAGE_KEY> visitedPages;
+	std::set<PAGE_KEY> missingPages;
+	std::set<PAGE_KEY> requestedPages;
+
+	for (int i = 0; i < width * height; i++)
+	{
+		const unsigned char* pPixel = &pPixels[i * 4];
+		if (pPixel[3] == 0)
+		{
+			continue;
+		}
+
+		int mip = pPixel[2];
+		int pageX = pPixel[0];
+		int pageY = pPixel[1];
+		for (; mip < m_layout.mipCount; mip++, pageX /= 2, pageY /= 2)
+		{
+			PAGE_KEY key = MakePageKey(mip, pageX, pageY);
+			if (!visitedPages.insert(key).second)
+			{
+				break;
+			}
+
+			std::map<PAGE_KEY, int>::const_iterator resident = m_residentPages.find(key);
+			if (resident != m_residentPages.end())
+			{
+				m_slots[resident->second].lastSeenFrame = m_frameIndex;
+			}
+			else if (m_requestedPages.count(key) == 0)
+			{
+				missingPages.insert(key);
+			}
+			else if (!bPrefetch)
+			{
+				requestedPages.insert(key);
+			}
+		}
+	}
+
+	if (!requestedPages.empty())
+	{
+		std::lock_guard<std::mutex> lock(m_loaderMutex);
+		for (std::deque<PAGE_KEY>::iterator page = m_prefetchPages.begin(); page != m_prefetchPages.end();)
+		{
+			if (requestedPages.count(*page) != 0)
+			{
+				m_requestedPages.erase(*page);
+				missingPages.insert(*page);
+				page = m_prefetchPages.erase(page);
+			}
+			else
+			{
+				++page;
+			}
+		}
+	}
+
+	if (missingPages.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_loaderMutex);
+		std::deque<PAGE_KEY>& pages = bPrefetch ? m_prefetchPages : m_queuedPages;
+		size_t maxPages = bPrefetch ? (size_t)MAX_PREFETCH_PAGES : (size_t)MAX_QUEUED_PAGES;
+		for (std::set<PAGE_KEY>::const_reverse_iterator key = missingPages.rbegin(); key != missingPages.rend(); ++key)
+		{
+			if (pages.size() >= maxPages)
+			{
+				break;
+			}
+			pages.push_back(*key);
+			m_requestedPages.insert(*key);
+		}
+	}
+	m_loaderSignal.notify_one();
+}
+
+/***********************************************************
+ *  UploadPage()
+ *
+ *  This method is used to copy a page into a free slot of the
+ *  cache, or into the slot of the page not seen for the
+ *  longest time. Pages seen or uploaded since the last
+ *  feedback pass of the view was processed are not replaced,
+ *  the locked page of the coarsest mip level never is.
+ ***********************************************************/
+bool VirtualTexture::UploadPage(PAGE_KEY key, const unsigned char* pTile)
+{
+	int slotIndex = -1;
+	for (size_t i = 0; i < m_slots.size(); i++)
+	{
+		const CACHE_SLOT& slot = m_slots[i];
+		if (!slot.bUsed)
+		{
+			slotIndex = (int)i;
+			break;
+		}
+		if (!slot.bLocked && (slot.lastSeenFrame < m_lastFeedbackFrame) &&
+			((slotIndex < 0) || (slot.lastSeenFrame < m_slots[slotIndex].lastSeenFrame)))
+		{
+			slotIndex = (int)i;
+		}
+	}
+	if (slotIndex < 0)
+	{
+		return(false);
+	}
+
+	CACHE_SLOT& slot = m_slots[slotIndex];
+	if (slot.bUsed)
+	{
+		m_residentPages.erase(slot.key);
+	}
+
+	int slotX = slotIndex % CACHE_PAGES_PER_SIDE;
+	int slotY = slotIndex / CACHE_PAGES_PER_SIDE;
+	glActiveTexture(GL_TEXTURE0 + PAGE_CACHE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_pageCache.Get());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0,
+		slotX * VirtualTextureFile::TILE_SIZE, slotY * VirtualTextureFile::TILE_SIZE,
+		VirtualTextureFile::TILE_SIZE, VirtualTextureFile::TILE_SIZE,
+		GL_RGBA, GL_UNSIGNED_BYTE, pTile);
+	glActiveTexture(GL_TEXTURE0);
+
+	slot.bUsed = true;
+	slot.key = key;
+	slot.lastSeenFrame = m_frameIndex;
+	m_residentPages[key] = slotIndex;
+	m_bPageTableDirty = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  UpdatePageTable()
+ *
+ *  This method is used to write every level of the page
+ *  table from the coarsest down. A loaded page points at its
+ *  own slot, any other page copies the entry of the page one
+ *  level above it.
+ ***********************************************************/
+void VirtualTexture::UpdatePageTable()
+{
+	glActiveTexture(GL_TEXTURE0 + PAGE_TABLE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_pageTable.Get());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	std::vector<unsigned char> coarserEntries;
+	std::vector<unsigned char> entries;
+	for (int mip = m_layout.mipCount - 1; mip >= 0; mip--)
+	{
+		int side = m_file.GetPagesPerSide(mip);
+		int coarserSide = side / 2;
+		entries.resize((size_t)side * side * 4);
+
+		for (int pageY = 0; pageY < side; pageY++)
+		{
+			for (int pageX = 0; pageX < side; pageX++)
+			{
+				unsigned char* pEntry = &entries[((size_t)pageY * side + pageX) * 4];
+				std::map<PAGE_KEY, int>::const_iterator resident = m_residentPages.find(MakePageKey(mip, pageX, pageY));
+				if (resident != m_residentPages.end())
+				{
+					pEntry[0] = (unsigned char)(resident->second % CACHE_PAGES_PER_SIDE);
+					pEntry[1] = (unsigned char)(resident->second / CACHE_PAGES_PER_SIDE);
+					pEntry[2] = (unsigned char)mip;
+					pEntry[3] = 255;
+				}
+				else
+				{
+					const unsigned char* pCoarser = &coarserEntries[((size_t)(pageY / 2) * coarserSide + (pageX / 2)) * 4];
+					pEntry[0] = pCoarser[0];
+					pEntry[1] = pCoarser[1];
+					pEntry[2] = pCoarser[2];
+					pEntry[3] = pCoarser[3];
+				}
+			}
+		}
+
+		glTexSubImage2D(GL_TEXTURE_2D, mip, 0, 0, side, side, GL_RGBA, GL_UNSIGNED_BYTE, entries.data());
+		coarserEntries.swap(entries);
+	}
+
+	glActiveTexture(GL_TEXTURE0);
+	m_bPageTableDirty = false;
+}
+
+/***********************************************************
+ *  SetLayoutUniforms()
+ *
+ *  This method is used to set the page grid values that the
+ *  feedback and draw programs share.
+ ***********************************************************/
+void VirtualTexture::SetLayoutUniforms(GLuint program, float mipBias)
+{
+	float virtualSize = (float)(m_layout.pagesPerSide * VirtualTextureFile::PAGE_SIZE);
+
+	glUniform2f(glGetUniformLocation(program, "contentScale"),
+		(float)m_layout.imageWidth / virtualSize, (float)m_layout.imageHeight / virtualSize);
+	glUniform1f(glGetUniformLocation(program, "virtualSize"), virtualSize);
+	glUniform1f(glGetUniformLocation(program, "maxMip"), (float)(m_layout.mipCount - 1));
+	glUniform1f(glGetUniformLocation(program, "mipBias"), mipBias);
+}
+
+/***********************************************************
+ *  BeginFeedbackPass()
+ *
+ *  This method is used to bind the feedback target at a
+ *  fraction of the current viewport. The mip bias makes up
+ *  for the lower resolution, so the pages asked for are the
+ *  ones the full view will draw. Only the objects with the
+ *  virtual texture are drawn into it, so pages behind other
+ *  objects are loaded as well.
+ ***********************************************************/
+void VirtualTexture::BeginFeedbackPass(const glm::mat4& viewProjection, bool bPrefetch)
+{
+	m_bFeedbackPrefetch = bPrefetch;
+	glGetIntegerv(GL_VIEWPORT, m_savedViewport);
+	glGetIntegerv(GL_CURRENT_PROGRAM, &m_previousProgram);
+
+	m_feedbackWidth = m_savedViewport[2] / FEEDBACK_DIVISOR;
+	m_feedbackHeight = m_savedViewport[3] / FEEDBACK_DIVISOR;
+	m_feedbackWidth = (m_feedbackWidth < 1) ? 1 : ((m_feedbackWidth > FEEDBACK_TARGET_SIZE) ? FEEDBACK_TARGET_SIZE : m_feedbackWidth);
+	m_feedbackHeight = (m_feedbackHeight < 1) ? 1 : ((m_feedbackHeight > FEEDBACK_TARGET_SIZE) ? FEEDBACK_TARGET_SIZE : m_feedbackHeight);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_feedbackFramebuffer);
+	glViewport(0, 0, m_feedbackWidth, m_feedbackHeight);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// the page values must be written exactly, so no blending
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+
+	m_activeProgram = m_feedbackProgram.Get();
+	glUseProgram(m_activeProgram);
+	SetLayoutUniforms(m_activeProgram, -std::log2((float)FEEDBACK_DIVISOR));
+	glUniformMatrix4fv(glGetUniformLocation(m_activeProgram, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+}
+
+/***********************************************************
+ *  EndFeedbackPass()
+ *
+ *  This method is used to start the copy of the feedback
+ *  into the readback buffer, and restore the viewport and
+ *  program. A fence marks when the copy has finished.
+ ***********************************************************/
+void VirtualTexture::EndFeedbackPass()
+{
+	glEnable(GL_BLEND);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_feedbackFramebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_feedbackBuffer.Get());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, m_feedbackWidth, m_feedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	m_feedbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	glViewport(m_savedViewport[0], m_savedViewport[1], m_savedViewport[2], m_savedViewport[3]);
+	glUseProgram((GLuint)m_previousProgram);
+	m_activeProgram = 0;
+}
+
+/***********************************************************
+ *  BeginDraw()
+ *
+ *  This method is used to switch to the draw program and
+ *  bind the page table and page cache with the values of the
+ *  material being drawn.
+ ***********************************************************/
+void VirtualTexture::BeginDraw(const glm::mat4& viewProjection, const glm::vec3& ambientColor, float ambientStrength, const glm::vec3& diffuseColor)
+{
+	glGetIntegerv(GL_CURRENT_PROGRAM, &m_previousProgram);
+
+	m_activeProgram = m_drawProgram.Get();
+	glUseProgram(m_activeProgram);
+
+	glActiveTexture(GL_TEXTURE0 + PAGE_TABLE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_pageTable.Get());
+	glActiveTexture(GL_TEXTURE0 + PAGE_CACHE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_pageCache.Get());
+	glActiveTexture(GL_TEXTURE0);
+
+	SetLayoutUniforms(m_activeProgram, 0.0f);
+	glUniformMatrix4fv(glGetUniformLocation(m_activeProgram, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+	glUniform1i(glGetUniformLocation(m_activeProgram, "pageTable"), PAGE_TABLE_TEXTURE_UNIT);
+	glUniform1i(glGetUniformLocation(m_activeProgram, "pageCache"), PAGE_CACHE_TEXTURE_UNIT);
+	glUniform1f(glGetUniformLocation(m_activeProgram, "pageSize"), (float)VirtualTextureFile::PAGE_SIZE);
+	glUniform1f(glGetUniformLocation(m_activeProgram, "pageBorder"), (float)VirtualTextureFile::PAGE_BORDER);
+	glUniform1f(glGetUniformLocation(m_activeProgram, "tileSize"), (float)VirtualTextureFile::TILE_SIZE);
+	glUniform1f(glGetUniformLocation(m_activeProgram, "cacheSize"), (float)CACHE_SIZE);
+	glUniform3fv(glGetUniformLocation(m_activeProgram, "lightDirection"), 1, glm::value_ptr(m_lightDirection));
+	glUniform3fv(glGetUniformLocation(m_activeProgram, "lightAmbient"), 1, glm::value_ptr(m_lightAmbient));
+	glUniform3fv(glGetUniformLocation(m_activeProgram, "lightDiffuse"), 1, glm::value_ptr(m_lightDiffuse));
+	glUniform3fv(glGetUniformLocation(m_activeProgram, "ambientColor"), 1, glm::value_ptr(ambientColor));
+	glUniform1f(glGetUniformLocation(m_activeProgram, "ambientStrength"), ambientStrength);
+	glUniform3fv(glGetUniformLocation(m_activeProgram, "diffuseColor"), 1, glm::value_ptr(diffuseColor));
+
+	if (NULL != m_pIrradianceVolume)
+	{
+		m_pIrradianceVolume->Bind(m_activeProgram);
+	}
+	else
+	{
+		IrradianceVolume::SetSamplerUnits(m_activeProgram);
+	}
+	glUniform1i(glGetUniformLocation(m_activeProgram, "bUseProbes"), (NULL != m_pIrradianceVolume) ? 1 : 0);
+}
+
+/***********************************************************
+ *  EndDraw()
+ *
+ *  This method is used to switch back to the scene program.
+ ***********************************************************/
+void VirtualTexture::EndDraw()
+{
+	glUseProgram((GLuint)m_previousProgram);
+	m_activeProgram = 0;
+}
+
+/***********************************************************
+ *  SetModel()
+ *
+ *  This method is used to set the model matrix of the next
+ *  object drawn in the feedback or the draw pass.
+ ***********************************************************/
+void VirtualTexture::SetModel(const glm::mat4& model)
+{
+	glUniformMatrix4fv(glGetUniformLocation(m_activeProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
+}
@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualtexture.h
+// ============
+// stream the pages of a very large texture into a fixed page cache, driven
+// by a feedback pass that records which pages are seen
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResource.h"
+#include "VirtualTextureFile.h"
+#include "IrradianceVolume.h"
+#include "FrameScheduler.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+/***********************************************************
+ *  VirtualTexture
+ *
+ *  This class draws with a texture too large to upload as a
+ *  whole. Only the pages that are seen are kept in a page
+ *  cache texture, and a page table texture maps every page of
+ *  every mip level to its place in the cache, or to the
+ *  nearest coarser page that is there. Each frame a small
+ *  feedback pass writes the page every pixel wants, and it
+ *  is read back without waiting for the GPU. The missing
+ *  pages are read from the tiled file on a loader thread and
+ *  a few are uploaded per frame, replacing the pages that
+ *  were not seen for the longest time. With a frame scheduler
+ *  the uploads and the feedback run in the time left of the
+ *  frame instead of a fixed number of pages. A feedback pass
+ *  can also be drawn from where the camera is heading, and
+ *  the pages it finds are read only when no page of the
+ *  current view is waiting.
+ ***********************************************************/
+class VirtualTexture
+{
+public:
+	// pages along each side of the page cache texture
+	static const int CACHE_PAGES_PER_SIDE = 16;
+	// the feedback pass is drawn at this fraction of the view
+	static const int FEEDBACK_DIVISOR = 8;
+	// largest feedback pass, enough for a 4K view
+	static const int FEEDBACK_TARGET_SIZE = 512;
+	// pages uploaded in one frame without a frame scheduler, so
+	// streaming never stalls it
+	static const int MAX_UPLOADS_PER_FRAME = 8;
+	// pages waiting for the loader thread at one time
+	static const int MAX_QUEUED_PAGES = 64;
+	// pages of a predicted view waiting for the loader thread,
+	// which are dropped when a newer prediction arrives
+	static const int MAX_PREFETCH_PAGES = 16;
+
+	// constructor
+	VirtualTexture();
+	// destructor
+	~VirtualTexture();
+
+	// open the tiled file of an image and create the textures,
+	// the feedback target and the loader thread
+	bool Initialize(const char* imageFile);
+	// stop the loader thread and free everything
+	void Destroy();
+	bool IsInitialized() const { return(m_bInitialized); }
+
+	// set the directional light the ground is lit with
+	void SetDirectionalLight(const glm::vec3& direction, const glm::vec3& ambient, const glm::vec3& diffuse);
+	// light the ground from irradiance probes instead of the
+	// ambient values, or from the ambient values again for NULL
+	void SetIrradianceVolume(const IrradianceVolume* pIrradianceVolume) { m_pIrradianceVolume = pIrradianceVolume; }
+
+	// upload loaded pages and request the pages seen in the last
+	// finished feedback pass, called once per frame, or queue
+	// that work on a frame scheduler when one is passed in
+	void Update(FrameScheduler* pScheduler = NULL);
+
+	// true when the last feedback pass has not been read and
+	// processed yet
+	bool IsFeedbackPending() const { return((m_feedbackFence != 0) || m_bFeedbackScheduled); }
+	// bind the feedback target for drawing the seen pages, or
+	// the pages a predicted view will see when prefetching
+	void BeginFeedbackPass(const glm::mat4& viewProjection, bool bPrefetch = false);
+	// start copying the feedback into the readback buffer
+	void EndFeedbackPass();
+
+	// use the program that draws with the virtual texture
+	void BeginDraw(const glm::mat4& viewProjection, const glm::vec3& ambientColor, float ambientStrength, const glm::vec3& diffuseColor);
+	// restore the program that was in use before BeginDraw()
+	void EndDraw();
+
+	// set the model matrix of the next object drawn in either pass
+	void SetModel(const glm::mat4& model);
+
+private:
+	// a page of one mip level, packed as mip, y and x
+	typedef uint32_t PAGE_KEY;
+
+	// a page read by the loader thread
+	struct LOADED_PAGE
+	{
+		PAGE_KEY key;
+		std::vector<unsigned char> tile;
+	};
+
+	// a place for one page in the page cache
+	struct CACHE_SLOT
+	{
+		bool bUsed;
+		bool bLocked;
+		PAGE_KEY key;
+		unsigned int lastSeenFrame;
+	};
+
+	static PAGE_KEY MakePageKey(int mip, int pageX, int pageY);
+
+	// read the requested pages until the loader is stopped
+	void LoaderThread();
+	// find the pages wanted by the read back feedback
+	void ProcessFeedback(const unsigned char* pPixels, int width, int height, bool bPrefetch);
+	// upload the oldest page read by the loader thread, returns
+	// true while more pages are waiting
+	bool UploadLoadedPage();
+	// put a loaded page into the cache, false when it is full
+	bool UploadPage(PAGE_KEY key, const unsigned char* pTile);
+	// write the whole page table and upload it
+	void UpdatePageTable();
+	// set the page grid values used by both programs
+	void SetLayoutUniforms(GLuint program, float mipBias);
+
+	bool m_bInitialized;
+	VirtualTextureFile m_file;
+	VirtualTextureFile::LAYOUT m_layout;
+
+	GpuTexture m_pageTable;
+	GpuTexture m_pageCache;
+	GpuProgram m_drawProgram;
+	GpuProgram m_feedbackProgram;
+	// program of the pass being drawn, and the one to restore
+	GLuint m_activeProgram;
+	GLint m_previousProgram;
+
+	// feedback target and its readback
+	GLuint m_feedbackFramebuffer;
+	GLuint m_feedbackColor;
+	GLuint m_feedbackDepth;
+	size_t m_feedbackBytes;
+	GpuBuffer m_feedbackBuffer;
+	GLsync m_feedbackFence;
+	int m_feedbackWidth;
+	int m_feedbackHeight;
+	GLint m_savedViewport[4];
+	std::vector<unsigned char> m_feedbackPixels;
+	// true while the read back feedback waits for the scheduler
+	bool m_bFeedbackScheduled;
+	// true when the last feedback pass was drawn from a predicted view
+	bool m_bFeedbackPrefetch;
+
+	// residency of the pages
+	std::vector<CACHE_SLOT> m_slots;
+	std::map<PAGE_KEY, int> m_residentPages;
+	std::set<PAGE_KEY> m_requestedPages;
+	bool m_bPageTableDirty;
+	unsigned int m_frameIndex;
+	// frame of the last feedback pass of the view processed
+	unsigned int m_lastFeedbackFrame;
+
+	// pages waiting for and returned by the loader thread
+	std::thread m_loaderThread;
+	std::mutex m_loaderMutex;
+	std::condition_variable m_loaderSignal;
+	std::deque<PAGE_KEY> m_queuedPages;
+	std::deque<PAGE_KEY> m_prefetchPages;
+	std::deque<LOADED_PAGE> m_loadedPages;
+	bool m_bStopLoader;
+
+	// directional light of the scene
+	glm::vec3 m_lightDirection;
+	glm::vec3 m_lightAmbient;
+	glm::vec3 m_lightDiffuse;
+	// probes of the indirect light, if any
+	const IrradianceVolume* m_pIrradianceVolume;
+};
@@ -0,0 +1,330 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualtexturefile.cpp
+// ============
+// tiled on-disk format for the pages of a virtual texture
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VirtualTextureFile.h"
+#include "TextureDecoder.h"
+#include "TextureCache.h"
+#include "MipGenerator.h"
+
+#include <iostream>
+#include <utility>
+#include <stdint.h>
+
+// declaration of global variables
+namespace
+{
+	// identifies a tiled file, and its layout version
+	const uint32_t TILED_MAGIC = 0x58455456;
+	const uint32_t TILED_VERSION = 1;
+
+	// values stored at the start of every tiled file, followed
+	// by the pages of each mip level row by row from the bottom
+	struct TILED_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		int64_t sourceSize;
+		int64_t sourceModifiedTime;
+		int32_t pageSize;
+		int32_t pageBorder;
+		int32_t imageWidth;
+		int32_t imageHeight;
+		int32_t pagesPerSide;
+		int32_t mipCount;
+	};
+
+	/***********************************************************
+	 *  SeekTo()
+	 *
+	 *  This function is used to move to a byte offset that can
+	 *  be past what a long holds on Windows.
+	 ***********************************************************/
+	bool SeekTo(FILE* pFile, long long offset)
+	{
+#ifdef _WIN32
+		return(_fseeki64(pFile, offset, SEEK_SET) == 0);
+#else
+		return(fseeko(pFile, (off_t)offset, SEEK_SET) == 0);
+#endif
+	}
+
+	/***********************************************************
+	 *  CopyTile()
+	 *
+	 *  This function is used to copy one page and its border
+	 *  out of a square RGBA mip level. The border past the edge
+	 *  of the level repeats the edge texels.
+	 ***********************************************************/
+	void CopyTile(const TextureDecoder::DECODED_IMAGE& level, int pageX, int pageY, unsigned char* pTile)
+	{
+		const int tileSize = VirtualTextureFile::TILE_SIZE;
+		int firstX = pageX * VirtualTextureFile::PAGE_SIZE - VirtualTextureFile::PAGE_BORDER;
+		int firstY = pageY * VirtualTextureFile::PAGE_SIZE - VirtualTextureFile::PAGE_BORDER;
+
+		for (int y = 0; y < tileSize; y++)
+		{
+			int sourceY = firstY + y;
+			sourceY = (sourceY < 0) ? 0 : ((sourceY >= level.height) ? (level.height - 1) : sourceY);
+			for (int x = 0; x < tileSize; x++)
+			{
+				int sourceX = firstX + x;
+				sourceX = (sourceX < 0) ? 0 : ((sourceX >= level.width) ? (level.width - 1) : sourceX);
+
+				const unsigned char* pSource = &level.pixels[((size_t)sourceY * level.width + sourceX) * 4];
+				unsigned char* pTarget = &pTile[(y * tileSize + x) * 4];
+				pTarget[0] = pSource[0];
+				pTarget[1] = pSource[1];
+				pTarget[2] = pSource[2];
+				pTarget[3] = pSource[3];
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  VirtualTextureFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VirtualTextureFile::VirtualTextureFile()
+{
+	m_pFile = NULL;
+	m_layout.imageWidth = 0;
+	m_layout.imageHeight = 0;
+	m_layout.pagesPerSide = 0;
+	m_layout.mipCount = 0;
+}
+
+/***********************************************************
+ *  ~VirtualTextureFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VirtualTextureFile::~VirtualTextureFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used to open the tiled file of an image.
+ *  A file written for another version of the image, or for
+ *  another page size, is built again.
+ ***********************************************************/
+bool VirtualTextureFile::Open(const char* imageFile)
+{
+	Close();
+
+	long long sourceSize = 0;
+	long long sourceModifiedTime = 0;
+	if (!TextureCache::ReadSourceStamp(imageFile, sourceSize, sourceModifiedTime))
+	{
+		std::cout << "ERROR: Could not find virtual texture image " << imageFile << std::endl;
+		return(false);
+	}
+
+	std::string tiledPath = TextureCache::GetCacheFile(imageFile, ".vtex");
+	for (int attempt = 0; attempt < 2; attempt++)
+	{
+		m_pFile = fopen(tiledPath.c_str(), "rb");
+
+		TILED_HEADER header;
+		if ((m_pFile != NULL) &&
+			(fread(&header, sizeof(header), 1, m_pFile) == 1) &&
+			(header.magic == TILED_MAGIC) &&
+			(header.version == TILED_VERSION) &&
+			(header.sourceSize == sourceSize) &&
+			(header.sourceModifiedTime == sourceModifiedTime) &&
+			(header.pageSize == PAGE_SIZE) &&
+			(header.pageBorder == PAGE_BORDER))
+		{
+			m_layout.imageWidth = header.imageWidth;
+			m_layout.imageHeight = header.imageHeight;
+			m_layout.pagesPerSide = header.pagesPerSide;
+			m_layout.mipCount = header.mipCount;
+
+			long long firstTile = 0;
+			for (int mip = 0; mip < m_layout.mipCount; mip++)
+			{
+				m_firstTiles.push_back(firstTile);
+				firstTile += (long long)GetPagesPerSide(mip) * GetPagesPerSide(mip);
+			}
+
+			return(true);
+		}
+
+		Close();
+		if ((attempt == 0) && !Build(imageFile, tiledPath))
+		{
+			break;
+		}
+	}
+
+	std::cout << "ERROR: Could not open virtual texture " << tiledPath << std::endl;
+
+	return(false);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used to close the tiled file.
+ ***********************************************************/
+void VirtualTextureFile::Close()
+{
+	if (m_pFile != NULL)
+	{
+		fclose(m_pFile);
+		m_pFile = NULL;
+	}
+	m_firstTiles.clear();
+}
+
+/***********************************************************
+ *  ReadTile()
+ *
+ *  This method is used to read one stored page. The file is
+ *  not locked, so only one thread may read tiles at a time.
+ ***********************************************************/
+bool VirtualTextureFile::ReadTile(int mip, int pageX, int pageY, unsigned char* pTile)
+{
+	if ((m_pFile == NULL) || (mip < 0) || (mip >= m_layout.mipCount))
+	{
+		return(false);
+	}
+
+	int pagesPerSide = GetPagesPerSide(mip);
+	if ((pageX < 0) || (pageY < 0) || (pageX >= pagesPerSide) || (pageY >= pagesPerSide))
+	{
+		return(false);
+	}
+
+	long long tileIndex = m_firstTiles[mip] + (long long)pageY * pagesPerSide + pageX;
+	long long offset = (long long)sizeof(TILED_HEADER) + tileIndex * TILE_BYTES;
+	if (!SeekTo(m_pFile, offset))
+	{
+		return(false);
+	}
+
+	return(fread(pTile, TILE_BYTES, 1, m_pFile) == 1);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used to write the tiled file of an image.
+ *  The image is padded to a power of two pages by repeating
+ *  its edges, then every mip level down to a single page is
+ *  cut into tiles. The whole image is held in memory while
+ *  the file is built, but never again after that.
+ ***********************************************************/
+bool VirtualTextureFile::Build(const char* imageFile, const std::string& tiledPath)
+{
+	long long sourceSize = 0;
+	long long sourceModifiedTime = 0;
+	TextureDecoder::DECODED_IMAGE image;
+	if (!TextureCache::ReadSourceStamp(imageFile, sourceSize, sourceModifiedTime) ||
+		!TextureDecoder::Decode(imageFile, 0, image))
+	{
+		return(false);
+	}
+
+	int largestSide = (image.width > image.height) ? image.width : image.height;
+	int pagesPerSide = 1;
+	int mipCount = 1;
+	while ((pagesPerSide * PAGE_SIZE < largestSide) && (pagesPerSide < MAX_PAGES_PER_SIDE))
+	{
+		pagesPerSide *= 2;
+		mipCount++;
+	}
+	if (pagesPerSide * PAGE_SIZE < largestSide)
+	{
+		std::cout << "ERROR: Virtual texture image " << imageFile << " is larger than "
+			<< (MAX_PAGES_PER_SIDE * PAGE_SIZE) << " texels" << std::endl;
+		return(false);
+	}
+
+	// expand to RGBA and pad the top and right edges
+	TextureDecoder::DECODED_IMAGE level;
+	level.width = pagesPerSide * PAGE_SIZE;
+	level.height = level.width;
+	level.channels = 4;
+	level.pixels.resize((size_t)level.width * level.height * 4);
+	for (int y = 0; y < level.height; y++)
+	{
+		int sourceY = (y < image.height) ? y : (image.height - 1);
+		for (int x = 0; x < level.width; x++)
+		{
+			int sourceX = (x < image.width) ? x : (image.width - 1);
+			const unsigned char* pSource = &image.pixels[((size_t)sourceY * image.width + sourceX) * image.channels];
+			unsigned char* pTarget = &level.pixels[((size_t)y * level.width + x) * 4];
+			pTarget[0] = pSource[0];
+			pTarget[1] = (image.channels >= 3) ? pSource[1] : pSource[0];
+			pTarget[2] = (image.channels >= 3) ? pSource[2] : pSource[0];
+			pTarget[3] = (image.channels == 4) ? pSource[3] : 255;
+		}
+	}
+
+	TILED_HEADER header;
+	header.magic = TILED_MAGIC;
+	header.version = TILED_VERSION;
+	header.sourceSize = sourceSize;
+	header.sourceModifiedTime = sourceModifiedTime;
+	header.pageSize = PAGE_SIZE;
+	header.pageBorder = PAGE_BORDER;
+	header.imageWidth = image.width;
+	header.imageHeight = image.height;
+	header.pagesPerSide = pagesPerSide;
+	header.mipCount = mipCount;
+	image.pixels.clear();
+	image.pixels.shrink_to_fit();
+
+	TextureCache::CreateCacheFolder();
+	std::string temporaryPath = tiledPath + ".tmp";
+	FILE* pFile = fopen(temporaryPath.c_str(), "wb");
+	if (pFile == NULL)
+	{
+		return(false);
+	}
+
+	bool bWritten = (fwrite(&header, sizeof(header), 1, pFile) == 1);
+	std::vector<unsigned char> tile(TILE_BYTES);
+	for (int mip = 0; bWritten && (mip < mipCount); mip++)
+	{
+		int levelPages = pagesPerSide >> mip;
+		for (int pageY = 0; bWritten && (pageY < levelPages); pageY++)
+		{
+			for (int pageX = 0; bWritten && (pageX < levelPages); pageX++)
+			{
+				CopyTile(level, pageX, pageY, tile.data());
+				bWritten = (fwrite(tile.data(), TILE_BYTES, 1, pFile) == 1);
+			}
+		}
+
+		if (mip + 1 < mipCount)
+		{
+			TextureDecoder::DECODED_IMAGE reduced;
+			MipGenerator::ReduceByHalf(level, reduced, true);
+			level = std::move(reduced);
+		}
+	}
+
+	bWritten = (fclose(pFile) == 0) && bWritten;
+	if (!bWritten)
+	{
+		std::remove(temporaryPath.c_str());
+		return(false);
+	}
+
+	std::remove(tiledPath.c_str());
+	std::rename(temporaryPath.c_str(), tiledPath.c_str());
+
+	std::cout << "INFO: Built virtual texture " << tiledPath << " with " << pagesPerSide
+		<< " pages per side and " << mipCount << " mip levels" << std::endl;
+
+	return(true);
+}
@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualtexturefile.h
+// ============
+// tiled on-disk format for the pages of a virtual texture
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  VirtualTextureFile
+ *
+ *  This class reads the pages of a virtual texture from a
+ *  tiled file in the texture cache folder. Every mip level
+ *  of the image is cut into square pages, and each page is
+ *  stored with a border copied from its neighbours, so any
+ *  page can be read with one seek and filtered without
+ *  seams. The file is built from the source image the first
+ *  time it is opened, and again when the image changes.
+ ***********************************************************/
+class VirtualTextureFile
+{
+public:
+	// texels of the image in one page, along each side
+	static const int PAGE_SIZE = 128;
+	// texels copied from the neighbouring pages on each side
+	static const int PAGE_BORDER = 4;
+	// texels of one stored page including its border
+	static const int TILE_SIZE = PAGE_SIZE + 2 * PAGE_BORDER;
+	// bytes of one stored page, always RGBA
+	static const int TILE_BYTES = TILE_SIZE * TILE_SIZE * 4;
+	// most pages along a side, which keeps the page coordinates
+	// in 8 bits for the feedback buffer
+	static const int MAX_PAGES_PER_SIDE = 256;
+
+	// size of the image and of the square page grid over it,
+	// padded to a power of two pages so that every mip level
+	// halves the grid down to a single page
+	struct LAYOUT
+	{
+		int imageWidth;
+		int imageHeight;
+		int pagesPerSide;
+		int mipCount;
+	};
+
+	// constructor
+	VirtualTextureFile();
+	// destructor
+	~VirtualTextureFile();
+
+	// open the tiled file of an image, building it when it is
+	// missing or older than the image
+	bool Open(const char* imageFile);
+	// close the tiled file
+	void Close();
+
+	const LAYOUT& GetLayout() const { return(m_layout); }
+	// get the number of pages along each side of a mip level
+	int GetPagesPerSide(int mip) const { return(m_layout.pagesPerSide >> mip); }
+
+	// read one page with its border into TILE_BYTES of memory,
+	// the rows are stored bottom up like the mip levels
+	bool ReadTile(int mip, int pageX, int pageY, unsigned char* pTile);
+
+private:
+	// cut the mip levels of an image into the tiled file
+	static bool Build(const char* imageFile, const std::string& tiledPath);
+
+	FILE* m_pFile;
+	LAYOUT m_layout;
+	// index of the first page of every mip level in the file
+	std::vector<long long> m_firstTiles;
+};
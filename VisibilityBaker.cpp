@@ -0,0 +1,205 @@
+///////////////////////////////////////////////////////////////////////////////
+// visibilitybaker.cpp
+// ============
+// bake the cells of the garden that can be seen from each other cell
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VisibilityBaker.h"
+#include "TriangleBVH.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// cells a worker thread takes at a time
+	const int WORK_CHUNK = 1;
+	// distance a hit may be outside a cell and still count as
+	// a surface of the cell
+	const float CELL_TOLERANCE = 0.01f;
+
+	/***********************************************************
+	 *  NextRandom()
+	 *
+	 *  This function returns a number from 0 up to 1 and steps
+	 *  the state, so every pair of cells gets the same samples
+	 *  in every bake.
+	 ***********************************************************/
+	float NextRandom(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		return((float)(state >> 8) / 16777216.0f);
+	}
+
+	/***********************************************************
+	 *  IsInColumn()
+	 *
+	 *  This function returns true when a point is over the
+	 *  square of a cell.
+	 ***********************************************************/
+	bool IsInColumn(const glm::vec3& point, const glm::vec2& cellMin)
+	{
+		return((point.x >= cellMin.x - CELL_TOLERANCE) && (point.x <= cellMin.x + VisibilityBaker::CELL_SIZE + CELL_TOLERANCE) &&
+			(point.z >= cellMin.y - CELL_TOLERANCE) && (point.z <= cellMin.y + VisibilityBaker::CELL_SIZE + CELL_TOLERANCE));
+	}
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used to bake the sets, one cell of the
+ *  camera at a time on every hardware thread. A ray that
+ *  hits a surface over the other cell reaches it as well,
+ *  since that surface is what the camera would see there. A
+ *  ray that first hits the back of a face started inside an
+ *  object, where no camera can see from, and is not counted.
+ ***********************************************************/
+bool VisibilityBaker::Bake(
+	const std::vector<LightmapBaker::BAKE_OBJECT>& objects,
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax,
+	VISIBILITY_GRID& grid)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	std::vector<glm::vec3> worldCorners;
+	std::vector<glm::vec3> worldNormals;
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		if (!LightmapBaker::IsSupported(objects[i].primitive))
+		{
+			std::cout << "ERROR: Cannot bake visibility for mesh primitive " << (int)objects[i].primitive << std::endl;
+			return(false);
+		}
+		LightmapBaker::AddWorldTriangles(objects[i], worldCorners, worldNormals);
+	}
+
+	TriangleBVH bvh;
+	bvh.Build(worldCorners);
+
+	grid.counts.x = std::min(std::max((int)std::ceil((boundsMax.x - boundsMin.x) / CELL_SIZE), 1), (int)MAX_CELLS_PER_AXIS);
+	grid.counts.y = std::min(std::max((int)std::ceil((boundsMax.z - boundsMin.z) / CELL_SIZE), 1), (int)MAX_CELLS_PER_AXIS);
+	// the grid is centered on the bounds when it is cut short
+	glm::vec2 center((boundsMin.x + boundsMax.x) * 0.5f, (boundsMin.z + boundsMax.z) * 0.5f);
+	grid.origin = center - glm::vec2((float)grid.counts.x, (float)grid.counts.y) * (CELL_SIZE * 0.5f);
+	grid.eyeMin = boundsMin.y + MIN_EYE_HEIGHT;
+	grid.eyeMax = boundsMin.y + MAX_EYE_HEIGHT;
+
+	int cellCount = grid.counts.x * grid.counts.y;
+	grid.wordsPerCell = (cellCount + 31) / 32;
+	grid.visibleCells.assign((size_t)cellCount * grid.wordsPerCell, 0);
+
+	ParallelFor(cellCount, WORK_CHUNK, [&](int fromCell)
+	{
+		glm::ivec2 from(fromCell % grid.counts.x, fromCell / grid.counts.x);
+		glm::vec2 fromMin = grid.origin + glm::vec2((float)from.x, (float)from.y) * CELL_SIZE;
+		uint32_t* pVisible = &grid.visibleCells[(size_t)fromCell * grid.wordsPerCell];
+
+		for (int toCell = 0; toCell < cellCount; toCell++)
+		{
+			glm::ivec2 to(toCell % grid.counts.x, toCell / grid.counts.x);
+			glm::vec2 toMin = grid.origin + glm::vec2((float)to.x, (float)to.y) * CELL_SIZE;
+
+			bool bVisible = (std::abs(to.x - from.x) <= 1) && (std::abs(to.y - from.y) <= 1);
+			uint32_t state = (uint32_t)(fromCell * cellCount + toCell) * 2654435761u + 1u;
+			for (int ray = 0; (ray < PAIR_RAYS) && !bVisible; ray++)
+			{
+				glm::vec3 eye(
+					fromMin.x + NextRandom(state) * CELL_SIZE,
+					grid.eyeMin + NextRandom(state) * (grid.eyeMax - grid.eyeMin),
+					fromMin.y + NextRandom(state) * CELL_SIZE);
+				glm::vec3 target(
+					toMin.x + NextRandom(state) * CELL_SIZE,
+					boundsMin.y + NextRandom(state) * (boundsMax.y - boundsMin.y),
+					toMin.y + NextRandom(state) * CELL_SIZE);
+
+				glm::vec3 direction = target - eye;
+				float distance = glm::length(direction);
+				if (distance <= 0.0f)
+				{
+					continue;
+				}
+				direction /= distance;
+
+				TriangleBVH::RAY_HIT hit;
+				if (!bvh.Intersect(eye, direction, distance, hit))
+				{
+					bVisible = true;
+				}
+				else if (glm::dot(direction, worldNormals[hit.triangle]) < 0.0f)
+				{
+					bVisible = IsInColumn(eye + direction * hit.distance, toMin);
+				}
+			}
+
+			if (bVisible)
+			{
+				pVisible[toCell / 32] |= (1u << (toCell % 32));
+			}
+		}
+	});
+
+	int visiblePairs = 0;
+	for (int fromCell = 0; fromCell < cellCount; fromCell++)
+	{
+		for (int toCell = 0; toCell < cellCount; toCell++)
+		{
+			visiblePairs += IsCellVisible(grid, fromCell, toCell) ? 1 : 0;
+		}
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "INFO: Baked visibility of " << grid.counts.x << "x" << grid.counts.y << " cells, "
+		<< (100.0 * visiblePairs / ((double)cellCount * cellCount)) << "% of cell pairs visible, in "
+		<< elapsed.count() << " ms" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindCell()
+ *
+ *  This method returns the cell a camera is in.
+ ***********************************************************/
+int VisibilityBaker::FindCell(const VISIBILITY_GRID& grid, const glm::vec3& position)
+{
+	if (grid.visibleCells.empty() || (position.y < grid.eyeMin) || (position.y > grid.eyeMax))
+	{
+		return(-1);
+	}
+
+	int x = (int)std::floor((position.x - grid.origin.x) / CELL_SIZE);
+	int z = (int)std::floor((position.z - grid.origin.y) / CELL_SIZE);
+	if ((x < 0) || (x >= grid.counts.x) || (z < 0) || (z >= grid.counts.y))
+	{
+		return(-1);
+	}
+
+	return(z * grid.counts.x + x);
+}
+
+/***********************************************************
+ *  GetCellRange()
+ *
+ *  This method is used to get the cells under a box.
+ ***********************************************************/
+void VisibilityBaker::GetCellRange(
+	const VISIBILITY_GRID& grid,
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax,
+	glm::ivec2& first,
+	glm::ivec2& last)
+{
+	first.x = std::min(std::max((int)std::floor((boundsMin.x - grid.origin.x) / CELL_SIZE), 0), grid.counts.x - 1);
+	first.y = std::min(std::max((int)std::floor((boundsMin.z - grid.origin.y) / CELL_SIZE), 0), grid.counts.y - 1);
+	last.x = std::min(std::max((int)std::floor((boundsMax.x - grid.origin.x) / CELL_SIZE), 0), grid.counts.x - 1);
+	last.y = std::min(std::max((int)std::floor((boundsMax.z - grid.origin.y) / CELL_SIZE), 0), grid.counts.y - 1);
+}
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+// visibilitybaker.h
+// ============
+// bake the cells of the garden that can be seen from each other cell
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "LightmapBaker.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+/***********************************************************
+ *  VisibilityBaker
+ *
+ *  This class splits the ground of the scene into square
+ *  cells and finds, for every cell, the cells that can be
+ *  seen from a camera standing in it. Rays are cast between
+ *  random points of the camera's heights over one cell and
+ *  random points of the other cell, and a cell counts as
+ *  seen as soon as one ray reaches it. A cell always sees
+ *  itself and the cells around it, so a camera near a cell
+ *  edge never loses what is right next to it. The sets only
+ *  hold for a camera between the lowest and highest eye
+ *  heights, from above the hedges everything can be seen.
+ ***********************************************************/
+class VisibilityBaker
+{
+public:
+	// width and depth of a cell
+	static constexpr float CELL_SIZE = 2.5f;
+	// most cells along each side of the grid
+	static const int MAX_CELLS_PER_AXIS = 32;
+	// heights over the bottom of the scene that a camera can
+	// have for the sets to hold
+	static constexpr float MIN_EYE_HEIGHT = 0.25f;
+	static constexpr float MAX_EYE_HEIGHT = 2.0f;
+	// most rays cast from one cell to another
+	static const int PAIR_RAYS = 128;
+
+	// the baked sets, one bit per cell for every cell, in rows
+	// along X
+	struct VISIBILITY_GRID
+	{
+		// cells along X and along Z
+		glm::ivec2 counts;
+		// X and Z of the corner of the first cell
+		glm::vec2 origin;
+		float eyeMin;
+		float eyeMax;
+		int wordsPerCell;
+		std::vector<uint32_t> visibleCells;
+	};
+
+	// bake the sets over the bounds of the objects, all of
+	// which can hide the cells behind them
+	static bool Bake(
+		const std::vector<LightmapBaker::BAKE_OBJECT>& objects,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		VISIBILITY_GRID& grid);
+
+	// get the cell a camera is in, or -1 when it is outside the
+	// grid or its heights
+	static int FindCell(const VISIBILITY_GRID& grid, const glm::vec3& position);
+	// get the first and last cell along X and Z a box covers,
+	// clamped to the grid
+	static void GetCellRange(
+		const VISIBILITY_GRID& grid,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		glm::ivec2& first,
+		glm::ivec2& last);
+	// true when a cell can be seen from another
+	static bool IsCellVisible(const VISIBILITY_GRID& grid, int fromCell, int toCell)
+	{
+		return(((grid.visibleCells[fromCell * grid.wordsPerCell + toCell / 32] >> (toCell % 32)) & 1u) != 0);
+	}
+};
@@ -0,0 +1,980 @@
+///////////////////////////////////////////////////////////////////////////////
+// vulkanrenderhardware.cpp
+// ============
+// the render hardware interface on a Vulkan device without a window
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VulkanRenderHardware.h"
+
+#include <iostream>
+
+#ifdef USE_VULKAN
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  VulkanRhiBuffer
+	 *
+	 *  This class is a buffer of the Vulkan device, kept in
+	 *  memory the CPU can write, which suits buffers that are
+	 *  filled once or every frame.
+	 ***********************************************************/
+	class VulkanRhiBuffer : public RhiBuffer
+	{
+	public:
+		VulkanRhiBuffer(VkDevice device, size_t bytes)
+		{
+			m_device = device;
+			m_buffer = VK_NULL_HANDLE;
+			m_memory = VK_NULL_HANDLE;
+			m_size = bytes;
+		}
+
+		~VulkanRhiBuffer()
+		{
+			vkDestroyBuffer(m_device, m_buffer, NULL);
+			vkFreeMemory(m_device, m_memory, NULL);
+		}
+
+		size_t GetSize() const { return(m_size); }
+
+		VkDevice m_device;
+		VkBuffer m_buffer;
+		VkDeviceMemory m_memory;
+		size_t m_size;
+	};
+
+	/***********************************************************
+	 *  VulkanRhiTexture
+	 *
+	 *  This class is a render target of the Vulkan device, an
+	 *  image with the view and framebuffer that draw into it.
+	 ***********************************************************/
+	class VulkanRhiTexture : public RhiTexture
+	{
+	public:
+		VulkanRhiTexture(VkDevice device, int width, int height)
+		{
+			m_device = device;
+			m_image = VK_NULL_HANDLE;
+			m_memory = VK_NULL_HANDLE;
+			m_view = VK_NULL_HANDLE;
+			m_framebuffer = VK_NULL_HANDLE;
+			m_width = width;
+			m_height = height;
+			m_bDrawn = false;
+		}
+
+		~VulkanRhiTexture()
+		{
+			vkDestroyFramebuffer(m_device, m_framebuffer, NULL);
+			vkDestroyImageView(m_device, m_view, NULL);
+			vkDestroyImage(m_device, m_image, NULL);
+			vkFreeMemory(m_device, m_memory, NULL);
+		}
+
+		int GetWidth() const { return(m_width); }
+		int GetHeight() const { return(m_height); }
+
+		VkDevice m_device;
+		VkImage m_image;
+		VkDeviceMemory m_memory;
+		VkImageView m_view;
+		VkFramebuffer m_framebuffer;
+		int m_width;
+		int m_height;
+		// true once a submitted render pass has drawn into it,
+		// which leaves it in the layout for copying
+		bool m_bDrawn;
+	};
+
+	/***********************************************************
+	 *  VulkanRhiPipeline
+	 *
+	 *  This class is a graphics pipeline of the Vulkan device.
+	 ***********************************************************/
+	class VulkanRhiPipeline : public RhiPipeline
+	{
+	public:
+		explicit VulkanRhiPipeline(VkDevice device)
+		{
+			m_device = device;
+			m_layout = VK_NULL_HANDLE;
+			m_pipeline = VK_NULL_HANDLE;
+		}
+
+		~VulkanRhiPipeline()
+		{
+			vkDestroyPipeline(m_device, m_pipeline, NULL);
+			vkDestroyPipelineLayout(m_device, m_layout, NULL);
+		}
+
+		VkDevice m_device;
+		VkPipelineLayout m_layout;
+		VkPipeline m_pipeline;
+	};
+
+	/***********************************************************
+	 *  VulkanRhiCommandList
+	 *
+	 *  This class is a command list of the Vulkan device. It
+	 *  has its own command pool, since a pool can only be used
+	 *  by one thread at a time, and Begin() resets the pool so
+	 *  the memory of the last frame is used again.
+	 ***********************************************************/
+	class VulkanRhiCommandList : public RhiCommandList
+	{
+	public:
+		VulkanRhiCommandList(VkDevice device, VkRenderPass renderPass)
+		{
+			m_device = device;
+			m_renderPass = renderPass;
+			m_commandPool = VK_NULL_HANDLE;
+			m_commandBuffer = VK_NULL_HANDLE;
+			m_targetHeight = 0;
+			m_bRecorded = false;
+		}
+
+		~VulkanRhiCommandList()
+		{
+			// the command buffer is freed with its pool
+			vkDestroyCommandPool(m_device, m_commandPool, NULL);
+		}
+
+		void Begin()
+		{
+			vkResetCommandPool(m_device, m_commandPool, 0);
+			VkCommandBufferBeginInfo beginInfo = {};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
+			m_targets.clear();
+			m_bRecorded = false;
+		}
+
+		void BeginRenderPass(RhiTexture* pTarget, const glm::vec4& clearColor);
+
+		void SetViewport(int x, int y, int width, int height)
+		{
+			// Vulkan places the viewport from the top left corner
+			VkViewport viewport = {};
+			viewport.x = (float)x;
+			viewport.y = (float)(m_targetHeight - y - height);
+			viewport.width = (float)width;
+			viewport.height = (float)height;
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+			vkCmdSetViewport(m_commandBuffer, 0, 1, &viewport);
+
+			VkRect2D scissor = {};
+			scissor.offset.x = x;
+			scissor.offset.y = m_targetHeight - y - height;
+			scissor.extent.width = (uint32_t)width;
+			scissor.extent.height = (uint32_t)height;
+			vkCmdSetScissor(m_commandBuffer, 0, 1, &scissor);
+		}
+
+		void BindPipeline(RhiPipeline* pPipeline)
+		{
+			vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, static_cast<VulkanRhiPipeline*>(pPipeline)->m_pipeline);
+		}
+
+		void BindVertexBuffer(RhiBuffer* pBuffer)
+		{
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(m_commandBuffer, 0, 1, &static_cast<VulkanRhiBuffer*>(pBuffer)->m_buffer, &offset);
+		}
+
+		void BindIndexBuffer(RhiBuffer* pBuffer)
+		{
+			vkCmdBindIndexBuffer(m_commandBuffer, static_cast<VulkanRhiBuffer*>(pBuffer)->m_buffer, 0, VK_INDEX_TYPE_UINT32);
+		}
+
+		void Draw(int vertexCount, int firstVertex)
+		{
+			vkCmdDraw(m_commandBuffer, (uint32_t)vertexCount, 1, (uint32_t)firstVertex, 0);
+		}
+
+		void DrawIndexed(int indexCount, int firstIndex)
+		{
+			vkCmdDrawIndexed(m_commandBuffer, (uint32_t)indexCount, 1, (uint32_t)firstIndex, 0, 0);
+		}
+
+		void EndRenderPass()
+		{
+			vkCmdEndRenderPass(m_commandBuffer);
+		}
+
+		void End()
+		{
+			vkEndCommandBuffer(m_commandBuffer);
+			m_bRecorded = true;
+		}
+
+		VkDevice m_device;
+		VkCommandPool m_commandPool;
+		VkCommandBuffer m_commandBuffer;
+		// render pass of the device, which every target is drawn with
+		VkRenderPass m_renderPass;
+		int m_targetHeight;
+		// the targets the list draws into
+		std::vector<VulkanRhiTexture*> m_targets;
+		bool m_bRecorded;
+	};
+
+	/***********************************************************
+	 *  BeginRenderPass()
+	 *
+	 *  This method is used to start drawing into a target. The
+	 *  pass clears it, and the viewport covers all of it.
+	 ***********************************************************/
+	void VulkanRhiCommandList::BeginRenderPass(RhiTexture* pTarget, const glm::vec4& clearColor)
+	{
+		VulkanRhiTexture* pVulkanTarget = static_cast<VulkanRhiTexture*>(pTarget);
+
+		VkClearValue clearValue = {};
+		clearValue.color.float32[0] = clearColor.r;
+		clearValue.color.float32[1] = clearColor.g;
+		clearValue.color.float32[2] = clearColor.b;
+		clearValue.color.float32[3] = clearColor.a;
+
+		VkRenderPassBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		beginInfo.renderPass = m_renderPass;
+		beginInfo.framebuffer = pVulkanTarget->m_framebuffer;
+		beginInfo.renderArea.extent.width = (uint32_t)pVulkanTarget->m_width;
+		beginInfo.renderArea.extent.height = (uint32_t)pVulkanTarget->m_height;
+		beginInfo.clearValueCount = 1;
+		beginInfo.pClearValues = &clearValue;
+		vkCmdBeginRenderPass(m_commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		m_targetHeight = pVulkanTarget->m_height;
+		m_targets.push_back(pVulkanTarget);
+		SetViewport(0, 0, pVulkanTarget->m_width, pVulkanTarget->m_height);
+	}
+
+	/***********************************************************
+	 *  GetVertexFormat()
+	 *
+	 *  This function returns the Vulkan format of a vertex
+	 *  attribute format.
+	 ***********************************************************/
+	VkFormat GetVertexFormat(RHI_VERTEX_FORMAT format)
+	{
+		switch (format)
+		{
+		case RHI_VERTEX_FLOAT2:
+			return(VK_FORMAT_R32G32_SFLOAT);
+		case RHI_VERTEX_FLOAT3:
+			return(VK_FORMAT_R32G32B32_SFLOAT);
+		default:
+			return(VK_FORMAT_R32G32B32A32_SFLOAT);
+		}
+	}
+
+	/***********************************************************
+	 *  CreateShaderModule()
+	 *
+	 *  This function is used to create a shader module from
+	 *  SPIR-V words.
+	 ***********************************************************/
+	VkShaderModule CreateShaderModule(VkDevice device, const void* pCode, size_t codeSize)
+	{
+		VkShaderModuleCreateInfo moduleInfo = {};
+		moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		moduleInfo.codeSize = codeSize;
+		moduleInfo.pCode = (const uint32_t*)pCode;
+
+		VkShaderModule shaderModule = VK_NULL_HANDLE;
+		if (vkCreateShaderModule(device, &moduleInfo, NULL, &shaderModule) != VK_SUCCESS)
+		{
+			return(VK_NULL_HANDLE);
+		}
+
+		return(shaderModule);
+	}
+}
+
+/***********************************************************
+ *  VulkanRenderHardware()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VulkanRenderHardware::VulkanRenderHardware()
+{
+	m_instance = VK_NULL_HANDLE;
+	m_physicalDevice = VK_NULL_HANDLE;
+	memset(&m_memoryProperties, 0, sizeof(m_memoryProperties));
+	m_device = VK_NULL_HANDLE;
+	m_queueFamily = 0;
+	m_queue = VK_NULL_HANDLE;
+	m_renderPass = VK_NULL_HANDLE;
+	m_commandPool = VK_NULL_HANDLE;
+	m_fence = VK_NULL_HANDLE;
+	m_name = "Vulkan";
+}
+
+/***********************************************************
+ *  ~VulkanRenderHardware()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VulkanRenderHardware::~VulkanRenderHardware()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used to create an instance without any
+ *  extensions, since nothing is presented, and a device with
+ *  one queue on the first GPU that has a graphics queue. The
+ *  render pass, the pool of the copies and the fence of the
+ *  submits are created with it.
+ ***********************************************************/
+bool VulkanRenderHardware::Initialize()
+{
+	Destroy();
+
+	VkApplicationInfo appInfo = {};
+	appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	appInfo.pApplicationName = "7-1 FinalProject and Milestones";
+	appInfo.apiVersion = VK_API_VERSION_1_0;
+
+	VkInstanceCreateInfo instanceInfo = {};
+	instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instanceInfo.pApplicationInfo = &appInfo;
+	if (vkCreateInstance(&instanceInfo, NULL, &m_instance) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: Could not create a Vulkan instance" << std::endl;
+		m_instance = VK_NULL_HANDLE;
+		return(false);
+	}
+
+	uint32_t deviceCount = 0;
+	vkEnumeratePhysicalDevices(m_instance, &deviceCount, NULL);
+	std::vector<VkPhysicalDevice> physicalDevices(deviceCount);
+	vkEnumeratePhysicalDevices(m_instance, &deviceCount, physicalDevices.data());
+	for (uint32_t i = 0; (i < deviceCount) && (VK_NULL_HANDLE == m_physicalDevice); i++)
+	{
+		uint32_t familyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevices[i], &familyCount, NULL);
+		std::vector<VkQueueFamilyProperties> families(familyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevices[i], &familyCount, families.data());
+		for (uint32_t family = 0; family < familyCount; family++)
+		{
+			if ((families[family].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0)
+			{
+				m_physicalDevice = physicalDevices[i];
+				m_queueFamily = family;
+				break;
+			}
+		}
+	}
+	if (VK_NULL_HANDLE == m_physicalDevice)
+	{
+		std::cout << "ERROR: No Vulkan device can draw" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+	m_name = std::string("Vulkan ") + properties.deviceName;
+
+	float queuePriority = 1.0f;
+	VkDeviceQueueCreateInfo queueInfo = {};
+	queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queueInfo.queueFamilyIndex = m_queueFamily;
+	queueInfo.queueCount = 1;
+	queueInfo.pQueuePriorities = &queuePriority;
+
+	VkDeviceCreateInfo deviceInfo = {};
+	deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceInfo.queueCreateInfoCount = 1;
+	deviceInfo.pQueueCreateInfos = &queueInfo;
+	if (vkCreateDevice(m_physicalDevice, &deviceInfo, NULL, &m_device) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: Could not create the Vulkan device of " << properties.deviceName << std::endl;
+		m_device = VK_NULL_HANDLE;
+		Destroy();
+		return(false);
+	}
+	vkGetDeviceQueue(m_device, m_queueFamily, 0, &m_queue);
+
+	// the target is cleared, drawn and then left ready to copy,
+	// and the dependency makes the copy wait for the drawing
+	VkAttachmentDescription colorAttachment = {};
+	colorAttachment.format = VK_FORMAT_R8G8B8A8_UNORM;
+	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+	VkAttachmentReference colorReference = {};
+	colorReference.attachment = 0;
+	colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorReference;
+
+	VkSubpassDependency dependency = {};
+	dependency.srcSubpass = 0;
+	dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	VkRenderPassCreateInfo renderPassInfo = {};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = 1;
+	renderPassInfo.pAttachments = &colorAttachment;
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = 1;
+	renderPassInfo.pDependencies = &dependency;
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_queueFamily;
+
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	if ((vkCreateRenderPass(m_device, &renderPassInfo, NULL, &m_renderPass) != VK_SUCCESS) ||
+		(vkCreateCommandPool(m_device, &poolInfo, NULL, &m_commandPool) != VK_SUCCESS) ||
+		(vkCreateFence(m_device, &fenceInfo, NULL, &m_fence) != VK_SUCCESS))
+	{
+		std::cout << "ERROR: Could not create the Vulkan render pass" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	std::cout << "INFO: " << m_name << " is ready" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to wait for the device and free it.
+ ***********************************************************/
+void VulkanRenderHardware::Destroy()
+{
+	if (VK_NULL_HANDLE != m_device)
+	{
+		vkDeviceWaitIdle(m_device);
+		vkDestroyFence(m_device, m_fence, NULL);
+		vkDestroyCommandPool(m_device, m_commandPool, NULL);
+		vkDestroyRenderPass(m_device, m_renderPass, NULL);
+		vkDestroyDevice(m_device, NULL);
+	}
+	if (VK_NULL_HANDLE != m_instance)
+	{
+		vkDestroyInstance(m_instance, NULL);
+	}
+
+	m_instance = VK_NULL_HANDLE;
+	m_physicalDevice = VK_NULL_HANDLE;
+	m_device = VK_NULL_HANDLE;
+	m_queue = VK_NULL_HANDLE;
+	m_renderPass = VK_NULL_HANDLE;
+	m_commandPool = VK_NULL_HANDLE;
+	m_fence = VK_NULL_HANDLE;
+}
+
+/***********************************************************
+ *  AllocateMemory()
+ *
+ *  This method is used to allocate memory of the first type
+ *  that an object can use and that has every property asked
+ *  for.
+ ***********************************************************/
+bool VulkanRenderHardware::AllocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, VkDeviceMemory& memory) const
+{
+	for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+	{
+		if (((requirements.memoryTypeBits & (1u << i)) != 0) &&
+			((m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties))
+		{
+			VkMemoryAllocateInfo allocateInfo = {};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocateInfo.allocationSize = requirements.size;
+			allocateInfo.memoryTypeIndex = i;
+			if (vkAllocateMemory(m_device, &allocateInfo, NULL, &memory) == VK_SUCCESS)
+			{
+				return(true);
+			}
+			break;
+		}
+	}
+
+	memory = VK_NULL_HANDLE;
+	return(false);
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used to create a buffer in memory the CPU
+ *  can write and copy the data into it.
+ ***********************************************************/
+RhiBuffer* VulkanRenderHardware::CreateBuffer(RHI_BUFFER_USAGE usage, size_t bytes, const void* pData)
+{
+	if (bytes == 0)
+	{
+		return(NULL);
+	}
+
+	VulkanRhiBuffer* pBuffer = new VulkanRhiBuffer(m_device, bytes);
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = bytes;
+	bufferInfo.usage = (usage == RHI_BUFFER_INDEX) ? VK_BUFFER_USAGE_INDEX_BUFFER_BIT : VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (vkCreateBuffer(m_device, &bufferInfo, NULL, &pBuffer->m_buffer) != VK_SUCCESS)
+	{
+		pBuffer->m_buffer = VK_NULL_HANDLE;
+		delete pBuffer;
+		return(NULL);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_device, pBuffer->m_buffer, &requirements);
+	if (!AllocateMemory(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, pBuffer->m_memory) ||
+		(vkBindBufferMemory(m_device, pBuffer->m_buffer, pBuffer->m_memory, 0) != VK_SUCCESS))
+	{
+		std::cout << "ERROR: Could not allocate a Vulkan buffer of " << bytes << " bytes" << std::endl;
+		delete pBuffer;
+		return(NULL);
+	}
+
+	if (NULL != pData)
+	{
+		void* pMapped = NULL;
+		vkMapMemory(m_device, pBuffer->m_memory, 0, bytes, 0, &pMapped);
+		memcpy(pMapped, pData, bytes);
+		vkUnmapMemory(m_device, pBuffer->m_memory);
+	}
+
+	return(pBuffer);
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used to create an RGBA8 image that the
+ *  render pass draws into and that can be copied out.
+ ***********************************************************/
+RhiTexture* VulkanRenderHardware::CreateRenderTarget(int width, int height)
+{
+	VulkanRhiTexture* pTexture = new VulkanRhiTexture(m_device, width, height);
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+	imageInfo.extent.width = (uint32_t)width;
+	imageInfo.extent.height = (uint32_t)height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	bool bCreated = (vkCreateImage(m_device, &imageInfo, NULL, &pTexture->m_image) == VK_SUCCESS);
+	if (bCreated)
+	{
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(m_device, pTexture->m_image, &requirements);
+		bCreated = AllocateMemory(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pTexture->m_memory) &&
+			(vkBindImageMemory(m_device, pTexture->m_image, pTexture->m_memory, 0) == VK_SUCCESS);
+	}
+	else
+	{
+		pTexture->m_image = VK_NULL_HANDLE;
+	}
+
+	if (bCreated)
+	{
+		VkImageViewCreateInfo viewInfo = {};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = pTexture->m_image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.layerCount = 1;
+		bCreated = (vkCreateImageView(m_device, &viewInfo, NULL, &pTexture->m_view) == VK_SUCCESS);
+	}
+
+	if (bCreated)
+	{
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = m_renderPass;
+		framebufferInfo.attachmentCount = 1;
+		framebufferInfo.pAttachments = &pTexture->m_view;
+		framebufferInfo.width = (uint32_t)width;
+		framebufferInfo.height = (uint32_t)height;
+		framebufferInfo.layers = 1;
+		bCreated = (vkCreateFramebuffer(m_device, &framebufferInfo, NULL, &pTexture->m_framebuffer) == VK_SUCCESS);
+	}
+
+	if (!bCreated)
+	{
+		std::cout << "ERROR: The render target could not be created" << std::endl;
+		delete pTexture;
+		return(NULL);
+	}
+
+	return(pTexture);
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used to create a graphics pipeline from
+ *  SPIR-V, which draws triangle lists without culling or
+ *  depth into the render pass of the targets. The viewport
+ *  is set by the command lists.
+ ***********************************************************/
+RhiPipeline* VulkanRenderHardware::CreatePipeline(const RHI_PIPELINE_DESC& desc)
+{
+	if ((desc.attributeCount < 0) || (desc.attributeCount > RHI_MAX_VERTEX_ATTRIBUTES))
+	{
+		return(NULL);
+	}
+
+	VkShaderModule vertexModule = CreateShaderModule(m_device, desc.pVertexCode, desc.vertexCodeSize);
+	VkShaderModule fragmentModule = CreateShaderModule(m_device, desc.pFragmentCode, desc.fragmentCodeSize);
+
+	VkPipelineShaderStageCreateInfo stages[2] = {};
+	stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	stages[0].module = vertexModule;
+	stages[0].pName = "main";
+	stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	stages[1].module = fragmentModule;
+	stages[1].pName = "main";
+
+	VkVertexInputBindingDescription binding = {};
+	binding.binding = 0;
+	binding.stride = (uint32_t)desc.vertexStride;
+	binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	VkVertexInputAttributeDescription attributes[RHI_MAX_VERTEX_ATTRIBUTES] = {};
+	for (int i = 0; i < desc.attributeCount; i++)
+	{
+		attributes[i].location = (uint32_t)i;
+		attributes[i].binding = 0;
+		attributes[i].format = GetVertexFormat(desc.attributeFormats[i]);
+		attributes[i].offset = (uint32_t)desc.attributeOffsets[i];
+	}
+
+	VkPipelineVertexInputStateCreateInfo vertexInput = {};
+	vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount = 1;
+	vertexInput.pVertexBindingDescriptions = &binding;
+	vertexInput.vertexAttributeDescriptionCount = (uint32_t)desc.attributeCount;
+	vertexInput.pVertexAttributeDescriptions = attributes;
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	VkPipelineViewportStateCreateInfo viewportState = {};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+
+	VkPipelineRasterizationStateCreateInfo rasterization = {};
+	rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterization.cullMode = VK_CULL_MODE_NONE;
+	rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterization.lineWidth = 1.0f;
+
+	VkPipelineMultisampleStateCreateInfo multisample = {};
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineColorBlendAttachmentState blendAttachment = {};
+	blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkPipelineColorBlendStateCreateInfo colorBlend = {};
+	colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlend.attachmentCount = 1;
+	colorBlend.pAttachments = &blendAttachment;
+
+	VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState = {};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicStates;
+
+	VulkanRhiPipeline* pPipeline = new VulkanRhiPipeline(m_device);
+
+	VkPipelineLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	bool bCreated = (VK_NULL_HANDLE != vertexModule) && (VK_NULL_HANDLE != fragmentModule);
+	if (bCreated && (vkCreatePipelineLayout(m_device, &layoutInfo, NULL, &pPipeline->m_layout) != VK_SUCCESS))
+	{
+		pPipeline->m_layout = VK_NULL_HANDLE;
+		bCreated = false;
+	}
+
+	if (bCreated)
+	{
+		VkGraphicsPipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.stageCount = 2;
+		pipelineInfo.pStages = stages;
+		pipelineInfo.pVertexInputState = &vertexInput;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterization;
+		pipelineInfo.pMultisampleState = &multisample;
+		pipelineInfo.pColorBlendState = &colorBlend;
+		pipelineInfo.pDynamicState = &dynamicState;
+		pipelineInfo.layout = pPipeline->m_layout;
+		pipelineInfo.renderPass = m_renderPass;
+		pipelineInfo.subpass = 0;
+		bCreated = (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &pPipeline->m_pipeline) == VK_SUCCESS);
+	}
+
+	// the pipeline keeps what it needs of the modules
+	vkDestroyShaderModule(m_device, vertexModule, NULL);
+	vkDestroyShaderModule(m_device, fragmentModule, NULL);
+
+	if (!bCreated)
+	{
+		std::cout << "ERROR: " << desc.pName << " pipeline could not be created" << std::endl;
+		pPipeline->m_pipeline = VK_NULL_HANDLE;
+		delete pPipeline;
+		return(NULL);
+	}
+
+	return(pPipeline);
+}
+
+/***********************************************************
+ *  CreateCommandList()
+ *
+ *  This method is used to create a command list with its
+ *  own pool and command buffer.
+ ***********************************************************/
+RhiCommandList* VulkanRenderHardware::CreateCommandList()
+{
+	VulkanRhiCommandList* pCommandList = new VulkanRhiCommandList(m_device, m_renderPass);
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex = m_queueFamily;
+	if (vkCreateCommandPool(m_device, &poolInfo, NULL, &pCommandList->m_commandPool) != VK_SUCCESS)
+	{
+		pCommandList->m_commandPool = VK_NULL_HANDLE;
+		delete pCommandList;
+		return(NULL);
+	}
+
+	VkCommandBufferAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = pCommandList->m_commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	if (vkAllocateCommandBuffers(m_device, &allocateInfo, &pCommandList->m_commandBuffer) != VK_SUCCESS)
+	{
+		delete pCommandList;
+		return(NULL);
+	}
+
+	return(pCommandList);
+}
+
+/***********************************************************
+ *  SubmitAndWait()
+ *
+ *  This method is used to submit one command buffer to the
+ *  queue and wait for the fence it signals.
+ ***********************************************************/
+bool VulkanRenderHardware::SubmitAndWait(VkCommandBuffer commandBuffer)
+{
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	if (vkQueueSubmit(m_queue, 1, &submitInfo, m_fence) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	bool bFinished = (vkWaitForFences(m_device, 1, &m_fence, VK_TRUE, UINT64_MAX) == VK_SUCCESS);
+	vkResetFences(m_device, 1, &m_fence);
+
+	return(bFinished);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used to run a recorded command list and
+ *  wait until it has finished, after which its targets can
+ *  be read and the list recorded again.
+ ***********************************************************/
+void VulkanRenderHardware::Submit(RhiCommandList* pCommandList)
+{
+	VulkanRhiCommandList* pVulkanCommandList = static_cast<VulkanRhiCommandList*>(pCommandList);
+	if (!pVulkanCommandList->m_bRecorded)
+	{
+		std::cout << "ERROR: A command list was submitted before it was ended" << std::endl;
+		return;
+	}
+
+	if (!SubmitAndWait(pVulkanCommandList->m_commandBuffer))
+	{
+		std::cout << "ERROR: A Vulkan command list could not be submitted" << std::endl;
+		return;
+	}
+
+	for (size_t i = 0; i < pVulkanCommandList->m_targets.size(); i++)
+	{
+		pVulkanCommandList->m_targets[i]->m_bDrawn = true;
+	}
+}
+
+/***********************************************************
+ *  WaitIdle()
+ *
+ *  This method is used to wait until the device is idle.
+ ***********************************************************/
+void VulkanRenderHardware::WaitIdle()
+{
+	vkDeviceWaitIdle(m_device);
+}
+
+/***********************************************************
+ *  ReadPixels()
+ *
+ *  This method is used to copy a drawn target into a buffer
+ *  the CPU can read and from there into the pixels. Vulkan
+ *  images start with the top row already.
+ ***********************************************************/
+bool VulkanRenderHardware::ReadPixels(RhiTexture* pTexture, std::vector<unsigned char>& pixels)
+{
+	VulkanRhiTexture* pVulkanTexture = static_cast<VulkanRhiTexture*>(pTexture);
+	if (!pVulkanTexture->m_bDrawn)
+	{
+		return(false);
+	}
+
+	size_t bytes = (size_t)pVulkanTexture->m_width * pVulkanTexture->m_height * 4;
+	VulkanRhiBuffer readBuffer(m_device, bytes);
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = bytes;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (vkCreateBuffer(m_device, &bufferInfo, NULL, &readBuffer.m_buffer) != VK_SUCCESS)
+	{
+		readBuffer.m_buffer = VK_NULL_HANDLE;
+		return(false);
+	}
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_device, readBuffer.m_buffer, &requirements);
+	if (!AllocateMemory(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, readBuffer.m_memory) ||
+		(vkBindBufferMemory(m_device, readBuffer.m_buffer, readBuffer.m_memory, 0) != VK_SUCCESS))
+	{
+		return(false);
+	}
+
+	VkCommandBufferAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = m_commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	if (vkAllocateCommandBuffers(m_device, &allocateInfo, &commandBuffer) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent.width = (uint32_t)pVulkanTexture->m_width;
+	region.imageExtent.height = (uint32_t)pVulkanTexture->m_height;
+	region.imageExtent.depth = 1;
+	vkCmdCopyImageToBuffer(commandBuffer, pVulkanTexture->m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readBuffer.m_buffer, 1, &region);
+
+	// the copy is made visible to the CPU before it is mapped
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = readBuffer.m_buffer;
+	barrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+	vkEndCommandBuffer(commandBuffer);
+
+	bool bCopied = SubmitAndWait(commandBuffer);
+	vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
+	if (bCopied)
+	{
+		void* pMapped = NULL;
+		vkMapMemory(m_device, readBuffer.m_memory, 0, bytes, 0, &pMapped);
+		pixels.assign((const unsigned char*)pMapped, (const unsigned char*)pMapped + bytes);
+		vkUnmapMemory(m_device, readBuffer.m_memory);
+	}
+
+	return(bCopied);
+}
+#endif
+
+/***********************************************************
+ *  CreateVulkanRenderHardware()
+ *
+ *  This function is used to create the Vulkan device, or to
+ *  say that the build has none.
+ ***********************************************************/
+RenderHardware* CreateVulkanRenderHardware()
+{
+#ifdef USE_VULKAN
+	VulkanRenderHardware* pHardware = new VulkanRenderHardware();
+	if (!pHardware->Initialize())
+	{
+		delete pHardware;
+		return(NULL);
+	}
+
+	return(pHardware);
+#else
+	std::cout << "ERROR: This build has no Vulkan backend, it is built with USE_VULKAN and the Vulkan loader" << std::endl;
+	return(NULL);
+#endif
+}
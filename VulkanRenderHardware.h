@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// vulkanrenderhardware.h
+// ============
+// the render hardware interface on a Vulkan device without a window
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderHardware.h"
+
+#ifdef USE_VULKAN
+#include <vulkan/vulkan.h>
+
+#include <string>
+
+/***********************************************************
+ *  VulkanRenderHardware
+ *
+ *  This class is the device of the render hardware interface
+ *  on Vulkan. It draws into its own render targets and has
+ *  no surface, so it runs on a software driver such as
+ *  lavapipe on a machine without a display. Each command
+ *  list has its own command pool, so lists can be recorded
+ *  on several threads at once, and a submit waits for the
+ *  list to finish. Pipelines take SPIR-V, and their clip
+ *  space has y pointing down, as Vulkan defines it. It is
+ *  built when USE_VULKAN is defined and the Vulkan loader is
+ *  linked.
+ ***********************************************************/
+class VulkanRenderHardware : public RenderHardware
+{
+public:
+	// constructor
+	VulkanRenderHardware();
+	// destructor
+	~VulkanRenderHardware();
+
+	// create the instance and the device of the first GPU that
+	// can draw, returns false when there is none
+	bool Initialize();
+	// free the device, the objects it created must be deleted
+	void Destroy();
+
+	const char* GetName() const { return(m_name.c_str()); }
+	RHI_SHADER_LANGUAGE GetShaderLanguage() const { return(RHI_SHADER_SPIRV); }
+
+	RhiBuffer* CreateBuffer(RHI_BUFFER_USAGE usage, size_t bytes, const void* pData);
+	RhiTexture* CreateRenderTarget(int width, int height);
+	RhiPipeline* CreatePipeline(const RHI_PIPELINE_DESC& desc);
+	RhiCommandList* CreateCommandList();
+
+	void Submit(RhiCommandList* pCommandList);
+	void WaitIdle();
+	bool ReadPixels(RhiTexture* pTexture, std::vector<unsigned char>& pixels);
+
+private:
+	VkInstance m_instance;
+	VkPhysicalDevice m_physicalDevice;
+	VkPhysicalDeviceMemoryProperties m_memoryProperties;
+	VkDevice m_device;
+	uint32_t m_queueFamily;
+	VkQueue m_queue;
+	// every render target is drawn with this pass, which clears
+	// it and leaves it ready to be copied
+	VkRenderPass m_renderPass;
+	// pool of the copies made by ReadPixels()
+	VkCommandPool m_commandPool;
+	// signaled when a submitted list has finished
+	VkFence m_fence;
+	std::string m_name;
+
+	// allocate memory for an object with the passed in properties
+	bool AllocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, VkDeviceMemory& memory) const;
+	// submit a command buffer and wait until it has finished
+	bool SubmitAndWait(VkCommandBuffer commandBuffer);
+};
+#endif
+
+// create and initialize the Vulkan device, NULL when there is
+// no device or the build has no Vulkan backend
+RenderHardware* CreateVulkanRenderHardware();